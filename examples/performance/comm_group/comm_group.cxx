@@ -0,0 +1,114 @@
+/*
+ * Group communications benchmark
+ *
+ * Times gathering to and scattering from one processor, as done by
+ * Laplacian solvers which collect data from a group of processors:
+ *  - starting each operation with Comm_gather_start / Comm_scatter_start
+ *  - with persistent requests, set up once by Comm_gather_init /
+ *    Comm_scatter_init and started with Comm_start
+ *
+ * The method used is set by the comms:group_nonblock and
+ * comms:group_native options. The runexample script compares them
+ */
+
+#include <bout.hxx>
+#include <comm_group.hxx>
+#include <boutcomm.hxx>
+
+#include <chrono>
+#include <vector>
+
+typedef std::chrono::time_point<std::chrono::steady_clock> SteadyClock;
+typedef std::chrono::duration<double> Duration;
+using namespace std::chrono;
+
+/// Time \p repeat calls to \p func, returning the time per call in microseconds.
+/// Processors are synchronised before starting, and the slowest time returned
+template<typename F>
+BoutReal timeit(F func, int repeat, MPI_Comm comm) {
+  func(); // Warm up
+  MPI_Barrier(comm);
+  SteadyClock start = steady_clock::now();
+  for(int i=0;i<repeat;i++)
+    func();
+  BoutReal local = 1e6 * Duration(steady_clock::now() - start).count() / repeat;
+  BoutReal slowest;
+  MPI_Allreduce(&local, &slowest, 1, MPI_DOUBLE, MPI_MAX, comm);
+  return slowest;
+}
+
+int main(int argc, char **argv) {
+  BoutInitialise(argc, argv);
+
+  Options *opt = Options::getRoot()->getSection("comm_group");
+  int nlocal, repeat;
+  OPTION(opt, nlocal, 64);
+  OPTION(opt, repeat, 100);
+
+  MPI_Comm comm = BoutComm::get();
+  int nprocs, myrank;
+  MPI_Comm_size(comm, &nprocs);
+  MPI_Comm_rank(comm, &myrank);
+  const int root = 0;
+
+  std::vector<BoutReal> local(nlocal), result(nlocal), data(nlocal*nprocs);
+  for(int i=0;i<nlocal;i++)
+    local[i] = myrank + 1e-3*i;
+
+  Comm_handle_t handle;
+
+  BoutReal gather = timeit([&]() {
+      Comm_gather_start(local.data(), nlocal, MPI_DOUBLE, data.data(), root, comm, &handle);
+      Comm_wait(&handle);
+    }, repeat, comm);
+
+  // Send back the gathered data
+  BoutReal scatter = timeit([&]() {
+      Comm_scatter_start(data.data(), nlocal, MPI_DOUBLE, result.data(), root, comm, &handle);
+      Comm_wait(&handle);
+    }, repeat, comm);
+
+  int errors = 0;
+  for(int i=0;i<nlocal;i++)
+    if(result[i] != local[i])
+      errors++;
+
+  Comm_handle_t pgather_handle, pscatter_handle;
+  Comm_gather_init(local.data(), nlocal, MPI_DOUBLE, data.data(), root, comm, &pgather_handle);
+  Comm_scatter_init(data.data(), nlocal, MPI_DOUBLE, result.data(), root, comm, &pscatter_handle);
+
+  BoutReal pgather = timeit([&]() {
+      Comm_start(&pgather_handle);
+      Comm_wait(&pgather_handle);
+    }, repeat, comm);
+
+  for(auto &r : result)
+    r = 0.0;
+
+  BoutReal pscatter = timeit([&]() {
+      Comm_start(&pscatter_handle);
+      Comm_wait(&pscatter_handle);
+    }, repeat, comm);
+
+  for(int i=0;i<nlocal;i++)
+    if(result[i] != local[i])
+      errors++;
+
+  Comm_handle_free(&handle);
+  Comm_handle_free(&pgather_handle);
+  Comm_handle_free(&pscatter_handle);
+
+  int total_errors;
+  MPI_Allreduce(&errors, &total_errors, 1, MPI_INT, MPI_SUM, comm);
+
+  output << "Processors                 : " << nprocs << std::endl;
+  output << "TIMING (us per operation)\n=========================\n";
+  output << "Gather                     : " << gather << std::endl;
+  output << "Scatter                    : " << scatter << std::endl;
+  output << "Persistent gather          : " << pgather << std::endl;
+  output << "Persistent scatter         : " << pscatter << std::endl;
+  output << "Errors                     : " << total_errors << std::endl;
+
+  BoutFinalise();
+  return 0;
+}
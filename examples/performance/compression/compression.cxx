@@ -0,0 +1,107 @@
+/*
+ * Compression of 3D output
+ *
+ * Writes a 3D field using each of the output settings listed in
+ * compression:cases, and reports for each
+ *  - the compression ratio (size of the data / size of the file)
+ *  - write throughput, in MB/s of uncompressed data
+ *  - the maximum error when the data is read back
+ *
+ * The field is set by compression:function, by default similar to the
+ * initial conditions of the standard examples. A dump file from a
+ * simulation can be used instead by setting compression:input to the
+ * file name (e.g. "data/BOUT.dmp.nc") and compression:var to the
+ * variable, in which case the last time point is used.
+ */
+
+#include <bout.hxx>
+#include <field_factory.hxx>
+#include <boutcomm.hxx>
+#include <utils.hxx>
+
+#include <chrono>
+#include <fstream>
+
+typedef std::chrono::time_point<std::chrono::steady_clock> SteadyClock;
+typedef std::chrono::duration<double> Duration;
+using namespace std::chrono;
+
+/// Size of a file in bytes, or zero if it can't be opened
+long fileSize(const std::string &name) {
+  std::ifstream file(name, std::ios::binary | std::ios::ate);
+  if(!file.good())
+    return 0;
+  return file.tellg();
+}
+
+int main(int argc, char **argv) {
+  BoutInitialise(argc, argv);
+
+  Options *opt = Options::getRoot()->getSection("compression");
+  int repeat;
+  OPTION(opt, repeat, 10);
+  std::string function, input, var, cases;
+  OPTION(opt, function, "1 + 0.1*sin(2*pi*x)*cos(y - 3*z) + 1e-3*mixmode(z)");
+  OPTION(opt, input, "");
+  OPTION(opt, var, "n");
+  OPTION(opt, cases, "none, lossless, lossy");
+
+  std::string dump_ext;
+  Options::getRoot()->get("dump_format", dump_ext, "nc");
+
+  Field3D f;
+  if(input.empty()) {
+    FieldFactory factory(mesh);
+    f = factory.create3D(function);
+  }else {
+    Datafile in(opt);
+    in.add(f, var.c_str(), true);
+    in.openr(input.c_str());
+    in.read();
+    in.close();
+  }
+
+  int MYPE;
+  MPI_Comm_rank(BoutComm::get(), &MYPE);
+
+  // Size of the data written by all processors
+  BoutReal megabytes = repeat * 8.0e-6 * mesh->LocalNx * mesh->LocalNy * mesh->LocalNz;
+  MPI_Allreduce(MPI_IN_PLACE, &megabytes, 1, MPI_DOUBLE, MPI_SUM, BoutComm::get());
+
+  output << "\nCase          Ratio   Write MB/s   Max error\n";
+  for(const auto &name : strsplit(cases, ',')) {
+    std::string section = trim(name);
+    Options *caseopt = Options::getRoot()->getSection(section);
+    std::string filename = "data/" + section + ".dmp." + dump_ext;
+
+    Datafile dump(caseopt);
+    dump.add(f, "f", true);
+    dump.openw(filename.c_str());
+
+    SteadyClock start = steady_clock::now();
+    for(int i=0;i<repeat;i++) {
+      dump.write();
+    }
+    dump.close();
+    BoutReal elapsed = Duration(steady_clock::now() - start).count();
+    MPI_Allreduce(MPI_IN_PLACE, &elapsed, 1, MPI_DOUBLE, MPI_MAX, BoutComm::get());
+
+    // Read the last record back
+    Field3D g;
+    Datafile in(caseopt);
+    in.add(g, "f", true);
+    in.openr(filename.c_str());
+    in.read();
+    in.close();
+
+    BoutReal bytes = fileSize("data/" + section + ".dmp." + toString(MYPE) + "." + dump_ext);
+    MPI_Allreduce(MPI_IN_PLACE, &bytes, 1, MPI_DOUBLE, MPI_SUM, BoutComm::get());
+
+    output.write("%-12s %6.2f   %10.1f   %9.2e\n", section.c_str(),
+                 1.0e6 * megabytes / bytes, megabytes / elapsed, max(abs(g - f), true));
+  }
+  output << "\n";
+
+  BoutFinalise();
+  return 0;
+}
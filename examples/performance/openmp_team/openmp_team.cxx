@@ -0,0 +1,108 @@
+/*
+ * Scaling of field operations with OpenMP threads
+ *
+ * Compares a chain of Field3D operations, similar to a physics RHS:
+ *  - run serially
+ *  - with a parallel region opened and closed for each operation
+ *  - with one persistent parallel region (as solver:openmp_team = true)
+ *
+ * Run with different numbers of threads using OMP_NUM_THREADS, or the
+ * runexample script.
+ */
+
+#include <bout.hxx>
+#include <derivs.hxx>
+#include <field_factory.hxx>
+#include <bout/openmpwrap.hxx>
+
+#include <chrono>
+
+typedef std::chrono::time_point<std::chrono::steady_clock> SteadyClock;
+typedef std::chrono::duration<double> Duration;
+using namespace std::chrono;
+
+/// A chain of operations on n and phi, returning a time derivative
+const Field3D rhs(const Field3D &n, const Field3D &phi) {
+  return -DDX(phi)*DDZ(n) + DDZ(phi)*DDX(n) + 0.1*D2DX2(n) + 0.01*n*n;
+}
+
+/// Evaluate f() in its own parallel region, the work being
+/// shared between the threads
+template<typename F>
+const Field3D forkJoin(F f) {
+  Field3D result;
+  ompRunTeam([&]() { result = f(); });
+  return result;
+}
+
+/// The same as rhs, but opening a parallel region for every operation
+const Field3D rhsForkJoin(const Field3D &n, const Field3D &phi) {
+  Field3D dxphi = forkJoin([&]() { return DDX(phi); });
+  Field3D dzn = forkJoin([&]() { return DDZ(n); });
+  Field3D dzphi = forkJoin([&]() { return DDZ(phi); });
+  Field3D dxn = forkJoin([&]() { return DDX(n); });
+  Field3D d2n = forkJoin([&]() { return D2DX2(n); });
+
+  Field3D result = forkJoin([&]() { return -dxphi*dzn; });
+  result = forkJoin([&]() { return result + dzphi*dxn; });
+  result = forkJoin([&]() { return result + 0.1*d2n; });
+  return forkJoin([&]() { return result + 0.01*n*n; });
+}
+
+int main(int argc, char **argv) {
+  BoutInitialise(argc, argv);
+
+  Options *opt = Options::getRoot()->getSection("openmp_team");
+  int repeat;
+  OPTION(opt, repeat, 100);
+
+  FieldFactory f(mesh);
+  Field3D n = f.create3D("1 + 0.1*sin(2*pi*x)*cos(z)");
+  Field3D phi = f.create3D("0.1*cos(2*pi*x)*sin(2*z)");
+  mesh->communicate(n, phi);
+
+  int threads = 1;
+#ifdef _OPENMP
+  threads = omp_get_max_threads();
+#endif
+
+  // Run once so first test doesn't have a disadvantage from caching
+  Field3D serial = rhs(n, phi);
+
+  // No threading
+  SteadyClock start1 = steady_clock::now();
+  for(int i=0;i<repeat;i++) {
+    serial = rhs(n, phi);
+  }
+  Duration elapsed1 = steady_clock::now() - start1;
+
+  // A parallel region for each operation
+  Field3D forkjoin;
+  SteadyClock start2 = steady_clock::now();
+  for(int i=0;i<repeat;i++) {
+    forkjoin = rhsForkJoin(n, phi);
+  }
+  Duration elapsed2 = steady_clock::now() - start2;
+
+  // One parallel region for all operations
+  Field3D team;
+  SteadyClock start3 = steady_clock::now();
+  ompRunTeam([&]() {
+    for(int i=0;i<repeat;i++) {
+      team = rhs(n, phi);
+    }
+  });
+  Duration elapsed3 = steady_clock::now() - start3;
+
+  output << "Threads                    : " << threads << std::endl;
+  output << "TIMING (per RHS)\n================\n";
+  output << "Serial                     : " << elapsed1.count() / repeat << std::endl;
+  output << "Parallel region per op     : " << elapsed2.count() / repeat << std::endl;
+  output << "Persistent team            : " << elapsed3.count() / repeat << std::endl;
+  output << "Max difference from serial : "
+         << BOUTMAX(max(abs(forkjoin - serial), true), max(abs(team - serial), true))
+         << std::endl;
+
+  BoutFinalise();
+  return 0;
+}
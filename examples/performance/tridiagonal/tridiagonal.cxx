@@ -0,0 +1,100 @@
+/*
+ * Batched tridiagonal solver benchmark
+ *
+ * Solves nsys independent tridiagonal systems of size n, as done by the
+ * Laplacian inversions for each Fourier mode, and reports the time per
+ * system for
+ *  - tridag (or cyclic_tridag if periodic), called once per system
+ *  - BatchedTridag, setting the coefficients and solving each time
+ *  - BatchedTridag, reusing the factorisation
+ *
+ * for both real and complex coefficients. The last column is the
+ * speed-up over tridag
+ */
+
+#include <bout.hxx>
+#include <batched_tridag.hxx>
+#include <lapack_routines.hxx>
+#include <utils.hxx>
+
+#include <chrono>
+
+typedef std::chrono::time_point<std::chrono::steady_clock> SteadyClock;
+typedef std::chrono::duration<double> Duration;
+using namespace std::chrono;
+
+/// Time \p repeat calls to \p func, returning the time per system in microseconds
+template<typename F>
+BoutReal timeit(F func, int repeat, int nsys) {
+  func(); // Warm up
+  SteadyClock start = steady_clock::now();
+  for(int i=0;i<repeat;i++)
+    func();
+  return 1e6 * Duration(steady_clock::now() - start).count() / (repeat * nsys);
+}
+
+template<typename T>
+void benchmark(const char *name, int nsys, int n, int repeat, bool periodic) {
+  T **a = matrix<T>(nsys, n);
+  T **b = matrix<T>(nsys, n);
+  T **c = matrix<T>(nsys, n);
+  T **rhs = matrix<T>(nsys, n);
+  T **x = matrix<T>(nsys, n);
+
+  // Diagonally dominant, like a Laplacian with different kz
+  for(int s=0;s<nsys;s++)
+    for(int i=0;i<n;i++) {
+      a[s][i] = c[s][i] = 1.0;
+      b[s][i] = -2.0 - 0.01*s*s - 0.1*sin(0.3*i);
+      rhs[s][i] = cos(0.1*i*(s+1));
+    }
+
+  BoutReal single = timeit([&]() {
+      for(int s=0;s<nsys;s++) {
+        if(periodic) {
+          cyclic_tridag(a[s], b[s], c[s], rhs[s], x[s], n);
+        }else
+          tridag(a[s], b[s], c[s], rhs[s], x[s], n);
+      }
+    }, repeat, nsys);
+
+  BatchedTridag<T> tri(nsys, n);
+  tri.setPeriodic(periodic);
+
+  BoutReal batched = timeit([&]() {
+      tri.setCoefs(nsys, a, b, c);
+      tri.solve(nsys, rhs, x);
+    }, repeat, nsys);
+
+  BoutReal reuse = timeit([&]() { tri.solve(nsys, rhs, x); }, repeat, nsys);
+
+  output.write("%-10s %-16s %10.4f   %5.2f\n", name, "tridag", single, 1.0);
+  output.write("%-10s %-16s %10.4f   %5.2f\n", name, "batched", batched, single/batched);
+  output.write("%-10s %-16s %10.4f   %5.2f\n", name, "batched reuse", reuse, single/reuse);
+
+  free_matrix(a);
+  free_matrix(b);
+  free_matrix(c);
+  free_matrix(rhs);
+  free_matrix(x);
+}
+
+int main(int argc, char **argv) {
+  BoutInitialise(argc, argv);
+
+  Options *opt = Options::getRoot()->getSection("tridiagonal");
+  int nsys, n, repeat;
+  OPTION(opt, nsys, 65);
+  OPTION(opt, n, 68);
+  OPTION(opt, repeat, 2000);
+  bool periodic;
+  OPTION(opt, periodic, false);
+
+  output << "\nCase       Method           us/system   Speedup\n";
+  benchmark<BoutReal>("real", nsys, n, repeat, periodic);
+  benchmark<dcomplex>("complex", nsys, n, repeat, periodic);
+  output << "\n";
+
+  BoutFinalise();
+  return 0;
+}
@@ -0,0 +1,321 @@
+/************************************************************************
+ * Batched solution of many independent tridiagonal systems
+ *
+ * Solving one small system at a time, as tridag() does, is limited by
+ * the recurrence in the Thomas algorithm: each row depends on the one
+ * before, so nothing can be vectorised. Here all systems are stored
+ * interleaved, row i of system s at index i*nsys + s, and each step of
+ * the algorithm is done for all systems at once. The inner loop over
+ * systems is over contiguous memory, and vectorises.
+ *
+ * The LU factorisation is done once, when the first solve is done after
+ * the coefficients are set. Later solves only do the forward and back
+ * substitution, using multiplication by stored inverse pivots.
+ *
+ * Example
+ * -------
+ *
+ *     BatchedTridag<dcomplex> tri(nsys, n);
+ *     tri.setCoefs(nsys, a, b, c);  // [nsys][n] arrays, as CyclicReduce
+ *     tri.solve(nsys, rhs, x);      // Factorises, then solves
+ *     tri.solve(nsys, rhs2, x2);    // Reuses the factorisation
+ *
+ * No pivoting is done, so the matrices should be diagonally dominant.
+ * This can be checked with diagonallyDominant(); systems which are not
+ * can be made the identity with setIdentity() and solved separately
+ * with a pivoting solver such as tridag().
+ *
+ **************************************************************************
+ * Copyright 2010 B.D.Dudson, S.Farley, M.V.Umansky, X.Q.Xu
+ *
+ * Contact: Ben Dudson, bd512@york.ac.uk
+ *
+ * This file is part of BOUT++.
+ *
+ * BOUT++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BOUT++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with BOUT++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ************************************************************************/
+
+#ifndef __BATCHED_TRIDAG_H__
+#define __BATCHED_TRIDAG_H__
+
+#include "bout_types.hxx"
+#include "dcomplex.hxx"
+#include "boutexception.hxx"
+#include "bout/array.hxx"
+#include "bout/openmpwrap.hxx"
+
+#include <cmath>
+
+namespace batched_tridag {
+  /// Multiplication which the compiler can vectorise. For complex
+  /// numbers operator* checks for NaNs and infinities, which prevents
+  /// vectorisation unless compiled with -ffast-math
+  inline BoutReal mul(BoutReal a, BoutReal b) { return a*b; }
+  inline dcomplex mul(const dcomplex &a, const dcomplex &b) {
+    return dcomplex(a.real()*b.real() - a.imag()*b.imag(),
+                    a.real()*b.imag() + a.imag()*b.real());
+  }
+
+  /// Reciprocal which the compiler can vectorise. Unlike operator/
+  /// this does not rescale to avoid overflow, which is not a problem
+  /// for the diagonally dominant matrices solved here
+  inline BoutReal inv(BoutReal a) { return 1.0 / a; }
+  inline dcomplex inv(const dcomplex &a) {
+    BoutReal norm = 1.0 / (a.real()*a.real() + a.imag()*a.imag());
+    return dcomplex(a.real()*norm, -a.imag()*norm);
+  }
+}
+
+template <class T>
+class BatchedTridag {
+public:
+  BatchedTridag() : Nsys(0), N(0), periodic(false), factored(false) {}
+
+  /// @param[in] nsys  The number of independent systems
+  /// @param[in] size  The number of rows in each system
+  BatchedTridag(int nsys, int size) : periodic(false) {
+    setup(nsys, size);
+  }
+
+  /// Set the number and size of the systems
+  void setup(int nsys, int size) {
+    Nsys = nsys;
+    N = size;
+    a = Array<T>(N*Nsys);
+    b = Array<T>(N*Nsys);
+    c = Array<T>(N*Nsys);
+    gam = Array<T>(N*Nsys);
+    ibet = Array<T>(N*Nsys);
+    work = Array<T>(N*Nsys);
+    factored = false;
+  }
+
+  /// Specify that the systems are periodic (cyclic tridiagonal).
+  /// By default not periodic
+  void setPeriodic(bool p=true) {
+    if(p != periodic)
+      factored = false;
+    periodic = p;
+  }
+
+  /// Set the coefficients of system \p s. Each array has N values
+  void setCoefs(int s, const T *as, const T *bs, const T *cs) {
+    for(int i=0;i<N;i++) {
+      a[i*Nsys + s] = as[i];
+      b[i*Nsys + s] = bs[i];
+      c[i*Nsys + s] = cs[i];
+    }
+    factored = false;
+  }
+
+  /// Make system \p s the identity, so that solve() leaves its right
+  /// hand side unchanged. Used for systems which are solved another way
+  void setIdentity(int s) {
+    for(int i=0;i<N;i++) {
+      a[i*Nsys + s] = 0.0;
+      b[i*Nsys + s] = 1.0;
+      c[i*Nsys + s] = 0.0;
+    }
+    factored = false;
+  }
+
+  /// Is the system with diagonals \p as, \p bs and \p cs, each of
+  /// size \p n, diagonally dominant? If so it can be solved without
+  /// pivoting. A small tolerance accepts rows which are dominant to
+  /// rounding error, such as interior rows of the Laplacian for kz = 0
+  static bool diagonallyDominant(int n, const T *as, const T *bs, const T *cs,
+                                 bool periodic) {
+    for(int i=0;i<n;i++) {
+      BoutReal offdiag = 0.0;
+      if((i > 0) || periodic)
+        offdiag += std::abs(as[i]);
+      if((i < n-1) || periodic)
+        offdiag += std::abs(cs[i]);
+      BoutReal diag = std::abs(bs[i]);
+      if((diag == 0.0) || (diag < offdiag*(1.0 - 1e-10)))
+        return false;
+    }
+    return true;
+  }
+
+  /// Set the coefficients of all systems
+  ///
+  /// @param[in] nsys  Number of systems. Must be the same as in setup
+  /// @param[in] as    Left diagonal, size [nsys][N]. as[s][0] only used if periodic
+  /// @param[in] bs    Diagonal, size [nsys][N]
+  /// @param[in] cs    Right diagonal, size [nsys][N]. cs[s][N-1] only used if periodic
+  void setCoefs(int nsys, T **as, T **bs, T **cs) {
+    if(nsys != Nsys)
+      throw BoutException("BatchedTridag: Expected %d systems, got %d", Nsys, nsys);
+    for(int s=0;s<Nsys;s++)
+      setCoefs(s, as[s], bs[s], cs[s]);
+  }
+
+  /// Solve all systems, with RHS and result in [nsys][N] arrays.
+  /// \p rhs and \p x can be the same
+  void solve(int nsys, T **rhs, T **x) {
+    if(nsys != Nsys)
+      throw BoutException("BatchedTridag: Expected %d systems, got %d", Nsys, nsys);
+
+    for(int i=0;i<N;i++)
+      for(int s=0;s<Nsys;s++)
+        work[i*Nsys + s] = rhs[s][i];
+
+    solve(work.begin(), Nsys);
+
+    for(int s=0;s<Nsys;s++)
+      for(int i=0;i<N;i++)
+        x[s][i] = work[i*Nsys + s];
+  }
+
+  /// Solve all systems in place, with data already interleaved:
+  /// row i of system s is data[i*ld + s]. The leading dimension \p ld
+  /// must be at least the number of systems
+  void solve(T *data, int ld) {
+    if(!factored)
+      factor();
+
+    using batched_tridag::mul;
+
+    // Forward substitution
+    {
+      T *x = data;
+      const T *ib = &ibet[0];
+      BOUT_OMP(simd)
+      for(int s=0;s<Nsys;s++)
+        x[s] = mul(x[s], ib[s]);
+    }
+    for(int i=1;i<N;i++) {
+      T *x = data + i*ld;
+      const T *xm = data + (i-1)*ld;
+      const T *ai = &a[i*Nsys];
+      const T *ib = &ibet[i*Nsys];
+      BOUT_OMP(simd)
+      for(int s=0;s<Nsys;s++)
+        x[s] = mul(x[s] - mul(ai[s], xm[s]), ib[s]);
+    }
+
+    // Back substitution
+    for(int i=N-2;i>=0;i--) {
+      T *x = data + i*ld;
+      const T *xp = data + (i+1)*ld;
+      const T *g = &gam[(i+1)*Nsys];
+      BOUT_OMP(simd)
+      for(int s=0;s<Nsys;s++)
+        x[s] -= mul(g[s], xp[s]);
+    }
+
+    if(periodic) {
+      // Sherman-Morrison correction, x -= (v.x / (1 + v.z)) z
+      const T *x0 = data;
+      const T *xn = data + (N-1)*ld;
+      for(int s=0;s<Nsys;s++)
+        fact[s] = mul(x0[s] + mul(va[s], xn[s]), iden[s]);
+      for(int i=0;i<N;i++) {
+        T *x = data + i*ld;
+        const T *zi = &z[i*Nsys];
+        BOUT_OMP(simd)
+        for(int s=0;s<Nsys;s++)
+          x[s] -= mul(fact[s], zi[s]);
+      }
+    }
+  }
+
+  /// Factorise the matrices. Called by solve() if needed
+  void factor() {
+    if(periodic && (N <= 2))
+      throw BoutException("BatchedTridag: N too small for periodic system");
+
+    // Diagonal, modified if periodic
+    Array<T> d(N*Nsys);
+    for(int i=0;i<N*Nsys;i++)
+      d[i] = b[i];
+
+    if(periodic) {
+      va = Array<T>(Nsys);
+      iden = Array<T>(Nsys);
+      fact = Array<T>(Nsys);
+      z = Array<T>(N*Nsys);
+      // As cyclic_tridag, with gamma = -b[0]
+      for(int s=0;s<Nsys;s++) {
+        const T gamma = -b[s];
+        d[s] = b[s] - gamma;
+        d[(N-1)*Nsys + s] = b[(N-1)*Nsys + s] - c[(N-1)*Nsys + s]*a[s]/gamma;
+        va[s] = a[s] / gamma;
+      }
+    }
+
+    using batched_tridag::mul;
+    using batched_tridag::inv;
+
+    // LU factorisation, storing inverse pivots. The pivots are
+    // left in d, to check for zeros at the end
+    for(int s=0;s<Nsys;s++)
+      ibet[s] = inv(d[s]);
+    for(int i=1;i<N;i++) {
+      const T *cm = &c[(i-1)*Nsys];
+      const T *ibm = &ibet[(i-1)*Nsys];
+      const T *ai = &a[i*Nsys];
+      T *g = &gam[i*Nsys];
+      T *di = &d[i*Nsys];
+      T *ib = &ibet[i*Nsys];
+      BOUT_OMP(simd)
+      for(int s=0;s<Nsys;s++) {
+        g[s] = mul(cm[s], ibm[s]);
+        di[s] -= mul(ai[s], g[s]);
+        ib[s] = inv(di[s]);
+      }
+    }
+    for(int i=0;i<N*Nsys;i++) {
+      if(d[i] == T(0.0))
+        throw BoutException("BatchedTridag: Zero pivot");
+    }
+
+    factored = true;
+
+    if(periodic) {
+      // Solve A z = u, u = (gamma, 0, ..., 0, c[N-1])
+      for(int i=0;i<N*Nsys;i++)
+        z[i] = 0.0;
+      for(int s=0;s<Nsys;s++) {
+        z[s] = -b[s];
+        z[(N-1)*Nsys + s] = c[(N-1)*Nsys + s];
+      }
+      periodic = false; // Plain solve
+      solve(z.begin(), Nsys);
+      periodic = true;
+
+      for(int s=0;s<Nsys;s++)
+        iden[s] = inv(T(1.0) + z[s] + mul(va[s], z[(N-1)*Nsys + s]));
+    }
+  }
+
+private:
+  int Nsys, N;   ///< Number of systems, size of each
+  bool periodic; ///< Cyclic tridiagonal?
+  bool factored; ///< Is the factorisation up to date?
+
+  Array<T> a, b, c; ///< Coefficients, interleaved [N][Nsys]
+  Array<T> gam, ibet; ///< Factorisation: multipliers and inverse pivots
+  Array<T> work; ///< RHS in interleaved form
+
+  /// Periodic systems only
+  Array<T> z;    ///< Solution of A z = u, interleaved
+  Array<T> va;   ///< a[0] / gamma for each system
+  Array<T> iden; ///< 1 / (1 + v.z) for each system
+  Array<T> fact; ///< Correction factor for each system
+};
+
+#endif // __BATCHED_TRIDAG_H__
@@ -8,6 +8,9 @@
  * arrays are released they are put into a store. Rather
  * than allocating memory, objects are retrieved from the
  * store. This minimises new and delete operations.
+ *
+ * If NUMA first touch is enabled (see bout/sys/numa.hxx), the
+ * store is also divided by NUMA domain.
  * 
  * 
  * Ben Dudson, University of York, 2015
@@ -26,8 +29,14 @@
 #define __ARRAY_H__
 
 #include <map>
+#include <new>
+#include <utility>
 #include <vector>
 
+#include "bout/dataiterator.hxx"
+#include "bout/openmpwrap.hxx"
+#include "bout/sys/numa.hxx"
+
 /*!
  * Data array type with automatic memory management
  *
@@ -50,6 +59,15 @@
  * This behaviour can be disabled by calling the static function useStore:
  *
  * Array<dcomplex>::useStore(false); // Disables memory store
+ *
+ * With NUMA first touch enabled (numaFirstTouch() = true), new data
+ * requested outside a parallel region is first written by all OpenMP
+ * threads, each writing the part which it handles in DataIterator
+ * loops, so that memory pages are placed close to the threads which
+ * use them. Data requested by a thread in a parallel region, other
+ * than the shared results allocated in a persistent team (see
+ * OmpTeam in bout/openmpwrap.hxx), is assumed to be private to that
+ * thread, so is kept in a separate store for the thread's NUMA domain.
  * 
  */
 template<typename T>
@@ -150,6 +168,16 @@ public:
     return value;
   }
   
+  /*!
+   * Number of blocks of data given to Arrays, either newly allocated
+   * or taken from the store. This can be set to zero, so that tests
+   * can check how many arrays an operation creates
+   */
+  static long& allocations() {
+    static long count = 0;
+    return count;
+  }
+
   /*!
    * Release data. After this the Array is empty and any data access
    * will be invalid
@@ -280,13 +308,35 @@ private:
   struct ArrayData {
     int refs;   ///< Number of references to this data
     int len;    ///< Size of the array
+    int domain; ///< NUMA domain of the store this belongs to
     T *data;    ///< Array of data
-    
-    ArrayData(int size) : refs(0), len(size) {
-      data = new T[len];
+
+    /// Allocate \p size elements. If \p spread is true then the elements
+    /// are initialised in parallel, with the same division between
+    /// threads as DataIterator (see DI_spread_work)
+    ArrayData(int size, int domain, bool spread) : refs(0), len(size), domain(domain) {
+      data = static_cast<T*>(::operator new(sizeof(T) * len));
+      if(!spread) {
+        for(int i = 0; i < len; i++)
+          new (data + i) T;
+        return;
+      }
+      BOUT_OMP(parallel)
+      {
+        int np = 1, cp = 0;
+#ifdef _OPENMP
+        np = omp_get_num_threads();
+        cp = omp_get_thread_num();
+#endif
+        // Value-initialised so that every page is written
+        for(int i = DI_spread_work(len, cp, np); i < DI_spread_work(len, cp + 1, np); i++)
+          new (data + i) T();
+      }
     }
     ~ArrayData() {
-      delete[] data;
+      for(int i = 0; i < len; i++)
+        data[i].~T();
+      ::operator delete(data);
     }
     iterator begin() {
       return data;
@@ -302,8 +352,13 @@ private:
    */
   ArrayData* ptr;
 
+  /// Store key: array size and NUMA domain
+  using StoreKey = std::pair<int, int>;
+
   /*!
-   * This maps from array size (int) to vectors of pointers to ArrayData objects
+   * This maps from array size and NUMA domain to vectors of pointers
+   * to ArrayData objects. The domain is -1 unless the data is private
+   * to a thread, and NUMA first touch is enabled
    *
    * By putting the static store inside a function it is initialised on first use,
    * and doesn't need to be separately declared for each type T
@@ -313,8 +368,8 @@ private:
    *
    * @param[in] cleanup   If set to true, deletes all ArrayData and clears the store
    */
-  static std::map< int, std::vector<ArrayData* > > & store(bool cleanup=false) {
-    static std::map< int, std::vector<ArrayData* > > store = {};
+  static std::map< StoreKey, std::vector<ArrayData* > > & store(bool cleanup=false) {
+    static std::map< StoreKey, std::vector<ArrayData* > > store = {};
     
     if (!cleanup) {
       return store;
@@ -338,16 +393,34 @@ private:
    * references. This is either from the store, or newly allocated
    */
   ArrayData* get(int len) {
-    ArrayData *p;
+    // Data requested outside a parallel region is spread over domains.
+    // In a persistent team, field data is shared by the team (see
+    // Field3D::allocateTeam). Otherwise it is private to this thread
+    int domain = -1;
+    bool spread = false;
+    if (numaFirstTouch()) {
+#ifdef _OPENMP
+      if (omp_in_parallel()) {
+        if (!ompTeam())
+          domain = numaDomain();
+      } else
+#endif
+        spread = true;
+    }
+
+    ArrayData *p = nullptr;
 #pragma omp critical (store)
     {
-      std::vector<ArrayData* >& st = store()[len];
+      std::vector<ArrayData* >& st = store()[StoreKey(len, domain)];
       if (!st.empty()) {
         p = st.back();
         st.pop_back();
-      } else {
-        p = new ArrayData(len);
       }
+      allocations()++;
+    }
+    if (!p) {
+      // Outside the critical section, since this may start a parallel region
+      p = new ArrayData(len, domain, spread);
     }
     return p;
   }
@@ -366,7 +439,7 @@ private:
       if (!--d->refs) {
         if (useStore()) {
           // Put back into store
-          store()[d->len].push_back(d);
+          store()[StoreKey(d->len, d->domain)].push_back(d);
         } else {
           delete d;
         }
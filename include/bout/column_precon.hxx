@@ -0,0 +1,165 @@
+/// \file column_precon.hxx
+/// Block Jacobi preconditioner built from a finite difference Jacobian
+///
+/// Implicit time integration needs solutions of (I - gamma J) z = r,
+/// where J is the Jacobian of the RHS function. This class approximates
+/// J by its diagonal blocks, one block for each (x,y) column of the
+/// local mesh, coupling all variables and z points in that column.
+/// There are no entries for coupling between columns, so the
+/// preconditioner is local to each processor and needs no
+/// communication to apply.
+///
+/// The blocks are calculated by finite differences of the RHS. Since
+/// each point only depends on points within a stencil width, many
+/// state elements can be perturbed at once, and their effects separated
+/// afterwards ("colouring"):
+///
+///  - Columns are coloured by their global (x,y) index, so that
+///    columns of the same colour are more than \p stencil points
+///    apart in x or y. All columns of one colour are perturbed together.
+///    Where the index wraps around (periodic x, closed flux surfaces)
+///    or jumps (branch cuts), columns on either side are only kept
+///    apart if the number of colours in that direction divides every
+///    jump; see periodColours().
+///
+///  - If \p zband is not negative, only coupling between z points at
+///    most \p zband apart (periodically) is kept. 3D variables at z
+///    points more than 2*zband apart are then perturbed together.
+///
+/// Coupling outside the blocks, or outside \p zband, is not simply
+/// dropped. The change in each RHS element is assigned to the kept
+/// entry of the perturbed element in its block, so it also includes
+/// the effect of every other element perturbed at the same time.
+/// Coupling to columns of the same colour, or to z points in the same
+/// group, is therefore added to the kept entries. This is only absent
+/// if the RHS really couples points no further than \p stencil in x
+/// and y and \p zband in z. Coupling to elements perturbed in other
+/// evaluations, such as neighbouring columns, is not included.
+///
+/// The number of RHS evaluations needed is the number of colours times
+/// the number of groups of elements in a column; see numEvaluations().
+///
+/// Each block of (I - gamma J) is factorised by incomplete LU with no
+/// fill-in outside the sparsity pattern of the block. If \p zband is
+/// negative the blocks are dense, and this is an exact LU factorisation
+/// (without pivoting). The Jacobian is kept, so that a change in gamma
+/// only needs a new factorisation.
+///
+/// Example
+/// -------
+///
+///     ColumnPrecon precon(nz, n2d, n3d, 2, 2);
+///     for each column in state order:
+///       precon.addColumn(xglobal, yglobal, evolve2d, evolve3d);
+///
+///     precon.computeJacobian(u, f, inc, rhs); // rhs(u, f) evaluates f(u)
+///     precon.factorise(gamma);
+///     precon.solve(r, z);
+
+#ifndef __COLUMN_PRECON_H__
+#define __COLUMN_PRECON_H__
+
+#include "bout_types.hxx"
+#include "bout/array.hxx"
+
+#include <functional>
+#include <vector>
+
+class ColumnPrecon {
+public:
+  /// Function which evaluates the RHS \p f for state \p u. The
+  /// state can be modified, but must be left unchanged on return
+  using RhsFunc = std::function<void(BoutReal *u, BoutReal *f)>;
+
+  /// @param[in] nz       Number of z points
+  /// @param[in] n2d      Number of 2D variables
+  /// @param[in] n3d      Number of 3D variables
+  /// @param[in] stencil  Largest distance in x or y between points which
+  ///                     are coupled by the RHS
+  /// @param[in] zband    Largest distance in z between coupled points.
+  ///                     If negative, all z points in a column are coupled
+  /// @param[in] xcolours Number of colours in x. Columns are coloured by
+  ///                     their x index modulo this. Zero for stencil+1
+  /// @param[in] ycolours Number of colours in y. Zero for stencil+1
+  ColumnPrecon(int nz, int n2d, int n3d, int stencil, int zband,
+               int xcolours = 0, int ycolours = 0);
+
+  /// Number of colours to use in a direction where the index jumps,
+  /// so that columns coupled across the jump have different colours.
+  /// \p period must divide b - a - 1 for every step from index a to a
+  /// non-consecutive index b; for a periodic direction this is the
+  /// number of points. Returns the smallest divisor of \p period which
+  /// is larger than \p stencil, or zero if there is none
+  static int periodColours(int stencil, int period);
+
+  /// Add the next column of the state vector. The elements of each
+  /// column are in the order used by Solver: 2D variables, then for
+  /// each z point the 3D variables. Variables which are not evolved
+  /// in this column (e.g. in boundaries) are not in the state.
+  ///
+  /// @param[in] xglobal   Global x index, used for colouring
+  /// @param[in] yglobal   Global y index, used for colouring
+  /// @param[in] evolve2d  Is each 2D variable in this column?
+  /// @param[in] evolve3d  Is each 3D variable in this column?
+  void addColumn(int xglobal, int yglobal,
+                 const std::vector<bool> &evolve2d, const std::vector<bool> &evolve3d);
+
+  /// Length of the (local) state vector
+  int size() const { return static_cast<int>(rowptr.size()) - 1; }
+
+  /// Number of RHS evaluations done by computeJacobian. This is the
+  /// same on every processor, so evaluations which communicate match
+  int numEvaluations() const { return ncolours * ngroups; }
+
+  /// Number of non-zeros stored in the blocks
+  int numNonZeros() const { return rowptr.back(); }
+
+  /// Calculate the Jacobian blocks by finite differences
+  ///
+  /// @param[in] u    The state to linearise about
+  /// @param[in] f    The RHS at state \p u
+  /// @param[in] inc  The increment to use for each element of \p u
+  /// @param[in] rhs  Function to evaluate the RHS
+  void computeJacobian(const BoutReal *u, const BoutReal *f, const BoutReal *inc,
+                       const RhsFunc &rhs);
+
+  /// Factorise I - gamma J, using the last Jacobian calculated.
+  /// Throws BoutException if a zero pivot is found
+  void factorise(BoutReal gamma);
+
+  /// Solve (I - gamma J) z = r approximately, using the last
+  /// factorisation. \p r and \p z can be the same
+  void solve(const BoutReal *r, BoutReal *z) const;
+
+private:
+  int nz, n2d, n3d; ///< Size of each column
+  int stencil;      ///< Coupling distance in x and y
+  int zband;        ///< Coupling distance in z. Negative if dense
+  int xcolours;     ///< Number of colours in x
+  int ycolours;     ///< Number of colours in y
+  int ncolours;     ///< Number of (x,y) colours
+  int nzgroup;      ///< z points j and j + nzgroup are perturbed together
+  int ngroups;      ///< Number of perturbation groups in each column
+
+  /// A column of the state vector
+  struct Column {
+    int start;  ///< Index of the first element
+    int n;      ///< Number of elements
+    int colour; ///< Colour used when calculating the Jacobian
+  };
+  std::vector<Column> columns;
+
+  // Each block is stored in compressed sparse row form, with rows
+  // numbered over the whole local state and column indices local
+  // to the block. Columns are sorted within each row
+  std::vector<int> rowptr; ///< Start of each row. Size size()+1
+  std::vector<int> colind; ///< Block-local column index of each non-zero
+  std::vector<int> diag;   ///< Index of the diagonal in each row
+  std::vector<int> group;  ///< Perturbation group of each element
+
+  Array<BoutReal> jac;     ///< Jacobian values
+  Array<BoutReal> lu;      ///< Incomplete LU factors of I - gamma J
+  Array<BoutReal> invdiag; ///< Inverse of the diagonal of U
+};
+
+#endif // __COLUMN_PRECON_H__
@@ -0,0 +1,52 @@
+/// \file compression.hxx
+/// Error-bounded lossy compression of output data
+///
+/// Output files can be compressed by the file format (shuffle and
+/// deflate filters in HDF5 and NetCDF-4). On its own this is lossless,
+/// and typically saves little on double precision data because
+/// the low bits of the mantissa are essentially random.
+///
+/// quantise() rounds each value to the fewest mantissa bits which
+/// keep the error within a given tolerance, and sets the discarded
+/// bits to zero. The result is still an ordinary double, so files can be
+/// read by any tool, but the zeroed bits compress very well.
+///
+/// Example
+/// -------
+///
+/// In BOUT.inp:
+///
+///     [output]
+///     compress = lossy   # none, lossless or lossy
+///     reltol = 1e-4      # Default relative tolerance
+///
+///     [output:phi]
+///     abstol = 1e-6      # Absolute tolerance for phi
+///
+
+#ifndef __COMPRESSION_H__
+#define __COMPRESSION_H__
+
+#include "bout_types.hxx"
+
+/// Number of mantissa bits to keep so that the relative error
+/// of every (normal) value is at most \p reltol. Rounding to k bits
+/// gives a relative error of at most 2^-(k+1). Returns 52 (all bits)
+/// if \p reltol is zero or negative
+int quantiseBits(BoutReal reltol);
+
+/// Round the values in \p data so that the error in each is at most
+/// max(abstol, reltol*|x|). A tolerance which is zero or negative is
+/// not used; if both are then the data is not changed.
+///
+/// Values with magnitude less than \p abstol may be set to zero.
+/// Infinities, NaNs and values within a factor of two of the largest
+/// double are not changed
+///
+/// @param[inout] data   The values to quantise
+/// @param[in] n         Number of values
+/// @param[in] abstol    Absolute tolerance
+/// @param[in] reltol    Relative tolerance
+void quantise(BoutReal *data, int n, BoutReal abstol, BoutReal reltol);
+
+#endif // __COMPRESSION_H__
@@ -38,6 +38,10 @@ class Coordinates;
 #include "mesh.hxx"
 #include "datafile.hxx"
 #include <bout_types.hxx>
+#include <bout/assert.hxx>
+#include <dcomplex.hxx>
+
+#include <vector>
 
 /*!
  * Represents a coordinate system, and associated operators
@@ -94,6 +98,38 @@ public:
   int calcContravariant(); ///< Invert covariant metric to get contravariant
   int jacobian(); ///< Calculate J and Bxy
 
+  /// Combinations of metric quantities used by the operators below,
+  /// stored together for each (x,y) point so that operators read a
+  /// single array rather than several Field2D objects.
+  struct MetricCoefs {
+    BoutReal one_over_dx;       ///< 1/dx. DDX
+    BoutReal one_over_dy;       ///< 1/dy. DDY
+    BoutReal one_over_sqrt_g22; ///< 1/sqrt(g_22). Grad_par, Vpar_Grad_par
+    BoutReal one_over_g22;      ///< 1/g_22. Grad2_par2, Laplace_par
+    BoutReal grad2_par2_coef;   ///< DDY(1/sqrt(g_22)) / sqrt(g_22). Grad2_par2
+    BoutReal laplace_par_coef;  ///< DDY(J/g_22) / J. Laplace_par
+  };
+
+  /// Cached coefficients at (\p x, \p y). These are calculated by
+  /// geometry(), and otherwise by the operators before they are used
+  const MetricCoefs &coefs(int x, int y) const {
+    ASSERT2(coefs_valid);
+    return metric_coefs[x*coefs_ny + y];
+  }
+
+  /// Mark the cached coefficients as out of date.
+  /// Called by geometry(), calcCovariant(), calcContravariant() and jacobian().
+  /// Must be called if metric components are modified without
+  /// calling geometry()
+  void invalidateCoefs() {
+    coefs_valid = false;
+    metric_version++;
+  }
+
+  /// Changed by invalidateCoefs(), so that code which keeps quantities
+  /// calculated from the metric can tell when they are out of date
+  int metricVersion() const { return metric_version; }
+
   // Operators
 
   const Field2D DDX(const Field2D &f);
@@ -137,6 +173,38 @@ private:
   int gaussj(BoutReal **a, int n);
   vector<int> indxc, indxr, ipiv;
   int nz; // Size of mesh in Z. This is mesh->ngz-1
+
+  std::vector<MetricCoefs> metric_coefs; ///< Indexed by x*coefs_ny + y
+  int coefs_ny;     ///< Size of metric_coefs in Y
+  bool coefs_valid; ///< False if metric_coefs needs to be recalculated
+  int metric_version; ///< Incremented by invalidateCoefs()
+  void calcCoefs(); ///< Calculate metric_coefs
+
+  /// Calculate metric_coefs if the metric has changed since geometry().
+  /// Called by every thread of a team, one of which does the calculation
+  void checkCoefs();
+
+  /// Multiply \p f by the coefficient \p c at each (x,y) point, in place
+  void multiplyCoef(Field2D &f, BoutReal MetricCoefs::*c);
+  void multiplyCoef(Field3D &f, BoutReal MetricCoefs::*c);
+
+  /// Coefficients of Delp2 at each (x,y) point. For wave number k the
+  /// tridiagonal coefficients used by the inversion code are
+  ///    a = xx - x - i k xz,  b = -2 xx - k^2 zz + i k z,  c = xx + x + i k xz
+  struct Delp2Coefs {
+    BoutReal xx, zz, xz, x, z;
+  };
+  bool delp2_fft;   ///< Use FFTs in Z for Delp2(Field3D)? Set by mesh:delp2_fft
+
+  /// Set \p coefs[x] to the Delp2 coefficients at (x, \p jy) for all X.
+  /// These are calculated on every call from the default Laplacian's
+  /// coefficients, so follow any change in the metric or its settings
+  void delp2Coefs(int jy, Delp2Coefs *coefs);
+
+  /// Fourier components of Delp2 at \p jx, given the components of the
+  /// input at all X in the plane and the coefficients \p d at \p jx.
+  /// \p ft is indexed by x*(nz/2+1) + kz
+  void delp2Line(int jx, const Delp2Coefs &d, const dcomplex *ft, dcomplex *delft);
 };
 
 /*
@@ -9,11 +9,11 @@
 #include <iterator>
 #include <iostream>
 #include "unused.hxx"
+#include "bout/openmpwrap.hxx"
 
-#ifdef _OPENMP
-#include <omp.h>
+/// Start of the part of \p num_work elements handled by \p thread of
+/// \p max_thread. Also used to place Array data (see bout/array.hxx)
 inline int DI_spread_work(int num_work, int thread, int max_thread);
-#endif
 
 /*!
  * Set of indices - DataIterator is dereferenced into these
@@ -29,6 +29,8 @@ struct Indices {
 /*!
  * Provides range-based iteration over indices. 
  * If OpenMP is enabled, then this divides work between threads.
+ * Inside a persistent team (see bout/openmpwrap.hxx) work is only
+ * divided inside team-aware operators, which use OmpWorkshare.
  * 
  * This is used mainly to loop over the indices of fields,
  * and provides convenient ways to index 
@@ -166,12 +168,12 @@ public:
     if (dz>0){
       int zp=z;
       for (int j=0;j<dz;++j)
-        zp=(zp == zend ? zstart : zp+1);
+        zp=(zp == zmax ? zmin : zp+1);
       return {x+dx, y+dy, zp };
     } else {
       int zm=z;
       for (;dz!= 0;++dz)
-        zm = (zm == zstart ? zend : zm-1);
+        zm = (zm == zmin ? zmax : zm-1);
       return {x+dx, y+dy, zm };
     }
   }
@@ -189,10 +191,11 @@ public:
   const Indices yp() const { return {x, y+1, z}; }
   /// The index one point -1 in y
   const Indices ym() const { return {x, y-1, z}; }
-  /// The index one point +1 in z. Wraps around zend to zstart
-  const Indices zp() const { return {x, y, z == zend ? zstart : z+1}; }
-  /// The index one point -1 in z. Wraps around zstart to zend
-  const Indices zm() const { return {x, y, z == zstart ? zend : z-1}; }
+  /// The index one point +1 in z. Wraps around the end of the Z range.
+  /// This is the whole range, not the part given to this thread
+  const Indices zp() const { return {x, y, z == zmax ? zmin : z+1}; }
+  /// The index one point -1 in z. Wraps around the start of the Z range
+  const Indices zm() const { return {x, y, z == zmin ? zmax : z-1}; }
 
   /*!
    * Resets DataIterator to the start of the range
@@ -217,9 +220,9 @@ public:
 #ifndef _OPENMP
     return (x > xend) || (x < xstart);
 #else //_OPENMP
-    return (x == xend && y == yend && z > zend)
-      || x > xend ||
-      (x <= xstart && y <= ystart && z < zstart)  ;
+    // Compare (x,y,z) lexicographically against the start and end.
+    // A thread given no work has start after end, so is always done
+    return after(xend, yend, zend) || before(xstart, ystart, zstart);
 #endif //_OPENMP
   }
   
@@ -243,6 +246,18 @@ private:
   int xmax, ymax, zmax;
 
   const bool isEnd;
+
+#ifdef _OPENMP
+  /// Is the current index after (xi, yi, zi) in iteration order?
+  bool after(int xi, int yi, int zi) const {
+    return (x != xi) ? (x > xi) : ((y != yi) ? (y > yi) : (z > zi));
+  }
+  /// Is the current index before (xi, yi, zi) in iteration order?
+  bool before(int xi, int yi, int zi) const {
+    return (x != xi) ? (x < xi) : ((y != yi) ? (y < yi) : (z < zi));
+  }
+#endif
+
   /// Advance to the next index
   void next() {
     ++z;
@@ -321,7 +336,6 @@ struct IndexRange {
   }
 };
 
-#ifdef _OPENMP
 inline int DI_spread_work(int work,int cp,int np){
   int pp=work/np;
   int rest=work%np;
@@ -334,9 +348,12 @@ inline int DI_spread_work(int work,int cp,int np){
   return result;
 };
 
+#ifdef _OPENMP
 inline void DataIterator::omp_init(bool end){
-  // In the case of OPENMP we need to calculate the range
-  int threads=omp_get_num_threads();
+  // In the case of OPENMP we need to calculate the range.
+  // Loops are not divided in a serial section, or when a persistent
+  // team is running code which is not team-aware
+  int threads = ompSplitLoops() ? omp_get_num_threads() : 1;
   if (threads > 1){
     int ny=ymax-ymin+1;
     int nz=zmax-zmin+1;
@@ -353,8 +370,8 @@ inline void DataIterator::omp_init(bool end){
     ystart = (begin_index % ny) + ymin;
     end_index   /= ny;
     begin_index /= ny;
-    xend   = end_index;
-    xstart = begin_index;
+    xend   = end_index   + xmin;
+    xstart = begin_index + xmin;
   } else {
     zstart = zmin;
     zend   = zmax;
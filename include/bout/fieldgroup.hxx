@@ -204,6 +204,16 @@ class FieldGroup {
    * Ensure that each field appears only once
    */
   void makeUnique();
+
+  /*!
+   * Add the fields in \p other which are not already in this group.
+   *
+   * Unlike makeUnique(), the order in which fields were first added
+   * is kept, so groups built the same way on every processor are packed
+   * into messages in the same order. Used to collect fields waiting
+   * for communication (see Mesh::communicateLater)
+   */
+  void merge(const FieldGroup &other);
  private:
   std::vector<FieldData*> fvec;  // Vector of fields
   std::vector<Field3D*>   f3vec; // Vector of 3D fields
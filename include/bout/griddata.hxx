@@ -82,6 +82,12 @@ class GridFile : public GridDataSource {
 
   bool get(Mesh *m, vector<int> &var,      const string &name, int len, int offset=0, GridDataSource::Direction dir = GridDataSource::X);
   bool get(Mesh *m, vector<BoutReal> &var, const string &name, int len, int offset=0, GridDataSource::Direction dir = GridDataSource::X);
+
+  /// Remove all 2D fields from the cache shared by all GridFile objects
+  static void clearCache();
+  /// Remove the 2D fields read by mesh \p m from the cache. Called when
+  /// the mesh is deleted
+  static void clearCache(const Mesh *m);
   
  private:
   GridFile();
@@ -89,6 +95,8 @@ class GridFile : public GridDataSource {
   std::unique_ptr<DataFormat> file;
   string filename;
 
+  bool use_cache; ///< Keep 2D fields in memory once read? Set by mesh:cache_grid (default false)
+
   bool readgrid_3dvar_fft(Mesh *m, const string &name, 
 			  int yread, int ydest, int ysize, 
 			  int xge, int xlt, Field3D &var);
@@ -209,7 +209,8 @@ class Mesh {
   void communicate(FieldGroup &g);
 
   /// Communcate guard cells in XZ only
-  /// i.e. no Y communication
+  /// i.e. no Y communication. Fields waiting for communication
+  /// (see communicateLater) are sent in the same messages
   ///
   /// @param g  The group of fields to communicate. Guard cells will be modified
   void communicateXZ(FieldGroup &g);
@@ -219,6 +220,43 @@ class Mesh {
    */
   void communicate(FieldPerp &f); 
 
+  /*!
+   * Mark fields as needing their guard cells filled, but defer the
+   * communication. All fields waiting are communicated together, in a
+   * single set of messages, by communicatePending(). This is called
+   * by the next communicate(), by X and Y derivatives, interpolation,
+   * brackets, Delp2, Laplacian inversions and smoothing, and by the
+   * solver at the end of each RHS call.
+   *
+   * Only pointers to the fields are stored, so the fields must
+   * outlive the communication. The values sent are those at the time
+   * of communication, not when this is called, so fields must not be
+   * modified in between.
+   *
+   * In a team (see bout/openmpwrap.hxx) this must be called by every
+   * thread, not inside ompMaster, so that all threads agree on whether
+   * communicatePending() has anything to send.
+   */
+  template <typename... Ts>
+  void communicateLater(Ts&... ts) {
+    FieldGroup g(ts...);
+    communicateLater(g);
+  }
+
+  /// Defer communication of a group of fields
+  void communicateLater(FieldGroup &g);
+
+  /// Communicate all fields passed to communicateLater since the
+  /// last call, in one round of messages
+  void communicatePending();
+
+  /// Number of communication rounds (calls to send) so far
+  int commRounds() const { return comm_rounds; }
+  /// Number of bytes sent in communications so far
+  BoutReal commBytes() const { return comm_bytes; }
+  /// Reset the counts of rounds and bytes to zero
+  void resetCommStats() { comm_rounds = 0; comm_bytes = 0.0; }
+
   /*!
    * Send a list of FieldData objects
    * Packs arguments into a FieldGroup and passes
@@ -616,6 +654,11 @@ class Mesh {
   
   /// Calculates the size of a message for a given x and y range
   int msg_len(const vector<FieldData*> &var_list, int xge, int xlt, int yge, int ylt);
+
+  FieldGroup pending_comms; ///< Fields waiting for communicatePending()
+
+  int comm_rounds;     ///< Number of times send() has been called
+  BoutReal comm_bytes; ///< Bytes sent by send(). Real to avoid overflow
   
   // Initialise derivatives
   void derivs_init(Options* options);
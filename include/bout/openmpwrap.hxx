@@ -0,0 +1,341 @@
+/*!************************************************************************
+ * \file openmpwrap.hxx
+ *
+ * Helpers for running field operations inside a persistent OpenMP team
+ *
+ * Opening and closing a parallel region in every operator costs several
+ * microseconds per call, which is comparable to the work in a single
+ * operation on a small field. Instead a whole function (for example the
+ * physics RHS, see the solver option openmp_team) can be run by every
+ * thread of one parallel region:
+ *
+ *     ompRunTeam([&]() {
+ *       // Field operators now share work
+ *       ddt(n) = -DDX(n) * a + b;
+ *     });
+ *
+ * Every thread executes every statement. Field3D arithmetic, the
+ * Field3D derivative operators and Field3D assignment recognise that
+ * they are in a team: the result is allocated once and shared, and the
+ * DataIterator loops are divided between threads using the same
+ * decomposition as DataIterator::omp_init. Other functions are run by
+ * every thread. This is only correct if they don't modify data shared
+ * between threads: results on thread-private fields are fine, but
+ * anything which fills a shared cache on first use must either be
+ * protected or be called once before the team starts.
+ *
+ * Code which communicates, or modifies a shared field in place, must be
+ * run by one thread while the others wait. Mesh::communicate and the
+ * Field3D boundary conditions do this themselves. Mesh::communicate
+ * is passed each thread's fields, and communicates any which are
+ * private to each thread once for every thread. Anything else, for
+ * example a Laplacian inversion or a global reduction, should be
+ * passed to ompMaster:
+ *
+ *     ompMaster([&]() { phi = invert_laplace(vort, 0); });
+ *
+ * The master thread is used so that timers and the message stack,
+ * which are only updated by the master thread, are kept. If the
+ * function throws, the exception is rethrown on every thread of the
+ * team after they have all reached the barrier.
+ *
+ * A team should be started with ompRunTeam. If one thread throws,
+ * the others can't wait for it at the next barrier, so team code
+ * waits with ompBarrier, which leaves the team with OmpTeamAbort once
+ * a thread has failed. The first exception is then rethrown after
+ * the parallel region has finished. Constructs with an implicit
+ * barrier (omp for, single) must be followed by ompCheckTeam, and
+ * single copyprivate, which waits twice, can't be used.
+ *
+ **************************************************************************
+ * Copyright 2017 B.D.Dudson
+ *
+ * Contact: Ben Dudson, benjamin.dudson@york.ac.uk
+ *
+ * This file is part of BOUT++.
+ *
+ * BOUT++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BOUT++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with BOUT++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **************************************************************************/
+
+#ifndef __OPENMPWRAP_H__
+#define __OPENMPWRAP_H__
+
+#include <atomic>
+#include <exception>
+#include <type_traits>
+
+#ifdef _OPENMP
+#include <omp.h>
+
+#define BOUT_OMP_STR(x) #x
+/// Insert an OpenMP pragma, e.g. BOUT_OMP(parallel for). Does nothing
+/// when compiled without OpenMP, so avoids unknown pragma warnings
+#define BOUT_OMP(...) _Pragma(BOUT_OMP_STR(omp __VA_ARGS__))
+#else
+#define BOUT_OMP(...)
+#endif
+
+/// How the calling thread treats field operations
+enum class OmpMode {
+  automatic, ///< Default. DataIterator loops divide work between threads
+  team,      ///< In a persistent team. Only team-aware operators share work
+  workshare, ///< Inside a team-aware loop. DataIterator loops divide work
+  serial     ///< One thread of a team working alone (see ompMaster)
+};
+
+/// The mode of the calling thread
+inline OmpMode &ompMode() {
+  static OmpMode mode = OmpMode::automatic;
+#ifdef _OPENMP
+#pragma omp threadprivate(mode)
+#endif
+  return mode;
+}
+
+/// Number of threads sharing the work of a field operation
+/// called by this thread. This is 1 outside a parallel region,
+/// or in a serial section
+inline int ompTeamSize() {
+#ifdef _OPENMP
+  if(ompMode() == OmpMode::serial)
+    return 1;
+  return omp_get_num_threads();
+#else
+  return 1;
+#endif
+}
+
+/// True if field operators called by this thread should share
+/// their result and work with the other threads of the team. This is
+/// only the case in a persistent team (see OmpTeam), not in other
+/// parallel regions
+inline bool ompTeam() {
+  OmpMode mode = ompMode();
+  return ((mode == OmpMode::team) || (mode == OmpMode::workshare))
+    && (ompTeamSize() > 1);
+}
+
+/// True if DataIterator loops should be divided between threads
+inline bool ompSplitLoops() {
+  OmpMode mode = ompMode();
+  return ((mode == OmpMode::automatic) || (mode == OmpMode::workshare))
+    && (ompTeamSize() > 1);
+}
+
+/// True if this is the initial thread, or descended from it
+/// through thread 0 at every level of (possibly nested) parallel regions.
+/// Used to restrict global bookkeeping (e.g. timers) to one thread
+inline bool ompMasterThread() {
+#ifdef _OPENMP
+  for(int level = 1; level <= omp_get_level(); level++) {
+    if(omp_get_ancestor_thread_num(level) != 0)
+      return false;
+  }
+#endif
+  return true;
+}
+
+/// Set the mode of the calling thread until the end of the scope
+class OmpModeGuard {
+public:
+  OmpModeGuard(OmpMode mode) : last(ompMode()) { ompMode() = mode; }
+  ~OmpModeGuard() { ompMode() = last; }
+private:
+  OmpMode last;
+};
+
+/// Thrown by the threads of a team when another thread has failed,
+/// so that they all leave the team (see ompRunTeam). Not derived from
+/// BoutException, so that handlers for those don't catch it
+struct OmpTeamAbort {};
+
+/// Set when a thread of the team has failed. Shared by the team
+inline std::atomic<bool> &ompTeamFailed() {
+  static std::atomic<bool> failed(false);
+  return failed;
+}
+
+/// Set once the calling thread has met the others after a failure
+inline bool &ompTeamLeft() {
+  static bool left = false;
+#ifdef _OPENMP
+#pragma omp threadprivate(left)
+#endif
+  return left;
+}
+
+/// Throw OmpTeamAbort if a thread of the team has failed. Called after
+/// every barrier in team code, so that threads which were waiting for
+/// a failed thread leave rather than wait at the next barrier
+inline void ompCheckTeam() {
+  if(ompTeamFailed()) {
+    ompTeamLeft() = true;
+    throw OmpTeamAbort();
+  }
+}
+
+/// Wait for the other threads of the team. Throws OmpTeamAbort if one
+/// of them has failed
+inline void ompBarrier() {
+  BOUT_OMP(barrier)
+  ompCheckTeam();
+}
+
+/// Called by a thread of the team which is leaving because of an
+/// exception. The others are told, and this thread meets them at the
+/// barrier they are waiting at (or reach next), after which they throw
+/// OmpTeamAbort. Does nothing if this thread has already left
+inline void ompTeamFail() {
+  if(ompTeamLeft())
+    return;
+  ompTeamLeft() = true;
+  ompTeamFailed() = true;
+  BOUT_OMP(barrier)
+}
+
+/// Mark the start of a persistent team. Must be created by every
+/// thread in the parallel region
+class OmpTeam : public OmpModeGuard {
+public:
+  OmpTeam() : OmpModeGuard(OmpMode::team) { ompTeamLeft() = false; }
+};
+
+/// Mark a section run by a single thread of a team, so that field
+/// operators don't wait for the other threads
+class OmpSerial : public OmpModeGuard {
+public:
+  OmpSerial() : OmpModeGuard(OmpMode::serial) {}
+};
+
+/// Divide the DataIterator loops in this scope between threads.
+/// Used by team-aware operators, which must only write to data
+/// shared by the team (see Field3D::allocateTeam)
+class OmpWorkshare : public OmpModeGuard {
+public:
+  OmpWorkshare() : OmpModeGuard(ompTeam() ? OmpMode::workshare : ompMode()) {}
+  /// Wait for the other threads to finish their share. If this thread
+  /// is leaving because of an exception, the others are told instead
+  ~OmpWorkshare() noexcept(false) {
+    if(ompTeam()) {
+      if(std::uncaught_exception()) {
+        ompTeamFail();
+      } else {
+        ompBarrier();
+      }
+    }
+  }
+};
+
+/// Run \p func on every thread of a new persistent team. If \p func
+/// throws on any thread, the others leave at their next barrier, and
+/// the first exception is rethrown by the calling thread once the
+/// parallel region has finished. Inside a team this just calls \p func
+template<typename F>
+void ompRunTeam(F func) {
+  if(ompTeam()) {
+    func();
+    return;
+  }
+
+  std::exception_ptr error;
+  ompTeamFailed() = false;
+  BOUT_OMP(parallel)
+  {
+    OmpTeam team;
+    try {
+      func();
+    } catch (OmpTeamAbort &) {
+      // Another thread failed
+    } catch (...) {
+      BOUT_OMP(critical(bout_team_error))
+      {
+        if(!error)
+          error = std::current_exception();
+      }
+      ompTeamFail();
+    }
+  }
+  ompTeamFailed() = false;
+
+  if(error)
+    std::rethrow_exception(error);
+}
+
+/// Call \p func on the master thread of the team, in a serial
+/// section, while the other threads wait. Outside a team this just
+/// calls \p func. An exception thrown by \p func can't leave the
+/// master block, so it is passed to the other threads and thrown by
+/// all of them after the barrier
+template<typename F>
+void ompMaster(F func) {
+  if(!ompTeam()) {
+    func();
+    return;
+  }
+  // Shared by the team, and only written by the master thread
+  static std::exception_ptr error;
+
+  BOUT_OMP(master)
+  {
+    OmpSerial serial;
+    try {
+      func();
+    } catch (...) {
+      error = std::current_exception();
+    }
+  }
+  BOUT_OMP(barrier)
+  if(ompTeamFailed()) {
+    // Another thread met the others here instead of the master
+    BOUT_OMP(master)
+    error = nullptr;
+    ompCheckTeam();
+  }
+
+  std::exception_ptr thrown = error;
+  // Everyone has a copy before the master resets it
+  BOUT_OMP(barrier)
+  BOUT_OMP(master)
+  error = nullptr;
+  ompCheckTeam();
+
+  if(thrown)
+    std::rethrow_exception(thrown);
+}
+
+/// Evaluate \p func on the master thread of the team, as ompMaster,
+/// and return a copy of the result to every thread. For a field the
+/// copies share the same data. Outside a team this just calls \p func
+template<typename F>
+auto ompMasterResult(F func) -> typename std::remove_cv<decltype(func())>::type {
+  using T = typename std::remove_cv<decltype(func())>::type;
+  if(!ompTeam())
+    return func();
+
+  // Points to the master's result, which all threads copy
+  static const T *shared;
+
+  T result;
+  ompMaster([&]() {
+    result = func();
+    shared = &result;
+  });
+  T copy(*shared);
+  // The master's result must outlive the copies
+  ompBarrier();
+  return copy;
+}
+
+#endif // __OPENMPWRAP_H__
@@ -0,0 +1,116 @@
+/// \file reduced_output.hxx
+/// Output of reduced representations of 3D fields
+///
+/// Writes averages, slices or truncated Fourier series of 3D fields
+/// to a separate output file, with its own output interval.
+/// These are calculated during the run, so the full 3D data does not
+/// need to be written to get these quantities.
+///
+/// Example
+/// -------
+///
+/// In BOUT.inp:
+///
+///     [output]
+///     reduced = profiles     # Comma-separated list of sections
+///
+///     [profiles]
+///     type = average_z       # average_z, average_yz, slice_z or fourier
+///     fields = n, T          # Evolving variables to output
+///     timestep = 0.1         # Output interval. Default is the output timestep
+///
+/// will write the toroidal averages of n and T to data/profiles.dmp.*.nc
+///
+/// Fields which are not evolving can be added in code:
+///
+///     ReducedOutput *out = new ReducedOutput(Options::getRoot()->getSection("phi_modes"),
+///                                            "phi_modes");
+///     out->add(phi, "phi");
+///     solver->addMonitor(out);
+///
+
+class ReducedOutput;
+
+#ifndef __REDUCED_OUTPUT_H__
+#define __REDUCED_OUTPUT_H__
+
+class Solver;
+
+#include "bout_types.hxx"
+#include "bout/monitor.hxx"
+#include "datafile.hxx"
+#include "field2d.hxx"
+#include "field3d.hxx"
+#include "options.hxx"
+
+#include <list>
+#include <string>
+#include <vector>
+
+class ReducedOutput : public Monitor {
+public:
+  /// Read settings from \p opt, and open the output file
+  ///
+  /// @param[in] opt   Options section containing the settings
+  /// @param[in] name  Used for the file name: <datadir>/<name>.dmp.<ext>
+  ReducedOutput(Options *opt, const std::string &name);
+  ~ReducedOutput();
+
+  /// The type of reduction to perform on each field
+  enum class Type {
+    average_z,  ///< Average in Z. One 2D field per variable
+    average_yz, ///< Flux-surface average (Y and Z), using averageY, so
+                ///< assumes no branch cuts. One 2D field per variable
+    slice_z,    ///< Values at one or more Z indices, starting at zstart
+                ///< with spacing zstride. One 2D field per plane
+    fourier     ///< Lowest nmodes Z Fourier modes. Real and imaginary parts
+                ///< of each mode as 2D fields
+  };
+
+  /// Add a field to be output. The field is reduced and written
+  /// each time the monitor is called.
+  ///
+  /// @param[in] f     The field to output. Must remain valid while this
+  ///                  monitor is in use
+  /// @param[in] name  Name of the variable. Outputs are named using this
+  ///                  as a prefix
+  void add(Field3D &f, const std::string &name);
+
+  int call(Solver *solver, BoutReal time, int iter, int nout) override;
+
+  void cleanup() override { dump.close(); }
+
+  /// Names of the fields given in the "fields" option
+  const std::list<std::string> &fieldNames() const { return field_names; }
+
+  /// The reduced fields of the \p i'th field added, in the order they
+  /// are named: real then imaginary parts of each mode for fourier
+  const std::vector<Field2D *> &outputs(int i) const { return vars.at(i).out; }
+
+private:
+  Type type;
+
+  int zstart, zstride; ///< Planes to output for slice_z
+  int nmodes;          ///< Number of Fourier modes for fourier
+
+  std::list<std::string> field_names; ///< From "fields" option
+
+  Datafile dump;      ///< The output file
+  BoutReal simtime;   ///< Simulation time written to file
+
+  /// A field being output, and the reduced fields to write
+  struct Variable {
+    Field3D *var;
+    std::vector<Field2D *> out;
+  };
+  std::vector<Variable> vars;
+
+  /// Storage for the reduced fields. A list is used so that the
+  /// addresses don't change, as these are added to dump
+  std::list<Field2D> data;
+
+  /// Get the "timestep" option, used by the constructor
+  static BoutReal getTimestep(Options *opt);
+};
+
+#endif // __REDUCED_OUTPUT_H__
@@ -71,6 +71,11 @@ typedef int (*TimestepMonitorFunc)(Solver *solver, BoutReal simtime, BoutReal la
 
 #include <string>
 #include <list>
+#include <memory>
+#include <vector>
+
+class ReducedOutput;
+
 using std::string;
 
 #define SolverType const char*
@@ -389,10 +394,18 @@ private:
   bool mms; ///< Enable sources and solutions for Method of Manufactured Solutions
   bool mms_initialise; ///< Initialise variables to the manufactured solution
 
+  bool openmp_team; ///< Run user RHS functions in one persistent OpenMP team
+  /// Call \p func, which runs a user RHS function, by every thread of
+  /// one parallel region if openmp_team is set. Returns the status
+  /// from the master thread
+  template<typename F>
+  int runInTeam(F func);
+
   void add_mms_sources(BoutReal t);
   void calculate_mms_error(BoutReal t);
   
   std::list<Monitor*> monitors; ///< List of monitor functions
+  std::vector<std::unique_ptr<ReducedOutput>> reduced_outputs; ///< Monitors created by addReducedOutputs
   std::list<TimestepMonitorFunc> timestep_monitors; ///< List of timestep monitor functions
 
   void pre_rhs(BoutReal t); // Should be run before user RHS is called
@@ -403,6 +416,10 @@ private:
   void loop_vars(BoutReal *udata, SOLVER_VAR_OP op);
 
   bool varAdded(const string &name); // Check if a variable has already been added
+
+  /// Create reduced output monitors listed in the "reduced" option
+  /// of the output section
+  void addReducedOutputs();
 };
 
 #endif // __SOLVER_H__
@@ -0,0 +1,48 @@
+/*!
+ * \file numa.hxx
+ *
+ * Placement of field data on nodes with non-uniform memory access
+ *
+ * On a node with several sockets each memory page is placed in the
+ * memory of the socket whose thread first writes to it. Field data is
+ * usually allocated and initialised by the master thread, so threads on
+ * the other sockets then read all their data remotely.
+ *
+ * With first touch enabled, Arrays allocated outside a parallel region
+ * are initialised by all OpenMP threads, each writing the part which
+ * DataIterator loops give it (see bout/array.hxx). This only helps if
+ * threads stay on the same CPUs, so threads can also be pinned.
+ *
+ * Settings in the [numa] section of the input:
+ *
+ *  - first_touch  Initialise new Arrays in parallel (default false)
+ *  - pin_threads  Pin each OpenMP thread to one CPU, if the OpenMP
+ *                 runtime doesn't already bind threads (default false)
+ *  - diagnose     Measure and print the fraction of remote pages
+ *                 and the memory bandwidth at startup (default false)
+ *
+ */
+
+#ifndef __NUMA_H__
+#define __NUMA_H__
+
+class Options;
+
+/// Should new Arrays be initialised in parallel? Off by default
+inline bool &numaFirstTouch() {
+  static bool value = false;
+  return value;
+}
+
+/// The NUMA domain of the CPU the calling thread is running on.
+/// Zero if this can't be found
+int numaDomain();
+
+/// Number of NUMA domains on this node. One if this can't be found
+int numaNumDomains();
+
+/// Read settings from \p options (the [numa] section), then
+/// enable first touch, pin threads and run the diagnostic as set
+void numaInitialise(Options *options);
+
+#endif // __NUMA_H__
@@ -0,0 +1,98 @@
+/*!
+ * \file shared_comm.hxx
+ *
+ * Exchange of data between processes on the same node through
+ * MPI-3 shared memory windows
+ *
+ * Each process allocates a number of buffers ("slots") in a window
+ * shared by all processes on its node. To send data to a process on
+ * the same node, the sender packs it directly into one of its slots and
+ * tells the receiver (e.g. with a zero-length message); the receiver then
+ * reads the data straight from the sender's memory, and releases the slot.
+ * This saves the copies through MPI's own buffers.
+ *
+ *     SharedComm shared(comm, 6, size); // Collective over comm
+ *
+ *     // Sender
+ *     BoutReal *buffer = shared.sendBuffer(slot, dest, len);
+ *     if (buffer) {
+ *       // pack data into buffer
+ *       shared.ready(slot, dest);
+ *       // send zero-length message to dest
+ *     } else {
+ *       // Not on the same node, or slot still in use: send as usual
+ *     }
+ *
+ *     // Receiver, after the message arrives
+ *     BoutReal *data = shared.recvBuffer(source, slot);
+ *     // unpack data
+ *     shared.release(source, slot);
+ *
+ * A slot can't be reused until the receiver has released it. If it
+ * hasn't, sendBuffer returns nullptr and the data should be sent by MPI
+ */
+
+class SharedComm;
+
+#ifndef __SHARED_COMM_H__
+#define __SHARED_COMM_H__
+
+#include "mpi.h"
+
+#include "bout_types.hxx"
+
+#include <vector>
+
+class SharedComm {
+public:
+  /// Create the shared memory windows. Collective over \p comm
+  ///
+  /// @param[in] comm      Communicator containing all processes
+  /// @param[in] nslots    Number of buffers for each process
+  /// @param[in] slotsize  Size of each buffer, in BoutReals. The
+  ///                      largest over each node is used
+  SharedComm(MPI_Comm comm, int nslots, int slotsize);
+
+  /// Free the windows. Collective over the communicator
+  ~SharedComm();
+
+  SharedComm(const SharedComm &) = delete;
+  SharedComm &operator=(const SharedComm &) = delete;
+
+  /// Is process \p rank on the same node as this one?
+  bool isLocal(int rank) const { return node_rank[rank] != MPI_UNDEFINED; }
+
+  /// Number of processes on this node
+  int nodeSize() const { return static_cast<int>(remote.size()); }
+
+  /// This process' buffer \p slot, to send \p len values to \p rank.
+  /// Returns nullptr if \p rank is not on this node, \p len is zero or
+  /// larger than the buffers, or the last data sent from this slot has
+  /// not yet been released
+  BoutReal *sendBuffer(int slot, int rank, int len);
+
+  /// The data in buffer \p slot is ready to be read by \p rank.
+  /// Should be called before \p rank is told that the data is ready
+  void ready(int slot, int rank);
+
+  /// Buffer \p slot of process \p rank. Should only be read after
+  /// \p rank has called ready() and told this process
+  BoutReal *recvBuffer(int rank, int slot);
+
+  /// Finished reading buffer \p slot of process \p rank
+  void release(int rank, int slot);
+
+private:
+  MPI_Comm comm_node; ///< Processes on this node
+  MPI_Comm comm_ack;  ///< Used to release slots
+  MPI_Win win;        ///< Shared memory window
+
+  int nslots, slotsize;
+  BoutReal *base;     ///< This process' buffers
+
+  std::vector<int> node_rank;      ///< Rank in comm_node of each process, or MPI_UNDEFINED
+  std::vector<BoutReal *> remote;  ///< Buffers of each process on this node
+  std::vector<MPI_Request> acks;   ///< Pending release of each slot
+};
+
+#endif // __SHARED_COMM_H__
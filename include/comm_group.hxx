@@ -22,6 +22,14 @@
  * You should have received a copy of the GNU Lesser General Public License
  * along with BOUT++.  If not, see <http://www.gnu.org/licenses/>.
  * 
+ * Handles can be reused: the request storage is kept between
+ * operations, so repeated gathers or scatters do not allocate.
+ * Call Comm_handle_free to release it.
+ *
+ * For an operation repeated many times with the same buffers,
+ * Comm_gather_init / Comm_scatter_init create persistent requests
+ * once, and each operation is then Comm_start followed by Comm_wait.
+ *
  ***********************************************************************/
 
 #ifndef __COMM_GROUP_H__
@@ -33,12 +41,21 @@ namespace comm_group {
   /// Communication handle
   typedef struct {
     // Communication info
-    int root, myrank, nprocs;
+    int root = 0, myrank = 0, nprocs = 0;
     
     // Handles
-    int nreq;     ///< Number of MPI requests
-    MPI_Request *request;
-    bool current; ///< True if currently in progress
+    int nreq = 0;     ///< Number of MPI requests
+    int nalloc = 0;   ///< Size of request array
+    MPI_Request *request = nullptr;
+    bool current = false; ///< True if currently in progress
+    bool persistent = false; ///< Requests created by Comm_*_init
+
+    // Operation, kept for Comm_start
+    bool gather = true;      ///< Gather or scatter?
+    void *sendbuf = nullptr, *recvbuf = nullptr;
+    int count = 0;           ///< Number of elements per processor
+    MPI_Datatype type = MPI_DATATYPE_NULL;
+    MPI_Comm comm = MPI_COMM_NULL;
   }Comm_handle_t;
   
   /// Begin a gather operation
@@ -52,17 +69,40 @@ namespace comm_group {
 			   int root, MPI_Comm comm,
 			   Comm_handle_t *handle);
   
+  /// Set up a persistent gather. Arguments as Comm_gather_start
+  bool Comm_gather_init(void *local, int nlocal, MPI_Datatype type,
+			void *data, 
+			int root, MPI_Comm comm,
+			Comm_handle_t *handle);
+
+  /// Set up a persistent scatter. Arguments as Comm_scatter_start
+  bool Comm_scatter_init( void *sendbuf, int sendcnt, MPI_Datatype type, 
+			  void *recvbuf, 
+			  int root, MPI_Comm comm,
+			  Comm_handle_t *handle);
+
+  /// Start a persistent operation
+  bool Comm_start(Comm_handle_t *handle);
+
   /// Wait for a single operation to finish
   bool Comm_wait(Comm_handle_t *handle);
   
   /// Wait for all the communications to finish
   bool Comm_wait_all(int n, Comm_handle_t *handles);
+
+  /// Free the requests and storage in a handle. Any operation
+  /// in progress is completed first
+  void Comm_handle_free(Comm_handle_t *handle);
 }
 
 using comm_group::Comm_handle_t;
 using comm_group::Comm_gather_start;
 using comm_group::Comm_scatter_start;
+using comm_group::Comm_gather_init;
+using comm_group::Comm_scatter_init;
+using comm_group::Comm_start;
 using comm_group::Comm_wait;
 using comm_group::Comm_wait_all;
+using comm_group::Comm_handle_free;
 
 #endif // __COMM_GROUP_H__
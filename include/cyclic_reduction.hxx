@@ -12,6 +12,11 @@
  ic    = (a1  (b2 - (a2/b1)*c1)  c2)
  alpha = a3 / b1
  *
+ * The elimination of the coefficients is done once, when the coefficients
+ * are set, and the multipliers stored. Solves with a new right-hand side
+ * then only apply the stored multipliers, and only RHS values are
+ * communicated between processors.
+ *
  **************************************************************************
  * Copyright 2010 B.D.Dudson, S.Farley, M.V.Umansky, X.Q.Xu
  *
@@ -47,6 +52,8 @@
 #include <lapack_routines.hxx>
 #include "boutexception.hxx"
 
+#include <vector>
+
 template <class T>
 class CyclicReduce {
 public:
@@ -56,9 +63,11 @@ public:
     myproc = -1;
     N = 0;
     Nsys = 0;
+    periodic = false;
+    factored = false;
   }
   
-  CyclicReduce(MPI_Comm c, int size) : comm(c), N(size), Nsys(0), periodic(false) {
+  CyclicReduce(MPI_Comm c, int size) : comm(c), N(size), Nsys(0), periodic(false), factored(false) {
     MPI_Comm_size(c, &nprocs);
     MPI_Comm_rank(c, &myproc);
   }
@@ -78,6 +87,7 @@ public:
     periodic = false;
     nprocs = np;
     myproc = myp;
+    factored = false;
   }
 
   ~CyclicReduce() {
@@ -86,7 +96,11 @@ public:
 
   /// Specify that the tridiagonal system is periodic
   /// By default not periodic
-  void setPeriodic(bool p=true) {periodic=p;}
+  void setPeriodic(bool p=true) {
+    if(p != periodic)
+      factored = false;
+    periodic=p;
+  }
   
   /// Set up a single equation to invert
   void setCoefs(T a[], T b[], T c[]) {
@@ -95,6 +109,9 @@ public:
 
   /// Set the entries in the matrix to be inverted
   ///
+  /// The matrix is factorised on the next call to solve(), and the
+  /// factorisation is reused by all solves until setCoefs is called again.
+  ///
   /// @param[in] nsys   The number of independent matrices to be solved
   /// @param[in] a   Left diagonal. Should have size [nsys][N]
   ///                where N is set in the constructor or setup
@@ -112,6 +129,8 @@ public:
         coefs[j][4*i + 2] = c[j][i];
         // 4*i + 3 will contain RHS
       }
+    
+    factored = false;
   }
 
   /// Solve a single triadiagonal system
@@ -129,74 +148,81 @@ public:
     if(nrhs != Nsys)
       throw BoutException("Sorry, can't yet handle nrhs != nsys");
     
-    // Insert RHS into coefs array. Ordered to allow efficient partitioning
-    // for MPI send/receives
-    for(int j=0;j<Nsys;j++)
-      for(int i=0;i<N;i++) {
-        coefs[j][4*i + 3] = rhs[j][i];
-      }
-
-    ///////////////////////////////////////
-    // Reduce local part of the matrix to interface equations
-    reduce(Nsys, N, coefs, myif);
-    
-    ///////////////////////////////////////
-    // Gather all interface equations onto single processor
-    // NOTE: Need to replace with divide-and-conquer at some point
+    if(!factored)
+      factor();
     
     int ns = Nsys / nprocs; // Number of systems to assign to all processors
     int nsextra = Nsys % nprocs;  // Number of processors with 1 extra 
     
-    MPI_Request* req = new MPI_Request[nprocs];
-
+    ///////////////////////////////////////
+    // Gather RHS of the interface equations onto the processor
+    // which solves them. Only 2 values per system are sent
+    
     if(myns > 0) {
       // Post receives from all other processors
-      req[myproc] = MPI_REQUEST_NULL;
       for(int p=0;p<nprocs;p++) { // Loop over processor
-        // 2 interface equations per processor
-        // myns systems to solve
-        // 3 coefficients + 1 RHS value
-        int len = 2 * myns * 4 * sizeof(T); // Length of data in bytes
-        
         if(p == myproc) {
-          // Just copy the data
-          for(int i=0;i<myns; i++)
-            for(int j=0;j<8;j++)
-              ifcs[i][8*p + j] = myif[sys0+i][j];
-        }else {
+          req[p] = MPI_REQUEST_NULL;
+          continue;
+        }
 #ifdef DIAGNOSE
-          output << "Expecting to receive " << len << " from " << p << endl;
+        output << "Expecting to receive " << 2*myns << " from " << p << endl;
 #endif
-          MPI_Irecv(recvbuffer[p], 
-                    len, 
-                    MPI_BYTE, // Just sending raw data, unknown type
-                    p,        // Destination processor
-                    p,        // Identifier
-                    comm,     // Communicator
-                    &req[p]); // Request
-        }
+        MPI_Irecv(recvbuffer[p], 
+                  2 * myns * sizeof(T), // Length of data in bytes
+                  MPI_BYTE, // Just sending raw data, unknown type
+                  p,        // Destination processor
+                  p,        // Identifier
+                  comm,     // Communicator
+                  &req[p]); // Request
       }
+    }else {
+      for(int p=0;p<nprocs;p++)
+        req[p] = MPI_REQUEST_NULL;
     }
     
-    // Send data
+    // Reduce the RHS for the systems going to each processor in turn,
+    // so that sends start while later systems are being reduced
     int s0 = 0;
     for(int p=0;p<nprocs;p++) { // Loop over processor
       int nsp = ns;
       if(p < nsextra)
         nsp++;
-      if((p != myproc) && (nsp > 0)) {
+      
+      // Insert RHS into coefs array
+      for(int j=s0;j<s0+nsp;j++)
+        for(int i=0;i<N;i++) {
+          coefs[j][4*i + 3] = rhs[j][i];
+        }
+      
+      // Reduce local part of the RHS to interface equations
+      reduceRHS(s0, nsp, N, coefs, lfac, myif);
+      
+      if(p == myproc) {
+        // Just copy the data
+        for(int i=0;i<myns; i++) {
+          ifcs[i][8*p + 3] = myif[sys0+i][3];
+          ifcs[i][8*p + 7] = myif[sys0+i][7];
+        }
+        sendreq[p] = MPI_REQUEST_NULL;
+      }else if(nsp > 0) {
+        for(int i=s0;i<s0+nsp;i++) {
+          ifsend[2*i]   = myif[i][3];
+          ifsend[2*i+1] = myif[i][7];
+        }
 #ifdef DIAGNOSE
         output << "Sending to " << p << endl;
-        for(int i=0;i<8;i++)
-          output << "value " << i << " : " << myif[s0][i] << endl;
 #endif
-        MPI_Send(myif[s0],        // Data pointer
-                 8*nsp*sizeof(T), // Number
-                 MPI_BYTE,        // Type
-		 p,               // Destination
-                 myproc,          // Message identifier
-                 comm);           // Communicator
-      }
+        MPI_Isend(&ifsend[2*s0],     // Data pointer
+                  2*nsp*sizeof(T),   // Number
+                  MPI_BYTE,          // Type
+                  p,                 // Destination
+                  myproc,            // Message identifier
+                  comm,              // Communicator
+                  &sendreq[p]);      // Request
+      }else
+        sendreq[p] = MPI_REQUEST_NULL;
+      
       s0 += nsp;
     }
     
@@ -205,69 +231,64 @@ public:
       int p;
       do {
         MPI_Status stat;
-        MPI_Waitany(nprocs, req, &p, &stat);
+        MPI_Waitany(nprocs, req.data(), &p, &stat);
         if(p != MPI_UNDEFINED) {
           // p is the processor number. Copy data
 #ifdef DIAGNOSE
           output << "Copying received data from " << p << endl;
 #endif
-          for(int i=0;i<myns; i++)
-            for(int j=0;j<8;j++) {
-#ifdef DIAGNOSE
-              output << "Value " << j << " : " << recvbuffer[p][8*i + j] << endl;
-#endif
-              ifcs[i][8*p + j] = recvbuffer[p][8*i + j];
-            }
+          for(int i=0;i<myns; i++) {
+            ifcs[i][8*p + 3] = recvbuffer[p][2*i];
+            ifcs[i][8*p + 7] = recvbuffer[p][2*i + 1];
+          }
           req[p] = MPI_REQUEST_NULL;
         }
       }while(p != MPI_UNDEFINED);
 
       ///////////////////////////////////////
       if(nprocs > 1) {
-	// Reduce the interface equations to a pair of equations
-#ifdef DIAGNOSE
-	output << "Reducing again\n";
-#endif
-	reduce(myns, 2*nprocs, ifcs, if2x2);
-      }else {
-	// Already just a pair of equations
-	if2x2 = ifcs;
+        // Reduce the interface equations to a pair of equations
+        reduceRHS(0, myns, 2*nprocs, ifcs, iffac, if2x2);
       }
+      
       ///////////////////////////////////////
       // Solve the 2x2 system directly
-        
+      
       for(int i=0;i<myns;i++) {
-	//  (a  b) (x1) = (b1)
-	//  (c  d) (xn)   (bn)
-          
-	T a, b, c, d;
-	a = if2x2[i][1];
-	b = if2x2[i][2];
-	c = if2x2[i][4];
-	d = if2x2[i][5];
-	if(periodic) {
-	  b += if2x2[i][0];
-	  c += if2x2[i][6];
-	}
-	T b1 = if2x2[i][3];
-	T bn = if2x2[i][7];
-          
-	// Solve
-	T det = a*d - b*c; // Determinant
-	x1[i] = (d*b1 - b*bn) / det;
-	xn[i] = (-c*b1 + a*bn) / det;
-          
+        //  (a  b) (x1) = (b1)
+        //  (c  d) (xn)   (bn)
+        
+        T a, b, c, d;
+        a = if2x2[i][1];
+        b = if2x2[i][2];
+        c = if2x2[i][4];
+        d = if2x2[i][5];
+        if(periodic) {
+          b += if2x2[i][0];
+          c += if2x2[i][6];
+        }
+        T b1 = if2x2[i][3];
+        T bn = if2x2[i][7];
+        
+        // Solve
+        T det = a*d - b*c; // Determinant
+        x1[i] = (d*b1 - b*bn) / det;
+        xn[i] = (-c*b1 + a*bn) / det;
+        
 #ifdef DIAGNOSE    
-	output << "system " << i << endl;
-	output << "(" << a << ", " << b << ") ("<<x1[i]<<") = (" << b1 << ")\n";
-	output << "(" << c << ", " << d << ") ("<<xn[i]<<")   (" << bn << ")\n\n";
+        output << "system " << i << endl;
+        output << "(" << a << ", " << b << ") ("<<x1[i]<<") = (" << b1 << ")\n";
+        output << "(" << c << ", " << d << ") ("<<xn[i]<<")   (" << bn << ")\n\n";
 #endif
       }
       
       // Solve the interface equations
-      back_solve(myns, 2*nprocs, ifcs, x1, xn, ifx);
+      back_solve(0, myns, 2*nprocs, ifcs, iffac, x1, xn, ifx);
     }
     
+    // Sends must complete before ifsend is reused
+    MPI_Waitall(nprocs, sendreq.data(), MPI_STATUSES_IGNORE);
+    
     if(nprocs > 1) { 
       ///////////////////////////////////////
       // Scatter back solution
@@ -275,29 +296,29 @@ public:
       // Post receives
       for(int p=0;p<nprocs;p++) { // Loop over processor
         int nsp = ns;
-	if(p < nsextra)
-	  nsp++;
-	int len = 2 * nsp * sizeof(T); // 2 values per system
+        if(p < nsextra)
+          nsp++;
+        int len = 2 * nsp * sizeof(T); // 2 values per system
         
-	if(p == myproc) {
-	  // Just copy the data
-	  for(int i=0;i<myns; i++) {
-	    x1[sys0+i] = ifx[i][2*p];
-	    xn[sys0+i] = ifx[i][2*p+1];
-	  }
+        if(p == myproc) {
+          // Just copy the data
+          for(int i=0;i<myns; i++) {
+            x1[sys0+i] = ifx[i][2*p];
+            xn[sys0+i] = ifx[i][2*p+1];
+          }
           req[p] = MPI_REQUEST_NULL;
-	}else if(nsp > 0) {
+        }else if(nsp > 0) {
 #ifdef DIAGNOSE
           output << "Expecting receive from " << p << " of size " << len << endl;
 #endif
-	  MPI_Irecv(recvbuffer[p],
-		    len,
-		    MPI_BYTE, // Just sending raw data, unknown type
-		    p,        // Destination processor
-		    p,        // Identifier
-		    comm,     // Communicator
-		    &req[p]); // Request
-	}else
+          MPI_Irecv(recvbuffer[p],
+                    len,
+                    MPI_BYTE, // Just sending raw data, unknown type
+                    p,        // Destination processor
+                    p,        // Identifier
+                    comm,     // Communicator
+                    &req[p]); // Request
+        }else
           req[p] = MPI_REQUEST_NULL;
       }
       
@@ -305,60 +326,73 @@ public:
         // Send data
         for(int p=0;p<nprocs;p++) { // Loop over processor
           if(p != myproc) {
+            T *buf = ifp + 2*myns*p; // Separate buffer for each processor
             for(int i=0;i<myns;i++) {
-              ifp[2*i]   = ifx[i][2*p];
-              ifp[2*i+1] = ifx[i][2*p+1];
+              buf[2*i]   = ifx[i][2*p];
+              buf[2*i+1] = ifx[i][2*p+1];
 #ifdef DIAGNOSE
-              output << "Returning: " << ifp[2*i] 
-                     << ", " << ifp[2*i+1] << " to " << p << endl;
+              output << "Returning: " << buf[2*i] 
+                     << ", " << buf[2*i+1] << " to " << p << endl;
 #endif
             }
-            MPI_Send(ifp,
-                     2*myns*sizeof(T),
-                     MPI_BYTE,
-                     p,
-                     myproc, // Message identifier
-                     comm);
-          }
+            MPI_Isend(buf,
+                      2*myns*sizeof(T),
+                      MPI_BYTE,
+                      p,
+                      myproc, // Message identifier
+                      comm,
+                      &sendreq[p]);
+          }else
+            sendreq[p] = MPI_REQUEST_NULL;
         }
+      }else {
+        for(int p=0;p<nprocs;p++)
+          sendreq[p] = MPI_REQUEST_NULL;
       }
       
-      // Wait for data
+      // Solve the local equations for my own systems
+      // while waiting for the other processors
+      back_solve(sys0, myns, N, coefs, lfac, x1, xn, x);
+      
+      // Wait for data, back-solving each set of systems as it arrives
       int fromproc;
       int nsp;
       do {
-	MPI_Status stat;
-	MPI_Waitany(nprocs, req, &fromproc, &stat);
-	if(fromproc != MPI_UNDEFINED) {
-	  // fromproc is the processor number. Copy data
-	  
-	  int s0 = fromproc*ns;
-	  if(fromproc > nsextra) {
-	    s0 += nsextra;
-	  }else
-	    s0 += fromproc;
-	    
-	  nsp = ns;
-	  if(fromproc < nsextra)
-	    nsp++;
-	  
-	  for(int i=0;i<nsp; i++) {
-	    x1[s0+i] = recvbuffer[fromproc][2*i];
-	    xn[s0+i] = recvbuffer[fromproc][2*i+1];
+        MPI_Status stat;
+        MPI_Waitany(nprocs, req.data(), &fromproc, &stat);
+        if(fromproc != MPI_UNDEFINED) {
+          // fromproc is the processor number. Copy data
+          
+          int s0 = fromproc*ns;
+          if(fromproc > nsextra) {
+            s0 += nsextra;
+          }else
+            s0 += fromproc;
+          
+          nsp = ns;
+          if(fromproc < nsextra)
+            nsp++;
+          
+          for(int i=0;i<nsp; i++) {
+            x1[s0+i] = recvbuffer[fromproc][2*i];
+            xn[s0+i] = recvbuffer[fromproc][2*i+1];
 #ifdef DIAGNOSE
             output << "Received x1,xn[" << s0+i << "] = " << x1[s0+i] << ", "
-		   << xn[s0+i] << " from " << fromproc << endl;
+                   << xn[s0+i] << " from " << fromproc << endl;
 #endif
-	  }
-	  req[fromproc] = MPI_REQUEST_NULL;
-	}
+          }
+          req[fromproc] = MPI_REQUEST_NULL;
+          
+          back_solve(s0, nsp, N, coefs, lfac, x1, xn, x);
+        }
       }while(fromproc != MPI_UNDEFINED);
+      
+      MPI_Waitall(nprocs, sendreq.data(), MPI_STATUSES_IGNORE);
+    }else {
+      ///////////////////////////////////////
+      // Solve local equations
+      back_solve(0, Nsys, N, coefs, lfac, x1, xn, x);
     }
-    
-    ///////////////////////////////////////
-    // Solve local equations
-    back_solve(Nsys, N, coefs, x1, xn, x);
-    delete[] req;
   }
   
 private:
@@ -371,16 +405,23 @@ private:
   int sys0;      ///< Starting system index for interface solve
   
   bool periodic; ///< Is the domain periodic?
+  bool factored; ///< Are the stored multipliers up to date with coefs?
 
   T **coefs;  ///< Starting coefficients, rhs [Nsys, {3*coef,rhs}*N]
+  T **lfac;   ///< Multipliers for the local system [Nsys, 4*N]
   T **myif;   ///< Interface equations for this processor
   
   T **recvbuffer; ///< Buffer for receiving from other processors
   T **ifcs;   ///< Coefficients for interface solve
+  T **iffac;  ///< Multipliers for the interface system [myns, 4*2*nprocs]
   T **if2x2;  ///< 2x2 interface equations on this processor
   T **ifx;    ///< Solution of interface equations
-  T *ifp;     ///< Interface equations returned to processor p
+  T *ifsend;  ///< Interface RHS sent to other processors [2*Nsys]
+  T *ifp;     ///< Interface equations returned to each processor [nprocs*2*myns]
   T *x1, *xn; ///< Interface solutions for back-solving
+  
+  std::vector<MPI_Request> req;     ///< Receive requests, one per processor
+  std::vector<MPI_Request> sendreq; ///< Send requests, one per processor
 
   /// Allocate memory arrays
   /// @param[in[ np   Number of processors
@@ -414,18 +455,28 @@ private:
       my = 0;
 
     coefs = matrix<T>(Nsys, 4*N);
+    lfac = matrix<T>(Nsys, 4*N);
       
     myif = matrix<T>(Nsys, 8);
     
-    recvbuffer = matrix<T>(nprocs, my*8); // Buffer for receiving from other processors
+    // Buffer for receiving from other processors. Needs to hold either
+    // interface equations for my systems, or the solution for up to
+    // ns+1 systems from another processor
+    recvbuffer = matrix<T>(nprocs, BOUTMAX(my*8, 2*(ns+1)));
     ifcs = matrix<T>(my, 2*4*nprocs);     // Coefficients for interface solve
+    iffac = matrix<T>(my, 2*4*nprocs);    // Multipliers for interface solve
     if(nprocs > 1)
       if2x2 = matrix<T>(my, 2*4);         // 2x2 interface equations on this processor
     ifx  = matrix<T>(my, 2*nprocs);       // Solution of interface equations
-    ifp = new T[my*2];     // Solution to be sent to processor p
+    ifsend = new T[2*Nsys];
+    ifp = new T[my*2*nprocs];     // Solution to be sent to processor p
     x1 = new T[Nsys];
     xn = new T[Nsys];
     
+    req.resize(nprocs);
+    sendreq.resize(nprocs);
+    
+    factored = false;
   }
 
   /// Free all memory arrays allocated by allocMemory()
@@ -435,53 +486,155 @@ private:
     
     // Free all working memory
     free_matrix(coefs);
+    free_matrix(lfac);
     free_matrix(myif);
     free_matrix(recvbuffer);
     free_matrix(ifcs);
+    free_matrix(iffac);
     if(nprocs > 1)
       free_matrix(if2x2);
     free_matrix(ifx);
+    delete[] ifsend;
     delete[] ifp;
     delete[] x1;
     delete[] xn;
     
     N = Nsys = 0;
+    factored = false;
   }
 
-  /// Calculate interface equations
-  void reduce(int ns, int nloc, T **co, T **ifc) {
+  /// Eliminate the coefficients, and gather the interface equations
+  /// onto the processors which solve them. This only needs to be done
+  /// when the coefficients change.
+  void factor() {
+    // Reduce local part of the matrix to interface equations
+    reduce(Nsys, N, coefs, myif, lfac);
+    factor_back(Nsys, N, coefs, lfac);
+    
+    ///////////////////////////////////////
+    // Gather all interface equations onto single processor
+    // NOTE: Need to replace with divide-and-conquer at some point
+    
+    int ns = Nsys / nprocs; // Number of systems to assign to all processors
+    int nsextra = Nsys % nprocs;  // Number of processors with 1 extra 
+    
+    for(int p=0;p<nprocs;p++)
+      req[p] = sendreq[p] = MPI_REQUEST_NULL;
+    
+    if(myns > 0) {
+      // Post receives from all other processors
+      for(int p=0;p<nprocs;p++) { // Loop over processor
+        // 2 interface equations per processor
+        // myns systems to solve
+        // 3 coefficients + 1 RHS value
+        int len = 2 * myns * 4 * sizeof(T); // Length of data in bytes
+        
+        if(p == myproc) {
+          // Just copy the data
+          for(int i=0;i<myns; i++)
+            for(int j=0;j<8;j++)
+              ifcs[i][8*p + j] = myif[sys0+i][j];
+        }else {
+          MPI_Irecv(recvbuffer[p], 
+                    len, 
+                    MPI_BYTE, // Just sending raw data, unknown type
+                    p,        // Destination processor
+                    p,        // Identifier
+                    comm,     // Communicator
+                    &req[p]); // Request
+        }
+      }
+    }
+    
+    // Send data
+    int s0 = 0;
+    for(int p=0;p<nprocs;p++) { // Loop over processor
+      int nsp = ns;
+      if(p < nsextra)
+        nsp++;
+      if((p != myproc) && (nsp > 0)) {
+        MPI_Isend(myif[s0],        // Data pointer
+                  8*nsp*sizeof(T), // Number
+                  MPI_BYTE,        // Type
+                  p,               // Destination
+                  myproc,          // Message identifier
+                  comm,            // Communicator
+                  &sendreq[p]);    // Request
+      }
+      s0 += nsp;
+    }
+    
+    if(myns > 0) {
+      // Wait for data
+      int p;
+      do {
+        MPI_Status stat;
+        MPI_Waitany(nprocs, req.data(), &p, &stat);
+        if(p != MPI_UNDEFINED) {
+          // p is the processor number. Copy data
+          for(int i=0;i<myns; i++)
+            for(int j=0;j<8;j++)
+              ifcs[i][8*p + j] = recvbuffer[p][8*i + j];
+          req[p] = MPI_REQUEST_NULL;
+        }
+      }while(p != MPI_UNDEFINED);
+      
+      ///////////////////////////////////////
+      if(nprocs > 1) {
+        // Reduce the interface equations to a pair of equations
+        reduce(myns, 2*nprocs, ifcs, if2x2, iffac);
+      }else {
+        // Already just a pair of equations
+        if2x2 = ifcs;
+      }
+      factor_back(myns, 2*nprocs, ifcs, iffac);
+    }
+    
+    MPI_Waitall(nprocs, sendreq.data(), MPI_STATUSES_IGNORE);
+    
+    factored = true;
+  }
+
+  /// Calculate the coefficients of the interface equations
+  /// 
+  /// The RHS of the interface equations is not calculated here
+  /// (see reduceRHS), but the multipliers used in the elimination
+  /// are stored in \p fac: upper equation in [0,nloc), lower in [nloc, 2*nloc)
+  void reduce(int ns, int nloc, T **co, T **ifc, T **fac) {
 #ifdef DIAGNOSE
     if(nloc < 2)
       throw BoutException("CyclicReduce::reduce nloc < 2");
 #endif
+    bool zeropivot = false;
+    #pragma omp parallel for reduction(||: zeropivot)
     for(int j=0;j<ns;j++) {
       T *c = co[j];    // Coefficients for system j
       T *ic = ifc[j];  // Interface equations for system j
+      T *beta = fac[j];      // Upper elimination multipliers
+      T *alpha = fac[j] + nloc; // Lower elimination multipliers
         
       // Calculate upper interface equation
       
       // v_l <- v_(k+N-2)
-      // b_u <- b_{k+N-2}
-      for(int i=0;i<4;i++) {
+      for(int i=0;i<3;i++) {
         ic[i] = c[4*(nloc-2)+i];
       }
       
       for(int i=nloc-3;i>=0;i--) {
-	// Check for zero pivot
-	if(abs(ic[1]) < 1e-10)
-	  throw BoutException("Zero pivot in CyclicReduce::reduce");
+        // Check for zero pivot
+        if(abs(ic[1]) < 1e-10) {
+          zeropivot = true;
+          break;
+        }
 	
         // beta <- v_{i,i+1} / v_u,i
-        T beta = c[4*i+2] / ic[1];
+        beta[i] = c[4*i+2] / ic[1];
           
         // v_u <- v_i - beta * v_u
-        ic[1] = c[4*i + 1] - beta * ic[0];
+        ic[1] = c[4*i + 1] - beta[i] * ic[0];
         ic[0] = c[4*i];
-	ic[2] *= -beta;
+        ic[2] *= -beta[i];
         // ic columns  {i-1, i, N-1}
-        
-        // b_u <- b_i - beta*b_u
-        ic[3] = c[4*i + 3] - beta*ic[3];
       }
       
       ic += 4;
@@ -489,54 +642,88 @@ private:
       // Calculate lower interface equation
       
       // v_l <- v_(k+1)
-      // b_l <- b_{k+1}
-      for(int i=0;i<4;i++)
+      for(int i=0;i<3;i++)
         ic[i] = c[4+i];
         
       for(int i=2;i<nloc;i++) {
 	
-	if(abs(ic[1]) < 1e-10)
-	  throw BoutException("Zero pivot in CyclicReduce::reduce");
+        if(abs(ic[1]) < 1e-10) {
+          zeropivot = true;
+          break;
+        }
 	
         // alpha <- v_{i,i-1} / v_l,i-1
-        T alpha = c[4*i] / ic[1];
+        alpha[i] = c[4*i] / ic[1];
           
         // v_l <- v_i - alpha*v_l
-	ic[0] *= -alpha;
-        ic[1] = c[4*i + 1] - alpha*ic[2];
+        ic[0] *= -alpha[i];
+        ic[1] = c[4*i + 1] - alpha[i]*ic[2];
         ic[2] = c[4*i + 2];
         // columns of ic are {0, i, i+1}
-          
-        // b_l <- b_{k+i} - alpha*b_l
-        ic[3] = c[4*i + 3] - alpha * ic[3];   
       }
-      
-#ifdef DIAGNOSE
-      output << "Lower: " << ic[0] << ", " << ic[1] << ", " << ic[2] << " : " << ic[3] << endl;
-      output << "Upper: " << ic[0] << ", " << ic[1] << ", " << ic[2] << " : " << ic[3] << endl;
-#endif
     }
+    
+    if(zeropivot)
+      throw BoutException("Zero pivot in CyclicReduce::reduce");
 
     // Lower system couples {0, N-1, N}
     // Upper system couples {-1. 0, N-1}
   }
   
+  /// Calculate the RHS of the interface equations for systems
+  /// [s0, s0+ns) using the multipliers stored by reduce()
+  void reduceRHS(int s0, int ns, int nloc, T **co, T **fac, T **ifc) {
+    #pragma omp parallel for
+    for(int j=s0;j<s0+ns;j++) {
+      const T *c = co[j];
+      const T *beta = fac[j];
+      const T *alpha = fac[j] + nloc;
+      
+      // b_u <- b_i - beta*b_u
+      T bu = c[4*(nloc-2) + 3];
+      for(int i=nloc-3;i>=0;i--)
+        bu = c[4*i + 3] - beta[i]*bu;
+      
+      // b_l <- b_{k+i} - alpha*b_l
+      T bl = c[4 + 3];
+      for(int i=2;i<nloc;i++)
+        bl = c[4*i + 3] - alpha[i]*bl;
+      
+      ifc[j][3] = bu;
+      ifc[j][7] = bl;
+    }
+  }
+  
+  /// Calculate the Thomas algorithm factors used in back_solve,
+  /// storing them in \p fac: gam in [2*nloc, 3*nloc), bet in [3*nloc, 4*nloc)
+  void factor_back(int ns, int nloc, T **co, T **fac) {
+    #pragma omp parallel for
+    for(int i=0;i<ns;i++) { // Loop over systems
+      const T *c = co[i];
+      T *gam = fac[i] + 2*nloc;
+      T *bet = fac[i] + 3*nloc;
+      gam[1] = 0.;
+      for(int j=1;j<nloc-1;j++) {
+        bet[j] = c[4*j+1] - c[4*j]*gam[j]; // bet = b[j]-a[j]*gam[j]
+        gam[j+1] = c[4*j+2] / bet[j];    // gam[j+1] = c[j]/bet
+      }
+    }
+  }
+  
   /// Back-solve from x at ends (x1, xn) to obtain remaining values
+  /// for systems [s0, s0+ns), using factors from factor_back
   /// Coefficients ordered [ns, nloc*(a,b,c,r)]
-  void back_solve(int ns, int nloc, T **co, T *x1, T *xn, T **xa) {
+  void back_solve(int s0, int ns, int nloc, T **co, T **fac, T *x1, T *xn, T **xa) {
     // Tridiagonal system, solve using serial Thomas algorithm
-    
-    T *gam = new T[nloc];
-    for(int i=0;i<ns;i++) { // Loop over systems
-      T *c = co[i]; // Coefficients & rhs for this system
+    #pragma omp parallel for
+    for(int i=s0;i<s0+ns;i++) { // Loop over systems
+      const T *c = co[i]; // Coefficients & rhs for this system
+      const T *gam = fac[i] + 2*nloc;
+      const T *bet = fac[i] + 3*nloc;
       T *x = xa[i]; // Result for this system
-      T bet = 1.0;
       x[0] = x1[i]; // Already know the first 
-      gam[1] = 0.;
       for(int j=1;j<nloc-1;j++) {
-        bet = c[4*j+1] - c[4*j]*gam[j]; // bet = b[j]-a[j]*gam[j]
-        x[j] = (c[4*j+3] - c[4*j]*x[j-1])/bet;  // x[j] = (r[j]-a[j]*x[j-1])/bet;
-        gam[j+1] = c[4*j+2] / bet;    // gam[j+1] = c[j]/bet
+        x[j] = (c[4*j+3] - c[4*j]*x[j-1])/bet[j];  // x[j] = (r[j]-a[j]*x[j-1])/bet;
       }
       x[nloc-1] = xn[i]; // Know the last value
       
@@ -544,7 +731,6 @@ private:
         x[j] = x[j]-gam[j+1]*x[j+1];
       }
     }
-    delete[] gam;
   }
 };
 
@@ -88,6 +88,10 @@ class Datafile {
   bool shiftOutput; //Do we want to write out in shifted space?
   int flushFrequencyCounter; //Counter used in determining when next openclose required
   int flushFrequency; //How many write calls do we want between openclose
+  int compress_level; // Deflate level for 3D fields, 0 for no compression
+  bool lossy;        // Quantise 3D fields before writing?
+  BoutReal abstol, reltol; // Default quantisation tolerances
+  Options *options;  // Per-variable tolerances are in subsections
 
   std::unique_ptr<DataFormat> file;
   size_t filenamelen;
@@ -105,6 +109,7 @@ class Datafile {
       string name;
       bool save_repeat;
       bool covar;
+      BoutReal abstol = 0.0, reltol = 0.0; ///< Quantisation tolerances, 3D only
     };
 
   // one set per variable type
@@ -121,7 +126,11 @@ class Datafile {
   bool write_int(const string &name, int *f, bool save_repeat);
   bool write_real(const string &name, BoutReal *f, bool save_repeat);
   bool write_f2d(const string &name, Field2D *f, bool save_repeat);
-  bool write_f3d(const string &name, Field3D *f, bool save_repeat);
+  bool write_f3d(const string &name, Field3D *f, bool save_repeat,
+                 BoutReal abstol, BoutReal reltol);
+
+  /// Get the quantisation tolerances for variable \p name
+  void getTolerances(const string &name, BoutReal &abs, BoutReal &rel);
 
   /// Check if a variable has already been added
   bool varAdded(const string &name);
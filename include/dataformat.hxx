@@ -34,6 +34,7 @@ class DataFormat;
 #define __DATAFORMAT_H__
 
 #include "bout_types.hxx"
+#include "unused.hxx"
 #include <string>
 #include <memory>
 using std::string;
@@ -98,6 +99,20 @@ class DataFormat {
   // Optional functions
   
   virtual void setLowPrecision() { }  // By default doesn't do anything
+
+  /// Compress 3D variables created after this call with the shuffle and
+  /// deflate filters, using deflate \p level (1-9). Zero disables compression.
+  /// By default doesn't do anything, since not all formats support this
+  virtual void setCompression(int UNUSED(level)) { }
+
+  /// Complete any writes which were queued rather than done when
+  /// requested. Called by Datafile at the start of each output time,
+  /// so that all variables in the previous record are written together
+  /// and the writes aren't waited for until they are needed.
+  /// flush() and close() must also complete queued writes.
+  /// The data passed to write and write_rec must already have been
+  /// copied, so it can be changed before this is called
+  virtual void completeWrites() { }
 };
 
 // For backwards compatability. In formatfactory.cxx
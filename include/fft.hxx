@@ -69,6 +69,24 @@ void rfft(const BoutReal *in, int length, dcomplex *out);
  */
 void irfft(const dcomplex *in, int length, BoutReal *out);
 
+/*!
+ * Real FFTs of \p howmany signals, each of \p length points, stored
+ * one after another in \p in. The length/2 + 1 modes of each signal
+ * are stored one after another in \p out, normalised as rfft.
+ *
+ * This is faster than calling rfft for each signal, for example
+ * for all the Z lines of a Field3D at once. One FFTW plan is made
+ * for each \p length and \p howmany, and kept
+ */
+void rfft(const BoutReal *in, int length, int howmany, dcomplex *out);
+
+/*!
+ * Inverse of the batched rfft above, doing irfft for each signal.
+ *
+ * NOTE: The input \p in is overwritten
+ */
+void irfft(dcomplex *in, int length, int howmany, BoutReal *out);
+
 /*!
  * Discrete Sine Transform
  *
@@ -74,9 +74,9 @@ class Field2D : public Field, public FieldData {
   Field2D(const Field2D& f);
 
   /*!
-   * Move constructor
+   * Move constructor. Takes the data of \p f, leaving it unallocated
    */
-  Field2D(Field2D&& f) = default;
+  Field2D(Field2D&& f);
 
   /*!
    * Constructor. This creates a Field2D using the global Mesh pointer (mesh)
@@ -96,6 +96,8 @@ class Field2D : public Field, public FieldData {
   /// Ensure data is allocated
   void allocate();
   bool isAllocated() const { return !data.empty(); } ///< Test if data is allocated
+  /// Test if data is allocated and not shared with another field
+  bool isUnique() const { return !data.empty() && data.unique(); }
 
   /// Return a pointer to the time-derivative field
   Field2D* timeDeriv();
@@ -270,40 +272,77 @@ class Field2D : public Field, public FieldData {
 };
 
 // Non-member overloaded operators
-
-const Field2D operator+(const Field2D &lhs, const Field2D &rhs);
-const Field2D operator-(const Field2D &lhs, const Field2D &rhs);
-const Field2D operator*(const Field2D &lhs, const Field2D &rhs);
-const Field2D operator/(const Field2D &lhs, const Field2D &rhs);
-
-const Field3D operator+(const Field2D &lhs, const Field3D &rhs);
-const Field3D operator-(const Field2D &lhs, const Field3D &rhs);
-const Field3D operator*(const Field2D &lhs, const Field3D &rhs);
-const Field3D operator/(const Field2D &lhs, const Field3D &rhs);
-
-const Field2D operator+(const Field2D &lhs, BoutReal rhs);
-const Field2D operator-(const Field2D &lhs, BoutReal rhs);
-const Field2D operator*(const Field2D &lhs, BoutReal rhs);
-const Field2D operator/(const Field2D &lhs, BoutReal rhs);
-
-const Field2D operator+(BoutReal lhs, const Field2D &rhs);
-const Field2D operator-(BoutReal lhs, const Field2D &rhs);
-const Field2D operator*(BoutReal lhs, const Field2D &rhs);
-const Field2D operator/(BoutReal lhs, const Field2D &rhs);
+//
+// Operators and functions with an rvalue argument reuse its data for
+// the result if it is not shared with another field, rather than
+// allocating a new array
+
+Field2D operator+(const Field2D &lhs, const Field2D &rhs);
+Field2D operator-(const Field2D &lhs, const Field2D &rhs);
+Field2D operator*(const Field2D &lhs, const Field2D &rhs);
+Field2D operator/(const Field2D &lhs, const Field2D &rhs);
+
+Field2D operator+(Field2D &&lhs, const Field2D &rhs);
+Field2D operator-(Field2D &&lhs, const Field2D &rhs);
+Field2D operator*(Field2D &&lhs, const Field2D &rhs);
+Field2D operator/(Field2D &&lhs, const Field2D &rhs);
+
+Field2D operator+(const Field2D &lhs, Field2D &&rhs);
+Field2D operator-(const Field2D &lhs, Field2D &&rhs);
+Field2D operator*(const Field2D &lhs, Field2D &&rhs);
+Field2D operator/(const Field2D &lhs, Field2D &&rhs);
+
+Field2D operator+(Field2D &&lhs, Field2D &&rhs);
+Field2D operator-(Field2D &&lhs, Field2D &&rhs);
+Field2D operator*(Field2D &&lhs, Field2D &&rhs);
+Field2D operator/(Field2D &&lhs, Field2D &&rhs);
+
+Field3D operator+(const Field2D &lhs, const Field3D &rhs);
+Field3D operator-(const Field2D &lhs, const Field3D &rhs);
+Field3D operator*(const Field2D &lhs, const Field3D &rhs);
+Field3D operator/(const Field2D &lhs, const Field3D &rhs);
+
+Field3D operator+(const Field2D &lhs, Field3D &&rhs);
+Field3D operator-(const Field2D &lhs, Field3D &&rhs);
+Field3D operator*(const Field2D &lhs, Field3D &&rhs);
+Field3D operator/(const Field2D &lhs, Field3D &&rhs);
+
+Field2D operator+(const Field2D &lhs, BoutReal rhs);
+Field2D operator-(const Field2D &lhs, BoutReal rhs);
+Field2D operator*(const Field2D &lhs, BoutReal rhs);
+Field2D operator/(const Field2D &lhs, BoutReal rhs);
+
+Field2D operator+(Field2D &&lhs, BoutReal rhs);
+Field2D operator-(Field2D &&lhs, BoutReal rhs);
+Field2D operator*(Field2D &&lhs, BoutReal rhs);
+Field2D operator/(Field2D &&lhs, BoutReal rhs);
+
+Field2D operator+(BoutReal lhs, const Field2D &rhs);
+Field2D operator-(BoutReal lhs, const Field2D &rhs);
+Field2D operator*(BoutReal lhs, const Field2D &rhs);
+Field2D operator/(BoutReal lhs, const Field2D &rhs);
+
+Field2D operator+(BoutReal lhs, Field2D &&rhs);
+Field2D operator-(BoutReal lhs, Field2D &&rhs);
+Field2D operator*(BoutReal lhs, Field2D &&rhs);
+Field2D operator/(BoutReal lhs, Field2D &&rhs);
 
 /*!
  * Unary minus. Returns the negative of given field,
  * iterates over whole domain including guard/boundary cells.
  */
-const Field2D operator-(const Field2D &f);
+Field2D operator-(const Field2D &f);
+Field2D operator-(Field2D &&f);
 
 // Non-member functions
 
 /// Square root
-const Field2D sqrt(const Field2D &f);
+Field2D sqrt(const Field2D &f);
+Field2D sqrt(Field2D &&f);
 
 /// Absolute value
-const Field2D abs(const Field2D &f);
+Field2D abs(const Field2D &f);
+Field2D abs(Field2D &&f);
 
 /*!
  * Calculates the minimum of a field, excluding
@@ -338,10 +377,12 @@ BoutReal max(const Field2D &f, bool allpe=false);
 bool finite(const Field2D &f);
 
 /// Exponential
-const Field2D exp(const Field2D &f);
+Field2D exp(const Field2D &f);
+Field2D exp(Field2D &&f);
 
 /// Natural logarithm
-const Field2D log(const Field2D &f);
+Field2D log(const Field2D &f);
+Field2D log(Field2D &&f);
 
 /*!
  * Sine trigonometric function. 
@@ -351,7 +392,8 @@ const Field2D log(const Field2D &f);
  * This loops over the entire domain, including guard/boundary cells
  * If CHECK >= 3 then the result will be checked for non-finite numbers
  */
-const Field2D sin(const Field2D &f);
+Field2D sin(const Field2D &f);
+Field2D sin(Field2D &&f);
 
 /*!
  * Cosine trigonometric function. 
@@ -361,7 +403,8 @@ const Field2D sin(const Field2D &f);
  * This loops over the entire domain, including guard/boundary cells
  * If CHECK >= 3 then the result will be checked for non-finite numbers
  */
-const Field2D cos(const Field2D &f);
+Field2D cos(const Field2D &f);
+Field2D cos(Field2D &&f);
 
 /*!
  * Tangent trigonometric function. 
@@ -371,7 +414,8 @@ const Field2D cos(const Field2D &f);
  * This loops over the entire domain, including guard/boundary cells
  * If CHECK >= 3 then the result will be checked for non-finite numbers
  */
-const Field2D tan(const Field2D &f);
+Field2D tan(const Field2D &f);
+Field2D tan(Field2D &&f);
 
 /*!
  * Hyperbolic sine function. 
@@ -379,7 +423,8 @@ const Field2D tan(const Field2D &f);
  * This loops over the entire domain, including guard/boundary cells
  * If CHECK >= 3 then the result will be checked for non-finite numbers
  */
-const Field2D sinh(const Field2D &f);
+Field2D sinh(const Field2D &f);
+Field2D sinh(Field2D &&f);
 
 /*!
  * Hyperbolic cosine function. 
@@ -387,7 +432,8 @@ const Field2D sinh(const Field2D &f);
  * This loops over the entire domain, including guard/boundary cells
  * If CHECK >= 3 then the result will be checked for non-finite numbers
  */
-const Field2D cosh(const Field2D &f);
+Field2D cosh(const Field2D &f);
+Field2D cosh(Field2D &&f);
 
 /*!
  * Hyperbolic tangent function. 
@@ -395,7 +441,8 @@ const Field2D cosh(const Field2D &f);
  * This loops over the entire domain, including guard/boundary cells
  * If CHECK >= 3 then the result will be checked for non-finite numbers
  */
-const Field2D tanh(const Field2D &f);
+Field2D tanh(const Field2D &f);
+Field2D tanh(Field2D &&f);
 
 /// Make an independent copy of field f
 const Field2D copy(const Field2D &f);
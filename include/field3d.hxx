@@ -180,6 +180,11 @@ class Field3D : public Field, public FieldData {
    * Copy constructor
    */
   Field3D(const Field3D& f);
+
+  /*!
+   * Move constructor. Takes the data of \p f, leaving it unallocated
+   */
+  Field3D(Field3D&& f);
   
   /// Constructor from 2D field
   Field3D(const Field2D& f);
@@ -195,11 +200,28 @@ class Field3D : public Field, public FieldData {
    * Ensures that memory is allocated and unique
    */
   void allocate();
-  
+
+  /*!
+   * Allocate a new block of data. When called by every thread of an
+   * OpenMP team (see bout/openmpwrap.hxx), one block is allocated and
+   * shared by all the threads' copies of this field. Otherwise the
+   * same as allocate().
+   *
+   * The field should be private to each thread, for example the
+   * result of an operator.
+   */
+  void allocateTeam();
+
   /*!
    * Test if data is allocated
    */
   bool isAllocated() const { return !data.empty(); } 
+
+  /*!
+   * Test if data is allocated and not shared with any other
+   * field, so can be changed without affecting other fields
+   */
+  bool isUnique() const { return !data.empty() && data.unique(); }
   
   /*!
    * Return a pointer to the time-derivative field
@@ -507,38 +529,80 @@ private:
 };
 
 // Non-member overloaded operators
+//
+// Operators and functions with an rvalue argument reuse its data for
+// the result if it is not shared with another field, rather than
+// allocating a new array. For example in a*b + c the result of a*b
+// is reused. This is not done in an OpenMP team (bout/openmpwrap.hxx),
+// where temporaries are shared between threads.
 
 // Binary operators
-const FieldPerp operator+(const Field3D &lhs, const FieldPerp &rhs);
-const FieldPerp operator-(const Field3D &lhs, const FieldPerp &rhs);
-const FieldPerp operator*(const Field3D &lhs, const FieldPerp &rhs);
-const FieldPerp operator/(const Field3D &lhs, const FieldPerp &rhs);
-
-const Field3D operator+(const Field3D &lhs, const Field3D &rhs);
-const Field3D operator-(const Field3D &lhs, const Field3D &rhs);
-const Field3D operator*(const Field3D &lhs, const Field3D &rhs);
-const Field3D operator/(const Field3D &lhs, const Field3D &rhs);
-
-const Field3D operator+(const Field3D &lhs, const Field2D &rhs);
-const Field3D operator-(const Field3D &lhs, const Field2D &rhs);
-const Field3D operator*(const Field3D &lhs, const Field2D &rhs);
-const Field3D operator/(const Field3D &lhs, const Field2D &rhs);
-
-const Field3D operator+(const Field3D &lhs, BoutReal rhs);
-const Field3D operator-(const Field3D &lhs, BoutReal rhs);
-const Field3D operator*(const Field3D &lhs, BoutReal rhs);
-const Field3D operator/(const Field3D &lhs, BoutReal rhs);
-
-const Field3D operator+(BoutReal lhs, const Field3D &rhs);
-const Field3D operator-(BoutReal lhs, const Field3D &rhs);
-const Field3D operator*(BoutReal lhs, const Field3D &rhs);
-const Field3D operator/(BoutReal lhs, const Field3D &rhs);
+FieldPerp operator+(const Field3D &lhs, const FieldPerp &rhs);
+FieldPerp operator-(const Field3D &lhs, const FieldPerp &rhs);
+FieldPerp operator*(const Field3D &lhs, const FieldPerp &rhs);
+FieldPerp operator/(const Field3D &lhs, const FieldPerp &rhs);
+
+FieldPerp operator+(const Field3D &lhs, FieldPerp &&rhs);
+FieldPerp operator-(const Field3D &lhs, FieldPerp &&rhs);
+FieldPerp operator*(const Field3D &lhs, FieldPerp &&rhs);
+FieldPerp operator/(const Field3D &lhs, FieldPerp &&rhs);
+
+Field3D operator+(const Field3D &lhs, const Field3D &rhs);
+Field3D operator-(const Field3D &lhs, const Field3D &rhs);
+Field3D operator*(const Field3D &lhs, const Field3D &rhs);
+Field3D operator/(const Field3D &lhs, const Field3D &rhs);
+
+Field3D operator+(Field3D &&lhs, const Field3D &rhs);
+Field3D operator-(Field3D &&lhs, const Field3D &rhs);
+Field3D operator*(Field3D &&lhs, const Field3D &rhs);
+Field3D operator/(Field3D &&lhs, const Field3D &rhs);
+
+Field3D operator+(const Field3D &lhs, Field3D &&rhs);
+Field3D operator-(const Field3D &lhs, Field3D &&rhs);
+Field3D operator*(const Field3D &lhs, Field3D &&rhs);
+Field3D operator/(const Field3D &lhs, Field3D &&rhs);
+
+Field3D operator+(Field3D &&lhs, Field3D &&rhs);
+Field3D operator-(Field3D &&lhs, Field3D &&rhs);
+Field3D operator*(Field3D &&lhs, Field3D &&rhs);
+Field3D operator/(Field3D &&lhs, Field3D &&rhs);
+
+Field3D operator+(const Field3D &lhs, const Field2D &rhs);
+Field3D operator-(const Field3D &lhs, const Field2D &rhs);
+Field3D operator*(const Field3D &lhs, const Field2D &rhs);
+Field3D operator/(const Field3D &lhs, const Field2D &rhs);
+
+Field3D operator+(Field3D &&lhs, const Field2D &rhs);
+Field3D operator-(Field3D &&lhs, const Field2D &rhs);
+Field3D operator*(Field3D &&lhs, const Field2D &rhs);
+Field3D operator/(Field3D &&lhs, const Field2D &rhs);
+
+Field3D operator+(const Field3D &lhs, BoutReal rhs);
+Field3D operator-(const Field3D &lhs, BoutReal rhs);
+Field3D operator*(const Field3D &lhs, BoutReal rhs);
+Field3D operator/(const Field3D &lhs, BoutReal rhs);
+
+Field3D operator+(Field3D &&lhs, BoutReal rhs);
+Field3D operator-(Field3D &&lhs, BoutReal rhs);
+Field3D operator*(Field3D &&lhs, BoutReal rhs);
+Field3D operator/(Field3D &&lhs, BoutReal rhs);
+
+Field3D operator+(BoutReal lhs, const Field3D &rhs);
+Field3D operator-(BoutReal lhs, const Field3D &rhs);
+Field3D operator*(BoutReal lhs, const Field3D &rhs);
+Field3D operator/(BoutReal lhs, const Field3D &rhs);
+
+Field3D operator+(BoutReal lhs, Field3D &&rhs);
+Field3D operator-(BoutReal lhs, Field3D &&rhs);
+Field3D operator*(BoutReal lhs, Field3D &&rhs);
+Field3D operator/(BoutReal lhs, Field3D &&rhs);
 
 /*!
  * Unary minus. Returns the negative of given field,
  * iterates over whole domain including guard/boundary cells.
  */
-const Field3D operator-(const Field3D &f);
+Field3D operator-(const Field3D &f);
+Field3D operator-(Field3D &&f);
 
 // Non-member functions
 
@@ -586,7 +650,8 @@ Field3D pow(BoutReal lhs, const Field3D &rhs);
  * This loops over the entire domain, including guard/boundary cells
  * If CHECK >= 3 then the result will be checked for non-finite numbers
  */
-const Field3D sqrt(const Field3D &f);
+Field3D sqrt(const Field3D &f);
+Field3D sqrt(Field3D &&f);
 
 /*!
  * Absolute value (modulus, |f|)
@@ -594,7 +659,8 @@ const Field3D sqrt(const Field3D &f);
  * This loops over the entire domain, including guard/boundary cells
  * If CHECK >= 3 then the result will be checked for non-finite numbers
  */
-const Field3D abs(const Field3D &f);
+Field3D abs(const Field3D &f);
+Field3D abs(Field3D &&f);
 
 /*!
  * Exponential: exp(f) is e to the power of f
@@ -602,7 +668,8 @@ const Field3D abs(const Field3D &f);
  * This loops over the entire domain, including guard/boundary cells
  * If CHECK >= 3 then the result will be checked for non-finite numbers
  */
-const Field3D exp(const Field3D &f);
+Field3D exp(const Field3D &f);
+Field3D exp(Field3D &&f);
 
 /*!
  * Natural logarithm, inverse of exponential
@@ -612,7 +679,8 @@ const Field3D exp(const Field3D &f);
  * This loops over the entire domain, including guard/boundary cells
  * If CHECK >= 3 then the result will be checked for non-finite numbers
  */
-const Field3D log(const Field3D &f);
+Field3D log(const Field3D &f);
+Field3D log(Field3D &&f);
 
 /*!
  * Sine trigonometric function. 
@@ -622,7 +690,8 @@ const Field3D log(const Field3D &f);
  * This loops over the entire domain, including guard/boundary cells
  * If CHECK >= 3 then the result will be checked for non-finite numbers
  */
-const Field3D sin(const Field3D &f);
+Field3D sin(const Field3D &f);
+Field3D sin(Field3D &&f);
 
 /*!
  * Cosine trigonometric function. 
@@ -632,7 +701,8 @@ const Field3D sin(const Field3D &f);
  * This loops over the entire domain, including guard/boundary cells
  * If CHECK >= 3 then the result will be checked for non-finite numbers
  */
-const Field3D cos(const Field3D &f);
+Field3D cos(const Field3D &f);
+Field3D cos(Field3D &&f);
 
 /*!
  * Tangent trigonometric function. 
@@ -642,7 +712,8 @@ const Field3D cos(const Field3D &f);
  * This loops over the entire domain, including guard/boundary cells
  * If CHECK >= 3 then the result will be checked for non-finite numbers
  */
-const Field3D tan(const Field3D &f);
+Field3D tan(const Field3D &f);
+Field3D tan(Field3D &&f);
 
 /*!
  * Hyperbolic sine function. 
@@ -650,7 +721,8 @@ const Field3D tan(const Field3D &f);
  * This loops over the entire domain, including guard/boundary cells
  * If CHECK >= 3 then the result will be checked for non-finite numbers
  */
-const Field3D sinh(const Field3D &f);
+Field3D sinh(const Field3D &f);
+Field3D sinh(Field3D &&f);
 
 /*!
  * Hyperbolic cosine function. 
@@ -658,7 +730,8 @@ const Field3D sinh(const Field3D &f);
  * This loops over the entire domain, including guard/boundary cells
  * If CHECK >= 3 then the result will be checked for non-finite numbers
  */
-const Field3D cosh(const Field3D &f);
+Field3D cosh(const Field3D &f);
+Field3D cosh(Field3D &&f);
 
 /*!
  * Hyperbolic tangent function. 
@@ -666,7 +739,8 @@ const Field3D cosh(const Field3D &f);
  * This loops over the entire domain, including guard/boundary cells
  * If CHECK >= 3 then the result will be checked for non-finite numbers
  */
-const Field3D tanh(const Field3D &f);
+Field3D tanh(const Field3D &f);
+Field3D tanh(Field3D &&f);
 
 /*!
  * Check if all values of a field are finite.
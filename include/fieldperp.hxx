@@ -38,6 +38,8 @@ class FieldPerp;
 
 #include "unused.hxx"
 
+#include <utility>
+
 class Field2D; // #include "field2d.hxx"
 class Field3D; // #include "field3d.hxx"
 
@@ -124,6 +126,12 @@ class FieldPerp : public Field {
    *
    */
   bool isAllocated() const { return !data.empty(); }
+
+  /*!
+   * True if the data is allocated and not shared with
+   * any other field, so can be changed in place
+   */
+  bool isUnique() const { return !data.empty() && data.unique(); }
   
   // operators
   
@@ -243,34 +251,65 @@ class FieldPerp : public Field {
 };
   
 // Non-member overloaded operators
+//
+// Operators with an rvalue FieldPerp argument reuse its data for the
+// result, if it is not shared with another field
   
-const FieldPerp operator+(const FieldPerp &lhs, const FieldPerp &rhs);
-const FieldPerp operator+(const FieldPerp &lhs, const Field3D &rhs);
-const FieldPerp operator+(const FieldPerp &lhs, const Field2D &rhs);
-const FieldPerp operator+(const FieldPerp &lhs, BoutReal rhs);
-inline const FieldPerp operator+(BoutReal lhs, const FieldPerp &rhs) {
+FieldPerp operator+(const FieldPerp &lhs, const FieldPerp &rhs);
+FieldPerp operator+(const FieldPerp &lhs, const Field3D &rhs);
+FieldPerp operator+(const FieldPerp &lhs, const Field2D &rhs);
+FieldPerp operator+(const FieldPerp &lhs, BoutReal rhs);
+inline FieldPerp operator+(BoutReal lhs, const FieldPerp &rhs) {
   return rhs + lhs;
 }
 
-const FieldPerp operator-(const FieldPerp &lhs, const FieldPerp &other);
-const FieldPerp operator-(const FieldPerp &lhs, const Field3D &other);
-const FieldPerp operator-(const FieldPerp &lhs, const Field2D &other);
-const FieldPerp operator-(const FieldPerp &lhs, BoutReal rhs);
-const FieldPerp operator-(BoutReal lhs, const FieldPerp &rhs);
-
-const FieldPerp operator*(const FieldPerp &lhs, const FieldPerp &other);
-const FieldPerp operator*(const FieldPerp &lhs, const Field3D &other);
-const FieldPerp operator*(const FieldPerp &lhs, const Field2D &other);
-const FieldPerp operator*(const FieldPerp &lhs, BoutReal rhs);
-inline const FieldPerp operator*(BoutReal lhs, const FieldPerp &rhs) {
+FieldPerp operator-(const FieldPerp &lhs, const FieldPerp &other);
+FieldPerp operator-(const FieldPerp &lhs, const Field3D &other);
+FieldPerp operator-(const FieldPerp &lhs, const Field2D &other);
+FieldPerp operator-(const FieldPerp &lhs, BoutReal rhs);
+FieldPerp operator-(BoutReal lhs, const FieldPerp &rhs);
+
+FieldPerp operator*(const FieldPerp &lhs, const FieldPerp &other);
+FieldPerp operator*(const FieldPerp &lhs, const Field3D &other);
+FieldPerp operator*(const FieldPerp &lhs, const Field2D &other);
+FieldPerp operator*(const FieldPerp &lhs, BoutReal rhs);
+inline FieldPerp operator*(BoutReal lhs, const FieldPerp &rhs) {
   return rhs * lhs;
 }
 
-const FieldPerp operator/(const FieldPerp &lhs, const FieldPerp &other);
-const FieldPerp operator/(const FieldPerp &lhs, const Field3D &other);
-const FieldPerp operator/(const FieldPerp &lhs, const Field2D &other);
-const FieldPerp operator/(const FieldPerp &lhs, BoutReal rhs);
-const FieldPerp operator/(BoutReal lhs, const FieldPerp &rhs);
+FieldPerp operator/(const FieldPerp &lhs, const FieldPerp &other);
+FieldPerp operator/(const FieldPerp &lhs, const Field3D &other);
+FieldPerp operator/(const FieldPerp &lhs, const Field2D &other);
+FieldPerp operator/(const FieldPerp &lhs, BoutReal rhs);
+FieldPerp operator/(BoutReal lhs, const FieldPerp &rhs);
+
+FieldPerp operator+(FieldPerp &&lhs, const FieldPerp &rhs);
+FieldPerp operator+(FieldPerp &&lhs, const Field3D &rhs);
+FieldPerp operator+(FieldPerp &&lhs, const Field2D &rhs);
+FieldPerp operator+(FieldPerp &&lhs, BoutReal rhs);
+inline FieldPerp operator+(BoutReal lhs, FieldPerp &&rhs) {
+  return std::move(rhs) + lhs;
+}
+
+FieldPerp operator-(FieldPerp &&lhs, const FieldPerp &rhs);
+FieldPerp operator-(FieldPerp &&lhs, const Field3D &rhs);
+FieldPerp operator-(FieldPerp &&lhs, const Field2D &rhs);
+FieldPerp operator-(FieldPerp &&lhs, BoutReal rhs);
+FieldPerp operator-(BoutReal lhs, FieldPerp &&rhs);
+
+FieldPerp operator*(FieldPerp &&lhs, const FieldPerp &rhs);
+FieldPerp operator*(FieldPerp &&lhs, const Field3D &rhs);
+FieldPerp operator*(FieldPerp &&lhs, const Field2D &rhs);
+FieldPerp operator*(FieldPerp &&lhs, BoutReal rhs);
+inline FieldPerp operator*(BoutReal lhs, FieldPerp &&rhs) {
+  return std::move(rhs) * lhs;
+}
+
+FieldPerp operator/(FieldPerp &&lhs, const FieldPerp &rhs);
+FieldPerp operator/(FieldPerp &&lhs, const Field3D &rhs);
+FieldPerp operator/(FieldPerp &&lhs, const Field2D &rhs);
+FieldPerp operator/(FieldPerp &&lhs, BoutReal rhs);
+FieldPerp operator/(BoutReal lhs, FieldPerp &&rhs);
   
 /*!
  * Create a unique copy of a FieldPerp, ensuring 
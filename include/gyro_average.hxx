@@ -33,8 +33,14 @@
 #define __GYRO_AVERAGE_H__
 
 #include "field3d.hxx"
+#include "field2d.hxx"
 // #include "invert_laplace.hxx"
 
+#include <memory>
+#include <vector>
+
+class Laplacian;
+
 const int GYRO_FLAGS = 64 + 16384 + 32768; // = INVERT_BNDRY_ONE | INVERT_IN_RHS | INVERT_OUT_RHS; uses old-style Laplacian inversion flags
 
 
@@ -64,6 +70,11 @@ const Field3D gyroPade0(const Field3D &f, const Field2D &rho,
 const Field3D gyroPade0(const Field3D &f, BoutReal rho, 
                         int flags=GYRO_FLAGS);
 
+/// Pade approximation G_0 of several fields with the same rho.
+/// The Laplacian inversions of all fields are done together
+std::vector<Field3D> gyroPade0(const std::vector<Field3D> &f, const Field2D &rho,
+                               int flags=GYRO_FLAGS);
+
 /// Pade approximation G_1 = (1 - 0.5*rho^2*Delp2)g = f
 ///
 /// Note: Have to use Z average of rho for efficient inversion
@@ -80,6 +91,11 @@ const Field3D gyroPade1(const Field3D &f, BoutReal rho,
 const Field2D gyroPade1(const Field2D &f, const Field2D &rho,
                         int flags=GYRO_FLAGS);
 
+/// Pade approximation G_1 of several fields with the same rho.
+/// The Laplacian inversions of all fields are done together
+std::vector<Field3D> gyroPade1(const std::vector<Field3D> &f, const Field2D &rho,
+                               int flags=GYRO_FLAGS);
+
 /// Pade approximation 
 ///
 /// \f[
@@ -98,4 +114,79 @@ const Field3D gyroPade2(const Field3D &f, const Field2D &rho,
 const Field3D gyroPade2(const Field3D &f, BoutReal rho, 
                         int flags=GYRO_FLAGS);
 
+/// Pade approximation G_2 of several fields with the same rho.
+/// The Laplacian inversions of all fields are done together
+std::vector<Field3D> gyroPade2(const std::vector<Field3D> &f, const Field2D &rho,
+                               int flags=GYRO_FLAGS);
+
+/// Gyro-averaging operators for a fixed gyro-radius profile
+///
+/// The gyroPade functions set up a Laplacian inversion on every
+/// call. This class does the setup once for a given rho, so that
+/// applying an operator only needs FFTs and tridiagonal solves:
+///
+///  - pade0, pade1 and pade2 are the Pade approximations of gyroPade0,
+///    gyroPade1 and gyroPade2. The tridiagonal matrix of each Z Fourier
+///    mode at each Y index is factorised once, and all Z lines of a
+///    field are transformed with one batched FFT. Options such as
+///    maxmode are read from the "laplace" section. If NXPE > 1 then a
+///    Laplacian solver is created once for each operator instead.
+///    With NXPE = 1, flags which set boundary values (INVERT_SET) and
+///    INVERT_4TH_ORDER are not supported, and throw a BoutException.
+///    The Y guard cells of the result are then copied from f (unless
+///    laplace:include_yguards is set); with NXPE > 1 they are not set.
+///    Either way, communicate or apply a boundary condition before
+///    taking Y derivatives of the result.
+///
+///  - besselJ0 multiplies each Z Fourier mode by J_0(k_perp rho), the
+///    exact gyro-average of a single mode. Only the Z wavenumber is
+///    included in k_perp, so this is only accurate when radial
+///    wavelengths are long compared to those in Z.
+///
+/// Example
+/// -------
+///
+///     GyroAverage gyro_i(rho_i);
+///     Field3D phi_G = gyro_i.pade1(phi);
+///     Field3D Phi_G = gyro_i.pade2(phi);
+class GyroAverage {
+public:
+  /// @param[in] rho    Gyro-radius
+  /// @param[in] flags  Flags for the Laplacian inversions, as for gyroPade0
+  GyroAverage(const Field2D &rho, int flags=GYRO_FLAGS);
+  GyroAverage(BoutReal rho, int flags=GYRO_FLAGS) : GyroAverage(Field2D(rho), flags) {}
+  ~GyroAverage();
+
+  /// Pade approximation G_0 = (1 - rho^2*Delp2)g = f
+  const Field3D pade0(const Field3D &f);
+  std::vector<Field3D> pade0(const std::vector<Field3D> &f);
+
+  /// Pade approximation G_1 = (1 - 0.5*rho^2*Delp2)g = f
+  const Field3D pade1(const Field3D &f);
+  const Field2D pade1(const Field2D &f);
+  std::vector<Field3D> pade1(const std::vector<Field3D> &f);
+
+  /// Pade approximation G_2, as gyroPade2
+  const Field3D pade2(const Field3D &f);
+  std::vector<Field3D> pade2(const std::vector<Field3D> &f);
+
+  /// Multiply each Z Fourier mode by J_0(k_z rho sqrt(g^zz)),
+  /// at every point including guard cells
+  const Field3D besselJ0(const Field3D &f);
+
+private:
+  Field2D rho;
+  int flags;
+  Field2D halfrhosq; ///< 0.5*rho^2, used in pade2
+
+  /// Inversions of (1 - rho^2*Delp2) and (1 - 0.5*rho^2*Delp2),
+  /// created when first used
+  std::unique_ptr<Laplacian> inv0, inv1;
+
+  Laplacian *getInversion(std::unique_ptr<Laplacian> &inv, BoutReal factor);
+
+  /// J_0 for each Z mode, indexed [x][y][kz]. Calculated when first used
+  Array<BoutReal> j0symbol;
+};
+
 #endif // __GYRO_AVERAGE_H__
@@ -31,10 +31,35 @@
 #include "mask.hxx"
 #include "utils.hxx"
 
+#include <vector>
+
 /// Interpolate to a give cell location
 const Field3D interp_to(const Field3D &var, CELL_LOC loc);
 const Field2D interp_to(const Field2D &var, CELL_LOC loc);
 
+/// Clear the cache of interpolated fields. Only used if mesh:interp_cache
+/// is true; called by the solver at the start and end of each RHS evaluation
+void interp_clear_cache();
+
+/// Indices of the four points used to interpolate in X or Y
+/// between cell centre and lower cell edge, at index \p i
+///
+/// @param[in] m      The mesh
+/// @param[in] dir    Direction of the shift (CELL_XLOW or CELL_YLOW)
+/// @param[in] tolow  True if interpolating from centre to \p dir,
+///                   false if from \p dir to centre
+/// @param[in] i      X or Y index of the result
+/// @param[out] ind   The X or Y indices of the four points
+void interp_index(const Mesh *m, CELL_LOC dir, bool tolow, int i, int ind[4]);
+
+/// 4th-order staggered interpolation of \p n values,
+/// given four neighbouring lines of data
+inline void interp_line(const BoutReal *fmm, const BoutReal *fm, const BoutReal *fp,
+                        const BoutReal *fpp, int n, BoutReal *result) {
+  for(int i=0;i<n;i++)
+    result[i] = ( 9.*(fm[i] + fp[i]) - fmm[i] - fpp[i] ) / 16.;
+}
+
 /// Print out the cell location (for debugging)
 void printLocation(const Field3D &var);
 
@@ -82,6 +107,7 @@ class HermiteSpline : public Interpolation {
   // The h00 and h01 basis functions are applied to the function itself
   // and the h10 and h11 basis functions are applied to its derivative
   // along the interpolation direction.
+  // Only allocated if the combined weights are not used.
 
   Field3D h00_x;
   Field3D h01_x;
@@ -92,6 +118,21 @@ class HermiteSpline : public Interpolation {
   Field3D h10_z;
   Field3D h11_z;
 
+  // If the X and Z first derivatives are second-order central differences
+  // then the derivatives can be combined with the Hermite basis functions.
+  // The result at each point is then a weighted sum over a 4x4 block of
+  // points in X-Z, starting at (i_corner-1, k_corner-1), with a weight
+  // which is the product of an X weight and a Z weight.
+  bool can_combine;              // interpolation:combine_weights set, and C2 derivatives?
+  bool use_combined;             // Use the combined weights? Set by calcWeights
+  std::vector<BoutReal> weights; // 8 per point: 4 in X followed by 4 in Z
+
+  // Set i_corner, k_corner at (x,y,z), and the position within the cell
+  void findCorner(int x, int y, int z, const Field3D &delta_x, const Field3D &delta_z,
+                  BoutReal &t_x, BoutReal &t_z);
+
+  Field3D interpolateCombined(const Field3D& f) const;
+
 public:
   HermiteSpline(int y_offset=0);
   HermiteSpline(BoutMask mask, int y_offset=0) : HermiteSpline(y_offset) {
@@ -116,6 +157,8 @@ public:
   Field3D interpolate(const Field3D& f, const Field3D &delta_x, const Field3D &delta_z);
   Field3D interpolate(const Field3D& f, const Field3D &delta_x, const Field3D &delta_z, BoutMask mask);
 
+  // Were the combined weights calculated by the last calcWeights?
+  bool usesCombined() const { return use_combined; }
 };
 
 class Lagrange4pt : public Interpolation {
@@ -47,6 +47,8 @@ class Laplacian;
 #include "dcomplex.hxx"
 #include "options.hxx"
 
+#include <vector>
+
 // Inversion flags for each boundary
 const int INVERT_DC_GRAD  = 1; ///< Zero-gradient for DC (constant in Z) component. Default is zero value
 const int INVERT_AC_GRAD  = 2; ///< Zero-gradient for AC (non-constant in Z) component. Default is zero value
@@ -154,6 +156,19 @@ public:
   virtual const Field3D solve(const Field3D &b, const Field3D &x0);
   virtual const Field2D solve(const Field2D &b, const Field2D &x0);
 
+  /// Solve for several right hand sides with the same operator.
+  /// By default each is solved in turn; implementations can override
+  /// the FieldPerp versions to share the matrix setup and communication
+  virtual std::vector<FieldPerp> solve(const std::vector<FieldPerp> &b);
+  virtual std::vector<FieldPerp> solve(const std::vector<FieldPerp> &b,
+                                       const std::vector<FieldPerp> &x0);
+
+  /// Solve for several right hand sides, y-slice by y-slice, calling
+  /// the FieldPerp versions with all fields at each y index
+  virtual std::vector<Field3D> solve(const std::vector<Field3D> &b);
+  virtual std::vector<Field3D> solve(const std::vector<Field3D> &b,
+                                     const std::vector<Field3D> &x0);
+
   /// Coefficients in tridiagonal inversion
   void tridagCoefs(int jx, int jy, int jz, dcomplex &a, dcomplex &b, dcomplex &c, const Field2D *ccoef = NULL, const Field2D *d=NULL);
 
@@ -195,6 +210,12 @@ protected:
                     const Field2D *a, const Field2D *ccoef, 
                     const Field2D *d,
                     bool includeguards=true);
+
+  /// Set the values of \p bk in the X boundaries to zero, unless the
+  /// flags say that they are set by the RHS or x0. This is done by
+  /// tridagMatrix; used for further right hand sides of the same matrix
+  void tridagBoundaryRHS(dcomplex *bk, int flags, int inner_boundary_flags,
+                         int outer_boundary_flags, bool includeguards=true);
 private:
   /// Singleton instance
   static Laplacian *instance;
@@ -52,6 +52,7 @@ const char DEFAULT_SET[] = "BOUT.settings";
 #include <msg_stack.hxx>
 
 #include <bout/sys/timer.hxx>
+#include <bout/sys/numa.hxx>
 
 #include <boundary_factory.hxx>
 
@@ -389,6 +390,9 @@ int BoutInitialise(int &argc, char **&argv) {
 
   try {
     /////////////////////////////////////////////
+
+    // Placement of field data. Before any fields are allocated
+    numaInitialise(options->getSection("numa"));
     
     mesh = Mesh::create();  ///< Create the mesh
     mesh->load();           ///< Load from sources. Required for Field initialisation
@@ -545,6 +549,12 @@ int BoutMonitor::call(Solver *solver, BoutReal t, int iter, int NOUT) {
   BoutReal wtime_comms  = Timer::resetTime("comms");  // Time spent communicating (part of RHS)
   BoutReal wtime_io     = Timer::resetTime("io");      // Time spend on I/O
 
+  // Communication rounds and kB sent per RHS evaluation
+  int ncalls_total = BOUTMAX(output_split ? ncalls_e + ncalls_i : ncalls, 1);
+  BoutReal comm_rounds = static_cast<BoutReal>(mesh->commRounds()) / ncalls_total;
+  BoutReal comm_kb = mesh->commBytes() / (1024. * ncalls_total);
+  mesh->resetCommStats();
+
   output_progress.print("\r"); // Only goes to screen
 
   if (first_time) {
@@ -573,30 +583,32 @@ int BoutMonitor::call(Solver *solver, BoutReal t, int iter, int NOUT) {
     /// Print the column header for timing info
     if (!output_split) {
       output_progress.write("Sim Time  |  RHS evals  | Wall Time |  Calc    Inv   Comm    I/O   "
-                            "SOLVER\n\n");
+                            "SOLVER | Rounds  kB/RHS\n\n");
     } else {
       output_progress.write("Sim Time  |  RHS_e evals  | RHS_I evals  | Wall Time |  Calc    Inv  "
-                            " Comm    I/O   SOLVER\n\n");
+                            " Comm    I/O   SOLVER | Rounds  kB/RHS\n\n");
     }
   }
 
   if (!output_split) {
-    output_progress.write("%.3e      %5d       %.2e   %5.1f  %5.1f  %5.1f  %5.1f  %5.1f\n", 
+    output_progress.write("%.3e      %5d       %.2e   %5.1f  %5.1f  %5.1f  %5.1f  %5.1f    %5.1f  %7.1f\n", 
                simtime, ncalls, wtime,
                100.0*(wtime_rhs - wtime_comms - wtime_invert)/wtime,
                100.*wtime_invert/wtime,  // Inversions
                100.0*wtime_comms/wtime,  // Communications
                100.* wtime_io / wtime,      // I/O
-               100.*(wtime - wtime_io - wtime_rhs)/wtime); // Everything else
+               100.*(wtime - wtime_io - wtime_rhs)/wtime, // Everything else
+               comm_rounds, comm_kb); // Communication rounds and kB per RHS
 
   } else {
-    output_progress.write("%.3e      %5d            %5d       %.2e   %5.1f  %5.1f  %5.1f  %5.1f  %5.1f\n",
+    output_progress.write("%.3e      %5d            %5d       %.2e   %5.1f  %5.1f  %5.1f  %5.1f  %5.1f    %5.1f  %7.1f\n",
                simtime, ncalls_e, ncalls_i, wtime,
                100.0*(wtime_rhs - wtime_comms - wtime_invert)/wtime,
                100.*wtime_invert/wtime,  // Inversions
                100.0*wtime_comms/wtime,  // Communications
                100.* wtime_io / wtime,      // I/O
-               100.*(wtime - wtime_io - wtime_rhs)/wtime); // Everything else
+               100.*(wtime - wtime_io - wtime_rhs)/wtime, // Everything else
+               comm_rounds, comm_kb); // Communication rounds and kB per RHS
   }
   
   // This bit only to screen, not log file
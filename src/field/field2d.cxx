@@ -44,6 +44,7 @@
 #include <output.hxx>
 
 #include <bout/assert.hxx>
+#include <bout/openmpwrap.hxx>
 
 Field2D::Field2D(Mesh *msh) : Field(msh), deriv(nullptr) {
 
@@ -89,6 +90,11 @@ Field2D::Field2D(const Field2D& f) : Field(f.fieldmesh), // The mesh containing
   *this = f; //This line is probably not required as we init data from f.data above.
 }
 
+Field2D::Field2D(Field2D&& f) : Field(f.fieldmesh), nx(f.nx), ny(f.ny),
+                                data(std::move(f.data)), deriv(nullptr) {
+  boundaryIsSet = false;
+}
+
 Field2D::Field2D(BoutReal val) : Field(nullptr), deriv(nullptr) {
   boundaryIsSet = false;
 
@@ -463,13 +469,35 @@ void Field2D::setBoundaryTo(const Field2D &f2d) {
 
 ////////////// NON-MEMBER OVERLOADED OPERATORS //////////////
 
+// If an argument is an rvalue which is the only reference to its
+// data, the result is calculated in place and the data reused
+
 #define F2D_OP_F2D(op)                                     \
-  const Field2D operator op(const Field2D &lhs, const Field2D &rhs) { \
+  Field2D operator op(const Field2D &lhs, const Field2D &rhs) {     \
     Field2D result;                                                 \
     result.allocate();                                              \
     for(const auto& i : result)                                            \
       result[i] = lhs[i] op rhs[i];                                 \
     return result;                                                  \
+  }                                                                 \
+  Field2D operator op(Field2D &&lhs, const Field2D &rhs) {          \
+    if(!lhs.isUnique())                                             \
+      return lhs op rhs;                                            \
+    for(const auto& i : lhs)                                        \
+      lhs[i] = lhs[i] op rhs[i];                                    \
+    return std::move(lhs);                                          \
+  }                                                                 \
+  Field2D operator op(const Field2D &lhs, Field2D &&rhs) {          \
+    if(!rhs.isUnique())                                             \
+      return lhs op rhs;                                            \
+    for(const auto& i : rhs)                                        \
+      rhs[i] = lhs[i] op rhs[i];                                    \
+    return std::move(rhs);                                          \
+  }                                                                 \
+  Field2D operator op(Field2D &&lhs, Field2D &&rhs) {               \
+    if(lhs.isUnique())                                              \
+      return std::move(lhs) op rhs;                                 \
+    return lhs op std::move(rhs);                                   \
   }
 
 F2D_OP_F2D(+);  // Field2D + Field2D
@@ -477,13 +505,24 @@ F2D_OP_F2D(-);  // Field2D - Field2D
 F2D_OP_F2D(*);  // Field2D * Field2D
 F2D_OP_F2D(/);  // Field2D / Field2D
 
+// A Field3D shared by an OpenMP team (see bout/openmpwrap.hxx) is
+// not reused, as in field3d.cxx
+
 #define F2D_OP_F3D(op)                                     \
-  const Field3D operator op(const Field2D &lhs, const Field3D &rhs) { \
+  Field3D operator op(const Field2D &lhs, const Field3D &rhs) {     \
     Field3D result;                                                 \
     result.allocate();                                              \
     for(const auto& i : result)                                            \
       result[i] = lhs[i] op rhs[i];                                 \
     return result;                                                  \
+  }                                                                 \
+  Field3D operator op(const Field2D &lhs, Field3D &&rhs) {          \
+    if(ompTeam() || !rhs.isUnique())                                \
+      return lhs op rhs;                                            \
+    for(const auto& i : rhs)                                        \
+      rhs[i] = lhs[i] op rhs[i];                                    \
+    rhs.setLocation(CELL_CENTRE);                                   \
+    return std::move(rhs);                                          \
   }
 
 F2D_OP_F3D(+);  // Field2D + Field3D
@@ -492,12 +531,19 @@ F2D_OP_F3D(*);  // Field2D * Field3D
 F2D_OP_F3D(/);  // Field2D / Field3D
 
 #define F2D_OP_REAL(op)                                     \
-  const Field2D operator op(const Field2D &lhs, BoutReal rhs) {     \
+  Field2D operator op(const Field2D &lhs, BoutReal rhs) {           \
     Field2D result;                                                 \
     result.allocate();                                              \
     for(const auto& i : result)                                            \
       result[i] = lhs[i] op rhs;                                    \
     return result;                                                  \
+  }                                                                 \
+  Field2D operator op(Field2D &&lhs, BoutReal rhs) {                \
+    if(!lhs.isUnique())                                             \
+      return lhs op rhs;                                            \
+    for(const auto& i : lhs)                                        \
+      lhs[i] = lhs[i] op rhs;                                       \
+    return std::move(lhs);                                          \
   }
 
 F2D_OP_REAL(+);  // Field2D + BoutReal
@@ -506,12 +552,19 @@ F2D_OP_REAL(*);  // Field2D * BoutReal
 F2D_OP_REAL(/);  // Field2D / BoutReal
 
 #define REAL_OP_F2D(op)                                     \
-  const Field2D operator op(BoutReal lhs, const Field2D &rhs) {     \
+  Field2D operator op(BoutReal lhs, const Field2D &rhs) {           \
     Field2D result;                                                 \
     result.allocate();                                              \
     for(const auto& i : result)                                            \
       result[i] = lhs op rhs[i];                                    \
     return result;                                                  \
+  }                                                                 \
+  Field2D operator op(BoutReal lhs, Field2D &&rhs) {                \
+    if(!rhs.isUnique())                                             \
+      return lhs op rhs;                                            \
+    for(const auto& i : rhs)                                        \
+      rhs[i] = lhs op rhs[i];                                       \
+    return std::move(rhs);                                          \
   }
 
 REAL_OP_F2D(+);  // BoutReal + Field2D
@@ -520,10 +573,14 @@ REAL_OP_F2D(*);  // BoutReal * Field2D
 REAL_OP_F2D(/);  // BoutReal / Field2D
 
 // Unary minus
-const Field2D operator-(const Field2D &f) {
+Field2D operator-(const Field2D &f) {
   return -1.0*f;
 }
 
+Field2D operator-(Field2D &&f) {
+  return -1.0*std::move(f);
+}
+
 //////////////// NON-MEMBER FUNCTIONS //////////////////
 
 BoutReal min(const Field2D &f, bool allpe) {
@@ -601,7 +658,7 @@ bool finite(const Field2D &f) {
  *
  */
 #define F2D_FUNC(name, func)                               \
-  const Field2D name(const Field2D &f) {                   \
+  Field2D name(const Field2D &f) {                         \
     TRACE(#name "(Field2D)");                     \
     /* Check if the input is allocated */                  \
     ASSERT1(f.isAllocated());                              \
@@ -615,6 +672,17 @@ bool finite(const Field2D &f) {
       ASSERT3(finite(result[d]));                          \
     }                                                      \
     return result;                                         \
+  }                                                        \
+  Field2D name(Field2D &&f) {                              \
+    /* Reuse the data of f if not shared */                \
+    if(!f.isUnique())                                      \
+      return name(f);                                      \
+    TRACE(#name "(Field2D&&)");                            \
+    for(const auto& d : f) {                               \
+      f[d] = func(f[d]);                                   \
+      ASSERT3(finite(f[d]));                               \
+    }                                                      \
+    return std::move(f);                                   \
   }
 
 F2D_FUNC(abs, ::fabs);
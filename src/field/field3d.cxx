@@ -29,6 +29,7 @@
 #include <globals.hxx>
 
 #include <cmath>
+#include <exception>
 
 #include <field3d.hxx>
 #include <utils.hxx>
@@ -42,6 +43,7 @@
 #include <msg_stack.hxx>
 #include <bout/constants.hxx>
 #include <bout/assert.hxx>
+#include <bout/openmpwrap.hxx>
 
 /// Constructor
 Field3D::Field3D(Mesh *msh)
@@ -100,6 +102,19 @@ Field3D::Field3D(const Field3D &f)
   boundaryIsSet = false;
 }
 
+Field3D::Field3D(Field3D &&f)
+    : Field(f.fieldmesh), background(nullptr), data(std::move(f.data)),
+      deriv(nullptr), yup_field(nullptr), ydown_field(nullptr) {
+
+  nx = f.nx;
+  ny = f.ny;
+  nz = f.nz;
+
+  location = f.location;
+
+  boundaryIsSet = false;
+}
+
 Field3D::Field3D(const Field2D &f)
     : Field(nullptr), background(nullptr), deriv(nullptr), yup_field(nullptr),
       ydown_field(nullptr) {
@@ -172,6 +187,58 @@ void Field3D::allocate() {
     data.ensureUnique();
 }
 
+void Field3D::allocateTeam() {
+  if(!ompTeam()) {
+    allocate();
+    return;
+  }
+
+  if(!fieldmesh) {
+    fieldmesh = mesh;
+    nx = fieldmesh->LocalNx;
+    ny = fieldmesh->LocalNy;
+    nz = fieldmesh->LocalNz;
+  }
+
+  // The master thread allocates a new block, which the others then
+  // share. A failed allocation is passed to every thread rather than
+  // leaving the master block. These are shared by the team, and only
+  // written by the master thread
+  static Array<BoutReal> *shared;
+  static std::exception_ptr error;
+  BOUT_OMP(master)
+  {
+    try {
+      data = Array<BoutReal>(nx*ny*nz);
+    } catch (...) {
+      error = std::current_exception();
+    }
+    shared = &data;
+  }
+  // Not single copyprivate, which has two barriers. If a thread of the
+  // team fails, the others must leave after the first (see ompBarrier)
+  BOUT_OMP(barrier)
+  if(ompTeamFailed()) {
+    BOUT_OMP(master)
+    error = nullptr;
+    ompCheckTeam();
+  }
+
+  std::exception_ptr thrown = error;
+  if(!thrown && (shared != &data))
+    data = *shared;
+
+  // The master can't change its data, or reset the error, until
+  // everyone has a reference
+  BOUT_OMP(barrier)
+  BOUT_OMP(master)
+  error = nullptr;
+  ompCheckTeam();
+
+  if(thrown)
+    std::rethrow_exception(thrown);
+}
+
 Field3D* Field3D::timeDeriv() {
   if(deriv == nullptr) {
     deriv = new Field3D(fieldmesh);
@@ -307,6 +374,21 @@ Field3D & Field3D::operator=(const Field3D &rhs) {
   /// Check that the data is valid
   checkData(rhs);
   
+  if(ompTeam()) {
+    // Every thread of the team makes this assignment. If this field is
+    // shared between threads then they must take turns, and none can use
+    // the result until all have finished
+    BOUT_OMP(critical(field3d_assign))
+    {
+      fieldmesh = rhs.fieldmesh;
+      nx = rhs.nx; ny = rhs.ny; nz = rhs.nz;
+      data = rhs.data;
+      location = rhs.location;
+    }
+    ompBarrier();
+    return *this;
+  }
+
   // Copy the data and data sizes
   fieldmesh = rhs.fieldmesh;
   nx = rhs.nx; ny = rhs.ny; nz = rhs.nz; 
@@ -325,6 +407,19 @@ Field3D & Field3D::operator=(const Field2D &rhs) {
   
   /// Check that the data is valid
   checkData(rhs);
+
+  if(ompTeam()) {
+    // Copy into a new shared block, then assign to this field
+    Field3D result(fieldmesh);
+    result.allocateTeam();
+    {
+      OmpWorkshare workshare;
+      for(const auto& i : result)
+        result[i] = rhs[i];
+    }
+    result.setLocation(location);
+    return (*this) = result;
+  }
  
   /// Make sure there's a unique array to copy data into
   allocate();
@@ -367,12 +462,26 @@ void Field3D::operator=(const bvalue &bv) {
 
 Field3D & Field3D::operator=(const BoutReal val) {
   TRACE("Field3D = BoutReal");
-  allocate();
 
 #if CHECK > 0
   if(!finite(val))
     throw BoutException("Field3D: Assignment from non-finite BoutReal\n");
 #endif
+
+  if(ompTeam()) {
+    // Fill a new shared block, then assign to this field
+    Field3D result(fieldmesh);
+    result.allocateTeam();
+    {
+      OmpWorkshare workshare;
+      for(const auto& i : result)
+        result[i] = val;
+    }
+    result.setLocation(location);
+    return (*this) = result;
+  }
+
+  allocate();
   for(const auto& i : (*this))
     (*this)[i] = val;
 
@@ -390,7 +499,7 @@ Field3D & Field3D::operator=(const BoutReal val) {
     TRACE("Field3D: %s %s", #op, #ftype);           \
     checkData(rhs) ;                                         \
     checkData(*this);                                        \
-    if(data.unique()) {                                      \
+    if(!ompTeam() && data.unique()) {                        \
       /* This is the only reference to this data */          \
       for(const auto& i : (*this))                                  \
         (*this)[i] op rhs[i];                                \
@@ -418,7 +527,7 @@ F3D_UPDATE_FIELD(/=, /, Field2D);    // operator/= Field2D
       throw BoutException("Field3D: %s operator passed non-finite BoutReal number", #op); \
     checkData(*this);                                        \
                                                              \
-    if(data.unique()) {                                      \
+    if(!ompTeam() && data.unique()) {                        \
       /* This is the only reference to this data */          \
       for(const auto& i : (*this))                                  \
         (*this)[i] op rhs;                                   \
@@ -549,6 +658,13 @@ void Field3D::setBackground(const Field2D &f2d) {
 void Field3D::applyBoundary(bool init) {
   TRACE("Field3D::applyBoundary()");
 
+  if(ompTeam()) {
+    // Boundaries are applied in place, so only one thread of the team can
+    // modify this field (see bout/openmpwrap.hxx)
+    ompMaster([&]() { applyBoundary(init); });
+    return;
+  }
+
 #if CHECK > 0
   if (init) {
 
@@ -576,6 +692,13 @@ void Field3D::applyBoundary(bool init) {
 
 void Field3D::applyBoundary(BoutReal t) {
   TRACE("Field3D::applyBoundary()");
+
+  if(ompTeam()) {
+    // Boundaries are applied in place, so only one thread of the team can
+    // modify this field (see bout/openmpwrap.hxx)
+    ompMaster([&]() { applyBoundary(t); });
+    return;
+  }
   
 #if CHECK > 0
   if(!boundaryIsSet)
@@ -600,6 +723,13 @@ void Field3D::applyBoundary(BoutReal t) {
 
 void Field3D::applyBoundary(const string &condition) {
   TRACE("Field3D::applyBoundary(condition)");
+
+  if(ompTeam()) {
+    // Boundaries are applied in place, so only one thread of the team can
+    // modify this field (see bout/openmpwrap.hxx)
+    ompMaster([&]() { applyBoundary(condition); });
+    return;
+  }
   
   ASSERT1(isAllocated());
   
@@ -626,6 +756,13 @@ void Field3D::applyBoundary(const string &condition) {
 }
 
 void Field3D::applyBoundary(const string &region, const string &condition) {
+
+  if(ompTeam()) {
+    // Boundaries are applied in place, so only one thread of the team can
+    // modify this field (see bout/openmpwrap.hxx)
+    ompMaster([&]() { applyBoundary(region, condition); });
+    return;
+  }
   ASSERT1(isAllocated());
 
   /// Get the boundary factory (singleton)
@@ -646,6 +783,13 @@ void Field3D::applyBoundary(const string &region, const string &condition) {
 
 void Field3D::applyTDerivBoundary() {
   TRACE("Field3D::applyTDerivBoundary()");
+
+  if(ompTeam()) {
+    // Boundaries are applied in place, so only one thread of the team can
+    // modify this field (see bout/openmpwrap.hxx)
+    ompMaster([&]() { applyTDerivBoundary(); });
+    return;
+  }
   
   ASSERT1(isAllocated());
   ASSERT1(deriv != NULL);
@@ -809,18 +953,32 @@ void Field3D::applyParallelBoundary(const string &region, const string &conditio
  ***************************************************************/
 
 
-const Field3D operator-(const Field3D &f) {
+Field3D operator-(const Field3D &f) {
   return -1.0*f;
 }
 
+Field3D operator-(Field3D &&f) {
+  return -1.0*std::move(f);
+}
+
+// If the FieldPerp is a temporary which doesn't share its data,
+// the data is reused for the result
+
 #define F3D_OP_FPERP(op)                     	                          \
-  const FieldPerp operator op(const Field3D &lhs, const FieldPerp &rhs) { \
+  FieldPerp operator op(const Field3D &lhs, const FieldPerp &rhs) {       \
     FieldPerp result;                                                     \
     result.allocate();                                                    \
     result.setIndex(rhs.getIndex());                                      \
     for(const auto& i : rhs)                                                     \
       result[i] = lhs[i] op rhs[i];                                       \
     return result;                                                        \
+  }                                                                       \
+  FieldPerp operator op(const Field3D &lhs, FieldPerp &&rhs) {            \
+    if(!rhs.isUnique())                                                   \
+      return lhs op rhs;                                                  \
+    for(const auto& i : rhs)                                              \
+      rhs[i] = lhs[i] op rhs[i];                                          \
+    return std::move(rhs);                                                \
   }
 
 F3D_OP_FPERP(+);
@@ -828,14 +986,31 @@ F3D_OP_FPERP(-);
 F3D_OP_FPERP(/);
 F3D_OP_FPERP(*);
 
+// In an OpenMP team (see bout/openmpwrap.hxx) the result is shared
+// between threads, each of which calculates part of it.
+//
+// Otherwise, if an argument is an rvalue which is the only reference
+// to its data, the result is calculated in place and the data reused.
+// Temporaries in a team are shared, so are never reused.
+
 #define F3D_OP_FIELD(op, ftype)                                     \
-  const Field3D operator op(const Field3D &lhs, const ftype &rhs) { \
+  Field3D operator op(const Field3D &lhs, const ftype &rhs) {       \
     Field3D result;                                                 \
-    result.allocate();                                              \
-    for(const auto& i : lhs)                                               \
-      result[i] = lhs[i] op rhs[i];                                 \
+    result.allocateTeam();                                          \
+    {                                                               \
+      OmpWorkshare workshare;                                       \
+      for(const auto& i : lhs)                                      \
+        result[i] = lhs[i] op rhs[i];                               \
+    }                                                               \
     result.setLocation( lhs.getLocation() );                        \
     return result;                                                  \
+  }                                                                 \
+  Field3D operator op(Field3D &&lhs, const ftype &rhs) {            \
+    if(ompTeam() || !lhs.isUnique())                                \
+      return lhs op rhs;                                            \
+    for(const auto& i : lhs)                                        \
+      lhs[i] = lhs[i] op rhs[i];                                    \
+    return std::move(lhs);                                          \
   }
 
 F3D_OP_FIELD(+, Field3D);   // Field3D + Field3D
@@ -848,14 +1023,44 @@ F3D_OP_FIELD(-, Field2D);   // Field3D - Field2D
 F3D_OP_FIELD(*, Field2D);   // Field3D * Field2D
 F3D_OP_FIELD(/, Field2D);   // Field3D / Field2D
 
+#define F3D_OP_F3D_RVALUE(op)                                       \
+  Field3D operator op(const Field3D &lhs, Field3D &&rhs) {          \
+    if(ompTeam() || !rhs.isUnique())                                \
+      return lhs op rhs;                                            \
+    for(const auto& i : rhs)                                        \
+      rhs[i] = lhs[i] op rhs[i];                                    \
+    rhs.setLocation( lhs.getLocation() );                           \
+    return std::move(rhs);                                          \
+  }                                                                 \
+  Field3D operator op(Field3D &&lhs, Field3D &&rhs) {               \
+    if(lhs.isUnique())                                              \
+      return std::move(lhs) op rhs;                                 \
+    return lhs op std::move(rhs);                                   \
+  }
+
+F3D_OP_F3D_RVALUE(+);   // Field3D + Field3D
+F3D_OP_F3D_RVALUE(-);   // Field3D - Field3D
+F3D_OP_F3D_RVALUE(*);   // Field3D * Field3D
+F3D_OP_F3D_RVALUE(/);   // Field3D / Field3D
+
 #define F3D_OP_REAL(op)                                         \
-  const Field3D operator op(const Field3D &lhs, BoutReal rhs) { \
+  Field3D operator op(const Field3D &lhs, BoutReal rhs) {       \
     Field3D result;                                             \
-    result.allocate();                                          \
-    for(const auto& i : lhs)                                           \
-      result[i] = lhs[i] op rhs;                                \
+    result.allocateTeam();                                      \
+    {                                                           \
+      OmpWorkshare workshare;                                   \
+      for(const auto& i : lhs)                                  \
+        result[i] = lhs[i] op rhs;                              \
+    }                                                           \
     result.setLocation( lhs.getLocation() );                    \
     return result;                                              \
+  }                                                             \
+  Field3D operator op(Field3D &&lhs, BoutReal rhs) {            \
+    if(ompTeam() || !lhs.isUnique())                            \
+      return lhs op rhs;                                        \
+    for(const auto& i : lhs)                                    \
+      lhs[i] = lhs[i] op rhs;                                   \
+    return std::move(lhs);                                      \
   }
 
 F3D_OP_REAL(+); // Field3D + BoutReal
@@ -864,13 +1069,23 @@ F3D_OP_REAL(*); // Field3D * BoutReal
 F3D_OP_REAL(/); // Field3D / BoutReal
 
 #define REAL_OP_F3D(op)                                         \
-  const Field3D operator op(BoutReal lhs, const Field3D &rhs) { \
+  Field3D operator op(BoutReal lhs, const Field3D &rhs) {       \
     Field3D result;                                             \
-    result.allocate();                                          \
-    for(const auto& i : rhs)                                           \
-      result[i] = lhs op rhs[i];                                \
+    result.allocateTeam();                                      \
+    {                                                           \
+      OmpWorkshare workshare;                                   \
+      for(const auto& i : rhs)                                  \
+        result[i] = lhs op rhs[i];                              \
+    }                                                           \
     result.setLocation( rhs.getLocation() );                    \
     return result;                                              \
+  }                                                             \
+  Field3D operator op(BoutReal lhs, Field3D &&rhs) {            \
+    if(ompTeam() || !rhs.isUnique())                            \
+      return lhs op rhs;                                        \
+    for(const auto& i : rhs)                                    \
+      rhs[i] = lhs op rhs[i];                                   \
+    return std::move(rhs);                                      \
   }
 
 REAL_OP_F3D(+); // BoutReal + Field3D
@@ -1017,21 +1232,35 @@ BoutReal max(const Field3D &f, bool allpe) {
 // Friend functions
 
 #define F3D_FUNC(name, func)                               \
-  const Field3D name(const Field3D &f) {                   \
+  Field3D name(const Field3D &f) {                         \
     TRACE(#name "(Field3D)");                     \
     /* Check if the input is allocated */                  \
     ASSERT1(f.isAllocated());                              \
     /* Define and allocate the output result */            \
     Field3D result;                                        \
-    result.allocate();                                     \
+    result.allocateTeam();                                 \
     /* Loop over domain */                                 \
-    for(const auto& d : result) {                                 \
-      result[d] = func(f[d]);                              \
-      /* If checking is set to 3 or higher, test result */ \
-      ASSERT3(finite(result[d]));                          \
+    {                                                      \
+      OmpWorkshare workshare;                              \
+      for(const auto& d : result) {                        \
+        result[d] = func(f[d]);                            \
+        /* If checking is set to 3 or higher, test result */ \
+        ASSERT3(finite(result[d]));                        \
+      }                                                    \
     }                                                      \
     result.setLocation(f.getLocation());                   \
     return result;                                         \
+  }                                                        \
+  Field3D name(Field3D &&f) {                              \
+    /* Reuse the data of f if not shared */                \
+    if(ompTeam() || !f.isUnique())                         \
+      return name(f);                                      \
+    TRACE(#name "(Field3D&&)");                            \
+    for(const auto& d : f) {                               \
+      f[d] = func(f[d]);                                   \
+      ASSERT3(finite(f[d]));                               \
+    }                                                      \
+    return std::move(f);                                   \
   }
 
 F3D_FUNC(sqrt, ::sqrt);
@@ -20,3 +20,14 @@ void FieldGroup::makeUnique() {
   auto last_f3 = std::unique(f3vec.begin(), f3vec.end());
   f3vec.erase(last_f3, f3vec.end());
 }
+
+void FieldGroup::merge(const FieldGroup &other) {
+  for(const auto &f : other.fvec) {
+    if(std::find(fvec.begin(), fvec.end(), f) == fvec.end())
+      fvec.push_back(f);
+  }
+  for(const auto &f : other.f3vec) {
+    if(std::find(f3vec.begin(), f3vec.end(), f) == f3vec.end())
+      f3vec.push_back(f);
+  }
+}
@@ -167,7 +167,7 @@ void FieldPerp::setZStencil(stencil &fval, const bindex &bx, CELL_LOC UNUSED(loc
 
 // Operator on FieldPerp and another field
 #define FPERP_FPERP_OP_FIELD(op, ftype)                     	          \
-  const FieldPerp operator op(const FieldPerp &lhs, const ftype &rhs) {   \
+  FieldPerp operator op(const FieldPerp &lhs, const ftype &rhs) {         \
     FieldPerp result;                                                     \
     result.allocate();                                                    \
                                                                           \
@@ -178,6 +178,14 @@ void FieldPerp::setZStencil(stencil &fval, const bindex &bx, CELL_LOC UNUSED(loc
       result[i] = lhs[i] op rhs[i];                                       \
                                                                           \
     return result;                                                        \
+  }                                                                       \
+  FieldPerp operator op(FieldPerp &&lhs, const ftype &rhs) {              \
+    /* Reuse the data of lhs if not shared */                             \
+    if(!lhs.isUnique())                                                   \
+      return lhs op rhs;                                                  \
+    for(auto i : lhs)                                                     \
+      lhs[i] = lhs[i] op rhs[i];                                          \
+    return std::move(lhs);                                                \
   }
 
 FPERP_FPERP_OP_FIELD(+, FieldPerp);
@@ -198,7 +206,7 @@ FPERP_FPERP_OP_FIELD(/, Field2D);
 
 // Operator on FieldPerp and BoutReal
 #define FPERP_FPERP_OP_REAL(op)                     	                   \
-  const FieldPerp operator op(const FieldPerp &lhs, BoutReal rhs) { \
+  FieldPerp operator op(const FieldPerp &lhs, BoutReal rhs) {             \
     FieldPerp result;                                                     \
     result.allocate();                                                    \
                                                                           \
@@ -209,6 +217,13 @@ FPERP_FPERP_OP_FIELD(/, Field2D);
       result[i] = lhs[i] op rhs;                                          \
                                                                           \
     return result;                                                        \
+  }                                                                       \
+  FieldPerp operator op(FieldPerp &&lhs, BoutReal rhs) {                  \
+    if(!lhs.isUnique())                                                   \
+      return lhs op rhs;                                                  \
+    for(auto i : lhs)                                                     \
+      lhs[i] = lhs[i] op rhs;                                             \
+    return std::move(lhs);                                                \
   }
 
 FPERP_FPERP_OP_REAL(+);
@@ -217,7 +232,7 @@ FPERP_FPERP_OP_REAL(*);
 FPERP_FPERP_OP_REAL(/);
 
 #define FPERP_REAL_OP_FPERP(op)                     	                   \
-  const FieldPerp operator op(BoutReal lhs, const FieldPerp &rhs) { \
+  FieldPerp operator op(BoutReal lhs, const FieldPerp &rhs) {             \
     FieldPerp result;                                                     \
     result.allocate();                                                    \
                                                                           \
@@ -228,6 +243,13 @@ FPERP_FPERP_OP_REAL(/);
       result[i] = lhs op rhs[i];                                          \
                                                                           \
     return result;                                                        \
+  }                                                                       \
+  FieldPerp operator op(BoutReal lhs, FieldPerp &&rhs) {                  \
+    if(!rhs.isUnique())                                                   \
+      return lhs op rhs;                                                  \
+    for(auto i : rhs)                                                     \
+      rhs[i] = lhs op rhs[i];                                             \
+    return std::move(rhs);                                                \
   }
 
 // Only need the asymmetric operators
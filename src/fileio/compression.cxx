@@ -0,0 +1,90 @@
+/**************************************************************************
+ * Error-bounded quantisation of output data
+ *
+ **************************************************************************
+ * Copyright 2010 B.D.Dudson, S.Farley, M.V.Umansky, X.Q.Xu
+ *
+ * Contact: Ben Dudson, bd512@york.ac.uk
+ *
+ * This file is part of BOUT++.
+ *
+ * BOUT++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BOUT++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with BOUT++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **************************************************************************/
+
+#include <bout/compression.hxx>
+#include <bout/openmpwrap.hxx>
+#include <utils.hxx>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+  const int mantissa_bits = 52;
+  const int exponent_bias = 1023;
+  const uint64_t sign_mask = uint64_t(1) << 63;
+}
+
+int quantiseBits(BoutReal reltol) {
+  if(reltol <= 0.0)
+    return mantissa_bits;
+  int bits = static_cast<int>(std::ceil(-std::log2(reltol))) - 1;
+  return BOUTMIN(BOUTMAX(bits, 0), mantissa_bits);
+}
+
+void quantise(BoutReal *data, int n, BoutReal abstol, BoutReal reltol) {
+  const bool use_abs = abstol > 0.0;
+  if(!use_abs && (reltol <= 0.0))
+    return;
+
+  const int keep_rel = quantiseBits(reltol);
+  // Exponent of the largest power of two not greater than abstol
+  const int tol_exp = use_abs ? std::ilogb(abstol) : 0;
+
+  BOUT_OMP(parallel for)
+  for(int i=0;i<n;i++) {
+    uint64_t bits;
+    std::memcpy(&bits, data+i, sizeof(bits));
+
+    const int biased = static_cast<int>((bits >> mantissa_bits) & 0x7ff);
+    if(biased >= 0x7fe)
+      continue; // Inf or NaN, or rounding could overflow
+
+    int keep = keep_rel;
+    if(use_abs) {
+      // Rounding 1.m * 2^e to k bits changes it by at most 2^(e-k-1),
+      // so keeping e - tol_exp bits gives an error of at most abstol/2
+      keep = BOUTMIN(keep, biased - exponent_bias - tol_exp);
+    }
+    if(keep >= mantissa_bits)
+      continue;
+
+    if(biased == 0) {
+      // Subnormal. Only changed if smaller than abstol
+      if(use_abs && (tol_exp >= 1 - exponent_bias))
+        bits &= sign_mask;
+    }else if(keep < 0) {
+      // |x| < 2^(e+1) <= abstol
+      bits &= sign_mask;
+    }else {
+      // Round to nearest, possibly carrying into the exponent
+      const int drop = mantissa_bits - keep;
+      bits += uint64_t(1) << (drop - 1);
+      bits &= ~((uint64_t(1) << drop) - 1);
+    }
+
+    std::memcpy(data+i, &bits, sizeof(bits));
+  }
+}
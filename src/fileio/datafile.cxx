@@ -44,9 +44,10 @@
 #include <utils.hxx>
 #include <msg_stack.hxx>
 #include <cstring>
+#include <bout/compression.hxx>
 #include "formatfactory.hxx"
 
-Datafile::Datafile(Options *opt) : parallel(false), flush(true), guards(true), floats(false), openclose(true), enabled(true), shiftOutput(false), flushFrequencyCounter(0), flushFrequency(1), file(nullptr) {
+Datafile::Datafile(Options *opt) : parallel(false), flush(true), guards(true), floats(false), openclose(true), enabled(true), shiftOutput(false), flushFrequencyCounter(0), flushFrequency(1), compress_level(0), lossy(false), abstol(0.0), reltol(0.0), options(opt), file(nullptr) {
   filenamelen=FILENAMELEN;
   filename=new char[filenamelen];
   filename[0] = 0; // Terminate the string
@@ -64,13 +65,29 @@ Datafile::Datafile(Options *opt) : parallel(false), flush(true), guards(true), f
   OPTION(opt, init_missing, false); // Initialise missing variables?
   OPTION(opt, shiftOutput, false); //Do we want to write 3D fields in shifted space?
   OPTION(opt, flushFrequency, 1); //How frequently do we flush the file
-  
+
+  // Compression of 3D fields
+  string compress;
+  OPTION(opt, compress, "none");
+  compress = lowercase(compress);
+  if(compress == "lossless") {
+    OPTION(opt, compress_level, 4);
+  }else if(compress == "lossy") {
+    OPTION(opt, compress_level, 4);
+    lossy = true;
+    OPTION(opt, abstol, 0.0); // Default tolerances. Zero is unused
+    OPTION(opt, reltol, 0.0);
+  }else if(compress != "none")
+    throw BoutException("Datafile: Unrecognised compress option '%s'. "
+                        "Expected none, lossless or lossy", compress.c_str());
 }
 
 Datafile::Datafile(Datafile &&other) :
   parallel(other.parallel), flush(other.flush), guards(other.guards),
   floats(other.floats), openclose(other.openclose), Lx(other.Lx), Ly(other.Ly), Lz(other.Lz),
   enabled(other.enabled), shiftOutput(other.shiftOutput), flushFrequencyCounter(other.flushFrequencyCounter), flushFrequency(other.flushFrequency), 
+  compress_level(other.compress_level), lossy(other.lossy), abstol(other.abstol),
+  reltol(other.reltol), options(other.options),
   file(other.file.release()), int_arr(other.int_arr),
   BoutReal_arr(other.BoutReal_arr), f2d_arr(other.f2d_arr),
   f3d_arr(other.f3d_arr), v2d_arr(other.v2d_arr), v3d_arr(other.v3d_arr) {
@@ -85,6 +102,8 @@ Datafile::Datafile(const Datafile &other) :
   parallel(other.parallel), flush(other.flush), guards(other.guards),
   floats(other.floats), openclose(other.openclose), Lx(other.Lx), Ly(other.Ly), Lz(other.Lz),
   enabled(other.enabled), shiftOutput(other.shiftOutput), flushFrequencyCounter(other.flushFrequencyCounter), flushFrequency(other.flushFrequency), 
+  compress_level(other.compress_level), lossy(other.lossy), abstol(other.abstol),
+  reltol(other.reltol), options(other.options),
   file(nullptr), int_arr(other.int_arr),
   BoutReal_arr(other.BoutReal_arr), f2d_arr(other.f2d_arr),
   f3d_arr(other.f3d_arr), v2d_arr(other.v2d_arr), v3d_arr(other.v3d_arr) {
@@ -106,6 +125,11 @@ Datafile& Datafile::operator=(Datafile &&rhs) {
   shiftOutput  = rhs.shiftOutput;
   flushFrequencyCounter = 0;
   flushFrequency = rhs.flushFrequency;
+  compress_level = rhs.compress_level;
+  lossy        = rhs.lossy;
+  abstol       = rhs.abstol;
+  reltol       = rhs.reltol;
+  options      = rhs.options;
   file         = std::move(rhs.file);
   rhs.file     = nullptr; // not needed?
   int_arr      = rhs.int_arr;
@@ -349,6 +373,7 @@ void Datafile::add(Field3D &f, const char *name, bool save_repeat) {
   d.name = string(name);
   d.save_repeat = save_repeat;
   d.covar = false;
+  getTolerances(d.name, d.abstol, d.reltol);
   
   f3d_arr.push_back(d);
 }
@@ -391,6 +416,7 @@ void Datafile::add(Vector3D &f, const char *name, bool save_repeat) {
   d.name = string(name);
   d.save_repeat = save_repeat;
   d.covar = f.covariant;
+  getTolerances(d.name, d.abstol, d.reltol);
 
   v3d_arr.push_back(d);
 }
@@ -531,8 +557,13 @@ bool Datafile::write() {
 
   if(floats)
     file->setLowPrecision();
+  file->setCompression(compress_level);
   
   Timer timer("io");
+
+  // Finish the writes queued by the previous output, before adding
+  // this one
+  file->completeWrites();
   
   file->setRecord(-1); // Latest record
 
@@ -553,7 +584,7 @@ bool Datafile::write() {
 
   // Write 3D fields
   for(const auto& var : f3d_arr) {
-    write_f3d(var.name, var.ptr, var.save_repeat);
+    write_f3d(var.name, var.ptr, var.save_repeat, var.abstol, var.reltol);
   }
   
   // 2D vectors
@@ -584,19 +615,22 @@ bool Datafile::write() {
       Vector3D v  = *(var.ptr);
       v.toCovariant();
       
-      write_f3d(var.name+string("_x"), &(v.x), var.save_repeat);
-      write_f3d(var.name+string("_y"), &(v.y), var.save_repeat);
-      write_f3d(var.name+string("_z"), &(v.z), var.save_repeat);
+      write_f3d(var.name+string("_x"), &(v.x), var.save_repeat, var.abstol, var.reltol);
+      write_f3d(var.name+string("_y"), &(v.y), var.save_repeat, var.abstol, var.reltol);
+      write_f3d(var.name+string("_z"), &(v.z), var.save_repeat, var.abstol, var.reltol);
     } else {
       // Writing contravariant vector
       Vector3D v  = *(var.ptr);
       v.toContravariant();
       
-      write_f3d(var.name+string("x"), &(v.x), var.save_repeat);
-      write_f3d(var.name+string("y"), &(v.y), var.save_repeat);
-      write_f3d(var.name+string("z"), &(v.z), var.save_repeat);
+      write_f3d(var.name+string("x"), &(v.x), var.save_repeat, var.abstol, var.reltol);
+      write_f3d(var.name+string("y"), &(v.y), var.save_repeat, var.abstol, var.reltol);
+      write_f3d(var.name+string("z"), &(v.z), var.save_repeat, var.abstol, var.reltol);
     }
   }
+
+  // Writes queued by the format are finished at the start of the next
+  // write, or when the file is flushed or closed
   
   if(openclose  && (flushFrequencyCounter+1 % flushFrequency == 0)){
     file->close();
@@ -732,7 +766,8 @@ bool Datafile::write_f2d(const string &name, Field2D *f, bool save_repeat) {
   return true;
 }
 
-bool Datafile::write_f3d(const string &name, Field3D *f, bool save_repeat) {
+bool Datafile::write_f3d(const string &name, Field3D *f, bool save_repeat,
+                         BoutReal abstol, BoutReal reltol) {
   if (!f->isAllocated()) {
     throw BoutException("Datafile::write_f3d: Field3D '%s' is not allocated!", name.c_str());
   }
@@ -745,6 +780,12 @@ bool Datafile::write_f3d(const string &name, Field3D *f, bool save_repeat) {
     f_out = *f;
   }
 
+  if(lossy && ((abstol > 0.0) || (reltol > 0.0))) {
+    // Quantise a copy, so the field itself is not changed
+    f_out = copy(f_out);
+    quantise(&(f_out(0,0,0)), mesh->LocalNx*mesh->LocalNy*mesh->LocalNz, abstol, reltol);
+  }
+
   if(save_repeat) {
     return file->write_rec(&(f_out(0,0,0)), name, mesh->LocalNx, mesh->LocalNy, mesh->LocalNz);
   }else {
@@ -752,6 +793,17 @@ bool Datafile::write_f3d(const string &name, Field3D *f, bool save_repeat) {
   }
 }
 
+void Datafile::getTolerances(const string &name, BoutReal &abs, BoutReal &rel) {
+  abs = abstol;
+  rel = reltol;
+  if(!lossy || (options == nullptr))
+    return;
+  // Only look for the section if quantising, to avoid adding empty sections
+  Options *varopt = options->getSection(name);
+  varopt->get("abstol", abs, abstol);
+  varopt->get("reltol", rel, reltol);
+}
+
 bool Datafile::varAdded(const string &name) {
   for(const auto& var : int_arr ) {
     if(name == var.name)
@@ -38,6 +38,7 @@ H5Format::H5Format(bool parallel_in) {
   parallel = parallel_in;
   x0 = y0 = z0 = t0 = 0;
   lowPrecision = false;
+  compression_level = 0;
   fname = NULL;
   dataFile = -1;
   chunk_length = 10; // could change this to try to optimize IO performance (i.e. allocate new chunks of disk space less often)
@@ -71,6 +72,7 @@ H5Format::H5Format(const char *name, bool parallel_in) {
   parallel = parallel_in;
   x0 = y0 = z0 = t0 = 0;
   lowPrecision = false;
+  compression_level = 0;
   fname = NULL;
   dataFile = -1;
   chunk_length = 10; // could change this to try to optimize IO performance (i.e. allocate new chunks of disk space less often)
@@ -398,9 +400,20 @@ bool H5Format::write(void *data, hid_t mem_hdf5_type, hid_t write_hdf5_type, con
     hid_t init_space = H5Screate_simple(nd, init_size, init_size);
     if (init_space < 0)
       throw BoutException("Failed to create init_space");
-    dataSet = H5Dcreate(dataFile, name, write_hdf5_type, init_space, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+    hid_t propertyList = H5Pcreate(H5P_DATASET_CREATE);
+    if (propertyList < 0)
+      throw BoutException("Failed to create propertyList");
+    if (compress(lz)) {
+      // Filters need a chunked dataset. Use a single chunk
+      if (H5Pset_chunk(propertyList, nd, init_size) < 0)
+        throw BoutException("Failed to set chunk property");
+      setFilters(propertyList);
+    }
+    dataSet = H5Dcreate(dataFile, name, write_hdf5_type, init_space, H5P_DEFAULT, propertyList, H5P_DEFAULT);
     if (dataSet < 0)
       throw BoutException("Failed to create dataSet");
+    if (H5Pclose(propertyList) < 0)
+      throw BoutException("Failed to close propertyList");
     
     // Add attribute to say what kind of field this is
     std::string datatype = "scalar";
@@ -455,7 +468,18 @@ bool H5Format::write(void *data, hid_t mem_hdf5_type, hid_t write_hdf5_type, con
     throw BoutException("Failed to close dataSet");
 
   return true;
-}/***************************************************************************
+}
+
+void H5Format::setFilters(hid_t propertyList) {
+  // Shuffle groups bytes of the same significance together, so that
+  // zeroed low bits (see quantise in bout/compression.hxx) form long runs
+  if (H5Pset_shuffle(propertyList) < 0)
+    throw BoutException("Failed to set shuffle filter");
+  if (H5Pset_deflate(propertyList, compression_level) < 0)
+    throw BoutException("Failed to set deflate filter");
+}
+
+/***************************************************************************
  * Record-based (time-dependent) data
  ***************************************************************************/
 
@@ -660,8 +684,14 @@ bool H5Format::write_rec(void *data, hid_t mem_hdf5_type, hid_t write_hdf5_type,
     hsize_t chunk_dims[4],max_dims[4];
     max_dims[0] = H5S_UNLIMITED; max_dims[1]=init_size[1]; max_dims[2]=init_size[2]; max_dims[3]=init_size[3];
     chunk_dims[0] = chunk_length; chunk_dims[1]=init_size[1]; chunk_dims[2]=init_size[2]; chunk_dims[3]=init_size[3];
+    if (compress(lz)) {
+      // One record per chunk, so each write compresses only the new data
+      chunk_dims[0] = 1;
+    }
     if (H5Pset_chunk(propertyList, nd, chunk_dims) < 0)
       throw BoutException("Failed to set chunk property");
+    if (compress(lz))
+      setFilters(propertyList);
     
     hid_t init_space = H5Screate_simple(nd, init_size, max_dims);
     if (init_space < 0)
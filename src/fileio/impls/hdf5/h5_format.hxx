@@ -108,6 +108,7 @@ class H5Format : public DataFormat {
   bool write_rec(BoutReal *var, const string &name, int lx = 0, int ly = 0, int lz = 0);
   
   void setLowPrecision() { lowPrecision = true; }
+  void setCompression(int level) { compression_level = level; }
 
  private:
 
@@ -119,12 +120,18 @@ class H5Format : public DataFormat {
 
   bool lowPrecision; ///< When writing, down-convert to floats
   bool parallel;
+  int compression_level; ///< Deflate level for new 3D datasets. 0 for none
 
   int x0, y0, z0, t0; ///< Data origins for file access
   int x0_local, y0_local, z0_local; ///< Data origins for memory access
   
   hsize_t chunk_length;
 
+  /// True if a new dataset with these dimensions should be compressed
+  bool compress(int lz) const { return (lz != 0) && (compression_level > 0) && !parallel; }
+  /// Add shuffle and deflate filters to a chunked dataset creation property list
+  void setFilters(hid_t propertyList);
+
   bool read(void *var, hid_t hdf5_type, const char *name, int lx = 1, int ly = 0, int lz = 0);
   bool write(void *var, hid_t mem_hdf5_type, hid_t write_hdf5_type, const char *name, int lx = 0, int ly = 0, int lz = 0);
   bool read_rec(void *var, hid_t hdf5_type, const char *name, int lx = 1, int ly = 0, int lz = 0);
@@ -45,6 +45,7 @@ Ncxx4::Ncxx4() {
   recDimList = new const NcDim*[4];
   dimList = recDimList+1;
   lowPrecision = false;
+  compression_level = 0;
 
   default_rec = 0;
   rec_nr.clear();
@@ -58,6 +59,7 @@ Ncxx4::Ncxx4(const char *name) {
   recDimList = new const NcDim*[4];
   dimList = recDimList+1;
   lowPrecision = false;
+  compression_level = 0;
 
   default_rec = 0;
   rec_nr.clear();
@@ -465,6 +467,7 @@ bool Ncxx4::write(BoutReal *data, const char *name, int lx, int ly, int lz) {
       output.write("ERROR: NetCDF could not add BoutReal '%s' to file '%s'\n", name, fname);
       return false;
     }
+    setFilters(var, lx, ly, lz, false);
   }  
 
   vector<size_t> start(3);
@@ -667,6 +670,7 @@ bool Ncxx4::write_rec(BoutReal *data, const char *name, int lx, int ly, int lz)
 #endif
       return false;
     }
+    setFilters(var, lx, ly, lz, true);
   }else {
     // Get record number
     if(rec_nr.find(name) == rec_nr.end()) {
@@ -735,5 +739,19 @@ vector<NcDim> Ncxx4::getRecDimVec(int nd) {
   return vec;
 }
 
+void Ncxx4::setFilters(NcVar &var, int lx, int ly, int lz, bool rec) {
+  if((lz == 0) || (compression_level <= 0))
+    return;
+
+  // One record per chunk, so each write compresses only the new data
+  vector<size_t> chunks;
+  if(rec)
+    chunks.push_back(1);
+  chunks.push_back(lx); chunks.push_back(ly); chunks.push_back(lz);
+
+  var.setChunking(NcVar::nc_CHUNKED, chunks);
+  var.setCompression(true, true, compression_level);
+}
+
 #endif // NCDF
 
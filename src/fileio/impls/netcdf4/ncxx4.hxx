@@ -106,6 +106,7 @@ class Ncxx4 : public DataFormat {
   bool write_rec(BoutReal *var, const std::string &name, int lx = 0, int ly = 0, int lz = 0);
   
   void setLowPrecision() { lowPrecision = true; }
+  void setCompression(int level) { compression_level = level; }
 
  private:
 
@@ -121,6 +122,7 @@ class Ncxx4 : public DataFormat {
 
   bool appending;
   bool lowPrecision; ///< When writing, down-convert to floats
+  int compression_level; ///< Deflate level for new 3D variables. 0 for none
 
   int x0, y0, z0, t0; ///< Data origins
 
@@ -129,6 +131,9 @@ class Ncxx4 : public DataFormat {
   
   std::vector<netCDF::NcDim> getDimVec(int nd);
   std::vector<netCDF::NcDim> getRecDimVec(int nd);
+
+  /// Set chunking, shuffle and deflate filters of a new variable if compressing
+  void setFilters(netCDF::NcVar &var, int lx, int ly, int lz, bool rec);
 };
 
 #endif // __NCFORMAT4_H__
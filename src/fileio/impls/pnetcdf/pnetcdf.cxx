@@ -47,6 +47,7 @@ PncFormat::PncFormat() {
   dimList = recDimList+1;
   default_rec = 0;
   rec_nr.clear();
+  bufsize = queued = 0;
 
   fname = NULL;
 }
@@ -57,6 +58,7 @@ PncFormat::PncFormat(const char *name) {
   dimList = recDimList+1;
   default_rec = 0;
   rec_nr.clear();
+  bufsize = queued = 0;
 
   openr(name);
 }
@@ -181,6 +183,12 @@ bool PncFormat::openw(const char *name, bool append) {
   recDimList[2] = yDim;
   recDimList[3] = zDim;
 
+  int localsize[3] = {mesh->LocalNx, mesh->LocalNy, mesh->LocalNz}, maxsize[3];
+  MPI_Allreduce(localsize, maxsize, 3, MPI_INT, MPI_MAX, comm);
+  maxnx = maxsize[0];
+  maxny = maxsize[1];
+  maxnz = maxsize[2];
+
   fname = copy_string(name);
 
   return true;
@@ -192,6 +200,12 @@ void PncFormat::close() {
   if(!is_valid())
     return; // Already closed
 
+  waitAll();
+  if(bufsize > 0) {
+    ncmpi_buffer_detach(ncfile);
+    bufsize = 0;
+  }
+
   int ret = ncmpi_close(ncfile);
   free(fname);
   fname = NULL;
@@ -200,9 +214,18 @@ void PncFormat::close() {
 void PncFormat::flush() {
   if(!is_valid())
     return;
+  waitAll();
   int ret = ncmpi_sync(ncfile);
 }
 
+void PncFormat::completeWrites() {
+  TRACE("PncFormat::completeWrites");
+
+  if(!is_valid())
+    return;
+  waitAll();
+}
+
 const vector<int> PncFormat::getSize(const char *name) {
   TRACE("PncFormat::getSize");
 
@@ -374,7 +397,8 @@ bool PncFormat::write(int *data, const char *name, int lx, int ly, int lz) {
   if(ret = ncmpi_inq_varid(ncfile, name, &var)) {
     // Variable not in file
     
-    // Put into define mode
+    // Put into define mode. Queued writes must finish first
+    waitAll();
     ret = ncmpi_redef(ncfile); CHKERR(ret); 
     // Define variable
     ret = ncmpi_def_var(ncfile, name, NC_INT, nd, dimList, &var); CHKERR(ret);
@@ -382,9 +406,13 @@ bool PncFormat::write(int *data, const char *name, int lx, int ly, int lz) {
     ret = ncmpi_enddef(ncfile); CHKERR(ret);
   }
   
+  reserve(lx, ly, lz);
+  int request;
+
   if(nd == 0) {
     // Writing a scalar
-    ret = ncmpi_put_var_int_all(ncfile, var, data); CHKERR(ret);
+    ret = ncmpi_bput_var_int(ncfile, var, data, &request); CHKERR(ret);
+    requests.push_back(request);
     return true;
   }
   
@@ -394,7 +422,8 @@ bool PncFormat::write(int *data, const char *name, int lx, int ly, int lz) {
   start[0] = x0; start[1] = y0; start[2] = z0;
   count[0] = lx; count[1] = ly; count[2] = lz;
   
-  ret = ncmpi_put_vara_int_all(ncfile, var, start, count, data); CHKERR(ret);
+  ret = ncmpi_bput_vara_int(ncfile, var, start, count, data, &request); CHKERR(ret);
+  requests.push_back(request);
 
   return true;
 }
@@ -404,21 +433,23 @@ bool PncFormat::write(int *var, const string &name, int lx, int ly, int lz) {
 }
 
 // Helper functions to select the correct ncmpi function
-int pnc_put_var_all(int ncfile, int var, double* data) {
-  return ncmpi_put_var_double_all(ncfile, var, data);
+int pnc_bput_var(int ncfile, int var, double* data, int *request) {
+  return ncmpi_bput_var_double(ncfile, var, data, request);
 }
 
-int pnc_put_var_all(int ncfile, int var, float* data) {
-  return ncmpi_put_var_float_all(ncfile, var, data);
+int pnc_bput_var(int ncfile, int var, float* data, int *request) {
+  return ncmpi_bput_var_float(ncfile, var, data, request);
 }
 
 // Helper functions to select the correct ncmpi function
-int pnc_put_vara_all(int ncfile, int var, MPI_Offset* start, MPI_Offset* count, double* data) {
-  return ncmpi_put_vara_double_all(ncfile, var, start, count, data);
+int pnc_bput_vara(int ncfile, int var, MPI_Offset* start, MPI_Offset* count, double* data,
+                  int *request) {
+  return ncmpi_bput_vara_double(ncfile, var, start, count, data, request);
 }
 
-int pnc_put_vara_all(int ncfile, int var, MPI_Offset* start, MPI_Offset* count, float* data) {
-  return ncmpi_put_vara_float_all(ncfile, var, start, count, data);
+int pnc_bput_vara(int ncfile, int var, MPI_Offset* start, MPI_Offset* count, float* data,
+                  int *request) {
+  return ncmpi_bput_vara_float(ncfile, var, start, count, data, request);
 }
 
 bool PncFormat::write(BoutReal *data, const char *name, int lx, int ly, int lz) {
@@ -440,7 +471,8 @@ bool PncFormat::write(BoutReal *data, const char *name, int lx, int ly, int lz)
   if(ret = ncmpi_inq_varid(ncfile, name, &var)) {
     // Variable not in file
     
-    // Put into define mode
+    // Put into define mode. Queued writes must finish first
+    waitAll();
     ret = ncmpi_redef(ncfile); CHKERR(ret); 
 
     nc_type type = (lowPrecision) ? NC_FLOAT : NC_DOUBLE;
@@ -451,9 +483,13 @@ bool PncFormat::write(BoutReal *data, const char *name, int lx, int ly, int lz)
     ret = ncmpi_enddef(ncfile); CHKERR(ret);
   }
   
+  reserve(lx, ly, lz);
+  int request;
+
   if(nd == 0) {
     // Writing a scalar
-    ret = pnc_put_var_all(ncfile, var, data); CHKERR(ret);
+    ret = pnc_bput_var(ncfile, var, data, &request); CHKERR(ret);
+    requests.push_back(request);
     return true;
   }
   
@@ -480,7 +516,8 @@ bool PncFormat::write(BoutReal *data, const char *name, int lx, int ly, int lz)
   start[0] = x0; start[1] = y0; start[2] = z0;
   count[0] = lx; count[1] = ly; count[2] = lz;
   
-  ret = pnc_put_vara_all(ncfile, var, start, count, data); CHKERR(ret);
+  ret = pnc_bput_vara(ncfile, var, start, count, data, &request); CHKERR(ret);
+  requests.push_back(request);
 
   return true;
 }
@@ -574,7 +611,8 @@ bool PncFormat::write_rec(int *data, const char *name, int lx, int ly, int lz) {
   if(ret = ncmpi_inq_varid(ncfile, name, &var)) {
     // Variable not in file
     
-    // Put into define mode
+    // Put into define mode. Queued writes must finish first
+    waitAll();
     ret = ncmpi_redef(ncfile); CHKERR(ret); 
     // Define variable
     ret = ncmpi_def_var(ncfile, name, NC_INT, nd, recDimList, &var); CHKERR(ret);
@@ -590,11 +628,15 @@ bool PncFormat::write_rec(int *data, const char *name, int lx, int ly, int lz) {
     }
   }
   
+  reserve(lx, ly, lz);
+
   MPI_Offset start[4], count[4];
   start[0] = rec_nr[name]; start[1] = x0; start[2] = y0; start[3] = z0;
   count[0] = 1;  count[1] = lx; count[2] = ly; count[3] = lz;
   
-  ret = ncmpi_put_vara_int_all(ncfile, var, start, count, data); CHKERR(ret);
+  int request;
+  ret = ncmpi_bput_vara_int(ncfile, var, start, count, data, &request); CHKERR(ret);
+  requests.push_back(request);
   
   // Increment record number
   rec_nr[name] += 1;
@@ -625,7 +667,8 @@ bool PncFormat::write_rec(BoutReal *data, const char *name, int lx, int ly, int
   if(ret = ncmpi_inq_varid(ncfile, name, &var)) {
     // Variable not in file
     
-    // Put into define mode
+    // Put into define mode. Queued writes must finish first
+    waitAll();
     ret = ncmpi_redef(ncfile); CHKERR(ret); 
     // Define variable
     nc_type type = (lowPrecision) ? NC_FLOAT : NC_DOUBLE;
@@ -664,13 +707,17 @@ bool PncFormat::write_rec(BoutReal *data, const char *name, int lx, int ly, int
       data[i] = 0.0;
   }
 
+  reserve(lx, ly, lz);
+
   MPI_Offset start[4], count[4];
   start[0] = rec_nr[name]; start[1] = x0; start[2] = y0; start[3] = z0;
   count[0] = 1;  count[1] = lx; count[2] = ly; count[3] = lz;
 
-  // Add the record
+  // Add the record. The data is copied, and written by completeWrites
 
-  ret = pnc_put_vara_all(ncfile, var, start, count, data); CHKERR(ret);
+  int request;
+  ret = pnc_bput_vara(ncfile, var, start, count, data, &request); CHKERR(ret);
+  requests.push_back(request);
   
   // Increment record number
   rec_nr[name] += 1;
@@ -686,5 +733,45 @@ bool PncFormat::write_rec(BoutReal *var, const string &name, int lx, int ly, int
  * Private functions
  ***************************************************************************/
 
+void PncFormat::reserve(int lx, int ly, int lz) {
+  // Space for the largest local size of this variable on any processor,
+  // so that every processor makes the same decisions
+  MPI_Offset bytes = sizeof(double);
+  if(lx != 0) bytes *= maxnx;
+  if(ly != 0) bytes *= maxny;
+  if(lz != 0) bytes *= maxnz;
+
+  if(queued + bytes <= bufsize) {
+    queued += bytes;
+    return;
+  }
+
+  // Not enough space. Write the queued data, then attach a
+  // buffer large enough for everything queued so far
+  MPI_Offset needed = queued + bytes;
+  waitAll();
+
+  int ret;
+  if(bufsize > 0) {
+    ret = ncmpi_buffer_detach(ncfile); CHKERR(ret);
+  }
+  bufsize = (2*bufsize > needed) ? 2*bufsize : needed;
+  ret = ncmpi_buffer_attach(ncfile, bufsize); CHKERR(ret);
+
+  queued = bytes;
+}
+
+void PncFormat::waitAll() {
+  // Collective, so called even if this processor has no requests
+  vector<int> status(requests.size());
+  int ret = ncmpi_wait_all(ncfile, static_cast<int>(requests.size()),
+                           requests.data(), status.data()); CHKERR(ret);
+  for(const auto &s : status) {
+    CHKERR(s);
+  }
+  requests.clear();
+  queued = 0;
+}
+
 #endif // PNCDF
 
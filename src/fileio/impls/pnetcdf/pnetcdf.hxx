@@ -61,10 +61,10 @@ class PncFormat : public DataFormat {
   ~PncFormat();
 
   bool openr(const char *name);
-  bool openr(const string &name, int mype) {return openr(name);}
+  bool openr(const string &name, int mype) {return openr(name.c_str());}
 
   bool openw(const char *name, bool append=false);
-  bool openw(const string &name, int mype, bool append=false) {return openw(name, append);}
+  bool openw(const string &name, int mype, bool append=false) {return openw(name.c_str(), append);}
 
   bool is_valid() { return fname != NULL;}
   
@@ -107,6 +107,9 @@ class PncFormat : public DataFormat {
   
   void setLowPrecision() { lowPrecision = true; }
 
+  /// Write all queued data with one collective call
+  void completeWrites();
+
  private:
   
   char *fname; ///< Current file name
@@ -128,6 +131,27 @@ class PncFormat : public DataFormat {
 
   map<string, int> rec_nr; // Record number for each variable (bit nasty)
   int default_rec;  // Starting record. Useful when appending to existing file
+
+  // Writes are buffered puts, which copy the data into a buffer
+  // attached to the file. They are written when completeWrites is
+  // called at the start of the next output, by flush or close, or when
+  // the buffer is full or a variable is defined
+
+  vector<int> requests;   ///< Nonblocking requests not yet completed
+  MPI_Offset bufsize;     ///< Size of attached buffer. Zero if none
+  MPI_Offset queued;      ///< Space reserved by queued writes
+
+  /// Largest local size in each direction on any processor, used to
+  /// reserve buffer space in the same way on all processors
+  int maxnx, maxny, maxnz;
+
+  /// Make sure there is space for a write of the given size, which
+  /// may complete the queued writes. Collective: must be called with
+  /// the same arguments on all processors
+  void reserve(int lx, int ly, int lz);
+
+  /// Wait for all queued writes to finish. Collective
+  void waitAll();
 };
 
 #endif // __PNCFORMAT_H__
@@ -0,0 +1,183 @@
+/**************************************************************************
+ * Output of reduced representations of 3D fields
+ *
+ **************************************************************************
+ * Copyright 2010 B.D.Dudson, S.Farley, M.V.Umansky, X.Q.Xu
+ *
+ * Contact: Ben Dudson, bd512@york.ac.uk
+ *
+ * This file is part of BOUT++.
+ *
+ * BOUT++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BOUT++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with BOUT++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **************************************************************************/
+
+#include <globals.hxx>
+#include <bout/reduced_output.hxx>
+#include <bout/array.hxx>
+#include <boutexception.hxx>
+#include <msg_stack.hxx>
+#include <output.hxx>
+#include <utils.hxx>
+#include <fft.hxx>
+#include <smoothing.hxx>
+#include <unused.hxx>
+
+ReducedOutput::ReducedOutput(Options *opt, const std::string &name)
+  : Monitor(getTimestep(opt)), dump(opt), simtime(0.0) {
+
+  std::string typestr;
+  opt->get("type", typestr, "average_z");
+  typestr = lowercase(typestr);
+
+  if(typestr == "average_z") {
+    type = Type::average_z;
+  }else if(typestr == "average_yz") {
+    type = Type::average_yz;
+  }else if(typestr == "slice_z") {
+    type = Type::slice_z;
+  }else if(typestr == "fourier") {
+    type = Type::fourier;
+  }else
+    throw BoutException("Unrecognised reduced output type '%s' in section '%s'",
+                        typestr.c_str(), name.c_str());
+
+  OPTION(opt, zstart, 0);
+  OPTION(opt, zstride, mesh->LocalNz); // By default a single plane
+  if((zstart < 0) || (zstart >= mesh->LocalNz) || (zstride < 1))
+    throw BoutException("Invalid zstart (%d) or zstride (%d) in section '%s'",
+                        zstart, zstride, name.c_str());
+
+  OPTION(opt, nmodes, 1);
+  if((nmodes < 1) || (nmodes > (mesh->LocalNz)/2 + 1))
+    throw BoutException("Invalid nmodes (%d) in section '%s'", nmodes, name.c_str());
+
+  std::string fields;
+  opt->get("fields", fields, "");
+  for(const auto &f : strsplit(fields, ',')) {
+    std::string fname = trim(f);
+    if(!fname.empty())
+      field_names.push_back(fname);
+  }
+
+  // Open the output file, in the same directory and format as the dump files
+  Options *globaloptions = Options::getRoot();
+  std::string datadir, dump_format;
+  globaloptions->get("datadir", datadir, "data");
+  globaloptions->get("dump_format", dump_format, "nc");
+  bool append;
+  globaloptions->get("append", append, false);
+
+  if(append) {
+    dump.opena("%s/%s.dmp.%s", datadir.c_str(), name.c_str(), dump_format.c_str());
+  }else {
+    dump.openw("%s/%s.dmp.%s", datadir.c_str(), name.c_str(), dump_format.c_str());
+  }
+
+  dump.add(simtime, "t_array", true);
+}
+
+ReducedOutput::~ReducedOutput() {
+  dump.close();
+}
+
+BoutReal ReducedOutput::getTimestep(Options *opt) {
+  BoutReal timestep;
+  opt->get("timestep", timestep, -1.0); // Negative -> same as output timestep
+  return timestep;
+}
+
+void ReducedOutput::add(Field3D &f, const std::string &name) {
+  Variable v;
+  v.var = &f;
+
+  std::vector<std::string> names;
+  switch(type) {
+  case Type::average_z:
+  case Type::average_yz: {
+    names.push_back(name);
+    break;
+  }
+  case Type::slice_z: {
+    for(int z = zstart; z < mesh->LocalNz; z += zstride)
+      names.push_back(name + "_z" + toString(z));
+    break;
+  }
+  case Type::fourier: {
+    for(int k = 0; k < nmodes; k++) {
+      names.push_back(name + "_k" + toString(k) + "_re");
+      names.push_back(name + "_k" + toString(k) + "_im");
+    }
+    break;
+  }
+  }
+
+  for(const auto &n : names) {
+    data.emplace_back(0.0);
+    Field2D *r = &data.back();
+    dump.add(*r, n.c_str(), true);
+    v.out.push_back(r);
+  }
+  vars.push_back(v);
+}
+
+int ReducedOutput::call(Solver *UNUSED(solver), BoutReal time, int UNUSED(iter), int UNUSED(nout)) {
+  TRACE("ReducedOutput::call");
+
+  simtime = time;
+
+  for(auto &v : vars) {
+    const Field3D &f = *(v.var);
+
+    switch(type) {
+    case Type::average_z: {
+      *(v.out[0]) = DC(f);
+      break;
+    }
+    case Type::average_yz: {
+      *(v.out[0]) = averageY(DC(f));
+      break;
+    }
+    case Type::slice_z: {
+      int i = 0;
+      for(int z = zstart; z < mesh->LocalNz; z += zstride, i++) {
+        Field2D &r = *(v.out[i]);
+        r.allocate();
+        for(int x=0;x<mesh->LocalNx;x++)
+          for(int y=0;y<mesh->LocalNy;y++)
+            r(x,y) = f(x,y,z);
+      }
+      break;
+    }
+    case Type::fourier: {
+      Array<dcomplex> fk((mesh->LocalNz)/2 + 1);
+      for(auto &r : v.out)
+        r->allocate();
+      for(int x=0;x<mesh->LocalNx;x++)
+        for(int y=0;y<mesh->LocalNy;y++) {
+          rfft(f(x,y), mesh->LocalNz, fk.begin());
+          for(int k=0;k<nmodes;k++) {
+            (*(v.out[2*k]))(x,y) = fk[k].real();
+            (*(v.out[2*k+1]))(x,y) = fk[k].imag();
+          }
+        }
+      break;
+    }
+    }
+  }
+
+  dump.write();
+
+  return 0;
+}
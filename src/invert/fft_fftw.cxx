@@ -33,6 +33,8 @@
 #include <fftw3.h>
 #include <math.h>
 
+#include <vector>
+
 #ifdef _OPENMP
 #include <omp.h>
 #endif
@@ -428,6 +430,88 @@ void irfft(const dcomplex *in, int length, BoutReal *out) {
 }
 #endif
 
+/***********************************************************
+ * Batched real FFTs
+ ***********************************************************/
+
+namespace {
+/// A plan for \p howmany transforms of \p length points, stored one
+/// after another
+struct ManyPlan {
+  int length, howmany;
+  bool forward;
+  fftw_plan plan;
+};
+
+/// Get a plan for batched real transforms, creating it the first time.
+/// Plans are made with FFTW_UNALIGNED, so that they can be executed on
+/// any arrays with the new-array execute functions
+fftw_plan getManyPlan(int length, int howmany, bool forward) {
+  static std::vector<ManyPlan> plans; // Never freed
+  fftw_plan result = nullptr;
+
+#pragma omp critical(fft_many)
+  {
+    for(const auto &p : plans) {
+      if((p.length == length) && (p.howmany == howmany) && (p.forward == forward)) {
+        result = p.plan;
+        break;
+      }
+    }
+
+    if(result == nullptr) {
+      // FFTW planning routines not thread safe
+      fft_init();
+
+      const int nmodes = (length/2) + 1;
+      double *r = (double*) fftw_malloc(sizeof(double) * length * howmany);
+      fftw_complex *c = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * nmodes * howmany);
+
+      unsigned int flags = FFTW_ESTIMATE;
+      if(fft_measure)
+        flags = FFTW_MEASURE;
+      flags |= FFTW_UNALIGNED;
+
+      if(forward) {
+        result = fftw_plan_many_dft_r2c(1, &length, howmany,
+                                        r, nullptr, 1, length,
+                                        c, nullptr, 1, nmodes, flags);
+      }else {
+        result = fftw_plan_many_dft_c2r(1, &length, howmany,
+                                        c, nullptr, 1, nmodes,
+                                        r, nullptr, 1, length, flags);
+      }
+
+      fftw_free(r);
+      fftw_free(c);
+
+      plans.push_back({length, howmany, forward, result});
+    }
+  }
+  return result;
+}
+}
+
+void rfft(const BoutReal *in, int length, int howmany, dcomplex *out) {
+  fftw_plan p = getManyPlan(length, howmany, true);
+
+  // Out of place real to complex transforms don't change the input
+  fftw_execute_dft_r2c(p, const_cast<BoutReal*>(in),
+                       reinterpret_cast<fftw_complex*>(out));
+
+  // Normalise, as rfft
+  const BoutReal fac = 1.0 / static_cast<BoutReal>(length);
+  const int n = ((length/2) + 1) * howmany;
+  for(int i=0;i<n;i++)
+    out[i] *= fac;
+}
+
+void irfft(dcomplex *in, int length, int howmany, BoutReal *out) {
+  fftw_plan p = getManyPlan(length, howmany, false);
+
+  fftw_execute_dft_c2r(p, reinterpret_cast<fftw_complex*>(in), out);
+}
+
 //  Discrete sine transforms (B Shanahan)
 
 void DST(const BoutReal *in, int length, dcomplex *out) {
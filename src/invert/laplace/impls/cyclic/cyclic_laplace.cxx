@@ -72,8 +72,10 @@ LaplaceCyclic::LaplaceCyclic(Options *opt)
   a   = matrix<dcomplex>(nsys, n);
   b   = matrix<dcomplex>(nsys, n);
   c   = matrix<dcomplex>(nsys, n);
-  xcmplx = matrix<dcomplex>(nsys, n);
-  bcmplx = matrix<dcomplex>(nsys, n);
+
+  // RHS and solution arrays, enlarged when solving several at once
+  maxrhs = 0;
+  allocRHS(1);
 
   if(dst)
     k1d = new dcomplex[mesh->LocalNz];         // DST has different k space
@@ -93,6 +95,9 @@ LaplaceCyclic::~LaplaceCyclic() {
   free_matrix(c);
   free_matrix(xcmplx);
   free_matrix(bcmplx);
+  delete[] acoef;
+  delete[] bcoef;
+  delete[] ccoef;
 
   delete[] k1d;
 
@@ -101,13 +106,32 @@ LaplaceCyclic::~LaplaceCyclic() {
 }
 
 const FieldPerp LaplaceCyclic::solve(const FieldPerp &rhs, const FieldPerp &x0) {
-  FieldPerp x;  // Result
-  x.allocate();
+  return solve(std::vector<FieldPerp>{rhs}, std::vector<FieldPerp>{x0})[0];
+}
+
+/*!
+ * Solve for several right hand sides at once. The matrix is set up once,
+ * and the systems for all right hand sides are passed to CyclicReduce
+ * together, so the communication is done once for all of them
+ */
+std::vector<FieldPerp> LaplaceCyclic::solve(const std::vector<FieldPerp> &rhs,
+                                            const std::vector<FieldPerp> &x0) {
+  if(rhs.size() != x0.size()) {
+    throw BoutException("LaplaceCyclic: %d right hand sides but %d initial guesses",
+                        static_cast<int>(rhs.size()), static_cast<int>(x0.size()));
+  }
+
+  std::vector<FieldPerp> result;
+  if(rhs.empty())
+    return result;
 
   Coordinates *coord = mesh->coordinates();
 
-  int jy = rhs.getIndex();  // Get the Y index
-  x.setIndex(jy);
+  int jy = rhs[0].getIndex();  // Get the Y index
+
+  int nrhs = rhs.size();
+  allocRHS(nrhs);
+  int nsys = nrhs*nmode; // Systems ordered [rhs][kz]
 
   // Get the width of the boundary
 
@@ -120,102 +144,119 @@ const FieldPerp LaplaceCyclic::solve(const FieldPerp &rhs, const FieldPerp &x0)
   if(outer_boundary_flags & INVERT_BNDRY_ONE)
     outbndry = 1;
 
-  if(dst) {
-    // Loop over X indices, including boundaries but not guard cells. (unless periodic in x)
+  for(int i=0; i<nrhs; i++) {
+    if(rhs[i].getIndex() != jy)
+      throw BoutException("LaplaceCyclic: Right hand sides at different y indices");
+
+    dcomplex **bk = bcmplx + i*nmode; // Modes of this RHS
+
+    // Loop over X indices, including boundaries but not guard cells (unless periodic in x)
     for(int ix=xs; ix <= xe; ix++) {
-      // Take DST in Z direction and put result in k1d
+      // Take DST or FFT in Z direction and put result in k1d
 
       if(((ix < inbndry) && (inner_boundary_flags & INVERT_SET) && mesh->firstX()) ||
          ((xe-ix < outbndry) && (outer_boundary_flags & INVERT_SET) && mesh->lastX())) {
         // Use the values in x0 in the boundary
-        DST(x0[ix]+1, mesh->LocalNz-2 , k1d);
+        if(dst) {
+          DST(x0[i][ix]+1, mesh->LocalNz-2 , k1d);
+        }else
+          rfft(x0[i][ix], mesh->LocalNz, k1d);
       }else {
-        //	  int length = sizeof(*rhs[ix])/sizeof(FieldPerp);
-        DST(rhs[ix]+1, mesh->LocalNz-2 , k1d);
+        if(dst) {
+          DST(rhs[i][ix]+1, mesh->LocalNz-2 , k1d);
+        }else
+          rfft(rhs[i][ix], mesh->LocalNz, k1d);
       }
 
       // Copy into array, transposing so kz is first index
       for(int kz = 0; kz < nmode; kz++)
-        bcmplx[kz][ix-xs] = k1d[kz];
+        bk[kz][ix-xs] = k1d[kz];
     }
 
-    // Get elements of the tridiagonal matrix
-    // including boundary conditions
-    for(int kz = 0; kz < nmode; kz++) {
-      BoutReal zlen = coord->dz*(mesh->LocalNz-3);
-      BoutReal kwave=kz*2.0*PI/(2.*zlen); // wave number is 1/[rad]; DST has extra 2.
-
-      tridagMatrix(a[kz], b[kz], c[kz], bcmplx[kz], jy,
-                   kz,    // wave number index
-                   kwave, // kwave (inverse wave length)
-                   global_flags, inner_boundary_flags, outer_boundary_flags, &Acoef,
-                   &Ccoef, &Dcoef,
-                   false); // Don't include guard cells in arrays
+    if(i == 0) {
+      // Get elements of the tridiagonal matrix
+      // including boundary conditions
+      for(int kz = 0; kz < nmode; kz++) {
+        BoutReal kwave;
+        if(dst) {
+          BoutReal zlen = coord->dz*(mesh->LocalNz-3);
+          kwave=kz*2.0*PI/(2.*zlen); // wave number is 1/[rad]; DST has extra 2.
+        }else
+          kwave=kz*2.0*PI/(coord->zlength()); // wave number is 1/[rad]
+
+        tridagMatrix(a[kz], b[kz], c[kz], bk[kz], jy,
+                     kz,    // wave number index
+                     kwave, // Z wave number
+                     global_flags, inner_boundary_flags, outer_boundary_flags, &Acoef,
+                     &Ccoef, &Dcoef,
+                     false); // Don't include guard cells in arrays
+      }
+    }else {
+      // Same matrix, so only the boundary values of the RHS are needed
+      for(int kz = 0; kz < nmode; kz++)
+        tridagBoundaryRHS(bk[kz], global_flags, inner_boundary_flags, outer_boundary_flags,
+                          false);
     }
+  }
 
-    // Solve tridiagonal systems
+  // Solve tridiagonal systems. All right hand sides use the same coefficients
+  for(int s = 0; s < nsys; s++) {
+    acoef[s] = a[s % nmode];
+    bcoef[s] = b[s % nmode];
+    ccoef[s] = c[s % nmode];
+  }
+  cr->setCoefs(nsys, acoef, bcoef, ccoef);
+  cr->solve(nsys, bcmplx, xcmplx);
+
+  for(int i=0; i<nrhs; i++) {
+    FieldPerp x;  // Result
+    x.allocate();
+    x.setIndex(jy);
 
-    cr->setCoefs(nmode, a, b, c);
-    cr->solve(nmode, bcmplx, xcmplx);
+    dcomplex **xk = xcmplx + i*nmode;
 
     // FFT back to real space
     for(int ix=xs; ix <= xe; ix++) {
       for(int kz = 0; kz < nmode; kz++)
-        k1d[kz] = xcmplx[kz][ix-xs];
+        k1d[kz] = xk[kz][ix-xs];
 
-      for(int kz=nmode;kz<(mesh->LocalNz);kz++)
-        k1d[kz] = 0.0; // Filtering out all higher harmonics
+      if(dst) {
+        for(int kz=nmode;kz<(mesh->LocalNz);kz++)
+          k1d[kz] = 0.0; // Filtering out all higher harmonics
 
-      DST_rev(k1d, mesh->LocalNz-2, x[ix]+1);
-
-      x[ix][0] = -x[ix][2];
-      x[ix][mesh->LocalNz-1] = -x[ix][mesh->LocalNz-3];
-    }
-  }else {
-    // Loop over X indices, including boundaries but not guard cells (unless periodic in x)
-    for(int ix=xs; ix <= xe; ix++) {
-      // Take FFT in Z direction, apply shift, and put result in k1d
+        DST_rev(k1d, mesh->LocalNz-2, x[ix]+1);
 
-    if(((ix < inbndry) && (inner_boundary_flags & INVERT_SET) && mesh->firstX()) ||
-       ((xe-ix < outbndry) && (outer_boundary_flags & INVERT_SET) && mesh->lastX())) {
-        // Use the values in x0 in the boundary
-        rfft(x0[ix], mesh->LocalNz, k1d);
+        x[ix][0] = -x[ix][2];
+        x[ix][mesh->LocalNz-1] = -x[ix][mesh->LocalNz-3];
       }else {
-        rfft(rhs[ix], mesh->LocalNz, k1d);
-      }
-
-      // Copy into array, transposing so kz is first index
-      for(int kz = 0; kz < nmode; kz++)
-        bcmplx[kz][ix-xs] = k1d[kz];
-    }
+        for(int kz=nmode;kz<(mesh->LocalNz)/2 + 1;kz++)
+          k1d[kz] = 0.0; // Filtering out all higher harmonics
 
-    // Get elements of the tridiagonal matrix
-    // including boundary conditions
-    for(int kz = 0; kz < nmode; kz++) {
-      BoutReal kwave=kz*2.0*PI/(coord->zlength()); // wave number is 1/[rad]
-      tridagMatrix(a[kz], b[kz], c[kz], bcmplx[kz], jy,
-                   kz,    // True for the component constant (DC) in Z
-                   kwave, // Z wave number
-                   global_flags, inner_boundary_flags, outer_boundary_flags, &Acoef,
-                   &Ccoef, &Dcoef,
-                   false); // Don't include guard cells in arrays
+        irfft(k1d, mesh->LocalNz, x[ix]);
+      }
     }
+    result.push_back(x);
+  }
+  return result;
+}
 
-    // Solve tridiagonal systems
-
-    cr->setCoefs(nmode, a, b, c);
-    cr->solve(nmode, bcmplx, xcmplx);
-
-    // FFT back to real space
-    for(int ix=xs; ix <= xe; ix++) {
-      for(int kz = 0; kz < nmode; kz++)
-        k1d[kz] = xcmplx[kz][ix-xs];
-
-      for(int kz=nmode;kz<(mesh->LocalNz)/2 + 1;kz++)
-        k1d[kz] = 0.0; // Filtering out all higher harmonics
+void LaplaceCyclic::allocRHS(int nrhs) {
+  if(nrhs <= maxrhs)
+    return;
 
-      irfft(k1d, mesh->LocalNz, x[ix]);
-    }
+  if(maxrhs > 0) {
+    free_matrix(xcmplx);
+    free_matrix(bcmplx);
+    delete[] acoef;
+    delete[] bcoef;
+    delete[] ccoef;
   }
-  return x;
+
+  maxrhs = nrhs;
+  int n = xe - xs + 1;
+  xcmplx = matrix<dcomplex>(maxrhs*nmode, n);
+  bcmplx = matrix<dcomplex>(maxrhs*nmode, n);
+  acoef = new dcomplex*[maxrhs*nmode];
+  bcoef = new dcomplex*[maxrhs*nmode];
+  ccoef = new dcomplex*[maxrhs*nmode];
 }
@@ -63,6 +63,12 @@ public:
   using Laplacian::solve;
   const FieldPerp solve(const FieldPerp &b) {return solve(b,b);}
   const FieldPerp solve(const FieldPerp &b, const FieldPerp &x0);
+
+  std::vector<FieldPerp> solve(const std::vector<FieldPerp> &b) override {
+    return solve(b, b);
+  }
+  std::vector<FieldPerp> solve(const std::vector<FieldPerp> &b,
+                               const std::vector<FieldPerp> &x0) override;
 private:
   Field2D Acoef, Ccoef, Dcoef;
   
@@ -70,6 +76,10 @@ private:
   int xs, xe; // Start and end X indices
   dcomplex **a, **b, **c, **bcmplx, **xcmplx;
   dcomplex *k1d;
+
+  int maxrhs; ///< Number of right hand sides bcmplx and xcmplx can hold
+  dcomplex **acoef, **bcoef, **ccoef; ///< Coefficients for each system
+  void allocRHS(int nrhs); ///< Make sure arrays can hold nrhs right hand sides
   
   bool dst;
   
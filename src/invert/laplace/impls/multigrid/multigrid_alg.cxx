@@ -159,21 +159,23 @@ void MultigridAlg::cycleMG(int level,BoutReal *sol,BoutReal *rhs)
 void MultigridAlg::projection(int level,BoutReal *r,BoutReal *pr) 
 {
 
-  int nn,n0,n1,n2,n3;
   communications(r,level);
-  for(int i=0;i<(lnx[level-1]+2)*(lnz[level-1]+2);i++) pr[i] = 0.;
-  for (int i=1; i<lnx[level-1]+1; i++) {
-    int i2 = 2*i-1;
-#pragma omp parallel default(shared) private(nn,n0,n1,n2,n3)
+#pragma omp parallel default(shared)
+  {
 #pragma omp for
-    for (int k=1; k<lnz[level-1]+1; k++) {
-      int k2 = 2*k-1;
-      nn = i*(lnz[level-1]+2)+k;
-      n0 = i2*(lnz[level]+2)+k2;
-      n1 = n0 + 1;
-      n2 = n0 + lnz[level]+2;
-      n3 = n2 + 1;
-      pr[nn] = (r[n0]+r[n1]+r[n2]+r[n3])/4.0;
+    for(int i=0;i<(lnx[level-1]+2)*(lnz[level-1]+2);i++) pr[i] = 0.;
+#pragma omp for
+    for (int i=1; i<lnx[level-1]+1; i++) {
+      int i2 = 2*i-1;
+      for (int k=1; k<lnz[level-1]+1; k++) {
+        int k2 = 2*k-1;
+        int nn = i*(lnz[level-1]+2)+k;
+        int n0 = i2*(lnz[level]+2)+k2;
+        int n1 = n0 + 1;
+        int n2 = n0 + lnz[level]+2;
+        int n3 = n2 + 1;
+        pr[nn] = (r[n0]+r[n1]+r[n2]+r[n3])/4.0;
+      }
     }
   }
   communications(pr,level-1);
@@ -182,26 +184,26 @@ void MultigridAlg::projection(int level,BoutReal *r,BoutReal *pr)
 
 void MultigridAlg::prolongation(int level,BoutReal *x,BoutReal *ix) {
 
-  int nn,n0,n1,n2,n3;
   communications(x,level);
 #pragma omp parallel default(shared)
+  {
 #pragma omp for
-  for(int i=0;i<(lnx[level+1]+2)*(lnz[level+1]+2);i++) ix[i] = 0.;
-  for (int i=1; i<lnx[level]+1; i++) {
-    int i2 = 2*i-1;
-#pragma omp parallel default(shared) private(nn,n0,n1,n2,n3)
+    for(int i=0;i<(lnx[level+1]+2)*(lnz[level+1]+2);i++) ix[i] = 0.;
 #pragma omp for
-    for (int k=1; k<lnz[level]+1; k++) {
-      int k2 = 2*k-1;
-      nn = i*(lnz[level]+2)+k;
-      n0 = i2*(lnz[level+1]+2)+k2;
-      n1 = n0 + 1;
-      n2 = n0 + lnz[level+1]+2;
-      n3 = n2 +1;
-      ix[n0] = x[nn];
-      ix[n1] = x[nn];
-      ix[n2] = x[nn];
-      ix[n3] = x[nn];
+    for (int i=1; i<lnx[level]+1; i++) {
+      int i2 = 2*i-1;
+      for (int k=1; k<lnz[level]+1; k++) {
+        int k2 = 2*k-1;
+        int nn = i*(lnz[level]+2)+k;
+        int n0 = i2*(lnz[level+1]+2)+k2;
+        int n1 = n0 + 1;
+        int n2 = n0 + lnz[level+1]+2;
+        int n3 = n2 +1;
+        ix[n0] = x[nn];
+        ix[n1] = x[nn];
+        ix[n2] = x[nn];
+        ix[n3] = x[nn];
+      }
     }
   }
   communications(ix,level+1);
@@ -210,65 +212,98 @@ void MultigridAlg::prolongation(int level,BoutReal *x,BoutReal *ix) {
 
 void MultigridAlg::smoothings(int level, BoutReal *x, BoutReal *b) {
 
-  BoutReal val,*x0;
-  int nn,dim;
+  BoutReal *x0;
   int mm = lnz[level]+2;
-  dim = mm*(lnx[level]+2);
+  int dim = mm*(lnx[level]+2);
+  BoutReal *mat = matmg[level];
+
+  // Check the diagonal before smoothing, since exceptions
+  // can't be thrown inside OpenMP regions
+  for(int i = 1;i<lnx[level]+1;i++)
+    for(int k=1;k<lnz[level]+1;k++) {
+      int nn = i*mm+k;
+      if(fabs(mat[nn*9+4]) <atol)
+        throw BoutException("Error at matmg(%d-%d)",level,nn);
+    }
+
   if(mgsm == 0) {
     x0 = new BoutReal[dim];
     communications(x,level);
     for(int num =0;num < 2;num++) {
 #pragma omp parallel default(shared)
+      {
 #pragma omp for
-      for(int i = 0;i<dim;i++) x0[i] = x[i];    
-      for(int i = 1;i<lnx[level]+1;i++)
-#pragma omp parallel default(shared) private(nn)
+        for(int i = 0;i<dim;i++) x0[i] = x[i];
 #pragma omp for
-        for(int k=1;k<lnz[level]+1;k++) {
-          nn = i*mm+k;
-          val = b[nn] - matmg[level][nn*9+3]*x0[nn-1]
+        for(int i = 1;i<lnx[level]+1;i++)
+          for(int k=1;k<lnz[level]+1;k++) {
+            int nn = i*mm+k;
+            BoutReal val = b[nn] - matmg[level][nn*9+3]*x0[nn-1]
 	   - matmg[level][nn*9+5]*x0[nn+1] - matmg[level][nn*9+1]*x0[nn-mm]
            - matmg[level][nn*9+7]*x0[nn+mm] - matmg[level][nn*9]*x0[nn-mm-1]
            - matmg[level][nn*9+2]*x0[nn-mm+1] - matmg[level][nn*9+6]*x0[nn+mm-1]
            - matmg[level][nn*9+8]*x0[nn+mm+1];
-          if(fabs(matmg[level][nn*9+4]) <atol)
-            throw BoutException("Error at matmg(%d-%d)",level,nn);
 
-          x[nn] = (1.0-omega)*x[nn] + omega*val/matmg[level][nn*9+4];
-        } 
+            x[nn] = (1.0-omega)*x[nn] + omega*val/matmg[level][nn*9+4];
+          }
+      }
       communications(x,level);
     }
     delete [] x0;
   }
+  else if(mgsm == 2) {
+    // Multicolour Gauss-Seidel. The 9-point stencil couples all
+    // neighbours, so points are split into four colours by the parity
+    // of i and k. Points of the same colour are independent, so each
+    // colour can be updated in parallel. Symmetric: colours in forward
+    // then reverse order
+    communications(x,level);
+    for(int sweep = 0;sweep < 2;sweep++) {
+#pragma omp parallel default(shared)
+      for(int c = 0;c < 4;c++) {
+        int colour = (sweep == 0) ? c : 3-c;
+        int i0 = 1 + colour/2;
+        int k0 = 1 + colour%2;
+#pragma omp for
+        for(int i = i0;i<lnx[level]+1;i+=2) {
+          for(int k=k0;k<lnz[level]+1;k+=2) {
+            int nn = i*mm+k;
+            const BoutReal *m = &mat[nn*9];
+            BoutReal val = b[nn] - m[3]*x[nn-1] - m[5]*x[nn+1]
+              - m[1]*x[nn-mm] - m[7]*x[nn+mm] - m[0]*x[nn-mm-1]
+              - m[2]*x[nn-mm+1] - m[6]*x[nn+mm-1] - m[8]*x[nn+mm+1];
+            x[nn] = val/m[4];
+          }
+        }
+        // Implicit barrier at end of omp for
+      }
+      communications(x,level);
+    }
+  }
   else {
+    // Lexicographic Gauss-Seidel. Each point uses the updated values of
+    // the points before it in both i and k, so the sweeps are serial;
+    // use the multicolour smoother (mgsm = 2) to smooth with OpenMP
     communications(x,level);    
     for(int i = 1;i<lnx[level]+1;i++)
-#pragma omp parallel default(shared) private(nn)
-#pragma omp for
       for(int k=1;k<lnz[level]+1;k++) {
-        nn = i*mm+k;
-        val = b[nn] - matmg[level][nn*9+3]*x[nn-1]
+        int nn = i*mm+k;
+        BoutReal val = b[nn] - matmg[level][nn*9+3]*x[nn-1]
 	    - matmg[level][nn*9+5]*x[nn+1] - matmg[level][nn*9+1]*x[nn-mm]
             - matmg[level][nn*9+7]*x[nn+mm] - matmg[level][nn*9]*x[nn-mm-1]
             - matmg[level][nn*9+2]*x[nn-mm+1] - matmg[level][nn*9+6]*x[nn+mm-1]
             - matmg[level][nn*9+8]*x[nn+mm+1];
-          if(fabs(matmg[level][nn*9+4]) <atol)
-            throw BoutException("Error at matmg(%d-%d)",level,nn);
         x[nn] = val/matmg[level][nn*9+4];
       } 
     communications(x,level);
     for(int i = lnx[level];i>0;i--)
-#pragma omp parallel default(shared) private(nn)
-#pragma omp for
       for(int k= lnz[level];k>0;k--) {
-        nn = i*mm+k;
-        val = b[nn] - matmg[level][nn*9+3]*x[nn-1]
+        int nn = i*mm+k;
+        BoutReal val = b[nn] - matmg[level][nn*9+3]*x[nn-1]
 	    - matmg[level][nn*9+5]*x[nn+1] - matmg[level][nn*9+1]*x[nn-mm]
             - matmg[level][nn*9+7]*x[nn+mm] - matmg[level][nn*9]*x[nn-mm-1]
             - matmg[level][nn*9+2]*x[nn-mm+1] - matmg[level][nn*9+6]*x[nn+mm-1]
             - matmg[level][nn*9+8]*x[nn+mm+1];
-          if(fabs(matmg[level][nn*9+4]) <atol)
-            throw BoutException("Error at matmg(%d-%d)",level,nn);
         x[nn] = val/matmg[level][nn*9+4];
       } 
     communications(x,level);
@@ -483,9 +518,8 @@ BoutReal MultigridAlg::vectorProd(int level,BoutReal* x,BoutReal* y) {
   
   BoutReal val;
   BoutReal ini_e = 0.0;
+#pragma omp parallel for default(shared) reduction(+:ini_e)
   for(int i= 1;i<lnx[level]+1;i++)
-#pragma omp parallel default(shared) 
-#pragma omp for reduction(+:ini_e)
     for(int k=1;k<lnz[level]+1;k++) {
       int ii = i*(lnz[level]+2)+k;
       ini_e += x[ii]*y[ii];
@@ -502,44 +536,44 @@ void MultigridAlg::multiAVec(int level, BoutReal *x, BoutReal *b) {
   communications(x,level);
   int mm = lnz[level]+2;
 #pragma omp parallel default(shared)
+  {
 #pragma omp for
-  for(int i = 0;i<mm*(lnx[level]+2);i++) b[i] = 0.0;
-  for(int i = 1;i<lnx[level]+1;i++)
-#pragma omp parallel default(shared)
+    for(int i = 0;i<mm*(lnx[level]+2);i++) b[i] = 0.0;
 #pragma omp for
-    for(int k=1;k<lnz[level]+1;k++) {
-      int nn = i*mm+k;
-      b[nn] = matmg[level][nn*9+4]*x[nn] + matmg[level][nn*9+3]*x[nn-1]
-	+matmg[level][nn*9+5]*x[nn+1] + matmg[level][nn*9+1]*x[nn-mm]
-        +matmg[level][nn*9+7]*x[nn+mm] +matmg[level][nn*9]*x[nn-mm-1]
-        +matmg[level][nn*9+2]*x[nn-mm+1] + matmg[level][nn*9+6]*x[nn+mm-1]
-        +matmg[level][nn*9+8]*x[nn+mm+1];
-    } 
+    for(int i = 1;i<lnx[level]+1;i++)
+      for(int k=1;k<lnz[level]+1;k++) {
+        int nn = i*mm+k;
+        b[nn] = matmg[level][nn*9+4]*x[nn] + matmg[level][nn*9+3]*x[nn-1]
+          +matmg[level][nn*9+5]*x[nn+1] + matmg[level][nn*9+1]*x[nn-mm]
+          +matmg[level][nn*9+7]*x[nn+mm] +matmg[level][nn*9]*x[nn-mm-1]
+          +matmg[level][nn*9+2]*x[nn-mm+1] + matmg[level][nn*9+6]*x[nn+mm-1]
+          +matmg[level][nn*9+8]*x[nn+mm+1];
+      }
+  }
   communications(b,level);
 }
 
 void MultigridAlg::residualVec(int level, BoutReal *x, BoutReal *b,
 BoutReal *r) {
 
-  BoutReal val;
-  int mm;
   communications(x,level);
-  mm = lnz[level]+2;
+  int mm = lnz[level]+2;
 #pragma omp parallel default(shared)
+  {
 #pragma omp for
-  for(int i = 0;i<mm*(lnx[level]+2);i++) r[i] = 0.0;
-  for(int i = 1;i<lnx[level]+1;i++)
-#pragma omp parallel default(shared)
+    for(int i = 0;i<mm*(lnx[level]+2);i++) r[i] = 0.0;
 #pragma omp for
-    for(int k=1;k<lnz[level]+1;k++) {
-      int nn = i*mm+k;
-      val = matmg[level][nn*9+4]*x[nn] + matmg[level][nn*9+3]*x[nn-1]
-	+matmg[level][nn*9+5]*x[nn+1] + matmg[level][nn*9+1]*x[nn-mm]
-        +matmg[level][nn*9+7]*x[nn+mm] +matmg[level][nn*9]*x[nn-mm-1]
-        +matmg[level][nn*9+2]*x[nn-mm+1] + matmg[level][nn*9+6]*x[nn+mm-1]
-        +matmg[level][nn*9+8]*x[nn+mm+1];
-      r[nn] = b[nn]-val;
-    } 
+    for(int i = 1;i<lnx[level]+1;i++)
+      for(int k=1;k<lnz[level]+1;k++) {
+        int nn = i*mm+k;
+        BoutReal val = matmg[level][nn*9+4]*x[nn] + matmg[level][nn*9+3]*x[nn-1]
+          +matmg[level][nn*9+5]*x[nn+1] + matmg[level][nn*9+1]*x[nn-mm]
+          +matmg[level][nn*9+7]*x[nn+mm] +matmg[level][nn*9]*x[nn-mm-1]
+          +matmg[level][nn*9+2]*x[nn-mm+1] + matmg[level][nn*9+6]*x[nn+mm-1]
+          +matmg[level][nn*9+8]*x[nn+mm+1];
+        r[nn] = b[nn]-val;
+      }
+  }
   communications(r,level);
 
 }
@@ -549,14 +583,14 @@ void MultigridAlg::setMatrixC(int level) {
   BoutReal ratio = 8.0; 
 
 #pragma omp parallel default(shared)
+  {
 #pragma omp for
   for(int i=0;i<(lnx[level-1]+2)*(lnz[level-1]+2)*9;i++) { 
     matmg[level-1][i] = 0.0;
   }
+#pragma omp for
   for(int i = 1;i<lnx[level-1]+1;i++) {
     int i2 = 2*i-1;
-#pragma omp parallel default(shared)
-#pragma omp for
     for(int k = 1;k<lnz[level-1]+1;k++) {
       int k2 = 2*k-1;
       int mm = i*(lnz[level-1]+2)+k;
@@ -591,6 +625,7 @@ void MultigridAlg::setMatrixC(int level) {
       matmg[level-1][mm*9+8] = matmg[level][m3*9+8]/ratio;      
     }
   }
+  } // End of parallel region
 
 }
 
@@ -147,6 +147,7 @@ LaplaceMultigrid::LaplaceMultigrid(Options *opt) :
       output<<"with omega = "<<omega<<endl;
     }
     else if(mgsm ==1) output<<" Gauss-Seidel smoother"<<endl;
+    else if(mgsm ==2) output<<" Multicolour Gauss-Seidel smoother"<<endl;
     else throw BoutException("Undefined smoother");
     output<<"Solver type is ";
     if (mglevel == 1) output<<"PGMRES with simple Preconditioner"<<endl;
@@ -174,12 +175,127 @@ LaplaceMultigrid::~LaplaceMultigrid() {
 const FieldPerp LaplaceMultigrid::solve(const FieldPerp &b_in, const FieldPerp &x0) {
 
   TRACE("LaplaceMultigrid::solve(const FieldPerp, const FieldPerp)");
+
+  yindex = b_in.getIndex();
+  setMatrix();
+  return solveRHS(b_in, x0);
+}
+
+std::vector<FieldPerp> LaplaceMultigrid::solve(const std::vector<FieldPerp> &b) {
+  std::vector<FieldPerp> zero(b.size());
+  for(auto &f : zero) {
+    f = 0.;
+  }
+  return solve(b, zero);
+}
+
+/*!
+ * Solve for several right hand sides at the same y index. The matrix
+ * is set up once, and used for all of them
+ */
+std::vector<FieldPerp> LaplaceMultigrid::solve(const std::vector<FieldPerp> &b,
+                                               const std::vector<FieldPerp> &x0) {
+
+  TRACE("LaplaceMultigrid::solve(vector<FieldPerp>, vector<FieldPerp>)");
+
+  if(b.size() != x0.size()) {
+    throw BoutException("LaplaceMultigrid: %d right hand sides but %d initial guesses",
+                        static_cast<int>(b.size()), static_cast<int>(x0.size()));
+  }
+
+  std::vector<FieldPerp> result;
+  if(b.empty())
+    return result;
+
+  yindex = b[0].getIndex();
+  setMatrix();
+
+  for(std::size_t i=0; i<b.size(); i++) {
+    if(b[i].getIndex() != yindex)
+      throw BoutException("LaplaceMultigrid: Right hand sides at different y indices");
+    result.push_back(solveRHS(b[i], x0[i]));
+  }
+  return result;
+}
+
+/// Set the matrices on all levels for the current yindex
+void LaplaceMultigrid::setMatrix() {
+
+  TRACE("LaplaceMultigrid::setMatrix()");
+
+  BoutReal t0,t1;
+
+  int level = kMG->mglevel-1;
+  int lzz = kMG->lnz[level];
+  int lxx = kMG->lnx[level];
+
+  if(mgcount == 0) {
+    soltime = 0.0;
+    settime = 0.0;
+  }
+  else {
+    if(kMG->pcheck > 0) {
+      kMG->setPcheck(0);
+    }
+  }
   
+
+  t0 = MPI_Wtime();
+  generateMatrixF(level);  
+
+  if (kMG->xNP > 1) MPI_Barrier(commX);
+
+  if ((pcheck == 3) && (mgcount == 0)) {
+    FILE *outf;
+    char outfile[256];
+    sprintf(outfile,"test_matF_%d.mat",kMG->rProcI);
+    output<<"Out file= "<<outfile<<endl;
+    outf = fopen(outfile,"w");
+    int dim =  (lxx+2)*(lzz+2);
+    fprintf(outf,"dim = %d (%d, %d)\n",dim,lxx,lzz);
+
+    for(int i = 0;i<dim;i++) {
+      fprintf(outf,"%d ==",i);
+      for(int j=0;j<9;j++) fprintf(outf,"%12.6f,",kMG->matmg[level][i*9+j]);
+      fprintf(outf,"\n");
+    }  
+    fclose(outf);
+  }
+
+  if (level > 0) kMG->setMultigridC(0);
+
+  if((pcheck == 3) && (mgcount == 0)) {
+    for(int i = level; i> 0;i--) {
+      output<<i<<"dimension= "<<kMG->lnx[i-1]<<"("<<kMG->gnx[i-1]<<"),"<<kMG->lnz[i-1]<<endl;
+      
+      FILE *outf;
+      char outfile[256];
+      sprintf(outfile,"test_matC%1d_%d.mat",i,kMG->rProcI);
+      output<<"Out file= "<<outfile<<endl;
+      outf = fopen(outfile,"w");
+      int dim =  (kMG->lnx[i-1]+2)*(kMG->lnz[i-1]+2);
+      fprintf(outf,"dim = %d (%d,%d)\n",dim,kMG->lnx[i-1],kMG->lnz[i-1]);
+  
+      for(int ii = 0;ii<dim;ii++) {
+        fprintf(outf,"%d ==",ii);
+        for(int j=0;j<9;j++) fprintf(outf,"%12.6f,",kMG->matmg[i-1][ii*9+j]);
+        fprintf(outf,"\n");
+      }  
+      fclose(outf);
+    }
+  }
+
+  t1 = MPI_Wtime();
+  settime += t1-t0;
+}
+
+/// Solve for one right hand side, using the matrix from setMatrix()
+const FieldPerp LaplaceMultigrid::solveRHS(const FieldPerp &b_in, const FieldPerp &x0) {
+
   BoutReal t0,t1;
   
   Coordinates *coords = mesh->coordinates();
 
-  yindex = b_in.getIndex();
   int level = kMG->mglevel-1;
   int lzz = kMG->lnz[level];
   int lz2 = lzz+2;
@@ -187,19 +303,17 @@ const FieldPerp LaplaceMultigrid::solve(const FieldPerp &b_in, const FieldPerp &
 
   if ( global_flags & INVERT_START_NEW ) {
     // set initial guess to zero
+#pragma omp parallel for default(shared)
     for (int i=1; i<lxx+1; i++) {
-#pragma omp parallel default(shared) 
-#pragma omp for
       for (int k=1; k<lzz+1; k++) {
         x[i*lz2+k] = 0.;
       }
     }
   } else {
     // Read initial guess into local array, ignoring guard cells
+#pragma omp parallel for default(shared)
     for (int i=1; i<lxx+1; i++) {
       int i2 = i-1+mesh->xstart;
-#pragma omp parallel default(shared) 
-#pragma omp for
       for (int k=1; k<lzz+1; k++) {
         int k2 = k-1;
         x[i*lz2+k] = x0[i2][k2];
@@ -296,64 +410,6 @@ const FieldPerp LaplaceMultigrid::solve(const FieldPerp &b_in, const FieldPerp &
     x[(i+1)*lz2-1] = x[i*lz2+1];
   }
    
-  if(mgcount == 0) {
-    soltime = 0.0;
-    settime = 0.0;
-  }
-  else {
-    if(kMG->pcheck > 0) {
-      kMG->setPcheck(0);
-    }
-  }
-  
-
-  t0 = MPI_Wtime();
-  generateMatrixF(level);  
-
-  if (kMG->xNP > 1) MPI_Barrier(commX);
-
-  if ((pcheck == 3) && (mgcount == 0)) {
-    FILE *outf;
-    char outfile[256];
-    sprintf(outfile,"test_matF_%d.mat",kMG->rProcI);
-    output<<"Out file= "<<outfile<<endl;
-    outf = fopen(outfile,"w");
-    int dim =  (lxx+2)*(lzz+2);
-    fprintf(outf,"dim = %d (%d, %d)\n",dim,lxx,lzz);
-
-    for(int i = 0;i<dim;i++) {
-      fprintf(outf,"%d ==",i);
-      for(int j=0;j<9;j++) fprintf(outf,"%12.6f,",kMG->matmg[level][i*9+j]);
-      fprintf(outf,"\n");
-    }  
-    fclose(outf);
-  }
-
-  if (level > 0) kMG->setMultigridC(0);
-
-  if((pcheck == 3) && (mgcount == 0)) {
-    for(int i = level; i> 0;i--) {
-      output<<i<<"dimension= "<<kMG->lnx[i-1]<<"("<<kMG->gnx[i-1]<<"),"<<kMG->lnz[i-1]<<endl;
-      
-      FILE *outf;
-      char outfile[256];
-      sprintf(outfile,"test_matC%1d_%d.mat",i,kMG->rProcI);
-      output<<"Out file= "<<outfile<<endl;
-      outf = fopen(outfile,"w");
-      int dim =  (kMG->lnx[i-1]+2)*(kMG->lnz[i-1]+2);
-      fprintf(outf,"dim = %d (%d,%d)\n",dim,kMG->lnx[i-1],kMG->lnz[i-1]);
-  
-      for(int ii = 0;ii<dim;ii++) {
-        fprintf(outf,"%d ==",ii);
-        for(int j=0;j<9;j++) fprintf(outf,"%12.6f,",kMG->matmg[i-1][ii*9+j]);
-        fprintf(outf,"\n");
-      }  
-      fclose(outf);
-    }
-  }
-
-  t1 = MPI_Wtime();
-  settime += t1-t0;
   // Compute solution.
 
   mgcount++;
@@ -435,18 +491,16 @@ void LaplaceMultigrid::generateMatrixF(int level) {
   // Set (fine-level) matrix entries
 
   Coordinates *coords = mesh->coordinates();
-  int i2,k2;
   BoutReal *mat;
   mat = kMG->matmg[level];
   int llx = kMG->lnx[level];
   int llz = kMG->lnz[level];
 
+#pragma omp parallel for default(shared)
   for (int i=1; i<llx+1; i++) {
-    i2 = i-1+mesh->xstart;
-#pragma omp parallel default(shared) private(k2)
-#pragma omp for
+    int i2 = i-1+mesh->xstart;
     for (int k=1; k<llz+1; k++) {
-      k2 = k-1;
+      int k2 = k-1;
       int k2p  = (k2+1)%Nz_global;
       int k2m  = (k2+Nz_global-1)%Nz_global;
       
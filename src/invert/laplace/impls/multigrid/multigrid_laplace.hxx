@@ -136,7 +136,12 @@ private:
 };
 
 
-
+// Each kernel uses one OpenMP parallel region per call, and the
+// multicolour smoother (smtype = 2) is the only threaded smoother.
+// Still to do: solving all Y planes in one V-cycle (needs the coarse
+// solvers to handle stacked planes), keeping one OpenMP team for the
+// whole cycle, vectorising the smoothers, and gathering the coarse
+// levels onto fewer processors
 class LaplaceMultigrid : public Laplacian {
 public:
   LaplaceMultigrid(Options *opt = NULL);
@@ -158,6 +163,10 @@ public:
   
   const FieldPerp solve(const FieldPerp &b) { FieldPerp zero; zero = 0.; return solve(b, zero); }
   const FieldPerp solve(const FieldPerp &b_in, const FieldPerp &x0);
+
+  std::vector<FieldPerp> solve(const std::vector<FieldPerp> &b) override;
+  std::vector<FieldPerp> solve(const std::vector<FieldPerp> &b,
+                               const std::vector<FieldPerp> &x0) override;
   
 private:
   Field3D A,C1,C2,D; // ODE Coefficients
@@ -179,6 +188,8 @@ private:
   int comms_tagbase;
 
   void generateMatrixF(int);
+  void setMatrix(); ///< Set the matrices for yindex on all levels
+  const FieldPerp solveRHS(const FieldPerp &b_in, const FieldPerp &x0);
 };
 
 #endif // __MULTIGRID_LAPLACE_H__
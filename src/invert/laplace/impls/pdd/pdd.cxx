@@ -56,6 +56,8 @@ const FieldPerp LaplacePDD::solve(const FieldPerp &b) {
 }
 
 const Field3D LaplacePDD::solve(const Field3D &b) {
+  // Guard cells are used, so fill any waiting for communication
+  mesh->communicatePending();
   Field3D x;
   x.allocate();
   FieldPerp xperp;
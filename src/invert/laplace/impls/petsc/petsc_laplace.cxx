@@ -31,6 +31,7 @@
 #include <boutcomm.hxx>
 #include <bout/assert.hxx>
 #include <utils.hxx>
+#include <unused.hxx>
 
 #define KSP_RICHARDSON "richardson"
 #define KSP_CHEBYSHEV   "chebyshev"
@@ -60,7 +61,7 @@ static PetscErrorCode laplacePCapply(PC pc,Vec x,Vec y) {
 LaplacePetsc::LaplacePetsc(Options *opt) :
   Laplacian(opt),
   A(0.0), C1(1.0), C2(1.0), D(1.0), Ex(0.0), Ez(0.0),
-  issetD(false), issetC(false), issetE(false)
+  issetD(false), issetC(false), issetE(false), row_ncols(0)
 {
 
   // Get Options in Laplace Section
@@ -123,8 +124,6 @@ LaplacePetsc::LaplacePetsc(Options *opt) :
   MatCreate( comm, &MatA );
   MatSetSizes( MatA, localN, localN, size, size );
   MatSetFromOptions(MatA);
-  //   if (fourth_order) MatMPIAIJSetPreallocation( MatA, 25, PETSC_NULL, 10, PETSC_NULL );
-//   else MatMPIAIJSetPreallocation( MatA, 9, PETSC_NULL, 3, PETSC_NULL );
 
   /* Pre allocate memory
    * nnz denotes an array containing the number of non-zeros in the various rows
@@ -132,138 +131,69 @@ LaplacePetsc::LaplacePetsc(Options *opt) :
    * d_nnz - The diagonal terms in the matrix
    * o_nnz - The off-diagonal terms in the matrix (needed when running in
    *         parallel)
+   *
+   * The counts are exact: each row is given the number of distinct columns
+   * touched by its stencil. Boundary rows use the widest of the possible
+   * boundary conditions, so that the flags can be changed after construction
    */
+
+  // Rows owned by this processor. Needed here to decide which columns
+  // are in the diagonal block; the same as MatGetOwnershipRange after set up
+  MPI_Scan(&localN, &Iend, 1, MPI_INT, MPI_SUM, comm);
+  Istart = Iend - localN;
+
   PetscInt *d_nnz, *o_nnz;
   PetscMalloc( (localN)*sizeof(PetscInt), &d_nnz );
   PetscMalloc( (localN)*sizeof(PetscInt), &o_nnz );
-  if (fourth_order) {
-    // first and last 2*mesh-LocalNz entries are the edge x-values that (may) have 'off-diagonal' components (i.e. on another processor)
-    if ( mesh->firstX() && mesh->lastX() ) {
-      for (int i=0; i<mesh->LocalNz; i++) {
-        d_nnz[i]=15;
-        d_nnz[localN-1-i]=15;
-        o_nnz[i]=0;
-        o_nnz[localN-1-i]=0;
-      }
-      for (int i=(mesh->LocalNz); i<2*(mesh->LocalNz); i++) {
-        d_nnz[i]=20;
-        d_nnz[localN-1-i]=20;
-        o_nnz[i]=0;
-        o_nnz[localN-1-i]=0;
-      }
-    }
-    else if ( mesh->firstX() ) {
-      for (int i=0; i<mesh->LocalNz; i++) {
-        d_nnz[i]=15;
-        d_nnz[localN-1-i]=15;
-        o_nnz[i]=0;
-        o_nnz[localN-1-i]=10;
-      }
-      for (int i=(mesh->LocalNz); i<2*(mesh->LocalNz); i++) {
-        d_nnz[i]=20;
-        d_nnz[localN-1-i]=20;
-        o_nnz[i]=0;
-        o_nnz[localN-1-i]=5;
-      }
-    }
-    else if ( mesh->lastX() ) {
-      for (int i=0; i<mesh->LocalNz; i++) {
-        d_nnz[i]=15;
-        d_nnz[localN-1-i]=15;
-        o_nnz[i]=10;
-        o_nnz[localN-1-i]=0;
-      }
-      for (int i=(mesh->LocalNz); i<2*(mesh->LocalNz); i++) {
-        d_nnz[i]=20;
-        d_nnz[localN-1-i]=20;
-        o_nnz[i]=5;
-        o_nnz[localN-1-i]=0;
-      }
-    }
-    else {
-      for (int i=0; i<mesh->LocalNz; i++) {
-        d_nnz[i]=15;
-        d_nnz[localN-1-i]=15;
-        o_nnz[i]=10;
-        o_nnz[localN-1-i]=10;
-      }
-      for (int i=(mesh->LocalNz); i<2*(mesh->LocalNz); i++) {
-        d_nnz[i]=20;
-        d_nnz[localN-1-i]=20;
-        o_nnz[i]=5;
-        o_nnz[localN-1-i]=5;
-      }
-    }
 
-    for (int i=2*(mesh->LocalNz); i<localN-2*((mesh->LocalNz));i++) {
-      d_nnz[i]=25;
-        d_nnz[localN-1-i]=25;
-        o_nnz[i]=0;
-        o_nnz[localN-1-i]=0;
+  int width = fourth_order ? 2 : 1; // Half-width of the interior stencil
+  int xfirst = mesh->firstX() ? 0 : mesh->xstart;
+  int xlast  = mesh->lastX() ? mesh->LocalNx-1 : mesh->xend;
+  int row = 0;
+  for(int x=xfirst; x <= xlast; x++) {
+    // Range of X shifts used in this row. Boundary rows are one-sided
+    // and only couple points at the same z
+    int xlow = -width, xhigh = width, zwidth = width;
+    if(x < mesh->xstart) {
+      xlow = 0; xhigh = 2*width; zwidth = 0;
+    }else if(x > mesh->xend) {
+      xlow = -2*width; xhigh = 0; zwidth = 0;
     }
-
-    // Use d_nnz and o_nnz for preallocating the matrix
-    if (mesh->firstX() && mesh->lastX()) {
-      // Only one processor in X
-      MatSeqAIJSetPreallocation( MatA, 0, d_nnz );
-    }else {
-      MatMPIAIJSetPreallocation( MatA, 0, d_nnz, 0, o_nnz );
-    }
-  }
-  else {
-    // first and last mesh-LocalNz entries are the edge x-values that (may) have 'off-diagonal' components (i.e. on another processor)
-    if ( mesh->firstX() && mesh->lastX() ) {
-      for (int i=0; i<mesh->LocalNz; i++) {
-        d_nnz[i]=6;
-        d_nnz[localN-1-i]=6;
-        o_nnz[i]=0;
-        o_nnz[localN-1-i]=0;
-      }
-    }
-    else if ( mesh->firstX() ) {
-      for (int i=0; i<mesh->LocalNz; i++) {
-        d_nnz[i]=6;
-        d_nnz[localN-1-i]=6;
-        o_nnz[i]=0;
-        o_nnz[localN-1-i]=3;
-      }
-    }
-    else if ( mesh->lastX() ) {
-      for (int i=0; i<mesh->LocalNz; i++) {
-        d_nnz[i]=6;
-        d_nnz[localN-1-i]=6;
-        o_nnz[i]=3;
-        o_nnz[localN-1-i]=0;
-      }
+    // Number of distinct columns in Z (Z is periodic)
+    int nz = BOUTMIN(2*zwidth + 1, meshz);
+
+    int d = 0, o = 0;
+    for(int xshift = xlow; xshift <= xhigh; xshift++) {
+      int col = globalIndex(x, 0, xshift, 0);
+      if((col >= Istart) && (col < Iend)) {
+        d += nz;
+      }else
+        o += nz;
     }
-    else {
-      for (int i=0; i<mesh->LocalNz; i++) {
-        d_nnz[i]=6;
-        d_nnz[localN-1-i]=6;
-        o_nnz[i]=3;
-        o_nnz[localN-1-i]=3;
-      }
-    }
-
-    for (int i=mesh->LocalNz; i<localN-(mesh->LocalNz);i++) {
-      d_nnz[i]=9;
-        d_nnz[localN-1-i]=9;
-        o_nnz[i]=0;
-        o_nnz[localN-1-i]=0;
+    for(int z=0; z < meshz; z++) {
+      d_nnz[row] = d;
+      o_nnz[row] = o;
+      row++;
     }
+  }
+  if(row != localN) {
+    throw BoutException("Petsc index sanity check failed in preallocation");
+  }
 
-    // Use d_nnz and o_nnz for preallocating the matrix
-    if (mesh->firstX() && mesh->lastX()) {
-      MatSeqAIJSetPreallocation( MatA, 0, d_nnz );
-    } else {
-      MatMPIAIJSetPreallocation( MatA, 0, d_nnz, 0, o_nnz );
-    }
+  // Use d_nnz and o_nnz for preallocating the matrix
+  if (mesh->firstX() && mesh->lastX()) {
+    // Only one processor in X
+    MatSeqAIJSetPreallocation( MatA, 0, d_nnz );
+  }else {
+    MatMPIAIJSetPreallocation( MatA, 0, d_nnz, 0, o_nnz );
   }
   // Free the d_nnz and o_nnz arrays, as these are will not be used anymore
   PetscFree( d_nnz );
   PetscFree( o_nnz );
   // Sets up the internal matrix data structures for the later use.
   MatSetUp(MatA);
+  // Preallocation is exact, so any new allocation during assembly is a bug
+  MatSetOption(MatA, MAT_NEW_NONZERO_ALLOCATION_ERR, PETSC_TRUE);
 
   // Declare KSP Context (abstract PETSc object that manages all Krylov methods)
   KSPCreate( comm, &ksp );
@@ -375,6 +305,8 @@ LaplacePetsc::LaplacePetsc(Options *opt) :
   opts->get("chebyshev_max",chebyshev_max,100,true);
   opts->get("chebyshev_min",chebyshev_min,0.01,true);
   opts->get("gmres_max_steps",gmres_max_steps,30,true);
+  // Number of eigenvalues used to build the deflation space in DGMRES
+  opts->get("dgmres_eigen",dgmres_eigen,1,true);
 
   // Get Tolerances for KSP solver
   opts->get("rtol",rtol,pow(10.0,-5),true);
@@ -399,12 +331,28 @@ LaplacePetsc::LaplacePetsc(Options *opt) :
     pcsolve = Laplacian::create(opts->getSection("precon"));
   }
 
+  // Use the last solution at each Y index as the initial guess,
+  // when no initial guess is given
+  OPTION(opts, reuse_solution, false);
+  if(reuse_solution) {
+    last_solution.resize(mesh->LocalNy);
+  }
+
   // Ensure that the matrix is constructed first time
   //   coefchanged = true;
   //  lastflag = -1;
 }
 
 const FieldPerp LaplacePetsc::solve(const FieldPerp &b) {
+  if(reuse_solution && !(global_flags & INVERT_START_NEW)
+     && !((inner_boundary_flags | outer_boundary_flags) & INVERT_SET)) {
+    // Start from the solution at this Y index from the last call.
+    // Not used if x0 sets the boundary values
+    const FieldPerp &last = last_solution[b.getIndex()];
+    if(last.isAllocated()) {
+      return solve(b, last);
+    }
+  }
   return solve(b,b);
 }
 
@@ -518,6 +466,9 @@ const FieldPerp LaplacePetsc::solve(const FieldPerp &b, const FieldPerp &x0) {
                     }
                 }
 
+              // Insert the row into the matrix
+              insertRow(i, MatA);
+
               val=0; // Initialize val
 
               // Set Components of RHS
@@ -697,6 +648,9 @@ const FieldPerp LaplacePetsc::solve(const FieldPerp &b, const FieldPerp &x0) {
             val = A3 / ( 4.0 * dxdz );
             Element(i,x,z, 1, 1, val, MatA );
           }
+          // Insert the row into the matrix
+          insertRow(i, MatA);
+
           // Set Components of RHS Vector
           val  = b[x][z];
           VecSetValues( bs, 1, &i, &val, INSERT_VALUES );
@@ -758,6 +712,9 @@ const FieldPerp LaplacePetsc::solve(const FieldPerp &b, const FieldPerp &x0) {
                   }
               }
 
+              // Insert the row into the matrix
+              insertRow(i, MatA);
+
               // Set Components of RHS
               // If the inner boundary value should be set by b or x0
               val=0;
@@ -822,6 +779,10 @@ const FieldPerp LaplacePetsc::solve(const FieldPerp &b, const FieldPerp &x0) {
     else if( ksptype == KSPCHEBYSHEV ) KSPChebyshevSetEigenvalues( ksp, chebyshev_max, chebyshev_min );
 #endif
     else if( ksptype == KSPGMRES )     KSPGMRESSetRestart( ksp, gmres_max_steps );
+    else if( ksptype == KSPDGMRES ) {
+      KSPGMRESSetRestart( ksp, gmres_max_steps );
+      KSPDGMRESSetEigen( ksp, dgmres_eigen );
+    }
 
     // Set the relative and absolute tolerances
     KSPSetTolerances( ksp, rtol, atol, dtol, maxits );
@@ -855,19 +816,7 @@ const FieldPerp LaplacePetsc::solve(const FieldPerp &b, const FieldPerp &x0) {
   }
 
   // Call the actual solver
-  { Timer timer("petscsolve");
-    KSPSolve( ksp, bs, xs ); // Call the solver to solve the system
-  }
-
-  KSPConvergedReason reason;
-  KSPGetConvergedReason( ksp, &reason );
-  if (reason==-3) { // Too many iterations, might be fixed by taking smaller timestep
-    throw BoutIterationFail("petsc_laplace: too many iterations");
-  }
-  else if (reason<=0) {
-    output<<"KSPConvergedReason is "<<reason<<endl;
-    throw BoutException("petsc_laplace: inversion failed to converge.");
-  }
+  solveKSP();
 
   // Add data to FieldPerp Object
   i = Istart;
@@ -909,13 +858,118 @@ const FieldPerp LaplacePetsc::solve(const FieldPerp &b, const FieldPerp &x0) {
     throw BoutException("Petsc index sanity check 2 failed");
   }
 
+  if(reuse_solution) {
+    // Keep for the initial guess next time. Shares data with sol,
+    // which is made unique when it is next set
+    last_solution[y] = sol;
+  }
+
   // Return the solution
   return sol;
 }
 
+std::vector<FieldPerp> LaplacePetsc::solve(const std::vector<FieldPerp> &b) {
+  // As solve(b,b). The last solution is not used as the
+  // initial guess, since it is only kept for one field
+  return solve(b, b);
+}
+
+/*!
+ * Solves Ax=b for several b with the same A
+ *
+ * The matrix and the solver (including any preconditioner or LU
+ * factorisation) are set up for the first right hand side, as in
+ * solve(b, x0), and reused for the others
+ *
+ * \param[in] b     The right hand sides, all at the same y index
+ * \param[in] x0    The initial guesses, one for each b
+ *
+ * \returns The solutions x
+ */
+std::vector<FieldPerp> LaplacePetsc::solve(const std::vector<FieldPerp> &b,
+                                           const std::vector<FieldPerp> &x0) {
+  if(b.size() != x0.size()) {
+    throw BoutException("LaplacePetsc: %d right hand sides but %d initial guesses",
+                        static_cast<int>(b.size()), static_cast<int>(x0.size()));
+  }
+
+  std::vector<FieldPerp> result;
+  if(b.empty())
+    return result;
+
+  int y = b[0].getIndex();
+
+  // Set the matrix and solve for the first RHS
+  result.push_back(solve(b[0], x0[0]));
+
+  for(std::size_t n=1; n<b.size(); n++) {
+    if(b[n].getIndex() != y) {
+      throw BoutException("LaplacePetsc: Right hand sides at different y indices");
+    }
+
+    // RHS vector, using the same boundary values as solve(b, x0)
+    FieldPerp rhs;
+    rhs.allocate();
+    rhs.setIndex(y);
+    for(int x=0; x<mesh->LocalNx; x++) {
+      int flags = 0;
+      if(mesh->firstX() && (x < mesh->xstart)) {
+        flags = inner_boundary_flags;
+      }else if(mesh->lastX() && (x > mesh->xend)) {
+        flags = outer_boundary_flags;
+      }else {
+        // Main domain
+        flags = INVERT_RHS;
+      }
+      for(int z=0; z<mesh->LocalNz; z++) {
+        if(flags & INVERT_RHS) {
+          rhs[x][z] = b[n][x][z];
+        }else if(flags & INVERT_SET) {
+          rhs[x][z] = x0[n][x][z];
+        }else
+          rhs[x][z] = 0.0;
+      }
+    }
+    fieldToVec(rhs, bs);
+
+    // Initial guess
+    fieldToVec(x0[n], xs);
+
+    solveKSP();
+
+    FieldPerp x;
+    vecToField(xs, x);
+    x.setIndex(y);
+    result.push_back(x);
+  }
+
+  return result;
+}
+
+/// Solve with the current matrix, RHS bs and initial guess xs
+void LaplacePetsc::solveKSP() {
+  { Timer timer("petscsolve");
+    KSPSolve( ksp, bs, xs ); // Call the solver to solve the system
+  }
+
+  KSPConvergedReason reason;
+  KSPGetConvergedReason( ksp, &reason );
+  if (reason==-3) { // Too many iterations, might be fixed by taking smaller timestep
+    throw BoutIterationFail("petsc_laplace: too many iterations");
+  }
+  else if (reason<=0) {
+    output<<"KSPConvergedReason is "<<reason<<endl;
+    throw BoutException("petsc_laplace: inversion failed to converge.");
+  }
+}
+
 /*!
  * Sets the elements of the matrix A, which is used to solve the problem Ax=b.
  *
+ * The elements are collected into a buffer for the current row, and
+ * inserted with a single call to MatSetValues by insertRow(). If the same
+ * column is set more than once, the last value is used.
+ *
  * \param[in]
  * i
  * The row of the PETSc matrix
@@ -928,10 +982,50 @@ const FieldPerp LaplacePetsc::solve(const FieldPerp &b, const FieldPerp &x0) {
  *
  * \param[out] MatA     The matrix A used in the inversion
  */
-void LaplacePetsc::Element(int i, int x, int z,
+void LaplacePetsc::Element(int UNUSED(i), int x, int z,
                            int xshift, int zshift,
-                           PetscScalar ele, Mat &MatA ) {
+                           PetscScalar ele, Mat &UNUSED(MatA) ) {
+
+  int index = globalIndex(x, z, xshift, zshift);
+
+  for(int c = 0; c < row_ncols; c++) {
+    if(row_cols[c] == index) {
+      // Already set: replace, as INSERT_VALUES would
+      row_vals[c] = ele;
+      return;
+    }
+  }
+
+  ASSERT1(row_ncols < max_row_cols);
+  row_cols[row_ncols] = index;
+  row_vals[row_ncols] = ele;
+  row_ncols++;
+}
+
+/*!
+ * Inserts the elements collected by Element() into row \p i of \p MatA,
+ * then clears the row buffer
+ */
+void LaplacePetsc::insertRow(int i, Mat &MatA) {
+  /* Inserts or adds a block of values into a matrix
+   * Input:
+   * MatA     - The matrix to set the values in
+   * 1        - The number of rows to be set
+   * &i       - The global index of the row
+   * row_ncols - The number of columns to be set
+   * row_cols - The global indices of the columns
+   * row_vals - The values to be set
+   * INSERT_VALUES replaces existing entries with new values
+   */
+  MatSetValues(MatA, 1, &i, row_ncols, row_cols, row_vals, INSERT_VALUES);
+  row_ncols = 0;
+}
 
+/*!
+ * Global index in the PETSc matrix of the point at local (x+xshift, z+zshift)
+ * Z is periodic, so z+zshift is wrapped into the range 0 to meshz-1.
+ */
+int LaplacePetsc::globalIndex(int x, int z, int xshift, int zshift) {
   // Need to convert LOCAL x to GLOBAL x in order to correctly calculate
   // PETSC Matrix Index.
   int xoffset = Istart / meshz;
@@ -948,19 +1042,7 @@ void LaplacePetsc::Element(int i, int x, int z,
   else if( col_new > meshz-1 ) col_new -= meshz;
 
   // Convert to global indices
-  int index = (row_new * meshz) + col_new;
-
-  /* Inserts or adds a block of values into a matrix
-   * Input:
-   * MatA   - The matrix to set the values in
-   * 1      - The number of rows to be set
-   * &i     - The global index of the row
-   * 1      - The number of columns to be set
-   * &index - The global index of the column
-   * &ele   - The vlaue to be set
-   * INSERT_VALUES replaces existing entries with new values
-   */
-  MatSetValues(MatA,1,&i,1,&index,&ele,INSERT_VALUES);
+  return (row_new * meshz) + col_new;
 }
 
 /*!
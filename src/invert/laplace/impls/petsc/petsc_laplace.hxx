@@ -64,6 +64,8 @@ public:
 #include <bout/petsclib.hxx>
 #include <boutexception.hxx>
 
+#include <vector>
+
 class LaplacePetsc : public Laplacian {
 public:
   LaplacePetsc(Options *opt = NULL);
@@ -95,10 +97,16 @@ public:
   const FieldPerp solve(const FieldPerp &b);
   const FieldPerp solve(const FieldPerp &b, const FieldPerp &x0);
 
+  std::vector<FieldPerp> solve(const std::vector<FieldPerp> &b) override;
+  std::vector<FieldPerp> solve(const std::vector<FieldPerp> &b,
+                               const std::vector<FieldPerp> &x0) override;
+
   int precon(Vec x, Vec y); ///< Preconditioner function
 
 private:
   void Element(int i, int x, int z, int xshift, int zshift, PetscScalar ele, Mat &MatA );
+  void insertRow(int i, Mat &MatA);
+  int globalIndex(int x, int z, int xshift, int zshift);
   void Coeffs( int x, int y, int z, BoutReal &A1, BoutReal &A2, BoutReal &A3, BoutReal &A4, BoutReal &A5 );
 
   /* Ex and Ez
@@ -119,6 +127,15 @@ private:
 
   FieldPerp sol;              // solution Field
 
+  // Entries of the matrix row being set by Element, inserted by insertRow
+  static const int max_row_cols = 25;
+  PetscInt row_cols[max_row_cols];
+  PetscScalar row_vals[max_row_cols];
+  int row_ncols;
+
+  bool reuse_solution;                 // Use the last solution as the initial guess
+  std::vector<FieldPerp> last_solution; // Last solution at each Y index
+
   // Istart is the first row of MatA owned by the process, Iend is 1 greater than the last row.
   int Istart, Iend;
 
@@ -136,6 +153,7 @@ private:
   BoutReal richardson_damping_factor;
   BoutReal chebyshev_max, chebyshev_min;
   int gmres_max_steps;
+  int dgmres_eigen;
 
   // Convergence Parameters. Solution is considered converged if |r_k| < max( rtol * |b| , atol )
   // where r_k = b - Ax_k. The solution is considered diverged if |r_k| > dtol * |b|.
@@ -152,6 +170,7 @@ private:
 
   void vecToField(Vec x, FieldPerp &f);        // Copy a vector into a fieldperp
   void fieldToVec(const FieldPerp &f, Vec x);  // Copy a fieldperp into a vector
+  void solveKSP();                             // Solve with the current matrix, bs and xs
 
   #if CHECK > 0
     int implemented_flags;
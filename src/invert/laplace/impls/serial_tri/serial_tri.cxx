@@ -31,12 +31,12 @@
 #include <utils.hxx>
 #include <fft.hxx>
 #include <lapack_routines.hxx>
-#include <bout/constants.hxx>
 #include <cmath>
 
 #include <output.hxx>
 
-LaplaceSerialTri::LaplaceSerialTri(Options *opt) : Laplacian(opt), A(0.0), C(1.0), D(1.0) {
+LaplaceSerialTri::LaplaceSerialTri(Options *opt)
+    : Laplacian(opt), A(0.0), C(1.0), D(1.0), coef_version(0) {
 
   if(!mesh->firstX() || !mesh->lastX()) {
     throw BoutException("LaplaceSerialTri only works for mesh->NXPE = 1");
@@ -47,7 +47,7 @@ LaplaceSerialTri::LaplaceSerialTri(Options *opt) : Laplacian(opt), A(0.0), C(1.0
   int ncz = mesh->LocalNz;
 
   bk = matrix<dcomplex>(mesh->LocalNx, ncz/2 + 1);
-  bk1d = new dcomplex[mesh->LocalNx];
+  bk1d = matrix<dcomplex>(maxmode + 1, mesh->LocalNx);
 
   //Initialise bk to 0 as we only visit 0<= kz <= maxmode in solve
   for(int kz=maxmode+1; kz < ncz/2 + 1; kz++){
@@ -57,7 +57,7 @@ LaplaceSerialTri::LaplaceSerialTri(Options *opt) : Laplacian(opt), A(0.0), C(1.0
   }
 
   xk = matrix<dcomplex>(mesh->LocalNx, ncz/2 + 1);
-  xk1d = new dcomplex[mesh->LocalNx];
+  xk1d = matrix<dcomplex>(maxmode + 1, mesh->LocalNx);
 
   //Initialise xk to 0 as we only visit 0<= kz <= maxmode in solve
   for(int kz=maxmode+1; kz < ncz/2 + 1; kz++){
@@ -66,54 +66,99 @@ LaplaceSerialTri::LaplaceSerialTri(Options *opt) : Laplacian(opt), A(0.0), C(1.0
     }
   }
 
-  avec = new dcomplex[mesh->LocalNx];
-  bvec = new dcomplex[mesh->LocalNx];
-  cvec = new dcomplex[mesh->LocalNx];
+  avec = matrix<dcomplex>(maxmode + 1, mesh->LocalNx);
+  bvec = matrix<dcomplex>(maxmode + 1, mesh->LocalNx);
+  cvec = matrix<dcomplex>(maxmode + 1, mesh->LocalNx);
+
+  // All modes are solved together. If periodic in X then the
+  // guard cells are not included in the cyclic system
+  int nsolve = mesh->LocalNx;
+  if (mesh->periodicX) {
+    nsolve -= 2 * mesh->xstart;
+  }
+  rhs = Array<dcomplex>(nsolve * (maxmode + 1));
+
+  // Matrices are calculated and factorised when first needed
+  ymatrices.resize(mesh->LocalNy);
 }
 
 LaplaceSerialTri::~LaplaceSerialTri() {
   free_matrix(bk);
-  delete[] bk1d;
+  free_matrix(bk1d);
   free_matrix(xk);
-  delete[] xk1d;
+  free_matrix(xk1d);
+
+  free_matrix(avec);
+  free_matrix(bvec);
+  free_matrix(cvec);
+}
 
-  delete[] avec;
-  delete[] bvec;
-  delete[] cvec;
+void LaplaceSerialTri::setCoef(Field2D &coef, const Field2D &val) {
+  // The legacy interface sets every coefficient before each solve, so
+  // the matrices are only recalculated if the values change
+  bool same = coef.isAllocated() && val.isAllocated();
+  for (int jx = 0; same && (jx < mesh->LocalNx); jx++) {
+    for (int jy = 0; jy < mesh->LocalNy; jy++) {
+      if (coef(jx, jy) != val(jx, jy)) {
+        same = false;
+        break;
+      }
+    }
+  }
+  if (!same) {
+    coef = copy(val);
+    coef_version++;
+  }
 }
 
 const FieldPerp LaplaceSerialTri::solve(const FieldPerp &b) {
   return solve(b,b);   // Call the solver below
 }
 
+const FieldPerp LaplaceSerialTri::solve(const FieldPerp &b, const FieldPerp &x0) {
+  return solve(std::vector<FieldPerp>{b}, std::vector<FieldPerp>{x0})[0];
+}
+
+std::vector<FieldPerp> LaplaceSerialTri::solve(const std::vector<FieldPerp> &b) {
+  return solve(b, b);
+}
+
 /*!
- * Solve Ax=b for x given b
+ * Solve Ax=b for x given b, for several b
  *
  * This function will
- *      1. Take the fourier transform of the y-slice given in the input
- *      2. For each fourier mode
- *          a) Set up the tridiagonal matrix
- *          b) Call the solver which inverts the matrix Ax_mode = b_mode
- *      3. Collect all the modes in a 2D array
- *      4. Back transform the y-slice
+ *      1. Set up the tridiagonal matrix for each fourier mode
+ *      2. For each right hand side
+ *          a) Take the fourier transform of the y-slice given in the input
+ *          b) Invert the matrices Ax_mode = b_mode for all modes together,
+ *             using BatchedTridag. The factorised matrices are kept for each
+ *             Y index, and reused until the coefficients, flags or metric
+ *             change. Modes whose matrices are not diagonally dominant are
+ *             solved separately with tridag, which pivots if LAPACK is used
+ *          c) Back transform the y-slice
  *
  * Input:
- * \param[in] b     A 2D variable that will be fourier decomposed, each fourier
- *                  mode of this variable is going to be the right hand side of
- *                  the equation Ax = b
- * \param[in] x0    Variable used to set BC (if the right flags are set, see
- *                  the user manual)
+ * \param[in] b     2D variables that will be fourier decomposed, each fourier
+ *                  mode of these variables is going to be the right hand side
+ *                  of the equation Ax = b. All must be at the same y index
+ * \param[in] x0    Variables used to set BC (if the right flags are set, see
+ *                  the user manual), one for each b
  *
- * \param[out] x    The inverted variable.
+ * \param[out] x    The inverted variables.
  */
-const FieldPerp LaplaceSerialTri::solve(const FieldPerp &b, const FieldPerp &x0) {
-  FieldPerp x;
-  x.allocate();
+std::vector<FieldPerp> LaplaceSerialTri::solve(const std::vector<FieldPerp> &b,
+                                               const std::vector<FieldPerp> &x0) {
+  if (b.size() != x0.size()) {
+    throw BoutException("LaplaceSerialTri: %d right hand sides but %d initial guesses",
+                        static_cast<int>(b.size()), static_cast<int>(x0.size()));
+  }
 
-  Coordinates *coord = mesh->coordinates();
+  std::vector<FieldPerp> result;
+  if (b.empty()) {
+    return result;
+  }
 
-  int jy = b.getIndex();
-  x.setIndex(jy);
+  int jy = b[0].getIndex();
 
   int ncz = mesh->LocalNz; // No of z pnts (counts from 1 to easily convert to kz)
   int ncx = mesh->LocalNx-1; // No of x pnts (counts from 0)
@@ -131,112 +176,179 @@ const FieldPerp LaplaceSerialTri::solve(const FieldPerp &b, const FieldPerp &x0)
   if (outer_boundary_flags & INVERT_BNDRY_ONE)
     outbndry = 1;
 
-  #pragma omp parallel for
-  for (int ix = 0; ix < mesh->LocalNx; ix++) {
-    /* This for loop will set the bk (initialized by the constructor)
-     * bk is the z fourier modes of b in z
-     * If the INVERT_SET flag is set (meaning that x0 will be used to set the
-     * bounadry values),
-     */
-    if (((ix < inbndry) && (inner_boundary_flags & INVERT_SET)) ||
-        ((ncx - ix < outbndry) && (outer_boundary_flags & INVERT_SET))) {
-      // Use the values in x0 in the boundary
-
-      // x0 is the input
-      // bk is the output
-      rfft(x0[ix], ncz, bk[ix]);
+  int nmode = maxmode + 1;
+
+  // If periodic in X then cyclic tridiagonal, excluding the guard cells
+  int xs = mesh->periodicX ? mesh->xstart : 0;
+  int nsolve = mesh->LocalNx - 2 * xs;
+
+  // The matrices at this Y index can be reused if nothing they
+  // depend on has changed since they were calculated
+  YMatrices &ym = ymatrices[jy];
+  int metric_version = mesh->coordinates()->metricVersion();
+  bool reuse = ym.valid && (ym.coef_version == coef_version) &&
+               (ym.metric_version == metric_version) &&
+               (ym.global_flags == global_flags) &&
+               (ym.inner_boundary_flags == inner_boundary_flags) &&
+               (ym.outer_boundary_flags == outer_boundary_flags);
+
+  // Modes whose matrices are not diagonally dominant. BatchedTridag
+  // doesn't pivot, so these are solved one at a time
+  std::vector<bool> pivot(nmode, false);
+
+  for (std::size_t i = 0; i < b.size(); i++) {
+    if (b[i].getIndex() != jy) {
+      throw BoutException("LaplaceSerialTri: Right hand sides at different y indices");
+    }
 
-    } else {
-      // b is the input
-      // bk is the output
-      rfft(b[ix], ncz, bk[ix]);
+    FieldPerp x;
+    x.allocate();
+    x.setIndex(jy);
+
+    #pragma omp parallel for
+    for (int ix = 0; ix < mesh->LocalNx; ix++) {
+      /* This for loop will set the bk (initialized by the constructor)
+       * bk is the z fourier modes of b in z
+       * If the INVERT_SET flag is set (meaning that x0 will be used to set the
+       * bounadry values),
+       */
+      if (((ix < inbndry) && (inner_boundary_flags & INVERT_SET)) ||
+          ((ncx - ix < outbndry) && (outer_boundary_flags & INVERT_SET))) {
+        // Use the values in x0 in the boundary
+
+        // x0 is the input
+        // bk is the output
+        rfft(x0[i][ix], ncz, bk[ix]);
+
+      } else {
+        // b is the input
+        // bk is the output
+        rfft(b[i][ix], ncz, bk[ix]);
+      }
     }
-  }
 
-  /* Solve differential equation in x for each fourier mode
-   * Note that only the non-degenerate fourier modes are being used (i.e. the
-   * offset and all the modes up to the Nyquist frequency)
-   */
-  for (int kz = 0; kz <= maxmode; kz++) {
-    
-    // set bk1d
+    /* Solve differential equation in x for each fourier mode
+     * Note that only the non-degenerate fourier modes are being used (i.e. the
+     * offset and all the modes up to the Nyquist frequency)
+     */
     for (int ix = 0; ix <= ncx; ix++) {
-      // Get bk of the current fourier mode
-      bk1d[ix] = bk[ix][kz];
+      for (int kz = 0; kz < nmode; kz++) {
+        bk1d[kz][ix] = bk[ix][kz];
+      }
     }
 
-    /* Set the matrix A used in the inversion of Ax=b
-     * by calling tridagCoef and setting the BC
-     *
-     * Note that A, C and D in
-     *
-     * D*Laplace_perp(x) + (1/C)Grad_perp(C)*Grad_perp(x) + Ax = B
-     *
-     * has nothing to do with
-     * avec - the lower diagonal of the tridiagonal matrix
-     * bvec - the main diagonal
-     * cvec - the upper diagonal
-    */
-    tridagMatrix(avec, bvec, cvec, bk1d, jy,
-                 // wave number index
-                 kz,
-                 // wave number (different from kz only if we are taking a part
-                 // of the z-domain [and not from 0 to 2*pi])
-                 kz*2.0*PI/coord->zlength(),
-                 global_flags, inner_boundary_flags, outer_boundary_flags,
-                 &A, &C, &D);
-
-    ///////// PERFORM INVERSION /////////
-    if (!mesh->periodicX) {
-      // Call tridiagonal solver
-      tridag(avec, bvec, cvec, bk1d, xk1d, mesh->LocalNx);
+    if ((i == 0) && !reuse) {
+      /* Set the matrix A used in the inversion of Ax=b for every mode
+       * by calling tridagCoef and setting the BC
+       *
+       * Note that A, C and D in
+       *
+       * D*Laplace_perp(x) + (1/C)Grad_perp(C)*Grad_perp(x) + Ax = B
+       *
+       * has nothing to do with
+       * avec - the lower diagonal of the tridiagonal matrix
+       * bvec - the main diagonal
+       * cvec - the upper diagonal
+       */
+      tridagMatrix(avec, bvec, cvec, bk1d, jy,
+                   global_flags, inner_boundary_flags, outer_boundary_flags,
+                   &A, &C, &D);
+
+      ym.tri.setup(nmode, nsolve);
+      ym.tri.setPeriodic(mesh->periodicX);
+      bool any_pivot = false;
+      for (int kz = 0; kz < nmode; kz++) {
+        if (BatchedTridag<dcomplex>::diagonallyDominant(
+                nsolve, avec[kz] + xs, bvec[kz] + xs, cvec[kz] + xs, mesh->periodicX)) {
+          ym.tri.setCoefs(kz, avec[kz] + xs, bvec[kz] + xs, cvec[kz] + xs);
+        } else {
+          pivot[kz] = any_pivot = true;
+          ym.tri.setIdentity(kz);
+        }
+      }
 
+      // avec, bvec and cvec are overwritten at other Y indices, so
+      // can't be kept for the modes which need them
+      ym.valid = !any_pivot;
+      ym.coef_version = coef_version;
+      ym.metric_version = metric_version;
+      ym.global_flags = global_flags;
+      ym.inner_boundary_flags = inner_boundary_flags;
+      ym.outer_boundary_flags = outer_boundary_flags;
     } else {
-      // Periodic in X, so cyclic tridiagonal
+      // Same matrix, so only the boundary values of the RHS are needed
+      for (int kz = 0; kz < nmode; kz++) {
+        tridagBoundaryRHS(bk1d[kz], global_flags, inner_boundary_flags,
+                          outer_boundary_flags);
+      }
+    }
 
-      int xs = mesh->xstart;
-      cyclic_tridag(avec + xs, bvec + xs, cvec + xs, bk1d + xs, xk1d + xs,
-                    mesh->LocalNx - 2 * xs);
+    ///////// PERFORM INVERSION /////////
+    for (int ix = 0; ix < nsolve; ix++) {
+      for (int kz = 0; kz < nmode; kz++) {
+        rhs[ix * nmode + kz] = bk1d[kz][ix + xs];
+      }
+    }
+
+    ym.tri.solve(rhs.begin(), nmode);
+
+    for (int kz = 0; kz < nmode; kz++) {
+      if (pivot[kz]) {
+        if (mesh->periodicX) {
+          cyclic_tridag(avec[kz] + xs, bvec[kz] + xs, cvec[kz] + xs, bk1d[kz] + xs,
+                        xk1d[kz] + xs, nsolve);
+        } else {
+          tridag(avec[kz], bvec[kz], cvec[kz], bk1d[kz], xk1d[kz], nsolve);
+        }
+      } else {
+        for (int ix = 0; ix < nsolve; ix++) {
+          xk1d[kz][ix + xs] = rhs[ix * nmode + kz];
+        }
+      }
 
       // Copy boundary regions
       for (int ix = 0; ix < xs; ix++) {
-        xk1d[ix] = xk1d[mesh->LocalNx - 2*xs + ix];
-        xk1d[mesh->LocalNx - xs + ix] = xk1d[xs + ix];
+        xk1d[kz][ix] = xk1d[kz][mesh->LocalNx - 2*xs + ix];
+        xk1d[kz][mesh->LocalNx - xs + ix] = xk1d[kz][xs + ix];
       }
     }
 
     // If the global flag is set to INVERT_KX_ZERO
-    if ((global_flags & INVERT_KX_ZERO) && (kz == 0)) {
+    if (global_flags & INVERT_KX_ZERO) {
       dcomplex offset(0.0);
       for (int ix = mesh->xstart; ix <= mesh->xend; ix++) {
-        offset += xk1d[ix];
+        offset += xk1d[0][ix];
       }
       offset /= static_cast<BoutReal>(mesh->xend - mesh->xstart + 1);
       for (int ix = mesh->xstart; ix <= mesh->xend; ix++) {
-        xk1d[ix] -= offset;
+        xk1d[0][ix] -= offset;
       }
     }
 
-    // Store the solution xk for the current fourier mode in a 2D array
-    for (int ix=0; ix<=ncx; ix++){
-      xk[ix][kz]=xk1d[ix];
+    // Store the solution xk for all fourier modes in a 2D array
+    for (int ix = 0; ix <= ncx; ix++) {
+      for (int kz = 0; kz < nmode; kz++) {
+        xk[ix][kz] = xk1d[kz][ix];
+      }
     }
-  }
 
-  // Done inversion, transform back
-  for(int ix=0; ix<=ncx; ix++){
+    // Done inversion, transform back
+    for(int ix=0; ix<=ncx; ix++){
 
-    if(global_flags & INVERT_ZERO_DC)
-      xk[ix][0] = 0.0;
+      if(global_flags & INVERT_ZERO_DC)
+        xk[ix][0] = 0.0;
 
-    irfft(xk[ix], ncz, x[ix]);
+      irfft(xk[ix], ncz, x[ix]);
 
 #if CHECK > 2
-    for(int kz=0;kz<ncz;kz++)
-      if(!finite(x(ix,kz)))
-        throw BoutException("Non-finite at %d, %d, %d", ix, jy, kz);
+      for(int kz=0;kz<ncz;kz++)
+        if(!finite(x(ix,kz)))
+          throw BoutException("Non-finite at %d, %d, %d", ix, jy, kz);
 #endif
+    }
+
+    result.push_back(x);
   }
 
-  return x; // Result of the inversion
+  return result; // Result of the inversion
 }
@@ -32,6 +32,9 @@ class LaplaceSerialTri;
 #include <invert_laplace.hxx>
 #include <dcomplex.hxx>
 #include <options.hxx>
+#include <batched_tridag.hxx>
+
+#include <vector>
 
 class LaplaceSerialTri : public Laplacian {
 public:
@@ -39,11 +42,11 @@ public:
   ~LaplaceSerialTri();
 
   using Laplacian::setCoefA;
-  void setCoefA(const Field2D &val) override { A = val; }
+  void setCoefA(const Field2D &val) override { setCoef(A, val); }
   using Laplacian::setCoefC;
-  void setCoefC(const Field2D &val) override { C = val; }
+  void setCoefC(const Field2D &val) override { setCoef(C, val); }
   using Laplacian::setCoefD;
-  void setCoefD(const Field2D &val) override { D = val; }
+  void setCoefD(const Field2D &val) override { setCoef(D, val); }
   using Laplacian::setCoefEx;
   void setCoefEx(const Field2D &UNUSED(val)) override {
     throw BoutException("LaplaceSerialTri does not have Ex coefficient");
@@ -56,23 +59,33 @@ public:
   using Laplacian::solve;
   const FieldPerp solve(const FieldPerp &b);
   const FieldPerp solve(const FieldPerp &b, const FieldPerp &x0);
+
+  std::vector<FieldPerp> solve(const std::vector<FieldPerp> &b) override;
+  std::vector<FieldPerp> solve(const std::vector<FieldPerp> &b,
+                               const std::vector<FieldPerp> &x0) override;
 private:
   // The coefficents in
   // D*grad_perp^2(x) + (1/C)*(grad_perp(C))*grad_perp(x) + A*x = b
+  // These are copies, so are not changed by later changes to the inputs
   Field2D A, C, D;
+  int coef_version; ///< Incremented when the values of A, C or D change
+
+  /// Set \p coef to a copy of \p val, if the values are different
+  void setCoef(Field2D &coef, const Field2D &val);
 
   /* Allocation fo
    * bk   = The fourier transformed of b, where b is one of the inputs in
    *        LaplaceSerialTri::solve()
-   * bk1d = The 1d array of bk
+   * bk1d = bk transposed, indexed [kz][ix]
    * xk   = The fourier transformed of x, where x the output of
    *        LaplaceSerialTri::solve()
-   * xk1d = The 1d array of xk
+   * xk1d = xk transposed, indexed [kz][ix]
    */
-  dcomplex **bk, *bk1d;
-  dcomplex **xk, *xk1d;
+  dcomplex **bk, **bk1d;
+  dcomplex **xk, **xk1d;
 
-  /* Coefficents in the tridiagonal solver matrix
+  /* Coefficents in the tridiagonal solver matrix for each fourier mode,
+   * indexed [kz][ix]
    * Following the notation in "Numerical recipes"
    * avec is the lower diagonal of the matrix
    * bvec is the diagonal of the matrix
@@ -80,7 +93,20 @@ private:
    * NOTE: Do not confuse avec, bvec and cvec with the A, C, and D coefficients
    *       above
    */
-  dcomplex *avec, *bvec, *cvec;
+  dcomplex **avec, **bvec, **cvec;
+
+  /// The factorised matrices for all fourier modes at one Y index,
+  /// and the settings they were calculated with. These are reused
+  /// while the coefficients, flags and metric are unchanged
+  struct YMatrices {
+    bool valid = false;
+    int coef_version, metric_version;
+    int global_flags, inner_boundary_flags, outer_boundary_flags;
+    BatchedTridag<dcomplex> tri; ///< Solves all modes together
+  };
+  std::vector<YMatrices> ymatrices; ///< Indexed by Y
+  /// Right hand side and solution in interleaved form [ix][kz]
+  Array<dcomplex> rhs;
 };
 
 #endif // __SERIAL_TRI_H__
@@ -113,6 +113,8 @@ const FieldPerp LaplaceSPT::solve(const FieldPerp &b, const FieldPerp &x0) {
  * in the config file uses less memory, and less communication overlap
  */
 const Field3D LaplaceSPT::solve(const Field3D &b) {
+  // Guard cells are used, so fill any waiting for communication
+  mesh->communicatePending();
   Timer timer("invert");
   Field3D x;
   x.allocate();
@@ -148,6 +150,8 @@ const Field3D LaplaceSPT::solve(const Field3D &b) {
 }
 
 const Field3D LaplaceSPT::solve(const Field3D &b, const Field3D &x0) {
+  // Guard cells are used, so fill any waiting for communication
+  mesh->communicatePending();
   if(  ((inner_boundary_flags & INVERT_SET) && mesh->firstX()) ||
        ((outer_boundary_flags & INVERT_SET) && mesh->lastX()) ) {
     Field3D bs = copy(b);
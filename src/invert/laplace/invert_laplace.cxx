@@ -126,6 +126,9 @@ void Laplacian::cleanup() {
 const Field3D Laplacian::solve(const Field3D &b) {
   TRACE("Laplacian::solve(Field3D)");
 
+  // Guard cells are used, so fill any waiting for communication
+  mesh->communicatePending();
+
   Timer timer("invert");
   int ys = mesh->ystart, ye = mesh->yend;
 
@@ -182,6 +185,9 @@ const Field2D Laplacian::solve(const Field2D &b) {
 const Field3D Laplacian::solve(const Field3D &b, const Field3D &x0) {
   TRACE("Laplacian::solve(Field3D, Field3D)");
 
+  // Guard cells are used, so fill any waiting for communication
+  mesh->communicatePending();
+
   Timer timer("invert");
 
   // Setting the start and end range of the y-slices
@@ -218,6 +224,136 @@ const Field2D Laplacian::solve(const Field2D &b, const Field2D &x0) {
   return DC(f);
 }
 
+std::vector<FieldPerp> Laplacian::solve(const std::vector<FieldPerp> &b) {
+  std::vector<FieldPerp> x;
+  for(const auto &f : b) {
+    x.push_back(solve(f));
+  }
+  return x;
+}
+
+std::vector<FieldPerp> Laplacian::solve(const std::vector<FieldPerp> &b,
+                                        const std::vector<FieldPerp> &x0) {
+  if(b.size() != x0.size()) {
+    throw BoutException("Laplacian::solve: %d right hand sides but %d initial guesses",
+                        static_cast<int>(b.size()), static_cast<int>(x0.size()));
+  }
+  std::vector<FieldPerp> x;
+  for(std::size_t i=0; i<b.size(); i++) {
+    x.push_back(solve(b[i], x0[i]));
+  }
+  return x;
+}
+
+/*!
+ * Inverts several fields with the same operator, as
+ * solve(const Field3D &b) does for one
+ */
+std::vector<Field3D> Laplacian::solve(const std::vector<Field3D> &b) {
+  TRACE("Laplacian::solve(vector<Field3D>)");
+
+  // Guard cells are used, so fill any waiting for communication
+  mesh->communicatePending();
+
+  Timer timer("invert");
+  int ys = mesh->ystart, ye = mesh->yend;
+
+  if(mesh->hasBndryLowerY()) {
+    if (include_yguards)
+      ys = 0; // Mesh contains a lower boundary and we are solving in the guard cells
+
+    ys += extra_yguards_lower;
+  }
+  if(mesh->hasBndryUpperY()) {
+    if (include_yguards)
+      ye = mesh->LocalNy-1; // Contains upper boundary and we are solving in the guard cells
+
+    ye -= extra_yguards_upper;
+  }
+
+  std::vector<Field3D> x(b.size());
+  for(auto &f : x) {
+    f.allocate();
+  }
+
+  int status = 0;
+  try {
+    std::vector<FieldPerp> slices(b.size());
+    for(int jy=ys; jy <= ye; jy++) {
+      // Slice all fields, and solve them together
+      for(std::size_t i=0; i<b.size(); i++) {
+        slices[i] = sliceXZ(b[i], jy);
+      }
+      std::vector<FieldPerp> result = solve(slices);
+      for(std::size_t i=0; i<b.size(); i++) {
+        x[i] = result[i];
+      }
+    }
+  }
+  catch (BoutIterationFail itfail) {
+    status = 1;
+  }
+  BoutParallelThrowRhsFail(status, "Laplacian inversion took too many iterations.");
+
+  for(std::size_t i=0; i<b.size(); i++) {
+    x[i].setLocation(b[i].getLocation());
+  }
+
+  return x;
+}
+
+std::vector<Field3D> Laplacian::solve(const std::vector<Field3D> &b,
+                                      const std::vector<Field3D> &x0) {
+  TRACE("Laplacian::solve(vector<Field3D>, vector<Field3D>)");
+
+  // Guard cells are used, so fill any waiting for communication
+  mesh->communicatePending();
+
+  if(b.size() != x0.size()) {
+    throw BoutException("Laplacian::solve: %d right hand sides but %d initial guesses",
+                        static_cast<int>(b.size()), static_cast<int>(x0.size()));
+  }
+
+  Timer timer("invert");
+
+  // Setting the start and end range of the y-slices
+  int ys = mesh->ystart, ye = mesh->yend;
+  if(mesh->hasBndryLowerY() && include_yguards)
+    ys = 0; // Mesh contains a lower boundary
+  if(mesh->hasBndryUpperY() && include_yguards)
+    ye = mesh->LocalNy-1; // Contains upper boundary
+
+  std::vector<Field3D> x(b.size());
+  for(auto &f : x) {
+    f.allocate();
+  }
+
+  int status = 0;
+  try {
+    std::vector<FieldPerp> bslices(b.size()), xslices(b.size());
+    for(int jy=ys; jy <= ye; jy++) {
+      for(std::size_t i=0; i<b.size(); i++) {
+        bslices[i] = sliceXZ(b[i], jy);
+        xslices[i] = sliceXZ(x0[i], jy);
+      }
+      std::vector<FieldPerp> result = solve(bslices, xslices);
+      for(std::size_t i=0; i<b.size(); i++) {
+        x[i] = result[i];
+      }
+    }
+  }
+  catch (BoutIterationFail itfail) {
+    status = 1;
+  }
+  BoutParallelThrowRhsFail(status, "Laplacian inversion took too many iterations.");
+
+  for(std::size_t i=0; i<b.size(); i++) {
+    x[i].setLocation(b[i].getLocation());
+  }
+
+  return x;
+}
+
 /**********************************************************************************
  *                              MATRIX ELEMENTS
  **********************************************************************************/
@@ -423,18 +559,15 @@ void Laplacian::tridagMatrix(dcomplex *avec, dcomplex *bvec, dcomplex *cvec,
       bvec[ix] += (*a)(xs+ix,jy);
   }
 
+  // Set the boundary values of the RHS
+  tridagBoundaryRHS(bk, global_flags, inner_boundary_flags, outer_boundary_flags,
+                    includeguards);
+
   // Set the boundary conditions if x is not periodic
   if(!mesh->periodicX) {
     if(mesh->firstX()) {
       // INNER BOUNDARY ON THIS PROCESSOR
 
-      // If no user specified value is set on inner boundary, set the first
-      // element in b (in the equation AX=b) to 0
-      if(!(inner_boundary_flags & (INVERT_RHS | INVERT_SET))) {
-        for(int ix=0;ix<inbndry;ix++)
-          bk[ix] = 0.;
-      }
-
       // DC i.e. kz = 0 (the offset mode)
       if(kz == 0) {
 
@@ -591,14 +724,6 @@ void Laplacian::tridagMatrix(dcomplex *avec, dcomplex *bvec, dcomplex *cvec,
     if(mesh->lastX()) {
       // OUTER BOUNDARY ON THIS PROCESSOR
 
-      // If no user specified value is set on outer boundary, set the last
-      // element in b (in the equation AX=b) to 0
-      if(!(outer_boundary_flags & (INVERT_RHS | INVERT_SET))) {
-        for (int ix=0;ix<outbndry;ix++) {
-          bk[ncx-ix] = 0.;
-        }
-      }
-
       // DC i.e. kz = 0 (the offset mode)
       if(kz==0) {
 
@@ -698,6 +823,54 @@ void Laplacian::tridagMatrix(dcomplex *avec, dcomplex *bvec, dcomplex *cvec,
   }
 }
 
+/*!
+ * Set the boundary elements of the RHS of Ax=b
+ *
+ * If no user specified value is set on the inner (outer) boundary, set
+ * the first (last) elements in b to 0. Called by tridagMatrix, and can be
+ * used on its own for further right hand sides of the same matrix.
+ *
+ * \param[inout] bk    The b in Ax = b
+ * \param[in] global_flags, inner_boundary_flags, outer_boundary_flags
+ *                      As passed to tridagMatrix
+ * \param[in] includeguards  Whether bk includes the guard cells,
+ *                      as in tridagMatrix
+ */
+void Laplacian::tridagBoundaryRHS(dcomplex *bk, int global_flags,
+                                  int inner_boundary_flags, int outer_boundary_flags,
+                                  bool includeguards) {
+  if(mesh->periodicX)
+    return;
+
+  int xs = 0;
+  int xe = mesh->LocalNx-1;
+  if(!includeguards) {
+    if(!mesh->firstX())
+      xs = mesh->xstart;
+    if(!mesh->lastX())
+      xe = mesh->xend;
+  }
+  int ncx = xe - xs;
+
+  int inbndry = 2, outbndry=2;
+  if((global_flags & INVERT_BOTH_BNDRY_ONE) || (mesh->xstart < 2))  {
+    inbndry = outbndry = 1;
+  }
+  if(inner_boundary_flags & INVERT_BNDRY_ONE)
+    inbndry = 1;
+  if(outer_boundary_flags & INVERT_BNDRY_ONE)
+    outbndry = 1;
+
+  if(mesh->firstX() && !(inner_boundary_flags & (INVERT_RHS | INVERT_SET))) {
+    for(int ix=0;ix<inbndry;ix++)
+      bk[ix] = 0.;
+  }
+  if(mesh->lastX() && !(outer_boundary_flags & (INVERT_RHS | INVERT_SET))) {
+    for (int ix=0;ix<outbndry;ix++)
+      bk[ncx-ix] = 0.;
+  }
+}
+
 /**********************************************************************************
  *                              LEGACY INTERFACE
  *
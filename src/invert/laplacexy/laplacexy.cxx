@@ -511,6 +511,8 @@ LaplaceXY::~LaplaceXY() {
 }
 
 const Field2D LaplaceXY::solve(const Field2D &rhs, const Field2D &x0) {
+  // Guard cells are used, so fill any waiting for communication
+  mesh->communicatePending();
   Timer timer("invert");
   
   // Load initial guess x0 into xs and rhs into bs
@@ -166,6 +166,8 @@ void LaplaceXZcyclic::setCoefs(const Field2D &A2D, const Field2D &B2D) {
 }
 
 Field3D LaplaceXZcyclic::solve(const Field3D &rhs, const Field3D &x0) {
+  // Guard cells are used, so fill any waiting for communication
+  mesh->communicatePending();
   Timer timer("invert");
   
   // Create the rhs array
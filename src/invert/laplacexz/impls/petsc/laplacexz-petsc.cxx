@@ -301,12 +301,9 @@ void LaplaceXZpetsc::setCoefs(const Field3D &Ain, const Field3D &Bin) {
          *       see note about BC in LaplaceXZ constructor for more details
          */
         for(int z=0; z < mesh->LocalNz; z++) {
-          PetscScalar val = 1.0;
-          MatSetValues(it->MatA,1,&row,1,&row,&val,INSERT_VALUES);
-
-          int col = row + (mesh->LocalNz); // +1 in X
-          val = -1.0;
-          MatSetValues(it->MatA,1,&row,1,&col,&val,INSERT_VALUES);
+          PetscInt cols[2] = {row, row + (mesh->LocalNz)}; // +1 in X
+          PetscScalar vals[2] = {1.0, -1.0};
+          MatSetValues(it->MatA,1,&row,2,cols,vals,INSERT_VALUES);
 
           row++;
         }
@@ -314,12 +311,9 @@ void LaplaceXZpetsc::setCoefs(const Field3D &Ain, const Field3D &Bin) {
       else if(inner_boundary_flags & INVERT_SET){
         // Setting BC from x0
         for(int z=0; z < mesh->LocalNz; z++) {
-          PetscScalar val = 1.0;
-          MatSetValues(it->MatA,1,&row,1,&row,&val,INSERT_VALUES);
-
-          int col = row + (mesh->LocalNz); // +1 in X
-          val = 0.0;
-          MatSetValues(it->MatA,1,&row,1,&col,&val,INSERT_VALUES);
+          PetscInt cols[2] = {row, row + (mesh->LocalNz)}; // +1 in X
+          PetscScalar vals[2] = {1.0, 0.0};
+          MatSetValues(it->MatA,1,&row,2,cols,vals,INSERT_VALUES);
 
           row++;
         }
@@ -327,12 +321,9 @@ void LaplaceXZpetsc::setCoefs(const Field3D &Ain, const Field3D &Bin) {
       else if(inner_boundary_flags & INVERT_RHS){
         // Setting BC from b
         for(int z=0; z < mesh->LocalNz; z++) {
-          PetscScalar val = 1.0;
-          MatSetValues(it->MatA,1,&row,1,&row,&val,INSERT_VALUES);
-
-          int col = row + (mesh->LocalNz); // +1 in X
-          val = 0.0;
-          MatSetValues(it->MatA,1,&row,1,&col,&val,INSERT_VALUES);
+          PetscInt cols[2] = {row, row + (mesh->LocalNz)}; // +1 in X
+          PetscScalar vals[2] = {1.0, 0.0};
+          MatSetValues(it->MatA,1,&row,2,cols,vals,INSERT_VALUES);
 
           row++;
         }
@@ -343,12 +334,9 @@ void LaplaceXZpetsc::setCoefs(const Field3D &Ain, const Field3D &Bin) {
          *       see note about BC in LaplaceXZ constructor for more details
          */
         for(int z=0; z < mesh->LocalNz; z++) {
-          PetscScalar val = 1.0;
-          MatSetValues(it->MatA,1,&row,1,&row,&val,INSERT_VALUES);
-
-          int col = row + (mesh->LocalNz); // +1 in X
-          val = -1.0;
-          MatSetValues(it->MatA,1,&row,1,&col,&val,INSERT_VALUES);
+          PetscInt cols[2] = {row, row + (mesh->LocalNz)}; // +1 in X
+          PetscScalar vals[2] = {1.0, -1.0};
+          MatSetValues(it->MatA,1,&row,2,cols,vals,INSERT_VALUES);
 
           row++;
         }
@@ -419,30 +407,25 @@ void LaplaceXZpetsc::setCoefs(const Field3D &Ain, const Field3D &Bin) {
         /////////////////////////////////////////////////
         // Now have a 5-point stencil for the Laplacian
 
-        // Set the centre (diagonal)
-        MatSetValues(it->MatA,1,&row,1,&row,&c,INSERT_VALUES);
-
-        // X + 1
-        int col = row + (mesh->LocalNz);
-        MatSetValues(it->MatA,1,&row,1,&col,&xp,INSERT_VALUES);
+        // Insert the whole row with one call
+        // Centre (diagonal), X + 1, X - 1, Z + 1, Z - 1
+        PetscInt cols[5];
+        cols[0] = row;
+        cols[1] = row + (mesh->LocalNz);
+        cols[2] = row - (mesh->LocalNz);
 
-        // X - 1
-        col = row - (mesh->LocalNz);
-        MatSetValues(it->MatA,1,&row,1,&col,&xm,INSERT_VALUES);
-
-        // Z + 1
-        col = row + 1;
+        cols[3] = row + 1;
         if(z == mesh->LocalNz-1) {
-          col -= mesh->LocalNz;  // Wrap around
+          cols[3] -= mesh->LocalNz;  // Wrap around
         }
-        MatSetValues(it->MatA,1,&row,1,&col,&zp,INSERT_VALUES);
 
-        // Z - 1
-        col = row - 1;
+        cols[4] = row - 1;
         if(z == 0) {
-          col += mesh->LocalNz;  // Wrap around
+          cols[4] += mesh->LocalNz;  // Wrap around
         }
-        MatSetValues(it->MatA,1,&row,1,&col,&zm,INSERT_VALUES);
+
+        PetscScalar vals[5] = {c, xp, xm, zp, zm};
+        MatSetValues(it->MatA,1,&row,5,cols,vals,INSERT_VALUES);
 
         row++;
       }
@@ -454,12 +437,9 @@ void LaplaceXZpetsc::setCoefs(const Field3D &Ain, const Field3D &Bin) {
       if (outer_boundary_flags & INVERT_AC_GRAD){
         // Neumann 0
         for(int z=0; z < mesh->LocalNz; z++) {
-          PetscScalar val = 1.0;
-          MatSetValues(it->MatA,1,&row,1,&row,&val,INSERT_VALUES);
-
-          int col = row - (mesh->LocalNz); // -1 in X
-          val = -1.0;
-          MatSetValues(it->MatA,1,&row,1,&col,&val,INSERT_VALUES);
+          PetscInt cols[2] = {row, row - (mesh->LocalNz)}; // -1 in X
+          PetscScalar vals[2] = {1.0, -1.0};
+          MatSetValues(it->MatA,1,&row,2,cols,vals,INSERT_VALUES);
 
           row++;
         }
@@ -467,12 +447,9 @@ void LaplaceXZpetsc::setCoefs(const Field3D &Ain, const Field3D &Bin) {
       else if (outer_boundary_flags & INVERT_SET){
         // Setting BC from x0
         for(int z=0; z < mesh->LocalNz; z++) {
-          PetscScalar val = 1.0;
-          MatSetValues(it->MatA,1,&row,1,&row,&val,INSERT_VALUES);
-
-          int col = row - (mesh->LocalNz); // -1 in X
-          val = 0.0;
-          MatSetValues(it->MatA,1,&row,1,&col,&val,INSERT_VALUES);
+          PetscInt cols[2] = {row, row - (mesh->LocalNz)}; // -1 in X
+          PetscScalar vals[2] = {1.0, 0.0};
+          MatSetValues(it->MatA,1,&row,2,cols,vals,INSERT_VALUES);
 
           row++;
         }
@@ -480,25 +457,19 @@ void LaplaceXZpetsc::setCoefs(const Field3D &Ain, const Field3D &Bin) {
       else if (outer_boundary_flags & INVERT_RHS){
         // Setting BC from b
         for(int z=0; z < mesh->LocalNz; z++) {
-          PetscScalar val = 1.0;
-          MatSetValues(it->MatA,1,&row,1,&row,&val,INSERT_VALUES);
-
-          int col = row - (mesh->LocalNz); // -1 in X
-          val = 0.0;
-          MatSetValues(it->MatA,1,&row,1,&col,&val,INSERT_VALUES);
+          PetscInt cols[2] = {row, row - (mesh->LocalNz)}; // -1 in X
+          PetscScalar vals[2] = {1.0, 0.0};
+          MatSetValues(it->MatA,1,&row,2,cols,vals,INSERT_VALUES);
 
           row++;
         }
       }
       else{
         //Default: Dirichlet on outer X boundary
-        PetscScalar val = 0.5;
-
         for(int z=0; z < mesh->LocalNz; z++) {
-          MatSetValues(it->MatA,1,&row,1,&row,&val,INSERT_VALUES);
-
-          int col = row - (mesh->LocalNz); // -1 in X
-          MatSetValues(it->MatA,1,&row,1,&col,&val,INSERT_VALUES);
+          PetscInt cols[2] = {row, row - (mesh->LocalNz)}; // -1 in X
+          PetscScalar vals[2] = {0.5, 0.5};
+          MatSetValues(it->MatA,1,&row,2,cols,vals,INSERT_VALUES);
 
           row++;
         }
@@ -572,6 +543,9 @@ Field3D LaplaceXZpetsc::solve(const Field3D &bin, const Field3D &x0in) {
    * result    - The solved x (returned as a Field3D) in the matrix problem Ax=b
    */
 
+  // Guard cells are used, so fill any waiting for communication
+  mesh->communicatePending();
+
   TRACE("LaplaceXZpetsc::solve");
 
   if(!coefs_set) {
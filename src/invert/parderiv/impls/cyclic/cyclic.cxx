@@ -48,98 +48,109 @@
 
 #include <cmath>
 
-InvertParCR::InvertParCR(Options *opt) : InvertPar(opt), A(1.0), B(0.0), C(0.0), D(0.0), E(0.0) {
+InvertParCR::InvertParCR(Options *opt) : InvertPar(opt), A(1.0), B(0.0), C(0.0), D(0.0), E(0.0), coefs_set(false) {
   // Number of k equations to solve for each x location
   nsys = 1 + (mesh->LocalNz)/2; 
 
   rhs = matrix<dcomplex>(mesh->LocalNy, nsys);
   
-  // Find out if we are on a boundary
-  int size = mesh->LocalNy-4;
-  SurfaceIter surf(mesh);
-  for(surf.first(); !surf.isDone(); surf.next()) {
-    BoutReal ts;
-    int n = mesh->LocalNy-4;
-    if(!surf.closed(ts)) {
-      // Open field line
-      if(surf.firstY())
-        n += 2;
-      if(surf.lastY())
-        n += 2;
-      
-      if(n > size)
-        size = n; // Maximum size
-    }
-  }
-  
-  rhsk = matrix<dcomplex>(nsys, size);
-  xk = matrix<dcomplex>(nsys, size);
-  a = matrix<dcomplex>(nsys, size);
-  b = matrix<dcomplex>(nsys, size);
-  c = matrix<dcomplex>(nsys, size);
+  createBatches();
 }
 
 InvertParCR::~InvertParCR() {
   free_matrix(rhs);
   
-  free_matrix(rhsk);
-  free_matrix(xk);
-  free_matrix(a);
-  free_matrix(b);
-  free_matrix(c);
+  for(auto &batch : batches) {
+    free_matrix(batch.rhsk);
+    free_matrix(batch.xk);
+  }
 }
 
-const Field3D InvertParCR::solve(const Field3D &f) {
-  TRACE("InvertParCR::solve(Field3D)");
-  
-  Field3D result;
-  result.allocate();
-  
-  Coordinates *coord = mesh->coordinates();
-  
-  // Create cyclic reduction object
-  CyclicReduce<dcomplex> *cr = 
-    new CyclicReduce<dcomplex>();
-  
-  // Loop over flux-surfaces
+void InvertParCR::createBatches() {
+  // Surfaces can be solved together if they share a communicator,
+  // and have the same boundaries (so the same number of rows)
   SurfaceIter surf(mesh);
   for(surf.first(); !surf.isDone(); surf.next()) {
-    int x = surf.xpos;
-    
-    // Test if open or closed field-lines
-    BoutReal ts;
+    MPI_Comm comm = surf.communicator();
+    BoutReal ts = 0.0;
     bool closed = surf.closed(ts);
-
-    // Number of rows
-    int y0 = 0, size = mesh->LocalNy-4; // If no boundaries
-    if(!closed) {
-      if(surf.firstY()) {
-        y0 += 2;
-        size += 2;
+    bool first = surf.firstY();
+    bool last = surf.lastY();
+    
+    SurfaceBatch *batch = nullptr;
+    for(auto &b : batches) {
+      if((b.comm == comm) && (b.closed == closed) && (b.first == first) && (b.last == last)) {
+        batch = &b;
+        break;
       }
-      if(surf.lastY())
-        size += 2;
     }
-      
-    // Setup CyclicReduce object
-    cr->setup(surf.communicator(), size);
-    cr->setPeriodic(closed);
     
-    // Take Fourier transform 
-    for(int y=0;y<mesh->LocalNy-4;y++)
-      rfft(f(x,y+2), mesh->LocalNz, rhs[y+y0]);
+    if(!batch) {
+      // Start a new batch
+      batches.emplace_back();
+      batch = &batches.back();
+      
+      batch->comm = comm;
+      batch->closed = closed;
+      batch->first = first;
+      batch->last = last;
+      
+      // Number of rows
+      batch->y0 = 0;
+      batch->size = mesh->LocalNy-4; // If no boundaries
+      if(first) {
+        batch->y0 += 2;
+        batch->size += 2;
+      }
+      if(last)
+        batch->size += 2;
+    }
+    batch->xpos.push_back(surf.xpos);
+    batch->ts.push_back(ts);
+  }
+
+  for(auto &batch : batches) {
+    int nsurf = batch.xpos.size();
+    batch.rhsk = matrix<dcomplex>(nsurf*nsys, batch.size);
+    batch.xk = matrix<dcomplex>(nsurf*nsys, batch.size);
+
+    batch.cr = std::unique_ptr<CyclicReduce<dcomplex>>(new CyclicReduce<dcomplex>());
+    batch.cr->setup(batch.comm, batch.size);
+    batch.cr->setPeriodic(batch.closed);
+  }
+}
+
+void InvertParCR::setBatchCoefs(SurfaceBatch &batch) {
+  TRACE("InvertParCR::setBatchCoefs");
+  
+  Coordinates *coord = mesh->coordinates();
+  
+  int nsurf = batch.xpos.size();
+  int y0 = batch.y0, size = batch.size;
+  
+  dcomplex **a = matrix<dcomplex>(nsurf*nsys, size);
+  dcomplex **b = matrix<dcomplex>(nsurf*nsys, size);
+  dcomplex **c = matrix<dcomplex>(nsurf*nsys, size);
+  
+  int rank, np;
+  MPI_Comm_rank(batch.comm, &rank);
+  MPI_Comm_size(batch.comm, &np);
+  
+  for(int s=0; s<nsurf; s++) {
+    int x = batch.xpos[s];
     
     // Set up tridiagonal system
     for(int k=0; k<nsys; k++) {
+      int sys = s*nsys + k; // Index of this system in the batch
       BoutReal kwave=k*2.0*PI/coord->zlength(); // wave number is 1/[rad]
       for(int y=0;y<mesh->LocalNy-4;y++) {
         
-	BoutReal acoef = A(x, y+2);                     // Constant
-	BoutReal bcoef = B(x, y+2) / coord->g_22(x,y+2); // d2dy2
+        BoutReal acoef = A(x, y+2);                     // Constant
+        BoutReal bcoef = B(x, y+2) / coord->g_22(x,y+2); // d2dy2
         BoutReal ccoef = C(x, y+2);                     // d2dydz
         BoutReal dcoef = D(x, y+2);                     // d2dz2
         BoutReal ecoef = E(x, y+2);                     // ddy
-	
+        
         bcoef /= SQ(coord->dy(x, y+2));
         ccoef /= coord->dy(x,y+2)*coord->dz;
         dcoef /= SQ(coord->dz);
@@ -147,78 +158,117 @@ const Field3D InvertParCR::solve(const Field3D &f) {
         
         //           const     d2dy2        d2dydz             d2dz2           ddy
         //           -----     -----        ------             -----           ---
-	a[k][y+y0] =            bcoef - 0.5*Im*kwave*ccoef                  -0.5*ecoef;
-	b[k][y+y0] = acoef - 2.*bcoef                     - SQ(kwave)*dcoef;
-	c[k][y+y0] =            bcoef + 0.5*Im*kwave*ccoef                  +0.5*ecoef;
-	
-	rhsk[k][y+y0] = rhs[y+y0][k]; // Transpose
+        a[sys][y+y0] =            bcoef - 0.5*Im*kwave*ccoef                  -0.5*ecoef;
+        b[sys][y+y0] = acoef - 2.*bcoef                     - SQ(kwave)*dcoef;
+        c[sys][y+y0] =            bcoef + 0.5*Im*kwave*ccoef                  +0.5*ecoef;
       }
     }
-
-    if(closed) {
+    
+    if(batch.closed) {
       // Twist-shift
-      int rank, np;
-      MPI_Comm_rank(surf.communicator(), &rank);
-      MPI_Comm_size(surf.communicator(), &np);
+      BoutReal ts = batch.ts[s];
       if(rank == 0) {
         for(int k=0; k<nsys; k++) {
           BoutReal kwave=k*2.0*PI/coord->zlength(); // wave number is 1/[rad]
           dcomplex phase(cos(kwave*ts) , -sin(kwave*ts));
-          a[k][0] *= phase;
+          a[s*nsys + k][0] *= phase;
         }
       }
       if(rank == np-1) {
         for(int k=0; k<nsys; k++) {
           BoutReal kwave=k*2.0*PI/coord->zlength(); // wave number is 1/[rad]
           dcomplex phase(cos(kwave*ts) , sin(kwave*ts));
-          c[k][mesh->LocalNy-5] *= phase;
+          c[s*nsys + k][mesh->LocalNy-5] *= phase;
         }
       }
     }else {
       // Open surface, so may have boundaries
-      if(surf.firstY()) {
+      if(batch.first) {
         for(int k=0; k<nsys; k++) {
           for(int y=0;y<2;y++) {
-            a[k][y] =  0.;
-            b[k][y] =  1.;
-            c[k][y] = -1.;
-            
-            rhsk[k][y] = 0.;
+            a[s*nsys + k][y] =  0.;
+            b[s*nsys + k][y] =  1.;
+            c[s*nsys + k][y] = -1.;
           }
         }
       }
-      if(surf.lastY()) {
+      if(batch.last) {
         for(int k=0; k<nsys; k++) {
           for(int y=size-2;y<size;y++) {
-            a[k][y] = -1.;
-            b[k][y] =  1.;
-            c[k][y] =  0.;
-            
-            rhsk[k][y] = 0.;
+            a[s*nsys + k][y] = -1.;
+            b[s*nsys + k][y] =  1.;
+            c[s*nsys + k][y] =  0.;
           }
         }
       }
     }
+  }
+  
+  // CyclicReduce keeps a copy of the coefficients
+  batch.cr->setCoefs(nsurf*nsys, a, b, c);
+  
+  free_matrix(a);
+  free_matrix(b);
+  free_matrix(c);
+}
+
+const Field3D InvertParCR::solve(const Field3D &f) {
+  TRACE("InvertParCR::solve(Field3D)");
+  
+  Field3D result;
+  result.allocate();
+  
+  if(!coefs_set) {
+    // Coefficients only depend on A-E and the metric, so are only
+    // recalculated when one of the coefficients is changed
+    for(auto &batch : batches)
+      setBatchCoefs(batch);
+    coefs_set = true;
+  }
+  
+  for(auto &batch : batches) {
+    int nsurf = batch.xpos.size();
+    int y0 = batch.y0, size = batch.size;
     
-    // Solve cyclic tridiagonal system for each k
-    cr->setCoefs(nsys, a, b, c);
-    cr->solve(nsys, rhsk, xk);
-    
-    // Put back into rhs array
-    for(int k=0;k<nsys;k++) {
-      for(int y=0;y<size;y++)
-        rhs[y][k] = xk[k][y];
+    for(int s=0; s<nsurf; s++) {
+      int x = batch.xpos[s];
+      
+      // Take Fourier transform 
+      for(int y=0;y<mesh->LocalNy-4;y++)
+        rfft(f(x,y+2), mesh->LocalNz, rhs[y+y0]);
+      
+      for(int k=0; k<nsys; k++) {
+        dcomplex *rk = batch.rhsk[s*nsys + k];
+        for(int y=0;y<mesh->LocalNy-4;y++)
+          rk[y+y0] = rhs[y+y0][k]; // Transpose
+        
+        // Boundary rows
+        if(batch.first) {
+          rk[0] = rk[1] = 0.;
+        }
+        if(batch.last) {
+          rk[size-2] = rk[size-1] = 0.;
+        }
+      }
     }
     
-    // Inverse Fourier transform 
-    for(int y=0;y<size;y++)
-      irfft(rhs[y], mesh->LocalNz, result(x,y+2-y0));
+    // Solve cyclic tridiagonal systems for all surfaces and k together
+    batch.cr->solve(nsurf*nsys, batch.rhsk, batch.xk);
     
+    for(int s=0; s<nsurf; s++) {
+      int x = batch.xpos[s];
+      
+      // Put back into rhs array
+      for(int k=0;k<nsys;k++) {
+        for(int y=0;y<size;y++)
+          rhs[y][k] = batch.xk[s*nsys + k][y];
+      }
+      
+      // Inverse Fourier transform 
+      for(int y=0;y<size;y++)
+        irfft(rhs[y], mesh->LocalNz, result(x,y+2-y0));
+    }
   }
   
-  // Delete cyclic reduction object
-  delete cr;
-
   return result;
 }
-
@@ -41,6 +41,10 @@
 
 #include "invert_parderiv.hxx"
 #include "dcomplex.hxx"
+#include <cyclic_reduction.hxx>
+
+#include <memory>
+#include <vector>
 
 class InvertParCR : public InvertPar {
 public:
@@ -51,15 +55,15 @@ public:
   const Field3D solve(const Field3D &f) override;
 
   using InvertPar::setCoefA;
-  void setCoefA(const Field2D &f) override { A = f; }
+  void setCoefA(const Field2D &f) override { A = f; coefs_set = false; }
   using InvertPar::setCoefB;
-  void setCoefB(const Field2D &f) override { B = f; }
+  void setCoefB(const Field2D &f) override { B = f; coefs_set = false; }
   using InvertPar::setCoefC;
-  void setCoefC(const Field2D &f) override { C = f; }
+  void setCoefC(const Field2D &f) override { C = f; coefs_set = false; }
   using InvertPar::setCoefD;
-  void setCoefD(const Field2D &f) override { D = f; }
+  void setCoefD(const Field2D &f) override { D = f; coefs_set = false; }
   using InvertPar::setCoefE;
-  void setCoefE(const Field2D &f) override { E = f; }
+  void setCoefE(const Field2D &f) override { E = f; coefs_set = false; }
 
 private:
   Field2D A, B, C, D, E;
@@ -67,9 +71,34 @@ private:
   int nsys;
   
   dcomplex **rhs;
-  dcomplex **rhsk;
-  dcomplex **xk;
-  dcomplex **a, **b, **c; // Matrix coefficients
+
+  /// A group of flux surfaces which share a Y communicator and the
+  /// same boundary layout. All surfaces in a batch are solved together
+  /// in a single cyclic reduction, so communication is per batch
+  /// rather than per surface.
+  struct SurfaceBatch {
+    MPI_Comm comm;         ///< Y communicator shared by all surfaces
+    bool closed;           ///< Periodic in Y?
+    bool first, last;      ///< Boundary at lower / upper Y on this processor
+    int y0, size;          ///< Offset of first interior point, and rows per system
+    std::vector<int> xpos; ///< X index of each surface in the batch
+    std::vector<BoutReal> ts; ///< Twist-shift angle of each (closed) surface
+
+    /// Solver, which keeps the coefficients between calls
+    std::unique_ptr<CyclicReduce<dcomplex>> cr;
+    
+    dcomplex **rhsk, **xk; ///< RHS and result [nsurf*nsys][size]
+  };
+  std::vector<SurfaceBatch> batches;
+
+  bool coefs_set; ///< Are the coefficients in the batch solvers up to date?
+  
+  /// Group flux surfaces into batches. Called once from the constructor
+  void createBatches();
+  
+  /// Calculate the matrix coefficients for all surfaces in \p batch
+  /// and pass them to its CyclicReduce solver
+  void setBatchCoefs(SurfaceBatch &batch);
 };
 
 
@@ -10,6 +10,7 @@
 #include <output.hxx>
 #include <bout/constants.hxx>
 #include <bout/assert.hxx>
+#include <bout/openmpwrap.hxx>
 
 #include <derivs.hxx>
 #include <interpolation.hxx>
@@ -17,7 +18,8 @@
 
 #include <globals.hxx>
 
-Coordinates::Coordinates(Mesh *mesh) {
+Coordinates::Coordinates(Mesh *mesh)
+    : coefs_ny(0), coefs_valid(false), metric_version(0) {
 
   dx = 1.0;
   dy = 1.0;
@@ -184,6 +186,9 @@ Coordinates::Coordinates(Mesh *mesh) {
       IntShiftTorsion = 0.0;
     }
   }
+
+  // Use FFTs in Delp2, or finite differences
+  Options::getRoot()->getSection("mesh")->get("delp2_fft", delp2_fft, true);
 }
 
 void Coordinates::outputVars(Datafile &file) {
@@ -211,6 +216,8 @@ void Coordinates::outputVars(Datafile &file) {
 int Coordinates::geometry() {
   TRACE("Coordinates::geometry");
 
+  invalidateCoefs();
+
   output_progress.write("Calculating differential geometry terms\n");
 
   if (min(abs(dx)) < 1e-8)
@@ -366,12 +373,17 @@ int Coordinates::geometry() {
   } else {
     d1_dy = -d2y / (dy * dy);
   }
+
+  // Calculated here rather than on first use, which may be inside a
+  // team of threads (see bout/openmpwrap.hxx)
+  calcCoefs();
   
   return 0;
 }
 
 int Coordinates::calcCovariant() {
   TRACE("Coordinates::calcCovariant");
+  invalidateCoefs();
 
   // Make sure metric elements are allocated
   g_11.allocate();
@@ -434,6 +446,7 @@ int Coordinates::calcCovariant() {
 
 int Coordinates::calcContravariant() {
   TRACE("Coordinates::calcContravariant");
+  invalidateCoefs();
 
   // Make sure metric elements are allocated
   g11.allocate();
@@ -495,6 +508,7 @@ int Coordinates::calcContravariant() {
 
 int Coordinates::jacobian() {
   TRACE("Coordinates::jacobian");
+  invalidateCoefs();
   // calculate Jacobian using g^-1 = det[g^ij], J = sqrt(g)
 
   Field2D g = g11 * g22 * g33 + 2.0 * g12 * g13 * g23 - g11 * g23 * g23 -
@@ -522,14 +536,109 @@ int Coordinates::jacobian() {
   return 0;
 }
 
+/*******************************************************************************
+ * Cached metric coefficients
+ *
+ *******************************************************************************/
+
+void Coordinates::calcCoefs() {
+  TRACE("Coordinates::calcCoefs");
+
+  // Note: Can't use DDY member function here, since that uses the coefficients
+  Field2D sg = sqrt(g_22);
+  Field2D grad2_par2 = mesh->indexDDY(1. / sg) / (dy * sg);
+  Field2D laplace_par = mesh->indexDDY(J / g_22) / (dy * J);
+
+  coefs_ny = mesh->LocalNy;
+  metric_coefs.resize(mesh->LocalNx * coefs_ny);
+
+  for (int jx = 0; jx < mesh->LocalNx; jx++) {
+    for (int jy = 0; jy < mesh->LocalNy; jy++) {
+      MetricCoefs &c = metric_coefs[jx * coefs_ny + jy];
+      c.one_over_dx = 1. / dx(jx, jy);
+      c.one_over_dy = 1. / dy(jx, jy);
+      c.one_over_sqrt_g22 = 1. / sg(jx, jy);
+      c.one_over_g22 = 1. / g_22(jx, jy);
+      c.grad2_par2_coef = grad2_par2(jx, jy);
+      c.laplace_par_coef = laplace_par(jx, jy);
+    }
+  }
+
+  coefs_valid = true;
+}
+
+void Coordinates::checkCoefs() {
+  if(coefs_valid)
+    return;
+
+  if(ompTeam()) {
+    // All threads have read coefs_valid before the master changes it
+    ompBarrier();
+    ompMaster([&]() { calcCoefs(); });
+    return;
+  }
+  calcCoefs();
+}
+
+void Coordinates::multiplyCoef(Field2D &f, BoutReal MetricCoefs::*c) {
+  checkCoefs();
+  f.allocate(); // Make sure data is unique
+
+  for (int jx = 0; jx < mesh->LocalNx; jx++) {
+    for (int jy = 0; jy < mesh->LocalNy; jy++) {
+      f(jx, jy) *= coefs(jx, jy).*c;
+    }
+  }
+}
+
+void Coordinates::multiplyCoef(Field3D &f, BoutReal MetricCoefs::*c) {
+  checkCoefs();
+
+  if(ompTeam()) {
+    // f may be shared with the other threads, so the product is put
+    // into a new shared field rather than each thread copying f
+    Field3D result(mesh);
+    result.allocateTeam();
+    {
+      OmpWorkshare workshare;
+      for(const auto &i : result)
+        result[i] = f[i] * (coefs(i.x, i.y).*c);
+    }
+    result.setLocation(f.getLocation());
+    f = result;
+    return;
+  }
+
+  f.allocate(); // Make sure data is unique
+
+  int ncz = f.getNz();
+  for (int jx = 0; jx < mesh->LocalNx; jx++) {
+    for (int jy = 0; jy < mesh->LocalNy; jy++) {
+      BoutReal coef = coefs(jx, jy).*c;
+      BoutReal *fxy = f(jx, jy);
+      for (int jz = 0; jz < ncz; jz++) {
+        fxy[jz] *= coef;
+      }
+    }
+  }
+}
+
 /*******************************************************************************
  * Operators
  *
  *******************************************************************************/
 
-const Field2D Coordinates::DDX(const Field2D &f) { return mesh->indexDDX(f) / dx; }
+const Field2D Coordinates::DDX(const Field2D &f) {
+  Field2D result = mesh->indexDDX(f);
+  multiplyCoef(result, &MetricCoefs::one_over_dx);
+  return result;
+}
 
-const Field2D Coordinates::DDY(const Field2D &f) { return mesh->indexDDY(f) / dy; }
+const Field2D Coordinates::DDY(const Field2D &f) {
+  Field2D result = mesh->indexDDY(f);
+  multiplyCoef(result, &MetricCoefs::one_over_dy);
+  return result;
+}
 
 const Field2D Coordinates::DDZ(const Field2D &UNUSED(f)) { return Field2D(0.0); }
 
@@ -542,14 +651,18 @@ const Field2D Coordinates::Grad_par(const Field2D &var, CELL_LOC UNUSED(outloc),
                                     DIFF_METHOD UNUSED(method)) {
   TRACE("Coordinates::Grad_par( Field2D )");
 
-  return DDY(var) / sqrt(g_22);
+  Field2D result = DDY(var);
+  multiplyCoef(result, &MetricCoefs::one_over_sqrt_g22);
+  return result;
 }
 
 const Field3D Coordinates::Grad_par(const Field3D &var, CELL_LOC outloc,
                                     DIFF_METHOD method) {
   TRACE("Coordinates::Grad_par( Field3D )");
 
-  return ::DDY(var, outloc, method) / sqrt(g_22);
+  Field3D result = ::DDY(var, outloc, method);
+  multiplyCoef(result, &MetricCoefs::one_over_sqrt_g22);
+  return result;
 }
 
 /////////////////////////////////////////////////////////
@@ -559,12 +672,16 @@ const Field3D Coordinates::Grad_par(const Field3D &var, CELL_LOC outloc,
 const Field2D Coordinates::Vpar_Grad_par(const Field2D &v, const Field2D &f,
                                          CELL_LOC UNUSED(outloc),
                                          DIFF_METHOD UNUSED(method)) {
-  return VDDY(v, f) / sqrt(g_22);
+  Field2D result = VDDY(v, f);
+  multiplyCoef(result, &MetricCoefs::one_over_sqrt_g22);
+  return result;
 }
 
 const Field3D Coordinates::Vpar_Grad_par(const Field &v, const Field &f, CELL_LOC outloc,
                                          DIFF_METHOD method) {
-  return VDDY(v, f, outloc, method) / sqrt(g_22);
+  Field3D result = VDDY(v, f, outloc, method);
+  multiplyCoef(result, &MetricCoefs::one_over_sqrt_g22);
+  return result;
 }
 
 /////////////////////////////////////////////////////////
@@ -607,8 +724,16 @@ const Field3D Coordinates::Div_par(const Field3D &f, CELL_LOC outloc,
 const Field2D Coordinates::Grad2_par2(const Field2D &f) {
   TRACE("Coordinates::Grad2_par2( Field2D )");
 
-  Field2D sg = sqrt(g_22);
-  Field2D result = DDY(1. / sg) * DDY(f) / sg + D2DY2(f) / g_22;
+  Field2D result = DDY(f);
+  Field2D r2 = D2DY2(f);
+
+  checkCoefs();
+  for (int jx = 0; jx < mesh->LocalNx; jx++) {
+    for (int jy = 0; jy < mesh->LocalNy; jy++) {
+      const MetricCoefs &c = coefs(jx, jy);
+      result(jx, jy) = c.grad2_par2_coef * result(jx, jy) + c.one_over_g22 * r2(jx, jy);
+    }
+  }
 
   return result;
 }
@@ -616,21 +741,40 @@ const Field2D Coordinates::Grad2_par2(const Field2D &f) {
 const Field3D Coordinates::Grad2_par2(const Field3D &f, CELL_LOC outloc) {
   TRACE("Coordinates::Grad2_par2( Field3D )");
 
-  Field2D sg;
-  Field3D result, r2;
-
-  sg = sqrt(g_22);
-  sg = DDY(1. / sg) / sg;
-  if (sg.getLocation() != outloc) {
-    mesh->communicate(sg);
-    sg = interp_to(sg, outloc);
+  // Note: interp_to(Field2D) doesn't change the metric coefficients,
+  // so the same coefficients are used for any outloc
+  Field3D result = ::DDY(f, outloc);
+  Field3D r2 = D2DY2(f, outloc);
+
+  checkCoefs();
+  if (ompTeam()) {
+    // Combine into a new field shared by the team
+    Field3D combined(mesh);
+    combined.allocateTeam();
+    {
+      OmpWorkshare workshare;
+      for (const auto &i : combined) {
+        const MetricCoefs &c = coefs(i.x, i.y);
+        combined[i] = c.grad2_par2_coef * result[i] + c.one_over_g22 * r2[i];
+      }
+    }
+    combined.setLocation(result.getLocation());
+    return combined;
   }
 
-  result = ::DDY(f, outloc);
-
-  r2 = D2DY2(f, outloc) / interp_to(g_22, outloc);
+  result.allocate();
 
-  result = sg * result + r2;
+  int ncz = result.getNz();
+  for (int jx = 0; jx < mesh->LocalNx; jx++) {
+    for (int jy = 0; jy < mesh->LocalNy; jy++) {
+      const MetricCoefs &c = coefs(jx, jy);
+      BoutReal *rxy = result(jx, jy);
+      const BoutReal *r2xy = r2(jx, jy);
+      for (int jz = 0; jz < ncz; jz++) {
+        rxy[jz] = c.grad2_par2_coef * rxy[jz] + c.one_over_g22 * r2xy[jz];
+      }
+    }
+  }
 
   return result;
 }
@@ -648,58 +792,103 @@ const Field2D Coordinates::Delp2(const Field2D &f) {
   return result;
 }
 
+void Coordinates::delp2Coefs(int jy, Delp2Coefs *coefs) {
+  // The coefficients from the inversion code are quadratic in the wave
+  // number, so can be found from the coefficients for kz = 0 and kz = 1
+  BoutReal kwave = 2.0 * PI / zlength();
+
+  for (int jx = 0; jx < mesh->LocalNx; jx++) {
+    dcomplex a0, b0, c0, a1, b1, c1;
+    laplace_tridag_coefs(jx, jy, 0, a0, b0, c0);
+    laplace_tridag_coefs(jx, jy, 1, a1, b1, c1);
+
+    Delp2Coefs &d = coefs[jx];
+    d.xx = 0.5 * (c0.real() + a0.real());
+    d.x = 0.5 * (c0.real() - a0.real());
+    d.xz = c1.imag() / kwave;
+    d.zz = (b0.real() - b1.real()) / SQ(kwave);
+    d.z = b1.imag() / kwave;
+  }
+}
+
+void Coordinates::delp2Line(int jx, const Delp2Coefs &d, const dcomplex *ft,
+                            dcomplex *delft) {
+  int nmodes = mesh->LocalNz / 2 + 1;
+  const dcomplex *fm = ft + (jx - 1) * nmodes;
+  const dcomplex *f0 = ft + jx * nmodes;
+  const dcomplex *fp = ft + (jx + 1) * nmodes;
+
+  BoutReal kwave = 2.0 * PI / zlength();
+
+  for (int jz = 0; jz < nmodes; jz++) {
+    BoutReal k = jz * kwave;
+    dcomplex a(d.xx - d.x, -k * d.xz);
+    dcomplex b(-2.0 * d.xx - k * k * d.zz, k * d.z);
+    dcomplex c(d.xx + d.x, k * d.xz);
+
+    delft[jz] = a * fm[jz] + b * f0[jz] + c * fp[jz];
+  }
+}
+
 const Field3D Coordinates::Delp2(const Field3D &f) {
   TRACE("Coordinates::Delp2( Field3D )");
   
   ASSERT2(mesh->xstart > 0); // Need at least one guard cell
 
+  if (!delp2_fft) {
+    // Finite differences in real space, for when Z is not periodic
+    // or the FFT is not wanted
+    Field3D result = G1 * ::DDX(f) + G3 * ::DDZ(f) + g11 * ::D2DX2(f) + g33 * ::D2DZ2(f) +
+                     2.0 * g13 * ::D2DXDZ(f);
+    result.setLocation(f.getLocation());
+    return result;
+  }
+
+  // Guard cells are used, so fill any waiting for communication
+  mesh->communicatePending();
+
+  // Create before the threads use it. The threads of a team may all be here
+  BOUT_OMP(critical(delp2_laplacian))
+  Laplacian::defaultInstance();
+
   Field3D result;
   result.allocate();
 
   int ncz = mesh->LocalNz;
+  int nmodes = ncz / 2 + 1;
 
-  static dcomplex **ft = (dcomplex **)NULL, **delft;
-  if (ft == (dcomplex **)NULL) {
-    // Allocate memory
-    ft = matrix<dcomplex>(mesh->LocalNx, ncz / 2 + 1);
-    delft = matrix<dcomplex>(mesh->LocalNx, ncz / 2 + 1);
-  }
-
-  // Loop over all y indices
-  for (int jy = 0; jy < mesh->LocalNy; jy++) {
-
-    // Take forward FFT
+  #pragma omp parallel
+  {
+    // Fourier components of one X-Z plane, and of the result on one line
+    Array<dcomplex> ft(mesh->LocalNx * nmodes);
+    Array<dcomplex> delft(nmodes);
+    std::vector<Delp2Coefs> coefs(mesh->LocalNx);
 
-    for (int jx = 0; jx < mesh->LocalNx; jx++)
-      rfft(&f(jx, jy, 0), ncz, ft[jx]);
+    // Loop over all y indices
+    #pragma omp for
+    for (int jy = 0; jy < mesh->LocalNy; jy++) {
+      delp2Coefs(jy, coefs.data());
 
-    // Loop over kz
-    for (int jz = 0; jz <= ncz / 2; jz++) {
-      dcomplex a, b, c;
+      // Take forward FFT
+      for (int jx = 0; jx < mesh->LocalNx; jx++)
+        rfft(&f(jx, jy, 0), ncz, &ft[jx * nmodes]);
 
       // No smoothing in the x direction
       for (int jx = mesh->xstart; jx <= mesh->xend; jx++) {
-        // Perform x derivative
-
-        laplace_tridag_coefs(jx, jy, jz, a, b, c);
+        delp2Line(jx, coefs[jx], ft.begin(), delft.begin());
 
-        delft[jx][jz] = a * ft[jx - 1][jz] + b * ft[jx][jz] + c * ft[jx + 1][jz];
+        // Reverse FFT
+        irfft(delft.begin(), ncz, &result(jx, jy, 0));
       }
-    }
 
-    // Reverse FFT
-    for (int jx = mesh->xstart; jx <= mesh->xend; jx++) {
-
-      irfft(delft[jx], ncz, &result(jx, jy, 0));
-    }
-
-    // Boundaries
-    for (int jz = 0; jz < ncz; jz++) {
-      for (int jx = 0; jx<mesh->xstart; jx++) {
-	result(jx, jy, jz) = 0.0;
-      }
-      for (int jx = mesh->xend+1; jx<mesh->LocalNx; jx++) {
-	result(jx, jy, jz) = 0.0;
+      // Boundaries
+      for (int jz = 0; jz < ncz; jz++) {
+        for (int jx = 0; jx < mesh->xstart; jx++) {
+          result(jx, jy, jz) = 0.0;
+        }
+        for (int jx = mesh->xend + 1; jx < mesh->LocalNx; jx++) {
+          result(jx, jy, jz) = 0.0;
+        }
       }
     }
   }
@@ -716,40 +905,31 @@ const FieldPerp Coordinates::Delp2(const FieldPerp &f) {
   FieldPerp result;
   result.allocate();
 
-  static dcomplex **ft = (dcomplex **)NULL, **delft;
-
   int jy = f.getIndex();
   result.setIndex(jy);
 
   int ncz = mesh->LocalNz;
+  int nmodes = ncz / 2 + 1;
 
-  if (ft == (dcomplex **)NULL) {
-    // Allocate memory
-    ft = matrix<dcomplex>(mesh->LocalNx, ncz / 2 + 1);
-    delft = matrix<dcomplex>(mesh->LocalNx, ncz / 2 + 1);
-  }
-
-  // Take forward FFT
-  for (int jx = 0; jx < mesh->LocalNx; jx++)
-    rfft(f[jx], ncz, ft[jx]);
+  BOUT_OMP(critical(delp2_laplacian))
+  Laplacian::defaultInstance();
 
-  // Loop over kz
-  for (int jz = 0; jz <= ncz / 2; jz++) {
+  std::vector<Delp2Coefs> coefs(mesh->LocalNx);
+  delp2Coefs(jy, coefs.data());
 
-    // No smoothing in the x direction
-    for (int jx = 2; jx < (mesh->LocalNx - 2); jx++) {
-      // Perform x derivative
+  Array<dcomplex> ft(mesh->LocalNx * nmodes);
+  Array<dcomplex> delft(nmodes);
 
-      dcomplex a, b, c;
-      laplace_tridag_coefs(jx, jy, jz, a, b, c);
-
-      delft[jx][jz] = a * ft[jx - 1][jz] + b * ft[jx][jz] + c * ft[jx + 1][jz];
-    }
-  }
+  // Take forward FFT
+  for (int jx = 0; jx < mesh->LocalNx; jx++)
+    rfft(f[jx], ncz, &ft[jx * nmodes]);
 
-  // Reverse FFT
+  // No smoothing in the x direction
   for (int jx = 1; jx < (mesh->LocalNx - 1); jx++) {
-    irfft(delft[jx], ncz, result[jx]);
+    delp2Line(jx, coefs[jx], ft.begin(), delft.begin());
+
+    // Reverse FFT
+    irfft(delft.begin(), ncz, result[jx]);
   }
 
   // Boundaries
@@ -762,11 +942,55 @@ const FieldPerp Coordinates::Delp2(const FieldPerp &f) {
 }
 
 const Field2D Coordinates::Laplace_par(const Field2D &f) {
-  return D2DY2(f) / g_22 + DDY(J / g_22) * DDY(f) / J;
+  Field2D result = D2DY2(f);
+  Field2D df = DDY(f);
+
+  checkCoefs();
+  for (int jx = 0; jx < mesh->LocalNx; jx++) {
+    for (int jy = 0; jy < mesh->LocalNy; jy++) {
+      const MetricCoefs &c = coefs(jx, jy);
+      result(jx, jy) = c.one_over_g22 * result(jx, jy) + c.laplace_par_coef * df(jx, jy);
+    }
+  }
+
+  return result;
 }
 
 const Field3D Coordinates::Laplace_par(const Field3D &f) {
-  return D2DY2(f) / g_22 + DDY(J / g_22) * ::DDY(f) / J;
+  Field3D result = D2DY2(f);
+  Field3D df = ::DDY(f);
+
+  checkCoefs();
+  if (ompTeam()) {
+    // Combine into a new field shared by the team
+    Field3D combined(mesh);
+    combined.allocateTeam();
+    {
+      OmpWorkshare workshare;
+      for (const auto &i : combined) {
+        const MetricCoefs &c = coefs(i.x, i.y);
+        combined[i] = c.one_over_g22 * result[i] + c.laplace_par_coef * df[i];
+      }
+    }
+    combined.setLocation(result.getLocation());
+    return combined;
+  }
+
+  result.allocate();
+
+  int ncz = result.getNz();
+  for (int jx = 0; jx < mesh->LocalNx; jx++) {
+    for (int jy = 0; jy < mesh->LocalNy; jy++) {
+      const MetricCoefs &c = coefs(jx, jy);
+      BoutReal *rxy = result(jx, jy);
+      const BoutReal *dfxy = df(jx, jy);
+      for (int jz = 0; jz < ncz; jz++) {
+        rxy[jz] = c.one_over_g22 * rxy[jz] + c.laplace_par_coef * dfxy[jz];
+      }
+    }
+  }
+
+  return result;
 }
 
 // Full Laplacian operator on scalar field
@@ -16,6 +16,31 @@
 
 #include <unused.hxx>
 
+#include <bout/array.hxx>
+
+#include <map>
+#include <utility>
+
+namespace {
+/// Key into field2d_cache: the mesh which read the variable, and a
+/// string of the file name, variable name, local domain and guard cells
+using CacheKey = std::pair<const Mesh*, string>;
+
+/// Cache of 2D fields which have been read from grid files. Used so
+/// that constructing Coordinates again (e.g. at another location)
+/// doesn't read the file again. Fields are on the mesh in their key
+std::map<CacheKey, Field2D> field2d_cache;
+
+/// Key into field2d_cache for variable \p name read by mesh \p m
+CacheKey cacheKey(const string &filename, Mesh *m, const string &name) {
+  return CacheKey(m, filename + ":" + name
+                  + ":" + toString(m->OffsetX) + ":" + toString(m->OffsetY)
+                  + ":" + toString(m->LocalNx) + ":" + toString(m->LocalNy)
+                  + ":" + toString(m->GlobalNx) + ":" + toString(m->GlobalNy)
+                  + ":" + toString(m->xstart) + ":" + toString(m->ystart));
+}
+}
+
 /*!
  * Creates a GridFile object
  * 
@@ -31,6 +56,22 @@ GridFile::GridFile(std::unique_ptr<DataFormat> format, const string gridfilename
 
   file->setGlobalOrigin(); // Set default global origin
 
+  // Keep 2D fields in memory after they are read
+  Options::getRoot()->getSection("mesh")->get("cache_grid", use_cache, false);
+}
+
+void GridFile::clearCache() {
+  field2d_cache.clear();
+}
+
+void GridFile::clearCache(const Mesh *m) {
+  for(auto it = field2d_cache.begin(); it != field2d_cache.end(); ) {
+    if(it->first.first == m) {
+      it = field2d_cache.erase(it);
+    } else {
+      ++it;
+    }
+  }
 }
 
 GridFile::~GridFile() {
@@ -125,6 +166,19 @@ bool GridFile::get(Mesh *m, Field2D &var,   const string &name, BoutReal def) {
   if (!file->is_valid()) {
     throw BoutException("Could not read '%s' from file: File cannot be read", name.c_str());
   }
+
+  CacheKey key;
+  if (use_cache) {
+    key = cacheKey(filename, m, name);
+    auto it = field2d_cache.find(key);
+    if (it != field2d_cache.end()) {
+      // Already read by this mesh. Return a copy, so the cached data
+      // can't be modified
+      var = copy(it->second);
+      return true;
+    }
+  }
+
   vector<int> size = file->getSize(name);
   
   switch(size.size()) {
@@ -158,7 +212,9 @@ bool GridFile::get(Mesh *m, Field2D &var,   const string &name, BoutReal def) {
   }
   };
 
-  var.allocate(); // Make sure data allocated
+  // Allocated on the mesh reading it, whichever mesh var was on
+  Field2D result(m);
+  result.allocate();
 
   // Index offsets into source array
   int xs = m->OffsetX;
@@ -206,11 +262,16 @@ bool GridFile::get(Mesh *m, Field2D &var,   const string &name, BoutReal def) {
                 "nor ny-2*myg = %i ", name.c_str(), field_dimensions[1], m->GlobalNy, m->GlobalNy-2*myg);
   }
 
-  ///Now read data from file
-  for(int x=xs;x < xs+nx_to_read; x++) {
-    file->setGlobalOrigin(x,ys,0);
-    if (!file->read(&var(x-xs+xd, yd), name, 1, ny_to_read) ) {
-      throw BoutException("Could not fetch data for '%s'", name.c_str());
+  ///Now read data from file. The whole local block is read in one call,
+  ///then copied into var, which has a different stride in Y
+  Array<BoutReal> buffer(nx_to_read * ny_to_read);
+  file->setGlobalOrigin(xs,ys,0);
+  if (!file->read(buffer.begin(), name, nx_to_read, ny_to_read) ) {
+    throw BoutException("Could not fetch data for '%s'", name.c_str());
+  }
+  for(int x=0;x < nx_to_read; x++) {
+    for(int y=0;y < ny_to_read; y++) {
+      result(x+xd, y+yd) = buffer[x*ny_to_read + y];
     }
   }
 
@@ -219,13 +280,18 @@ bool GridFile::get(Mesh *m, Field2D &var,   const string &name, BoutReal def) {
   if (field_dimensions[1] == m->GlobalNy - 2*myg ) {
     for(int x=0;x<m->LocalNx;x++) {
       for(int y=0;y<m->ystart;y++)
-        var(x, y) = var(x, m->ystart);
+        result(x, y) = result(x, m->ystart);
       for(int y=m->yend+1;y<m->LocalNy;y++)
-        var(x, y) = var(x, m->yend);
+        result(x, y) = result(x, m->yend);
     }
   }
   file->setGlobalOrigin();
 
+  var = result;
+  if (use_cache) {
+    field2d_cache[key] = copy(result);
+  }
+
   return true;
 }
 
@@ -422,20 +488,21 @@ bool GridFile::readgrid_3dvar_fft(Mesh *m, const string &name,
 
   /// Data for FFT. Only positive frequencies
   dcomplex* fdata = new dcomplex[ncz/2 + 1];
-  BoutReal* zdata = new BoutReal[size[2]];
 
-  for(int jx=xge;jx<xlt;jx++) {
-    // Set the global X index
+  /// Read all the data in one call
+  int nx = xlt - xge;
+  Array<BoutReal> buffer(nx * ysize * size[2]);
+  file->setGlobalOrigin(xge + m->OffsetX, yread);
+  if (!file->read(buffer.begin(), name, nx, ysize, size[2])) {
+    delete[] fdata;
+    file->setGlobalOrigin();
+    return false;
+  }
 
+  for(int jx=xge;jx<xlt;jx++) {
     for(int jy=0; jy < ysize; jy++) {
-      /// Read data
-
-      int yind = yread + jy; // Global location to read from
-
-      file->setGlobalOrigin(jx + m->OffsetX, yind);
-      if (!file->read(zdata, name, 1, 1, size[2])) {
-        return 1;
-      }
+      /// Data at this X-Y location
+      const BoutReal *zdata = &buffer[((jx - xge)*ysize + jy) * size[2]];
 
       /// Load into dcomplex array
 
@@ -458,7 +525,6 @@ bool GridFile::readgrid_3dvar_fft(Mesh *m, const string &name,
   file->setGlobalOrigin();
 
   // free data
-  delete[] zdata;
   delete[] fdata;
   
   return true;
@@ -484,21 +550,25 @@ bool GridFile::readgrid_3dvar_real(Mesh *m, const string &name,
     return false;
   }
   
+  /// Read all the data in one call, then copy into var
+  int nx = xlt - xge;
+  Array<BoutReal> buffer(nx * ysize * size[2]);
+  file->setGlobalOrigin(xge + m->OffsetX, yread);
+  if (!file->read(buffer.begin(), name, nx, ysize, size[2])) {
+    file->setGlobalOrigin();
+    return false;
+  }
+  file->setGlobalOrigin();
+
   for(int jx=xge;jx<xlt;jx++) {
-    // Set the global X index
-    
     for(int jy=0; jy < ysize; jy++) {
-      /// Read data
-      
-      int yind = yread + jy; // Global location to read from
-      
-      file->setGlobalOrigin(jx + m->OffsetX, yind);
-      if (!file->read(&var(jx,ydest+jy,0), name, 1, 1, size[2])) {
-        return false;
+      const BoutReal *zdata = &buffer[((jx - xge)*ysize + jy) * size[2]];
+      BoutReal *vdata = &var(jx,ydest+jy,0);
+      for(int jz=0; jz < size[2]; jz++) {
+        vdata[jz] = zdata[jz];
       }
     }
   }
-  file->setGlobalOrigin();
   
   return true;
 }
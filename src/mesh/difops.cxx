@@ -632,6 +632,9 @@ const Field3D bracket(const Field3D &f, const Field2D &g, BRACKET_METHOD method,
   TRACE("bracket(Field3D, Field2D)");
   
   Field3D result;
+
+  // Guard cells are used, so fill any waiting for communication
+  mesh->communicatePending();
   
   Coordinates *metric = mesh->coordinates();
 
@@ -769,6 +772,9 @@ const Field3D bracket(const Field3D &f, const Field3D &g, BRACKET_METHOD method,
   
   Coordinates *metric = mesh->coordinates();
 
+  // Guard cells are used, so fill any waiting for communication
+  mesh->communicatePending();
+
   Field3D result;
 
   CELL_LOC result_loc = bracket_location(f.getLocation(), g.getLocation(), outloc);
@@ -46,6 +46,10 @@
 #include <bout/sys/timer.hxx>
 #include <msg_stack.hxx>
 #include <bout/constants.hxx>
+#include <bout/array.hxx>
+
+#include <algorithm>
+#include <fstream>
 
 /// MPI type of BoutReal for communications
 #define PVEC_REAL_MPI_TYPE MPI_DOUBLE
@@ -89,6 +93,228 @@ BoutMesh::~BoutMesh() {
     MPI_Comm_free(&comm_outer);
 }
 
+namespace {
+/// Estimate of the cost of one guard cell exchange and one pass over the
+/// local domain, for a decomposition with \p nxpe processors in X.
+/// Units are the time to send one BoutReal within a node.
+///
+/// Messages in X go to neighbouring ranks, and messages in Y go to ranks
+/// nxpe apart, so are between nodes if nxpe >= ranks_per_node
+BoutReal decompositionCost(int nxpe, int npes, int MX, int ny, int MZ, int MXG, int MYG,
+                           int ranks_per_node) {
+  const BoutReal latency = 1000.; ///< Message latency, as a number of BoutReals
+  const BoutReal offnode = 4.;    ///< Relative cost of sending between nodes
+  const BoutReal compute = 0.1;   ///< Relative cost of calculating one point
+
+  int nype = npes / nxpe;
+  int mxsub = MX / nxpe;
+  int mysub = ny / nype;
+
+  BoutReal cost = 0.0;
+  if (nxpe > 1) {
+    BoutReal factor = (ranks_per_node > 1) ? 1.0 : offnode;
+    cost += 2. * factor * (latency + MXG * mysub * MZ);
+  }
+  BoutReal factor = (nxpe < ranks_per_node) ? 1.0 : offnode;
+  cost += 2. * factor * (latency + MYG * mxsub * MZ);
+
+  // Guard cells are included, as many operators also calculate there
+  cost += compute * (mxsub + 2 * MXG) * (mysub + 2 * MYG) * MZ;
+
+  return cost;
+}
+
+/// Time guard cell exchanges and a central difference stencil,
+/// for a decomposition with \p nxpe processors in X. Y is treated as
+/// periodic, so branch cuts are ignored. Returns the maximum time
+/// over all processors
+BoutReal measureDecomposition(int nxpe, int npes, int mype, int MX, int ny, int MZ,
+                              int MXG, int MYG, int nrepeat) {
+  int nype = npes / nxpe;
+  int mxsub = MX / nxpe;
+  int mysub = ny / nype;
+  int xind = mype % nxpe;
+  int yind = mype / nxpe;
+
+  int nlx = mxsub + 2 * MXG;
+  int nly = mysub + 2 * MYG;
+  Array<BoutReal> f(nlx * nly * MZ), df(nlx * nly * MZ);
+  for (int i = 0; i < f.size(); i++) {
+    f[i] = static_cast<BoutReal>(i % 7);
+  }
+
+  // Neighbouring processors. -1 if there is no neighbour
+  int xin = (xind > 0) ? mype - 1 : -1;
+  int xout = (xind < nxpe - 1) ? mype + 1 : -1;
+  int yup = ((yind + 1) % nype) * nxpe + xind;
+  int ydown = ((yind - 1 + nype) % nype) * nxpe + xind;
+
+  int xsize = MXG * nly * MZ; // X guard cells are contiguous
+  int ysize = MYG * nlx * MZ;
+  Array<BoutReal> ysend(2 * ysize), yrecv(2 * ysize);
+
+  MPI_Comm comm = BoutComm::get();
+  MPI_Barrier(comm);
+  BoutReal starttime = MPI_Wtime();
+
+  for (int n = 0; n < nrepeat; n++) {
+    MPI_Request request[8];
+    int nreq = 0;
+
+    // Pack Y guard cells
+    for (int x = 0; x < nlx; x++) {
+      for (int y = 0; y < MYG; y++) {
+        for (int z = 0; z < MZ; z++) {
+          ysend[(x * MYG + y) * MZ + z] = f[(x * nly + MYG + y) * MZ + z];
+          ysend[ysize + (x * MYG + y) * MZ + z] = f[(x * nly + mysub + y) * MZ + z];
+        }
+      }
+    }
+
+    MPI_Irecv(&yrecv[0], ysize, PVEC_REAL_MPI_TYPE, yup, 0, comm, &request[nreq++]);
+    MPI_Irecv(&yrecv[ysize], ysize, PVEC_REAL_MPI_TYPE, ydown, 1, comm, &request[nreq++]);
+    if (xin >= 0) {
+      MPI_Irecv(&f[0], xsize, PVEC_REAL_MPI_TYPE, xin, 2, comm, &request[nreq++]);
+    }
+    if (xout >= 0) {
+      MPI_Irecv(&f[(mxsub + MXG) * nly * MZ], xsize, PVEC_REAL_MPI_TYPE, xout, 3, comm,
+                &request[nreq++]);
+    }
+
+    MPI_Isend(&ysend[0], ysize, PVEC_REAL_MPI_TYPE, ydown, 0, comm, &request[nreq++]);
+    MPI_Isend(&ysend[ysize], ysize, PVEC_REAL_MPI_TYPE, yup, 1, comm, &request[nreq++]);
+    if (xout >= 0) {
+      MPI_Isend(&f[mxsub * nly * MZ], xsize, PVEC_REAL_MPI_TYPE, xout, 2, comm,
+                &request[nreq++]);
+    }
+    if (xin >= 0) {
+      MPI_Isend(&f[MXG * nly * MZ], xsize, PVEC_REAL_MPI_TYPE, xin, 3, comm,
+                &request[nreq++]);
+    }
+    MPI_Waitall(nreq, request, MPI_STATUSES_IGNORE);
+
+    // Unpack Y guard cells
+    for (int x = 0; x < nlx; x++) {
+      for (int y = 0; y < MYG; y++) {
+        for (int z = 0; z < MZ; z++) {
+          f[(x * nly + mysub + MYG + y) * MZ + z] = yrecv[(x * MYG + y) * MZ + z];
+          f[(x * nly + y) * MZ + z] = yrecv[ysize + (x * MYG + y) * MZ + z];
+        }
+      }
+    }
+
+    // Central differences in X and Y
+    for (int x = MXG; x < mxsub + MXG; x++) {
+      for (int y = MYG; y < mysub + MYG; y++) {
+        for (int z = 0; z < MZ; z++) {
+          int i = (x * nly + y) * MZ + z;
+          df[i] = f[i + nly * MZ] - f[i - nly * MZ] + f[i + MZ] - f[i - MZ];
+        }
+      }
+    }
+  }
+
+  BoutReal local = MPI_Wtime() - starttime;
+  BoutReal result;
+  MPI_Allreduce(&local, &result, 1, MPI_DOUBLE, MPI_MAX, comm);
+  return result;
+}
+} // namespace
+
+/// Choose NXPE from the valid \p candidates using the decomposition method
+/// in \p options: "model" ranks the candidates using decompositionCost, and
+/// "measure" times the best few with measureDecomposition. Measured
+/// choices are stored in a cache file so they can be reused
+int BoutMesh::chooseNXPE(Options *options, const std::vector<int> &candidates, int MZ,
+                         bool measure) {
+  TRACE("BoutMesh::chooseNXPE");
+
+  MPI_Comm comm = BoutComm::get();
+
+  // Identify the grid and number of processors for the cache
+  std::string grid;
+  options->get("grid", grid, "");
+  std::string key = (grid.empty() ? "none" : grid) + " " + toString(nx) + " " +
+                    toString(ny) + " " + toString(MZ) + " " + toString(NPES);
+
+  std::string cachefile;
+  if (measure) {
+    std::string datadir;
+    options->get("datadir", datadir, "data");
+    options->get("decomposition_cache", cachefile, datadir + "/BOUT.decomposition");
+
+    // Look for this grid in the cache
+    int cached = -1;
+    if (MYPE == 0) {
+      std::ifstream in(cachefile);
+      std::string line;
+      while (std::getline(in, line)) {
+        std::size_t pos = line.find_last_of(' ');
+        if ((pos != std::string::npos) && (line.substr(0, pos) == key)) {
+          cached = atoi(line.substr(pos + 1).c_str());
+        }
+      }
+    }
+    MPI_Bcast(&cached, 1, MPI_INT, 0, comm);
+
+    if (std::find(candidates.begin(), candidates.end(), cached) != candidates.end()) {
+      output_info.write("\tUsing NXPE = %d from %s\n", cached, cachefile.c_str());
+      return cached;
+    }
+  }
+
+  // Number of processors on this node, which share memory
+  int ranks_per_node = 1;
+#if MPI_VERSION >= 3
+  MPI_Comm nodecomm;
+  MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &nodecomm);
+  MPI_Comm_size(nodecomm, &ranks_per_node);
+  MPI_Comm_free(&nodecomm);
+  // Use the minimum over nodes, so all processors make the same choice
+  MPI_Allreduce(MPI_IN_PLACE, &ranks_per_node, 1, MPI_INT, MPI_MIN, comm);
+#endif
+
+  // Sort candidates by their estimated cost
+  std::vector<std::pair<BoutReal, int>> ranked;
+  for (int c : candidates) {
+    BoutReal cost = decompositionCost(c, NPES, MX, ny, MZ, MXG, MYG, ranks_per_node);
+    output_info.write("\tNXPE = %d: estimated cost %e\n", c, cost);
+    ranked.push_back(std::make_pair(cost, c));
+  }
+  std::sort(ranked.begin(), ranked.end());
+
+  int best = ranked[0].second;
+  if (!measure) {
+    return best;
+  }
+
+  int ntest, nrepeat;
+  options->get("decomposition_ntest", ntest, 3);
+  options->get("decomposition_repeat", nrepeat, 10);
+
+  BoutReal besttime = -1.0;
+  for (int i = 0; i < BOUTMIN(ntest, static_cast<int>(ranked.size())); i++) {
+    int c = ranked[i].second;
+    BoutReal time = measureDecomposition(c, NPES, MYPE, MX, ny, MZ, MXG, MYG, nrepeat);
+    output_info.write("\tNXPE = %d: measured time %e s\n", c, time);
+    if ((besttime < 0.0) || (time < besttime)) {
+      besttime = time;
+      best = c;
+    }
+  }
+
+  if (MYPE == 0) {
+    std::ofstream out(cachefile, std::ios::app);
+    if (out) {
+      out << key << " " << best << std::endl;
+    } else {
+      output_warn.write("\tWARNING: Could not write decomposition to %s\n",
+                        cachefile.c_str());
+    }
+  }
+  return best;
+}
+
 int BoutMesh::load() {
   TRACE("BoutMesh::load()");
 
@@ -235,8 +461,8 @@ int BoutMesh::load() {
 
     MX = nx - 2 * MXG;
 
-    NXPE = -1; // Best option
-    
+    std::vector<int> candidates; // Acceptable values of NXPE
+
     BoutReal ideal = sqrt(MX * NPES / static_cast<BoutReal>(ny)); // Results in square domains
 
     output_info.write("Finding value for NXPE (ideal = %f)\n", ideal);
@@ -313,15 +539,32 @@ int BoutMesh::load() {
         }
         output_info.write("\t -> Good value\n");
         // Found an acceptable value
-        if ((NXPE < 1) || (fabs(ideal - i) < fabs(ideal - NXPE)))
-          NXPE = i; // Keep value nearest to the ideal
+        candidates.push_back(i);
       }
     }
 
-    if (NXPE < 1)
+    if (candidates.empty())
       throw BoutException(
           "Could not find a valid value for NXPE. Try a different number of processors.");
 
+    // How to choose between acceptable values
+    std::string decomposition;
+    options->get("decomposition", decomposition, "ideal");
+    decomposition = lowercase(decomposition);
+
+    if (decomposition == "ideal") {
+      NXPE = candidates[0];
+      for (int i : candidates) {
+        if (fabs(ideal - i) < fabs(ideal - NXPE))
+          NXPE = i; // Keep value nearest to the ideal
+      }
+    } else if ((decomposition == "model") || (decomposition == "measure")) {
+      NXPE = chooseNXPE(options, candidates, MZ, decomposition == "measure");
+    } else {
+      throw BoutException("Unrecognised decomposition '%s'. Options are ideal, model, measure",
+                          decomposition.c_str());
+    }
+
     NYPE = NPES / NXPE;
 
     output_progress.write(
@@ -359,6 +602,9 @@ int BoutMesh::load() {
 
   OPTION(options, async_send, false); // Whether to use asyncronous sends
 
+  bool shared_comms;
+  OPTION(options, shared_comms, false); // Use shared memory within nodes
+
   // Set global offsets
 
   OffsetX = PE_XIND * MXSUB;
@@ -393,6 +639,18 @@ int BoutMesh::load() {
   /// Call topology to set layout of grid
   topology();
 
+  if (shared_comms) {
+    // Room in each buffer for this many 3D fields
+    int shared_comm_fields;
+    OPTION(options, shared_comm_fields, 8);
+    int slotsize = shared_comm_fields * LocalNz * BOUTMAX(LocalNx * MYG, MXG * MYSUB);
+
+    // One buffer for each message tag, since each is sent to one processor
+    shared = std::unique_ptr<SharedComm>(new SharedComm(BoutComm::get(), 6, slotsize));
+    output_info.write("\tShared memory communication with %d processors on this node\n",
+                      shared->nodeSize());
+  }
+
   OPTION(options, TwistShift, false);
 
   if (TwistShift) {
@@ -845,6 +1103,8 @@ comm_handle BoutMesh::send(FieldGroup &g) {
   /// Start timer
   Timer timer("comms");
 
+  comm_rounds++;
+
   /// Work out length of buffer needed
   int xlen = msg_len(g.get(), 0, MXG, 0, MYSUB);
   int ylen = msg_len(g.get(), 0, LocalNx, 0, MYG);
@@ -861,89 +1121,41 @@ comm_handle BoutMesh::send(FieldGroup &g) {
   /// Send data going up (y+1)
 
   int len = 0;
-  BoutReal *outbuff;
 
   if (UDATA_INDEST != -1) { // If there is a destination for inner x data
-    len = pack_data(ch->var_list.get(), 0, UDATA_XSPLIT, MYSUB, MYSUB + MYG,
-                    ch->umsg_sendbuff);
-    // Send the data to processor UDATA_INDEST
-
-    if (async_send) {
-      MPI_Isend(ch->umsg_sendbuff,  // Buffer to send
-                len,                // Length of buffer in BoutReals
-                PVEC_REAL_MPI_TYPE, // Real variable type
-                UDATA_INDEST,       // Destination processor
-                IN_SENT_UP,         // Label (tag) for the message
-                BoutComm::get(), &(ch->sendreq[0]));
-    } else
-      MPI_Send(ch->umsg_sendbuff, len, PVEC_REAL_MPI_TYPE, UDATA_INDEST, IN_SENT_UP,
-               BoutComm::get());
-  }
-  if (UDATA_OUTDEST != -1) {             // if destination for outer x data
-    outbuff = &(ch->umsg_sendbuff[len]); // A pointer to the start of the second part
-                                         // of the buffer
-    len =
-        pack_data(ch->var_list.get(), UDATA_XSPLIT, LocalNx, MYSUB, MYSUB + MYG, outbuff);
-    // Send the data to processor UDATA_OUTDEST
-    if (async_send) {
-      MPI_Isend(outbuff, len, PVEC_REAL_MPI_TYPE, UDATA_OUTDEST, OUT_SENT_UP,
-                BoutComm::get(), &(ch->sendreq[1]));
-    } else
-      MPI_Send(outbuff, len, PVEC_REAL_MPI_TYPE, UDATA_OUTDEST, OUT_SENT_UP,
-               BoutComm::get());
+    len = send_data(ch->var_list.get(), 0, UDATA_XSPLIT, MYSUB, MYSUB + MYG,
+                    ch->umsg_sendbuff, UDATA_INDEST, IN_SENT_UP, &(ch->sendreq[0]));
+  }
+  if (UDATA_OUTDEST != -1) { // if destination for outer x data
+    // Use the second part of the buffer
+    send_data(ch->var_list.get(), UDATA_XSPLIT, LocalNx, MYSUB, MYSUB + MYG,
+              &(ch->umsg_sendbuff[len]), UDATA_OUTDEST, OUT_SENT_UP, &(ch->sendreq[1]));
   }
 
   /// Send data going down (y-1)
 
   len = 0;
   if (DDATA_INDEST != -1) { // If there is a destination for inner x data
-    len = pack_data(ch->var_list.get(), 0, DDATA_XSPLIT, MYG, 2 * MYG, ch->dmsg_sendbuff);
-    // Send the data to processor DDATA_INDEST
-    if (async_send) {
-      MPI_Isend(ch->dmsg_sendbuff, len, PVEC_REAL_MPI_TYPE, DDATA_INDEST, IN_SENT_DOWN,
-                BoutComm::get(), &(ch->sendreq[2]));
-    } else
-      MPI_Send(ch->dmsg_sendbuff, len, PVEC_REAL_MPI_TYPE, DDATA_INDEST, IN_SENT_DOWN,
-               BoutComm::get());
-  }
-  if (DDATA_OUTDEST != -1) {             // if destination for outer x data
-    outbuff = &(ch->dmsg_sendbuff[len]); // A pointer to the start of the second part
-                                         // of the buffer
-    len = pack_data(ch->var_list.get(), DDATA_XSPLIT, LocalNx, MYG, 2 * MYG, outbuff);
-    // Send the data to processor DDATA_OUTDEST
-
-    if (async_send) {
-      MPI_Isend(outbuff, len, PVEC_REAL_MPI_TYPE, DDATA_OUTDEST, OUT_SENT_DOWN,
-                BoutComm::get(), &(ch->sendreq[3]));
-    } else
-      MPI_Send(outbuff, len, PVEC_REAL_MPI_TYPE, DDATA_OUTDEST, OUT_SENT_DOWN,
-               BoutComm::get());
+    len = send_data(ch->var_list.get(), 0, DDATA_XSPLIT, MYG, 2 * MYG,
+                    ch->dmsg_sendbuff, DDATA_INDEST, IN_SENT_DOWN, &(ch->sendreq[2]));
+  }
+  if (DDATA_OUTDEST != -1) { // if destination for outer x data
+    send_data(ch->var_list.get(), DDATA_XSPLIT, LocalNx, MYG, 2 * MYG,
+              &(ch->dmsg_sendbuff[len]), DDATA_OUTDEST, OUT_SENT_DOWN, &(ch->sendreq[3]));
   }
 
   /// Send to the left (x-1)
 
   if (IDATA_DEST != -1) {
-    len =
-        pack_data(ch->var_list.get(), MXG, 2 * MXG, MYG, MYG + MYSUB, ch->imsg_sendbuff);
-    if (async_send) {
-      MPI_Isend(ch->imsg_sendbuff, len, PVEC_REAL_MPI_TYPE, IDATA_DEST, IN_SENT_OUT,
-                BoutComm::get(), &(ch->sendreq[4]));
-    } else
-      MPI_Send(ch->imsg_sendbuff, len, PVEC_REAL_MPI_TYPE, IDATA_DEST, IN_SENT_OUT,
-               BoutComm::get());
+    send_data(ch->var_list.get(), MXG, 2 * MXG, MYG, MYG + MYSUB,
+              ch->imsg_sendbuff, IDATA_DEST, IN_SENT_OUT, &(ch->sendreq[4]));
   }
 
   /// Send to the right (x+1)
 
   if (ODATA_DEST != -1) {
-    len = pack_data(ch->var_list.get(), MXSUB, MXSUB + MXG, MYG, MYG + MYSUB,
-                    ch->omsg_sendbuff);
-    if (async_send) {
-      MPI_Isend(ch->omsg_sendbuff, len, PVEC_REAL_MPI_TYPE, ODATA_DEST, OUT_SENT_IN,
-                BoutComm::get(), &(ch->sendreq[5]));
-    } else
-      MPI_Send(ch->omsg_sendbuff, len, PVEC_REAL_MPI_TYPE, ODATA_DEST, OUT_SENT_IN,
-               BoutComm::get());
+    send_data(ch->var_list.get(), MXSUB, MXSUB + MXG, MYG, MYG + MYSUB,
+              ch->omsg_sendbuff, ODATA_DEST, OUT_SENT_IN, &(ch->sendreq[5]));
   }
 
   /// Mark communication handle as in progress
@@ -984,33 +1196,35 @@ int BoutMesh::wait(comm_handle handle) {
     MPI_Waitany(6, ch->request, &ind, &status);
     switch (ind) {
     case 0: { // Up, inner
-      unpack_data(ch->var_list.get(), 0, UDATA_XSPLIT, MYSUB + MYG, MYSUB + 2 * MYG,
-                  ch->umsg_recvbuff);
+      unpack_received(ch->var_list.get(), 0, UDATA_XSPLIT, MYSUB + MYG, MYSUB + 2 * MYG,
+                      ch->umsg_recvbuff, status);
       break;
     }
     case 1: { // Up, outer
       len = msg_len(ch->var_list.get(), 0, UDATA_XSPLIT, 0, MYG);
-      unpack_data(ch->var_list.get(), UDATA_XSPLIT, LocalNx, MYSUB + MYG, MYSUB + 2 * MYG,
-                  &(ch->umsg_recvbuff[len]));
+      unpack_received(ch->var_list.get(), UDATA_XSPLIT, LocalNx, MYSUB + MYG,
+                      MYSUB + 2 * MYG, &(ch->umsg_recvbuff[len]), status);
       break;
     }
     case 2: { // Down, inner
-      unpack_data(ch->var_list.get(), 0, DDATA_XSPLIT, 0, MYG, ch->dmsg_recvbuff);
+      unpack_received(ch->var_list.get(), 0, DDATA_XSPLIT, 0, MYG, ch->dmsg_recvbuff,
+                      status);
       break;
     }
     case 3: { // Down, outer
       len = msg_len(ch->var_list.get(), 0, DDATA_XSPLIT, 0, MYG);
-      unpack_data(ch->var_list.get(), DDATA_XSPLIT, LocalNx, 0, MYG,
-                  &(ch->dmsg_recvbuff[len]));
+      unpack_received(ch->var_list.get(), DDATA_XSPLIT, LocalNx, 0, MYG,
+                      &(ch->dmsg_recvbuff[len]), status);
       break;
     }
     case 4: { // inner
-      unpack_data(ch->var_list.get(), 0, MXG, MYG, MYG + MYSUB, ch->imsg_recvbuff);
+      unpack_received(ch->var_list.get(), 0, MXG, MYG, MYG + MYSUB, ch->imsg_recvbuff,
+                      status);
       break;
     }
     case 5: { // outer
-      unpack_data(ch->var_list.get(), MXSUB + MXG, MXSUB + 2 * MXG, MYG, MYG + MYSUB,
-                  ch->omsg_recvbuff);
+      unpack_received(ch->var_list.get(), MXSUB + MXG, MXSUB + 2 * MXG, MYG, MYG + MYSUB,
+                      ch->omsg_recvbuff, status);
       break;
     }
     }
@@ -1881,6 +2095,54 @@ void BoutMesh::clear_handles() {
  *                   Communication utilities
  ****************************************************************/
 
+int BoutMesh::send_data(const vector<FieldData *> &var_list, int xge, int xlt, int yge,
+                        int ylt, BoutReal *buffer, int dest, int tag,
+                        MPI_Request *request) {
+  // Shared buffer for this tag, if dest is on this node and it's free
+  BoutReal *shared_buffer = nullptr;
+  if (shared)
+    shared_buffer = shared->sendBuffer(tag, dest, msg_len(var_list, xge, xlt, yge, ylt));
+
+  int len = pack_data(var_list, xge, xlt, yge, ylt, shared_buffer ? shared_buffer : buffer);
+  comm_bytes += len * sizeof(BoutReal);
+
+  int sendlen = len;
+  if (shared_buffer) {
+    // Receiver reads the data from our memory
+    shared->ready(tag, dest);
+    sendlen = 0;
+  }
+
+  if (async_send) {
+    MPI_Isend(buffer,             // Buffer to send
+              sendlen,            // Length of buffer in BoutReals
+              PVEC_REAL_MPI_TYPE, // Real variable type
+              dest,               // Destination processor
+              tag,                // Label (tag) for the message
+              BoutComm::get(), request);
+  } else
+    MPI_Send(buffer, sendlen, PVEC_REAL_MPI_TYPE, dest, tag, BoutComm::get());
+
+  return len;
+}
+
+void BoutMesh::unpack_received(const vector<FieldData *> &var_list, int xge, int xlt,
+                               int yge, int ylt, BoutReal *buffer,
+                               const MPI_Status &status) {
+  if (shared) {
+    int count;
+    MPI_Get_count(&status, PVEC_REAL_MPI_TYPE, &count);
+    if ((count == 0) && (msg_len(var_list, xge, xlt, yge, ylt) > 0)) {
+      // Data is in the sender's shared buffer. The tag identifies the buffer
+      unpack_data(var_list, xge, xlt, yge, ylt,
+                  shared->recvBuffer(status.MPI_SOURCE, status.MPI_TAG));
+      shared->release(status.MPI_SOURCE, status.MPI_TAG);
+      return;
+    }
+  }
+  unpack_data(var_list, xge, xlt, yge, ylt, buffer);
+}
+
 int BoutMesh::pack_data(const vector<FieldData *> &var_list, int xge, int xlt, int yge,
                         int ylt, BoutReal *buffer) {
 
@@ -5,9 +5,11 @@
 #include "mpi.h"
 
 #include <bout/mesh.hxx>
+#include <bout/sys/shared_comm.hxx>
 #include "unused.hxx"
 
 #include <list>
+#include <memory>
 #include <vector>
 #include <cmath>
 
@@ -203,6 +205,9 @@ class BoutMesh : public Mesh {
   int YPROC(int yind);
   int XPROC(int xind);
 
+  /// Choose NXPE from acceptable values, using a cost model or measurement
+  int chooseNXPE(Options *options, const std::vector<int> &candidates, int MZ, bool measure);
+
   // Twist-shift switches
   bool TS_up_in, TS_up_out, TS_down_in, TS_down_out;
 
@@ -235,6 +240,10 @@ class BoutMesh : public Mesh {
 
   bool async_send;   ///< Switch to asyncronous sends (ISend, not Send)
 
+  /// Exchange with processors on the same node through shared memory.
+  /// Null unless the shared_comms option is set
+  std::unique_ptr<SharedComm> shared;
+
   /// Communication handle
   /// Used to keep track of communications between send and receive
   struct CommHandle {
@@ -275,6 +284,16 @@ class BoutMesh : public Mesh {
   int pack_data(const vector<FieldData*> &var_list, int xge, int xlt, int yge, int ylt, BoutReal *buffer);
   /// Copy data from a buffer back into the fields
   int unpack_data(const vector<FieldData*> &var_list, int xge, int xlt, int yge, int ylt, BoutReal *buffer);
+
+  /// Pack data and send it to processor \p dest. If \p dest is on the
+  /// same node and shared memory is used, the data is packed into a shared
+  /// buffer and a zero-length message sent. Returns the length of the data
+  int send_data(const vector<FieldData*> &var_list, int xge, int xlt, int yge, int ylt,
+                BoutReal *buffer, int dest, int tag, MPI_Request *request);
+  /// Unpack data received with \p status, either from \p buffer or
+  /// from the sender's shared buffer
+  void unpack_received(const vector<FieldData*> &var_list, int xge, int xlt, int yge, int ylt,
+                       BoutReal *buffer, const MPI_Status &status);
 };
 
 #endif // __BOUTMESH_H__
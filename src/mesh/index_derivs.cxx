@@ -52,6 +52,7 @@
 #include <interpolation.hxx>
 #include <bout/constants.hxx>
 #include <msg_stack.hxx>
+#include <bout/openmpwrap.hxx>
 
 #include <cmath>
 #include <string.h>
@@ -668,6 +669,9 @@ void Mesh::derivs_init(Options* options) {
 // X derivative
 
 const Field2D Mesh::applyXdiff(const Field2D &var, Mesh::deriv_func func, CELL_LOC loc, REGION region) {
+  // Guard cells are used, so fill any waiting for communication
+  communicatePending();
+
   if (var.getNx() == 1){
     return 0.;
   }
@@ -771,6 +775,8 @@ const Field2D Mesh::applyXdiff(const Field2D &var, Mesh::deriv_func func, CELL_L
 }
 
 const Field3D Mesh::applyXdiff(const Field3D &var, Mesh::deriv_func func, CELL_LOC loc, REGION region) {
+  communicatePending();
+
   if (var.getNx() == 1) {
     return 0.;
   }
@@ -781,7 +787,10 @@ const Field3D Mesh::applyXdiff(const Field3D &var, Mesh::deriv_func func, CELL_L
   ASSERT1(this == var.getMesh());
 
   Field3D result(this);
-  result.allocate(); // Make sure data allocated
+  result.allocateTeam(); // Make sure data allocated, shared in a team
+
+  // Divide the loops between threads in a team
+  OmpWorkshare workshare;
   
   if (mesh->StaggerGrids && 
       (loc != CELL_DEFAULT) && (loc != var.getLocation())) {
@@ -878,6 +887,8 @@ const Field3D Mesh::applyXdiff(const Field3D &var, Mesh::deriv_func func, CELL_L
 // Y derivative
 
 const Field2D Mesh::applyYdiff(const Field2D &var, Mesh::deriv_func func, CELL_LOC loc, REGION region) {
+  communicatePending();
+
   if (var.getNy() == 1) {
     return 0.;
   }
@@ -929,6 +940,8 @@ const Field2D Mesh::applyYdiff(const Field2D &var, Mesh::deriv_func func, CELL_L
 }
 
 const Field3D Mesh::applyYdiff(const Field3D &var, Mesh::deriv_func func, CELL_LOC loc, REGION region) {
+  communicatePending();
+
   if (var.getNy() == 1){
     return 0.;
   }
@@ -939,7 +952,7 @@ const Field3D Mesh::applyYdiff(const Field3D &var, Mesh::deriv_func func, CELL_L
   ASSERT1(this == var.getMesh());
 
   Field3D result(this);
-  result.allocate(); // Make sure data allocated
+  result.allocateTeam(); // Make sure data allocated, shared in a team
   
   if (var.hasYupYdown() && 
       ( (&var.yup() != &var) || (&var.ydown() != &var))) {
@@ -953,39 +966,45 @@ const Field3D Mesh::applyYdiff(const Field3D &var, Mesh::deriv_func func, CELL_L
       // Cell location of the input field
       CELL_LOC location = var.getLocation();
       
-      for(const auto &i : result.region(region)) {
-        // Set stencils
-        stencil s;
-        s.c = var[i];
-        s.p = var.yup()[i.yp()];
-        s.m = var.ydown()[i.ym()];
-        s.pp = nan("");
-        s.mm = nan("");
+      {
+        OmpWorkshare workshare;
+        for(const auto &i : result.region(region)) {
+          // Set stencils
+          stencil s;
+          s.c = var[i];
+          s.p = var.yup()[i.yp()];
+          s.m = var.ydown()[i.ym()];
+          s.pp = nan("");
+          s.mm = nan("");
         
-        if ((location == CELL_CENTRE) && (loc == CELL_YLOW)) {
-          // Producing a stencil centred around a lower Y value
-          s.pp = s.p;
-          s.p  = s.c;
-        } else if(location == CELL_YLOW) {
-          // Stencil centred around a cell centre
-          s.mm = s.m;
-          s.m  = s.c;
-        }
+          if ((location == CELL_CENTRE) && (loc == CELL_YLOW)) {
+            // Producing a stencil centred around a lower Y value
+            s.pp = s.p;
+            s.p  = s.c;
+          } else if(location == CELL_YLOW) {
+            // Stencil centred around a cell centre
+            s.mm = s.m;
+            s.m  = s.c;
+          }
 
-        result[i] = func(s);
+          result[i] = func(s);
+        }
       }
     } else {
       // Non-staggered
-      for(const auto &i : result.region(region)) {
-        // Set stencils
-        stencil s;
-        s.c = var[i];
-        s.p = var.yup()[i.yp()];
-        s.m = var.ydown()[i.ym()];
-        s.pp = nan("");
-        s.mm = nan("");
+      {
+        OmpWorkshare workshare;
+        for(const auto &i : result.region(region)) {
+          // Set stencils
+          stencil s;
+          s.c = var[i];
+          s.p = var.yup()[i.yp()];
+          s.m = var.ydown()[i.ym()];
+          s.pp = nan("");
+          s.mm = nan("");
         
-        result[i] = func(s);
+          result[i] = func(s);
+        }
       }
     }
   } else {
@@ -1002,49 +1021,55 @@ const Field3D Mesh::applyYdiff(const Field3D &var, Mesh::deriv_func func, CELL_L
       if (mesh->ystart > 1) {
         // More than one guard cell, so set pp and mm values
         // This allows higher-order methods to be used
-        for(const auto &i : result.region(region)) {
-          // Set stencils
-          stencil s;
-          s.c = var_fa[i];
-          s.p = var_fa[i.yp()];
-          s.m = var_fa[i.ym()];
-          s.pp = var_fa[i.offset(0,2,0)];
-          s.mm = var_fa[i.offset(0,-2,0)];
+        {
+          OmpWorkshare workshare;
+          for(const auto &i : result.region(region)) {
+            // Set stencils
+            stencil s;
+            s.c = var_fa[i];
+            s.p = var_fa[i.yp()];
+            s.m = var_fa[i.ym()];
+            s.pp = var_fa[i.offset(0,2,0)];
+            s.mm = var_fa[i.offset(0,-2,0)];
           
-          if ((location == CELL_CENTRE) && (loc == CELL_YLOW)) {
-            // Producing a stencil centred around a lower Y value
-            s.pp = s.p;
-            s.p  = s.c;
-          } else if(location == CELL_YLOW) {
-            // Stencil centred around a cell centre
-            s.mm = s.m;
-            s.m  = s.c;
-          }
+            if ((location == CELL_CENTRE) && (loc == CELL_YLOW)) {
+              // Producing a stencil centred around a lower Y value
+              s.pp = s.p;
+              s.p  = s.c;
+            } else if(location == CELL_YLOW) {
+              // Stencil centred around a cell centre
+              s.mm = s.m;
+              s.m  = s.c;
+            }
           
-          result[i] = func(s);
+            result[i] = func(s);
+          }
         }
       } else {
         // Only one guard cell, so no pp or mm values
-        for(const auto &i : result.region(region)) {
-          // Set stencils
-          stencil s;
-          s.c = var_fa[i];
-          s.p = var_fa[i.yp()];
-          s.m = var_fa[i.ym()];
-          s.pp = nan("");
-          s.mm = nan("");
+        {
+          OmpWorkshare workshare;
+          for(const auto &i : result.region(region)) {
+            // Set stencils
+            stencil s;
+            s.c = var_fa[i];
+            s.p = var_fa[i.yp()];
+            s.m = var_fa[i.ym()];
+            s.pp = nan("");
+            s.mm = nan("");
           
-          if ((location == CELL_CENTRE) && (loc == CELL_YLOW)) {
-            // Producing a stencil centred around a lower Y value
-            s.pp = s.p;
-            s.p  = s.c;
-          } else if(location == CELL_YLOW) {
-            // Stencil centred around a cell centre
-            s.mm = s.m;
-            s.m  = s.c;
-          }
+            if ((location == CELL_CENTRE) && (loc == CELL_YLOW)) {
+              // Producing a stencil centred around a lower Y value
+              s.pp = s.p;
+              s.p  = s.c;
+            } else if(location == CELL_YLOW) {
+              // Stencil centred around a cell centre
+              s.mm = s.m;
+              s.m  = s.c;
+            }
           
-          result[i] = func(s);
+            result[i] = func(s);
+          }
         }
       }
       
@@ -1054,29 +1079,35 @@ const Field3D Mesh::applyYdiff(const Field3D &var, Mesh::deriv_func func, CELL_L
       if (mesh->ystart > 1) {
         // More than one guard cell, so set pp and mm values
         // This allows higher-order methods to be used
-        for(const auto &i : result.region(region)) {
-          // Set stencils
-          stencil s;
-          s.c = var_fa[i];
-          s.p = var_fa[i.yp()];
-          s.m = var_fa[i.ym()];
-          s.pp = var_fa[i.offset(0,2,0)];
-          s.mm = var_fa[i.offset(0,-2,0)];
+        {
+          OmpWorkshare workshare;
+          for(const auto &i : result.region(region)) {
+            // Set stencils
+            stencil s;
+            s.c = var_fa[i];
+            s.p = var_fa[i.yp()];
+            s.m = var_fa[i.ym()];
+            s.pp = var_fa[i.offset(0,2,0)];
+            s.mm = var_fa[i.offset(0,-2,0)];
           
-          result[i] = func(s);
+            result[i] = func(s);
+          }
         }
       } else {
         // Only one guard cell, so no pp or mm values
-        for(const auto &i : result.region(region)) {
-          // Set stencils
-          stencil s;
-          s.c = var_fa[i];
-          s.p = var_fa[i.yp()];
-          s.m = var_fa[i.ym()];
-          s.pp = nan("");
-          s.mm = nan("");
+        {
+          OmpWorkshare workshare;
+          for(const auto &i : result.region(region)) {
+            // Set stencils
+            stencil s;
+            s.c = var_fa[i];
+            s.p = var_fa[i.yp()];
+            s.m = var_fa[i.ym()];
+            s.pp = nan("");
+            s.mm = nan("");
           
-          result[i] = func(s);
+            result[i] = func(s);
+          }
         }
       }
     }
@@ -1108,7 +1139,10 @@ const Field3D Mesh::applyZdiff(const Field3D &var, Mesh::deriv_func func, CELL_L
   }
 
   Field3D result(this);
-  result.allocate(); // Make sure data allocated
+  result.allocateTeam(); // Make sure data allocated, shared in a team
+
+  // Divide the loops between threads in a team
+  OmpWorkshare workshare;
   
   // Check that the input variable has data
   ASSERT1(var.isAllocated());
@@ -1257,6 +1291,171 @@ const Field2D Mesh::indexDDY(const Field2D &f) {
   return applyYdiff(f, fDDY);
 }
 
+/*******************************************************************************
+ * Z derivatives combined with a shift in X or Y
+ *******************************************************************************/
+
+namespace {
+/// Z derivative of a single line of \p ncz points, periodic in Z
+///
+/// @param[in] f       Input data, \p ncz points
+/// @param[in] func    The derivative function. If NULL then uses FFT
+/// @param[in] cv      Workspace for FFT, size ncz/2 + 1
+/// @param[out] result Output data, \p ncz points
+void ddzLine(const BoutReal *f, int ncz, Mesh::deriv_func func, Array<dcomplex> &cv,
+             BoutReal *result) {
+  if(func == NULL) {
+    rfft(f, ncz, cv.begin()); // Forward FFT
+    
+    for(int jz=0;jz<=ncz/2;jz++) {
+      BoutReal kwave=jz*2.0*PI/ncz; // wave number is 1/[rad]
+      
+      BoutReal flt;
+      if (jz>0.4*ncz) flt=1e-10; else flt=1.0;
+      cv[jz] *= dcomplex(0.0, kwave) * flt;
+    }
+    
+    irfft(cv.begin(), ncz, result); // Reverse FFT
+    return;
+  }
+  
+  stencil s;
+  for(int jz=0;jz<ncz;jz++) {
+    s.c  = f[jz];
+    s.p  = f[(jz+1) % ncz];
+    s.m  = f[(jz+ncz-1) % ncz];
+    s.pp = f[(jz+2) % ncz];
+    s.mm = f[(jz+2*ncz-2) % ncz];
+    result[jz] = func(s);
+  }
+}
+
+/// Can the Z derivative of \p f at \p inloc be combined with
+/// interpolation to \p outloc?
+bool canFuseDDZ(const Field3D &f, CELL_LOC inloc, CELL_LOC outloc) {
+  if(f.getNz() < 2)
+    return false;
+  
+  CELL_LOC dir;
+  if(inloc == CELL_CENTRE) {
+    dir = outloc;
+  }else if(outloc == CELL_CENTRE) {
+    dir = inloc;
+  }else
+    return false;
+
+  if(dir == CELL_XLOW)
+    return true;
+  
+  // Interpolation in Y needs second neighbours,
+  // so yup and ydown fields must not be separate
+  return (dir == CELL_YLOW) && (&f.yup() == &f) && (&f.ydown() == &f);
+}
+
+/// Z derivative of \p f, interpolated between cell centre and XLOW or YLOW.
+/// Gives the same result as the separate derivative and interp_to calls,
+/// but without temporary 3D fields. Lines in Z are differentiated at most
+/// once, into a buffer for each X-Z or Y-Z slice.
+///
+/// Points are interpolated in the same region as interp_to, except that
+/// for YLOW the X boundaries are only included if \p inc_xbndry is set.
+/// As interp_to copies its input outside this region, the other points
+/// are set to the derivative without a shift. The guard cells are then
+/// communicated, as by interp_to
+const Field3D ddzShifted(const Field3D &f, CELL_LOC inloc, CELL_LOC outloc,
+                         Mesh::deriv_func func, bool inc_xbndry) {
+  Mesh *m = f.getMesh();
+  int ncz = f.getNz();
+  
+  bool tolow = (inloc == CELL_CENTRE); // Derivative then interpolate
+  CELL_LOC dir = tolow ? outloc : inloc;
+  bool xdir = (dir == CELL_XLOW);
+
+  // Range of the index being shifted
+  int ilo = xdir ? m->xstart : m->ystart;
+  int ihi = xdir ? m->xend : m->yend;
+  // Range of the other index
+  int jlo = xdir ? m->ystart : (inc_xbndry ? 0 : m->xstart);
+  int jhi = xdir ? m->yend : (inc_xbndry ? m->LocalNx-1 : m->xend);
+
+  // All lines needed for the interpolation
+  int first[4], last[4];
+  interp_index(m, dir, tolow, ilo, first);
+  interp_index(m, dir, tolow, ihi, last);
+  int lo = first[0], hi = last[3];
+  
+  Field3D result(m);
+  result.allocateTeam(); // Shared in a team
+
+  // The loops are shared between the threads of the enclosing
+  // parallel region
+  auto shifted_lines = [&]() {
+    Array<dcomplex> cv(ncz/2 + 1);
+    Array<BoutReal> buffer(tolow ? (hi - lo + 1)*ncz : ncz);
+
+    // Points which aren't interpolated
+    #pragma omp for nowait
+    for(int jx=0;jx<m->LocalNx;jx++) {
+      for(int jy=0;jy<m->LocalNy;jy++) {
+        int i = xdir ? jx : jy, j = xdir ? jy : jx;
+        if((i < ilo) || (i > ihi) || (j < jlo) || (j > jhi))
+          ddzLine(f(jx, jy), ncz, func, cv, result(jx, jy));
+      }
+    }
+    
+    #pragma omp for
+    for(int j=jlo;j<=jhi;j++) {
+      auto in = [&](int i) -> const BoutReal* { return xdir ? f(i, j) : f(j, i); };
+      auto out = [&](int i) -> BoutReal* { return xdir ? result(i, j) : result(j, i); };
+      
+      int ind[4];
+      if(tolow) {
+        // Differentiate each line once
+        for(int i=lo;i<=hi;i++)
+          ddzLine(in(i), ncz, func, cv, &buffer[(i - lo)*ncz]);
+        
+        // Interpolate the derivatives
+        for(int i=ilo;i<=ihi;i++) {
+          interp_index(m, dir, tolow, i, ind);
+          interp_line(&buffer[(ind[0] - lo)*ncz], &buffer[(ind[1] - lo)*ncz],
+                      &buffer[(ind[2] - lo)*ncz], &buffer[(ind[3] - lo)*ncz],
+                      ncz, out(i));
+        }
+      }else {
+        // Interpolate to cell centre, then differentiate
+        for(int i=ilo;i<=ihi;i++) {
+          interp_index(m, dir, tolow, i, ind);
+          interp_line(in(ind[0]), in(ind[1]), in(ind[2]), in(ind[3]), ncz, buffer.begin());
+          ddzLine(buffer.begin(), ncz, func, cv, out(i));
+        }
+      }
+    }
+  };
+
+  if(ompTeam()) {
+    // Already in a team, so don't start a new parallel region
+    shifted_lines();
+    ompCheckTeam(); // After the barrier at the end of omp for
+  } else {
+    #pragma omp parallel
+    shifted_lines();
+  }
+
+  m->communicate(result);
+  
+#if CHECK > 0
+  // Mark boundaries as invalid
+  result.bndry_xin = false;
+  result.bndry_xout = false;
+  result.bndry_yup = false;
+  result.bndry_ydown = false;
+#endif
+  
+  result.setLocation(outloc);
+  return result;
+}
+}
+
 ////////////// Z DERIVATIVE /////////////////
 
 const Field3D Mesh::indexDDZ(const Field3D &f, CELL_LOC outloc, DIFF_METHOD method, bool inc_xbndry) {
@@ -1274,6 +1473,14 @@ const Field3D Mesh::indexDDZ(const Field3D &f, CELL_LOC outloc, DIFF_METHOD meth
     outloc = diffloc; // No shift (i.e. same as no stagger case)
   }
 
+  if(mesh->StaggerGrids && (outloc != inloc) && canFuseDDZ(f, inloc, outloc)) {
+    // Shifting in X or Y. Combine derivative and interpolation
+    if(method != DIFF_DEFAULT) {
+      func = lookupFunc(table, method);
+    }
+    return ddzShifted(f, inloc, outloc, func, inc_xbndry);
+  }
+
   if(mesh->StaggerGrids && (outloc != inloc)) {
     // Shifting to a new location
     
@@ -1320,12 +1527,13 @@ const Field3D Mesh::indexDDZ(const Field3D &f, CELL_LOC outloc, DIFF_METHOD meth
       }
     }
 
-    result.allocate(); // Make sure data allocated
+    result.allocateTeam(); // Make sure data allocated, shared in a team
 
     int ncz = mesh->LocalNz;
     
-    #pragma omp parallel
-    {
+    // Transform each line. The loop is shared between the threads
+    // of the enclosing parallel region
+    auto ddz_lines = [&]() {
       Array<dcomplex> cv(ncz/2 + 1);
       
       int xs = mesh->xstart;
@@ -1354,8 +1562,16 @@ const Field3D Mesh::indexDDZ(const Field3D &f, CELL_LOC outloc, DIFF_METHOD meth
         irfft(cv.begin(), ncz, result(jx,jy)); // Reverse FFT
       }
     }
+    };
+
+    if(ompTeam()) {
+      // Already in a team, so don't start a new parallel region
+      ddz_lines();
+      ompCheckTeam(); // After the barrier at the end of omp for
+    } else {
+      #pragma omp parallel
+      ddz_lines();
     }
-    // End of parallel section
     
 #if CHECK > 0
     // Mark boundaries as invalid
@@ -1725,6 +1941,8 @@ const Field3D Mesh::indexD4DZ4(const Field3D &f) {
 
 /// Special case where both arguments are 2D. Output location ignored for now
 const Field2D Mesh::indexVDDX(const Field2D &v, const Field2D &f, CELL_LOC UNUSED(outloc), DIFF_METHOD method) {
+  communicatePending();
+
   Mesh::upwind_func func = fVDDX;
 
   if(method != DIFF_DEFAULT) {
@@ -1758,6 +1976,8 @@ const Field2D Mesh::indexVDDX(const Field2D &v, const Field2D &f, CELL_LOC UNUSE
 
 /// General version for 2 or 3-D objects
 const Field3D Mesh::indexVDDX(const Field &v, const Field &f, CELL_LOC outloc, DIFF_METHOD method) {
+  communicatePending();
+
   TRACE("Mesh::indexVDDX(Field, Field)");
 
   ASSERT1(this == v.getMesh());
@@ -1848,6 +2068,8 @@ const Field3D Mesh::indexVDDX(const Field &v, const Field &f, CELL_LOC outloc, D
 
 // special case where both are 2D
 const Field2D Mesh::indexVDDY(const Field2D &v, const Field2D &f, CELL_LOC outloc, DIFF_METHOD method) {
+  communicatePending();
+
   TRACE("Mesh::indexVDDY");
 
   ASSERT1(this == v.getMesh());
@@ -1934,6 +2156,8 @@ const Field2D Mesh::indexVDDY(const Field2D &v, const Field2D &f, CELL_LOC outlo
 
 // general case
 const Field3D Mesh::indexVDDY(const Field &v, const Field &f, CELL_LOC outloc, DIFF_METHOD method) {
+  communicatePending();
+
   TRACE("Mesh::indexVDDY(Field, Field)");
 
   ASSERT1(this == v.getMesh());
@@ -2116,6 +2340,8 @@ const Field3D Mesh::indexVDDZ(const Field &v, const Field &f, CELL_LOC outloc, D
  *******************************************************************************/
 
 const Field2D Mesh::indexFDDX(const Field2D &v, const Field2D &f, CELL_LOC outloc, DIFF_METHOD method) {
+  communicatePending();
+
   TRACE("Mesh::::indexFDDX(Field2D, Field2D)");
   
   if( (method == DIFF_SPLIT) || ((method == DIFF_DEFAULT) && (fFDDX == NULL)) ) {
@@ -2155,6 +2381,8 @@ const Field2D Mesh::indexFDDX(const Field2D &v, const Field2D &f, CELL_LOC outlo
 }
 
 const Field3D Mesh::indexFDDX(const Field3D &v, const Field3D &f, CELL_LOC outloc, DIFF_METHOD method) {
+  communicatePending();
+
   TRACE("Mesh::indexFDDX");
   
   if( (method == DIFF_SPLIT) || ((method == DIFF_DEFAULT) && (fFDDX == NULL)) ) {
@@ -2233,6 +2461,8 @@ const Field3D Mesh::indexFDDX(const Field3D &v, const Field3D &f, CELL_LOC outlo
 /////////////////////////////////////////////////////////////////////////
 
 const Field2D Mesh::indexFDDY(const Field2D &v, const Field2D &f, CELL_LOC outloc, DIFF_METHOD method) {
+  communicatePending();
+
   TRACE("Mesh::indexFDDY(Field2D, Field2D)");
   
   if( (method == DIFF_SPLIT) || ((method == DIFF_DEFAULT) && (fFDDY == NULL)) ) {
@@ -2272,6 +2502,8 @@ const Field2D Mesh::indexFDDY(const Field2D &v, const Field2D &f, CELL_LOC outlo
 }
 
 const Field3D Mesh::indexFDDY(const Field3D &v, const Field3D &f, CELL_LOC outloc, DIFF_METHOD method) {
+  communicatePending();
+
   TRACE("Mesh::indexFDDY");
   
   if( (method == DIFF_SPLIT) || ((method == DIFF_DEFAULT) && (fFDDY == NULL)) ) {
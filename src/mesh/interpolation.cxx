@@ -29,6 +29,13 @@
 #include <output.hxx>
 #include <msg_stack.hxx>
 #include <unused.hxx>
+#include <options.hxx>
+#include <bout/openmpwrap.hxx>
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <vector>
 
 /// Perform interpolation between centre -> shifted or vice-versa
 /*!
@@ -41,6 +48,151 @@ BoutReal interp(const stencil &s)
   return ( 9.*(s.m + s.p) - s.mm - s.pp ) / 16.;
 }
 
+namespace {
+/// Cache of interpolated fields. Only used if enabled
+/// with the mesh:interp_cache option. Not thread safe: in a parallel
+/// region interp_to only uses it on the master thread
+struct InterpCache {
+  bool initialised = false;
+  bool enabled = false;
+  int max_entries = 16; ///< Oldest entries are removed beyond this number
+  
+  /// A cached interpolation. The input is a copy of the values which
+  /// were interpolated, so that changes made in place, by boundary
+  /// conditions or by communication are detected. The result is
+  /// also a copy, so callers can modify what is returned
+  struct Entry {
+    Field3D input;
+    bool split; ///< Input had separate yup and ydown fields
+    Field3D result;
+  };
+  std::deque<Entry> entries;
+
+  bool isEnabled() {
+    if(!initialised) {
+      Options *opt = Options::getRoot()->getSection("mesh");
+      opt->get("interp_cache", enabled, false);
+      opt->get("interp_cache_size", max_entries, 16);
+      initialised = true;
+    }
+    return enabled;
+  }
+
+  /// Interpolation in Y can't use separate yup and ydown fields
+  static bool isSplit(const Field3D &var) {
+    return var.hasYupYdown() && ((&var.yup() != &var) || (&var.ydown() != &var));
+  }
+
+  /// Are the values of \p a and \p b the same at every point?
+  static bool sameValues(const Field3D &a, const Field3D &b) {
+    if((a.getNx() != b.getNx()) || (a.getNy() != b.getNy()) || (a.getNz() != b.getNz()))
+      return false;
+    const BoutReal *ad = &a(0,0,0);
+    const BoutReal *bd = &b(0,0,0);
+    return std::equal(ad, ad + a.getNx()*a.getNy()*a.getNz(), bd);
+  }
+  
+  /// Find a cached result for \p var at \p loc. Returns nullptr if not found
+  const Field3D* find(const Field3D &var, CELL_LOC loc) {
+    for(const auto &e : entries) {
+      if((e.result.getLocation() == loc) &&
+         (e.input.getLocation() == var.getLocation()) &&
+         (e.input.getMesh() == var.getMesh()) &&
+         (e.split == isSplit(var)) &&
+         sameValues(e.input, var))
+        return &e.result;
+    }
+    return nullptr;
+  }
+
+  /// Add the \p result of interpolating \p var
+  void add(const Field3D &var, const Field3D &result) {
+    if(max_entries < 1)
+      return;
+    while(static_cast<int>(entries.size()) >= max_entries)
+      entries.pop_front();
+    // Copies, so that later changes to either field made in place
+    // don't change the cache
+    entries.push_back({copy(var), isSplit(var), copy(result)});
+  }
+};
+
+InterpCache interp_cache;
+}
+
+void interp_clear_cache() {
+  interp_cache.entries.clear();
+}
+
+void interp_index(const Mesh *m, CELL_LOC dir, bool tolow, int i, int ind[4]) {
+  // Centre -> low uses points (-2,-1,0,+1); low -> centre uses (-1,0,+1,+2)
+  int off = tolow ? -2 : -1;
+  for(int k=0;k<4;k++)
+    ind[k] = i + off + k;
+
+  // Second neighbours, matching the indices used in calc_index
+  int &second = tolow ? ind[0] : ind[3];
+  if(dir == CELL_XLOW) {
+    for(int k=0;k<4;k++)
+      ind[k] = BOUTMIN(BOUTMAX(ind[k], 0), m->LocalNx-1);
+  }else if(tolow) {
+    if((i <= m->ystart) && (m->ystart <= 1))
+      second = i - 1;
+  }else {
+    if((i >= m->yend) && (m->ystart <= 1))
+      second = i + 1;
+  }
+}
+
+/// Interpolate \p var in the X or Y direction, between cell centre and
+/// lower cell edge. Only points in the region given by \p xs, \p xe,
+/// \p ys, \p ye are set in \p result.
+///
+/// @param[in] var     The field to interpolate
+/// @param[in] dir     The shifted location (CELL_XLOW or CELL_YLOW)
+/// @param[in] tolow   If true, interpolate from centre to \p dir. If false,
+///                    interpolate from \p dir to centre
+/// @param[out] result Must be allocated
+static void interp_shift(const Field3D &var, CELL_LOC dir, bool tolow, Field3D &result,
+                         int xs, int xe, int ys, int ye) {
+  Mesh *m = var.getMesh();
+  int nz = var.getNz();
+
+  if(dir == CELL_XLOW) {
+    #pragma omp parallel for
+    for(int jx=xs;jx<=xe;jx++) {
+      int ind[4];
+      interp_index(m, dir, tolow, jx, ind);
+      for(int jy=ys;jy<=ye;jy++) {
+        interp_line(var(ind[0], jy), var(ind[1], jy), var(ind[2], jy), var(ind[3], jy),
+                    nz, result(jx, jy));
+      }
+    }
+  }else {
+    // Neighbouring points in Y may be in separate yup/ydown fields
+    const Field3D &yup = var.yup();
+    const Field3D &ydown = var.ydown();
+    bool split = (&yup != &var) || (&ydown != &var);
+    
+    #pragma omp parallel for
+    for(int jx=xs;jx<=xe;jx++) {
+      for(int jy=ys;jy<=ye;jy++) {
+        BoutReal *r = result(jx, jy);
+        if(split) {
+          // Second neighbours not available
+          for(int jz=0;jz<nz;jz++)
+            r[jz] = nan("");
+          continue;
+        }
+        int ind[4];
+        interp_index(m, dir, tolow, jy, ind);
+        interp_line(var(jx, ind[0]), var(jx, ind[1]), var(jx, ind[2]), var(jx, ind[3]),
+                    nz, r);
+      }
+    }
+  }
+}
+
 /*!
   Interpolate between different cell locations
   
@@ -53,9 +205,25 @@ const Field3D interp_to(const Field3D &var, CELL_LOC loc)
 {
   if(mesh->StaggerGrids && (var.getLocation() != loc)) {
 
+    if(ompTeam()) {
+      // The cache and the communication are only used by one thread,
+      // which shares the result with the others
+      return ompMasterResult([&]() { return interp_to(var, loc); });
+    }
+
     // Staggered grids enabled, and need to perform interpolation
     TRACE("Interpolating %s -> %s", strLocation(var.getLocation()), strLocation(loc));
 
+    // Guard cells are used, so fill any waiting for communication
+    mesh->communicatePending();
+
+    bool use_cache = interp_cache.isEnabled();
+    if(use_cache) {
+      const Field3D *cached = interp_cache.find(var, loc);
+      if(cached)
+        return copy(*cached);
+    }
+
     Field3D result;
 
     result = var; // NOTE: This is just for boundaries. FIX!
@@ -64,38 +232,42 @@ const Field3D interp_to(const Field3D &var, CELL_LOC loc)
     if((var.getLocation() == CELL_CENTRE) || (loc == CELL_CENTRE)) {
       // Going between centred and shifted
       
-      bindex bx;
-      stencil s;
       CELL_LOC dir; 
       
       // Get the non-centre location for interpolation direction
       dir = (loc == CELL_CENTRE) ? var.getLocation() : loc;
+      bool tolow = (loc != CELL_CENTRE);
 
       switch(dir) {
       case CELL_XLOW: {
-	start_index(&bx, RGN_NOX);
-	do {
-	  var.setXStencil(s, bx, loc);
-	  result(bx.jx,bx.jy,bx.jz) = interp(s);
-	}while(next_index3(&bx));
+        interp_shift(var, dir, tolow, result, mesh->xstart, mesh->xend, mesh->ystart, mesh->yend);
 	break;
 	// Need to communicate in X
       }
       case CELL_YLOW: {
-	start_index(&bx, RGN_NOY);
-	do {
-	  var.setYStencil(s, bx, loc);
-	  result(bx.jx,bx.jy,bx.jz) = interp(s);
-	}while(next_index3(&bx));
+        interp_shift(var, dir, tolow, result, 0, mesh->LocalNx-1, mesh->ystart, mesh->yend);
 	break;
 	// Need to communicate in Y
       }
       case CELL_ZLOW: {
-	start_index(&bx, RGN_NOZ);
-	do {
-	  var.setZStencil(s, bx, loc);
-	  result(bx.jx,bx.jy,bx.jz) = interp(s);
-	}while(next_index3(&bx));
+        int nz = var.getNz();
+        // Centre -> low uses points (-2,-1,0,+1); low -> centre uses (-1,0,+1,+2)
+        int off = tolow ? -2 : -1;
+        #pragma omp parallel for
+        for(int jx=0;jx<mesh->LocalNx;jx++) {
+          for(int jy=mesh->ystart;jy<=mesh->yend;jy++) {
+            const BoutReal *f = var(jx, jy);
+            BoutReal *r = result(jx, jy);
+            for(int jz=0;jz<nz;jz++) {
+              // Periodic in Z
+              BoutReal fmm = f[(jz + off + nz) % nz];
+              BoutReal fm  = f[(jz + off + 1 + nz) % nz];
+              BoutReal fp  = f[(jz + off + 2) % nz];
+              BoutReal fpp = f[(jz + off + 3) % nz];
+              r[jz] = ( 9.*(fm + fp) - fmm - fpp ) / 16.;
+            }
+          }
+        }
 	break;
       }
       default: {
@@ -121,6 +293,10 @@ const Field3D interp_to(const Field3D &var, CELL_LOC loc)
     }
     result.setLocation(loc);
 
+    if(use_cache) {
+      interp_cache.add(var, result);
+    }
+
     return result;
   }
   
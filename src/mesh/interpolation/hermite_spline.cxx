@@ -23,7 +23,10 @@
 #include "bout/mesh.hxx"
 #include "globals.hxx"
 #include "interpolation.hxx"
+#include "options.hxx"
+#include "bout/openmpwrap.hxx"
 
+#include <string>
 #include <vector>
 
 HermiteSpline::HermiteSpline(int y_offset) :
@@ -33,62 +36,132 @@ HermiteSpline::HermiteSpline(int y_offset) :
   i_corner = i3tensor(mesh->LocalNx, mesh->LocalNy, mesh->LocalNz);
   k_corner = i3tensor(mesh->LocalNx, mesh->LocalNy, mesh->LocalNz);
 
-  // Allocate Field3D members
-  h00_x.allocate();
-  h01_x.allocate();
-  h10_x.allocate();
-  h11_x.allocate();
-  h00_z.allocate();
-  h01_z.allocate();
-  h10_z.allocate();
-  h11_z.allocate();
+  // Combined weights are only valid for second-order central
+  // first derivatives in X and Z
+  bool combine_weights;
+  Options::getRoot()->getSection("interpolation")->get("combine_weights", combine_weights, false);
+
+  Options *meshopt = Options::getRoot()->getSection("mesh");
+  std::string ddx_first, ddz_first;
+  meshopt->getSection("ddx")->get("first", ddx_first, "C2");
+  meshopt->getSection("ddz")->get("first", ddz_first, "C2");
+
+  can_combine = combine_weights && (lowercase(ddx_first) == "c2")
+                                && (lowercase(ddz_first) == "c2");
+  use_combined = false;
+}
+
+void HermiteSpline::findCorner(int x, int y, int z, const Field3D &delta_x,
+                               const Field3D &delta_z, BoutReal &t_x, BoutReal &t_z) {
+  // The integer part of xt_prime, zt_prime are the indices of the cell
+  // containing the field line end-point
+  i_corner[x][y][z] = static_cast<int>(floor(delta_x(x,y,z)));
+  k_corner[x][y][z] = static_cast<int>(floor(delta_z(x,y,z)));
+
+  // t_x, t_z are the normalised coordinates \in [0,1) within the cell
+  // calculated by taking the remainder of the floating point index
+  t_x = delta_x(x,y,z) - static_cast<BoutReal>(i_corner[x][y][z]);
+  t_z = delta_z(x,y,z) - static_cast<BoutReal>(k_corner[x][y][z]);
+
+  // NOTE: A (small) hack to avoid one-sided differences
+  if( i_corner[x][y][z] >= mesh->xend ) {
+    i_corner[x][y][z] = mesh->xend-1;
+    t_x = 1.0;
+  }
+
+  // Check that t_x and t_z are in range
+  if( (t_x < 0.0) || (t_x > 1.0) )
+    throw BoutException("t_x=%e out of range at (%d,%d,%d)", t_x, x,y,z);
+
+  if( (t_z < 0.0) || (t_z > 1.0) )
+    throw BoutException("t_z=%e out of range at (%d,%d,%d)", t_z, x,y,z);
 }
 
 void HermiteSpline::calcWeights(const Field3D &delta_x, const Field3D &delta_z) {
 
   BoutReal t_x, t_z;
 
+  // The combined weights use points i_corner-1 to i_corner+2 in X. If
+  // any point is in the first cell, the derivative there isn't a central
+  // difference, so use the separate basis functions everywhere
+  use_combined = can_combine;
+  for(int x=mesh->xstart;x<=mesh->xend;x++) {
+    for(int y=mesh->ystart; y<=mesh->yend;y++) {
+      for(int z=0;z<mesh->LocalNz;z++) {
+        if (skip_mask(x, y, z)) continue;
+
+        findCorner(x, y, z, delta_x, delta_z, t_x, t_z);
+        if (i_corner[x][y][z] < 1) {
+          use_combined = false;
+        }
+      }
+    }
+  }
+
+  // Only allocate the weights which will be used
+  if (use_combined) {
+    weights.resize(mesh->LocalNx*mesh->LocalNy*mesh->LocalNz*8);
+  } else {
+    std::vector<BoutReal>().swap(weights);
+    h00_x.allocate();
+    h01_x.allocate();
+    h10_x.allocate();
+    h11_x.allocate();
+    h00_z.allocate();
+    h01_z.allocate();
+    h10_z.allocate();
+    h11_z.allocate();
+  }
+
   for(int x=mesh->xstart;x<=mesh->xend;x++) {
     for(int y=mesh->ystart; y<=mesh->yend;y++) {
       for(int z=0;z<mesh->LocalNz;z++) {
 
         if (skip_mask(x, y, z)) continue;
 
-        // The integer part of xt_prime, zt_prime are the indices of the cell
-        // containing the field line end-point
-        i_corner[x][y][z] = static_cast<int>(floor(delta_x(x,y,z)));
-        k_corner[x][y][z] = static_cast<int>(floor(delta_z(x,y,z)));
+        findCorner(x, y, z, delta_x, delta_z, t_x, t_z);
 
-        // t_x, t_z are the normalised coordinates \in [0,1) within the cell
-        // calculated by taking the remainder of the floating point index
-        t_x = delta_x(x,y,z) - static_cast<BoutReal>(i_corner[x][y][z]);
-        t_z = delta_z(x,y,z) - static_cast<BoutReal>(k_corner[x][y][z]);
+        BoutReal hx00 = 2.*t_x*t_x*t_x - 3.*t_x*t_x + 1.;
+        BoutReal hz00 = 2.*t_z*t_z*t_z - 3.*t_z*t_z + 1.;
 
-        // NOTE: A (small) hack to avoid one-sided differences
-        if( i_corner[x][y][z] >= mesh->xend ) {
-          i_corner[x][y][z] = mesh->xend-1;
-          t_x = 1.0;
-        }
+        BoutReal hx01 = -2.*t_x*t_x*t_x + 3.*t_x*t_x;
+        BoutReal hz01 = -2.*t_z*t_z*t_z + 3.*t_z*t_z;
+
+        BoutReal hx10 = t_x*(1.-t_x)*(1.-t_x);
+        BoutReal hz10 = t_z*(1.-t_z)*(1.-t_z);
 
-        // Check that t_x and t_z are in range
-        if( (t_x < 0.0) || (t_x > 1.0) )
-          throw BoutException("t_x=%e out of range at (%d,%d,%d)", t_x, x,y,z);
+        BoutReal hx11 = t_x*t_x*t_x - t_x*t_x;
+        BoutReal hz11 = t_z*t_z*t_z - t_z*t_z;
 
-        if( (t_z < 0.0) || (t_z > 1.0) )
-          throw BoutException("t_z=%e out of range at (%d,%d,%d)", t_z, x,y,z);
+        if(use_combined) {
+          // Fold the C2 derivatives into the weights. In X:
+          //   h00*f(i) + h01*f(i+1) + h10*df/dx(i) + h11*df/dx(i+1)
+          // with df/dx(i) = 0.5*(f(i+1) - f(i-1)), gives weights for
+          // points i-1, i, i+1, i+2. Similarly in Z
+          BoutReal *w = &weights[((x*mesh->LocalNy + y)*mesh->LocalNz + z)*8];
 
-        h00_x(x, y, z) = 2.*t_x*t_x*t_x - 3.*t_x*t_x + 1.;
-        h00_z(x, y, z) = 2.*t_z*t_z*t_z - 3.*t_z*t_z + 1.;
+          w[0] = -0.5*hx10;
+          w[1] = hx00 - 0.5*hx11;
+          w[2] = hx01 + 0.5*hx10;
+          w[3] = 0.5*hx11;
 
-        h01_x(x, y, z) = -2.*t_x*t_x*t_x + 3.*t_x*t_x;
-        h01_z(x, y, z) = -2.*t_z*t_z*t_z + 3.*t_z*t_z;
+          w[4] = -0.5*hz10;
+          w[5] = hz00 - 0.5*hz11;
+          w[6] = hz01 + 0.5*hz10;
+          w[7] = 0.5*hz11;
+        } else {
+          h00_x(x, y, z) = hx00;
+          h00_z(x, y, z) = hz00;
 
-        h10_x(x, y, z) = t_x*(1.-t_x)*(1.-t_x);
-        h10_z(x, y, z) = t_z*(1.-t_z)*(1.-t_z);
+          h01_x(x, y, z) = hx01;
+          h01_z(x, y, z) = hz01;
 
-        h11_x(x, y, z) = t_x*t_x*t_x - t_x*t_x;
-        h11_z(x, y, z) = t_z*t_z*t_z - t_z*t_z;
+          h10_x(x, y, z) = hx10;
+          h10_z(x, y, z) = hz10;
 
+          h11_x(x, y, z) = hx11;
+          h11_z(x, y, z) = hz11;
+        }
       }
     }
   }
@@ -101,6 +174,9 @@ void HermiteSpline::calcWeights(const Field3D &delta_x, const Field3D &delta_z,
 
 Field3D HermiteSpline::interpolate(const Field3D& f) const {
 
+  if(use_combined)
+    return interpolateCombined(f);
+
   Field3D f_interp;
   f_interp.allocate();
 
@@ -163,6 +239,48 @@ Field3D HermiteSpline::interpolate(const Field3D& f) const {
   return f_interp;
 }
 
+Field3D HermiteSpline::interpolateCombined(const Field3D& f) const {
+
+  Field3D f_interp;
+  f_interp.allocate();
+
+  // No derivatives are needed, so no communication. The X guard cells of f
+  // must be set, as for the derivatives in interpolate(). calcWeights has
+  // checked that i_corner-1 to i_corner+2 are in the domain
+  int ncz = mesh->LocalNz;
+
+  BOUT_OMP(parallel for)
+  for(int x=mesh->xstart;x<=mesh->xend;x++) {
+    for(int y=mesh->ystart; y<=mesh->yend;y++) {
+      int y_next = y + y_offset;
+
+      for(int z=0;z<ncz;z++) {
+
+        if (skip_mask(x, y, z)) continue;
+
+        const BoutReal *w = &weights[((x*mesh->LocalNy + y)*ncz + z)*8];
+
+        // X indices i-1 to i+2, and Z indices k-1 to k+2 wrapped
+        const BoutReal *fx[4];
+        int zind[4];
+        int z_mod = ((k_corner[x][y][z] % ncz) + ncz) % ncz;
+        for(int i=0;i<4;i++) {
+          fx[i] = f(i_corner[x][y][z] - 1 + i, y_next);
+          zind[i] = (z_mod - 1 + i + ncz) % ncz;
+        }
+
+        BoutReal result = 0.0;
+        for(int k=0;k<4;k++) {
+          int zk = zind[k];
+          result += w[4+k] * (w[0]*fx[0][zk] + w[1]*fx[1][zk] + w[2]*fx[2][zk] + w[3]*fx[3][zk]);
+        }
+        f_interp(x,y_next,z) = result;
+      }
+    }
+  }
+  return f_interp;
+}
+
 Field3D HermiteSpline::interpolate(const Field3D& f, const Field3D &delta_x, const Field3D &delta_z) {
   calcWeights(delta_x, delta_z);
   return interpolate(f);
@@ -5,8 +5,12 @@
 #include <utils.hxx>
 #include <derivs.hxx>
 #include <msg_stack.hxx>
+#include <bout/openmpwrap.hxx>
 
+#include <algorithm>
 #include <cmath>
+#include <utility>
+#include <vector>
 
 #include "meshfactory.hxx"
 
@@ -22,7 +26,8 @@ Mesh* Mesh::create(Options *opt) {
   return create(NULL, opt);
 }
 
-Mesh::Mesh(GridDataSource *s, Options* opt) : source(s), coords(0), options(opt) {
+Mesh::Mesh(GridDataSource *s, Options* opt)
+    : source(s), coords(0), options(opt), comm_rounds(0), comm_bytes(0.0) {
   if(s == NULL)
     throw BoutException("GridDataSource passed to Mesh::Mesh() is NULL");
   
@@ -38,6 +43,9 @@ Mesh::~Mesh() {
     delete source;
   }
 
+  // Another mesh may be created at the same address
+  GridFile::clearCache(this);
+
   if (coords) {
     delete coords;
   }
@@ -162,19 +170,102 @@ bool Mesh::sourceHasVar(const string &name) {
  * Communications
  **************************************************************************/
 
+namespace {
+  /// Start of the data of a Field2D or Field3D, or null if not allocated
+  const BoutReal *fieldData(const FieldData *f) {
+    if(auto f3d = dynamic_cast<const Field3D*>(f))
+      return f3d->isAllocated() ? &(*f3d)(0, 0, 0) : nullptr;
+    if(auto f2d = dynamic_cast<const Field2D*>(f))
+      return f2d->isAllocated() ? &(*f2d)(0, 0) : nullptr;
+    return nullptr;
+  }
+
+  /// True if \p g has any field data which isn't in \p master
+  bool hasPrivateData(const FieldGroup &g, const FieldGroup &master) {
+    if(g.size() != master.size())
+      return true;
+    for(int i = 0; i < g.size(); i++) {
+      if(fieldData(g.get()[i]) != fieldData(master.get()[i]))
+        return true;
+    }
+    return false;
+  }
+
+  /// Call \p func on the master thread of a team with the FieldGroup of
+  /// each thread, while the others wait. Fields shared by the team (see
+  /// Field3D::allocateTeam) are the same on every thread, so are only
+  /// passed once. Fields private to each thread, such as the results of
+  /// functions which aren't team-aware, have a copy on every thread,
+  /// so the groups of the other threads are also passed, in thread order
+  template<typename F>
+  void forEachTeamGroup(FieldGroup &g, F func) {
+    // Groups of all threads, shared by the team
+    static std::vector<std::pair<int, FieldGroup*>> groups;
+    int thread = 0;
+#ifdef _OPENMP
+    thread = omp_get_thread_num();
+#endif
+    BOUT_OMP(critical(mesh_team_groups))
+    groups.emplace_back(thread, &g);
+    ompBarrier();
+
+    ompMaster([&]() {
+      std::vector<std::pair<int, FieldGroup*>> all;
+      all.swap(groups);
+      std::sort(all.begin(), all.end());
+
+      FieldGroup &master = *all.front().second;
+      func(master);
+      for(std::size_t t = 1; t < all.size(); t++) {
+        if(hasPrivateData(*all[t].second, master))
+          func(*all[t].second);
+      }
+    });
+  }
+}
+
 void Mesh::communicateXZ(FieldGroup &g) {
   TRACE("Mesh::communicate(FieldGroup&)");
 
+  if(ompTeam()) {
+    forEachTeamGroup(g, [&](FieldGroup &group) { communicateXZ(group); });
+    return;
+  }
+
+  // Include fields waiting for communication in the same messages
+  FieldGroup pending(pending_comms);
+  pending_comms.clear();
+  FieldGroup all(pending);
+  all.merge(g);
+
   // Send data
-  comm_handle h = send(g);
+  comm_handle h = send(all);
 
   // Wait for data from other processors
   wait(h);
+
+  // The waiting fields need their yup and ydown fields, as in communicate
+  for(const auto& fptr : pending.field3d())
+    getParallelTransform().calcYUpDown(*fptr);
 }
 
 void Mesh::communicate(FieldGroup &g) {
   TRACE("Mesh::communicate(FieldGroup&)");
 
+  if(ompTeam()) {
+    forEachTeamGroup(g, [&](FieldGroup &group) { communicate(group); });
+    return;
+  }
+
+  if(!pending_comms.empty()) {
+    // Include fields waiting for communication in the same messages
+    FieldGroup all(pending_comms);
+    pending_comms.clear();
+    all.merge(g);
+    communicate(all);
+    return;
+  }
+
   // Send data
   comm_handle h = send(g);
 
@@ -186,9 +277,44 @@ void Mesh::communicate(FieldGroup &g) {
     getParallelTransform().calcYUpDown(*fptr);
 }
 
+void Mesh::communicateLater(FieldGroup &g) {
+  if(ompTeam()) {
+    forEachTeamGroup(g, [&](FieldGroup &group) { communicateLater(group); });
+    return;
+  }
+  pending_comms.merge(g);
+}
+
+void Mesh::communicatePending() {
+  // In a team, every thread sees the same queue here: it is only
+  // changed by the master after a barrier (see forEachTeamGroup), and
+  // all threads wait after the change. So the barriers are only
+  // needed if there is something to send
+  if(pending_comms.empty())
+    return;
+
+  if(ompTeam()) {
+    // Everyone has read the queue before the master empties it
+    ompBarrier();
+    ompMaster([&]() { communicatePending(); });
+    return;
+  }
+
+  TRACE("Mesh::communicatePending()");
+
+  FieldGroup g(pending_comms);
+  pending_comms.clear();
+  communicate(g);
+}
+
 /// This is a bit of a hack for now to get FieldPerp communications
 /// The FieldData class needs to be changed to accomodate FieldPerp objects
 void Mesh::communicate(FieldPerp &f) {
+  if(ompTeam()) {
+    ompMaster([&]() { communicate(f); });
+    return;
+  }
+
   comm_handle recv[2];
   
   int nin = xstart; // Number of x points in inner guard cell
@@ -199,6 +325,9 @@ void Mesh::communicate(FieldPerp &f) {
   recv[0] = irecvXIn(f[0],       nin*LocalNz, 0);
   recv[1] = irecvXOut(f[xend+1], nout*LocalNz, 1);
   
+  comm_rounds++;
+  comm_bytes += (nin + nout) * LocalNz * sizeof(BoutReal);
+
   // Send data
   sendXIn(f[xstart], nin*LocalNz, 1);
   sendXOut(f[xend-nout+1], nout*LocalNz, 0);
@@ -31,29 +31,50 @@
 #include <difops.hxx>
 #include <gyro_average.hxx>
 #include <invert_laplace.hxx>
+#include <batched_tridag.hxx>
+#include <fft.hxx>
+#include <msg_stack.hxx>
+#include <utils.hxx>
+#include <bout/constants.hxx>
+#include <bout/openmpwrap.hxx>
+#include <bout/sys/timer.hxx>
+
+#include <cmath>
 
 const Field3D gyroTaylor0(const Field3D &f, const Field3D &rho) {
   return f + SQ(rho) * Delp2(f);
 }
 
+namespace {
+/// Laplacian solver used by the Pade approximations. This is separate
+/// from Laplacian::defaultInstance(), so that setting the coefficients and
+/// flags here does not change those used by other code. Settings are read
+/// from the "laplace" section, as for the default instance
+Laplacian *gyroLaplacian() {
+  static Laplacian *lap = nullptr;
+  if(lap == nullptr)
+    lap = Laplacian::create();
+  return lap;
+}
+
+/// Invert (1 + d*Delp2)g = f for each f, leaving boundaries unchanged
+std::vector<Field3D> gyroInvert(const std::vector<Field3D> &f, const Field2D &d, int flags) {
+  Laplacian *lap = gyroLaplacian();
+  lap->setCoefA(1.0);
+  lap->setCoefC(1.0);
+  lap->setCoefD(d);
+  lap->setFlags(flags);
+  return lap->solve(f);
+}
+}
+
 const Field3D gyroPade0(const Field3D &f, BoutReal rho, int flags) {
-  
-  Field2D a = 1.0;
-  Field2D d = -rho*rho;
-  
-  /// Invert, leaving boundaries unchanged
-  return invert_laplace(f, flags, &a, NULL, &d);
+  return gyroPade0(f, Field2D(rho), flags);
 }
 
 /// Pade approximation G_0 = (1 - rho^2*Delp2)g = f
 const Field3D gyroPade0(const Field3D &f, const Field2D &rho, int flags) {
-  /// Have to use Z average of rho for efficient inversion
-  
-  Field2D a = 1.0;
-  Field2D d = -rho*rho;
-  
-  /// Invert, leaving boundaries unchanged
-  return invert_laplace(f, flags, &a, NULL, &d);
+  return gyroPade0(std::vector<Field3D>{f}, rho, flags)[0];
 }
 
 /// Pade approximation G_0 = (1 - rho^2*Delp2)g = f
@@ -62,21 +83,17 @@ const Field3D gyroPade0(const Field3D &f, const Field3D &rho, int flags) {
   return gyroPade0(f, DC(rho), flags);
 }
 
+std::vector<Field3D> gyroPade0(const std::vector<Field3D> &f, const Field2D &rho, int flags) {
+  return gyroInvert(f, -rho*rho, flags);
+}
+
 const Field3D gyroPade1(const Field3D &f, BoutReal rho, int flags) {
-  Field2D a = 1.0;
-  Field2D d = -0.5*rho*rho;
-  
-  /// Invert, leaving boundaries unchanged
-  return invert_laplace(f, flags, &a, NULL, &d);
+  return gyroPade1(f, Field2D(rho), flags);
 }
 
 /// Pade approximation G_1 = (1 - 0.5*rho^2*Delp2)g = f
 const Field3D gyroPade1(const Field3D &f, const Field2D &rho, int flags) {
-  Field2D a = 1.0;
-  Field2D d = -0.5*rho*rho;
-  
-  /// Invert, leaving boundaries unchanged
-  return invert_laplace(f, flags, &a, NULL, &d);
+  return gyroPade1(std::vector<Field3D>{f}, rho, flags)[0];
 }
 
 /// Pade approximation G_1 = (1 - 0.5*rho^2*Delp2)g = f
@@ -84,6 +101,10 @@ const Field3D gyroPade1(const Field3D &f, const Field3D &rho, int flags) {
   return gyroPade1(f, DC(rho), flags);
 }
 
+std::vector<Field3D> gyroPade1(const std::vector<Field3D> &f, const Field2D &rho, int flags) {
+  return gyroInvert(f, -0.5*rho*rho, flags);
+}
+
 /// Pade approximation G_1 = (1 - 0.5*rho^2*Delp2)g = f
 const Field2D gyroPade1(const Field2D &f, const Field2D &rho, int flags) {
   // Very inefficient implementation
@@ -108,8 +129,385 @@ const Field3D gyroPade2(const Field3D &f, const Field2D &rho, int flags) {
   return result;
 }
 
+std::vector<Field3D> gyroPade2(const std::vector<Field3D> &f, const Field2D &rho, int flags) {
+  std::vector<Field3D> result = gyroPade1(gyroPade1(f, rho, flags), rho, flags);
+  FieldGroup group;
+  for(auto &r : result) {
+    group.add(r);
+  }
+  mesh->communicate(group);
+  for(auto &r : result) {
+    r = 0.5*rho*rho*Delp2( r );
+    r.applyBoundary("dirichlet");
+  }
+  return result;
+}
+
 const Field3D gyroPade2(const Field3D &f, const Field3D &rho, int flags) {
   /// Have to use Z average of rho for efficient inversion
   return gyroPade2(f, DC(rho), flags);
 }
 
+
+/**************************************************************
+ * Gyro-averaging operator object
+ **************************************************************/
+
+namespace {
+/// Inversion of (1 + d*Delp2) for a fixed d. The matrices for all Z
+/// modes and Y indices are factorised when this is created, so each
+/// solve only needs the FFTs and the forward and back substitution.
+/// Like LaplaceSerialTri, only works for NXPE = 1. Boundary values can't
+/// be given, so INVERT_SET boundary flags are not supported.
+///
+/// Y indices outside the range solved (set by include_yguards and
+/// extra_yguards_*) are copied from the input, where Laplacian::solve
+/// leaves them unset.
+class GyroPade : public Laplacian {
+public:
+  GyroPade(const Field2D &d, int flags);
+
+  using Laplacian::setCoefA;
+  void setCoefA(const Field2D &UNUSED(val)) override { fixed(); }
+  using Laplacian::setCoefC;
+  void setCoefC(const Field2D &UNUSED(val)) override { fixed(); }
+  using Laplacian::setCoefD;
+  void setCoefD(const Field2D &UNUSED(val)) override { fixed(); }
+  using Laplacian::setCoefEx;
+  void setCoefEx(const Field2D &UNUSED(val)) override { fixed(); }
+  using Laplacian::setCoefEz;
+  void setCoefEz(const Field2D &UNUSED(val)) override { fixed(); }
+
+  using Laplacian::solve;
+  const FieldPerp solve(const FieldPerp &b) override;
+  const Field3D solve(const Field3D &b) override {
+    return solve(std::vector<Field3D>{b})[0];
+  }
+  const Field2D solve(const Field2D &b) override;
+  std::vector<Field3D> solve(const std::vector<Field3D> &b) override;
+
+  // x0 is only used for INVERT_SET boundaries, which are rejected
+  const FieldPerp solve(const FieldPerp &b, const FieldPerp &UNUSED(x0)) override {
+    return solve(b);
+  }
+  const Field3D solve(const Field3D &b, const Field3D &UNUSED(x0)) override {
+    return solve(b);
+  }
+  const Field2D solve(const Field2D &b, const Field2D &UNUSED(x0)) override {
+    return solve(b);
+  }
+
+private:
+  int ys, ye;     ///< Range of Y indices solved, as Laplacian::solve
+  int nkz;        ///< Number of Z Fourier modes, LocalNz/2 + 1
+  int xs, nsolve; ///< First X index and number of X points in the matrices
+
+  /// 1 where the RHS is used, 0 in boundary cells which are set to zero
+  Array<BoutReal> mask;
+
+  /// Factorised matrices for all modes, one for each Y index
+  std::vector<BatchedTridag<dcomplex>> tri;
+
+  void fixed() {
+    throw BoutException("GyroPade: coefficients are set when created");
+  }
+
+  /// Solve for all modes at Y index \p jy, in place. Mode kz at
+  /// X index ix is fk[ix*xstride + kz]. \p rhs is work space of
+  /// size nsolve*(maxmode+1)
+  void solveModes(int jy, dcomplex *fk, int xstride, dcomplex *rhs);
+};
+
+GyroPade::GyroPade(const Field2D &d, int flags) {
+  if(!mesh->firstX() || !mesh->lastX()) {
+    throw BoutException("GyroPade only works for mesh->NXPE = 1");
+  }
+  setFlags(flags);
+
+  // The boundary cells are either zeroed or keep the RHS value (see
+  // mask below), which can't set a boundary to a given value
+  if((inner_boundary_flags & INVERT_SET) || (outer_boundary_flags & INVERT_SET)) {
+    throw BoutException("GyroPade: INVERT_SET boundary flags are not supported");
+  }
+  if(global_flags & INVERT_4TH_ORDER) {
+    throw BoutException("GyroPade: INVERT_4TH_ORDER is not supported");
+  }
+
+  ys = mesh->ystart;
+  ye = mesh->yend;
+  if(mesh->hasBndryLowerY()) {
+    if(include_yguards)
+      ys = 0;
+    ys += extra_yguards_lower;
+  }
+  if(mesh->hasBndryUpperY()) {
+    if(include_yguards)
+      ye = mesh->LocalNy-1;
+    ye -= extra_yguards_upper;
+  }
+
+  nkz = mesh->LocalNz/2 + 1;
+
+  // If periodic in X then cyclic tridiagonal, excluding the guard cells
+  xs = mesh->periodicX ? mesh->xstart : 0;
+  nsolve = mesh->LocalNx - 2*xs;
+
+  // The boundary cells of the RHS which are zeroed, from what
+  // tridagBoundaryRHS does to an array of ones
+  Array<dcomplex> bk(mesh->LocalNx);
+  for(int ix=0;ix<mesh->LocalNx;ix++)
+    bk[ix] = 1.0;
+  tridagBoundaryRHS(bk.begin(), global_flags, inner_boundary_flags, outer_boundary_flags);
+  mask = Array<BoutReal>(mesh->LocalNx);
+  for(int ix=0;ix<mesh->LocalNx;ix++)
+    mask[ix] = bk[ix].real();
+
+  Coordinates *coord = mesh->coordinates();
+  Field2D one(1.0);
+  Array<dcomplex> avec(mesh->LocalNx), bvec(mesh->LocalNx), cvec(mesh->LocalNx);
+
+  const int nmode = maxmode + 1;
+  tri.resize(ye - ys + 1);
+  for(int jy=ys;jy<=ye;jy++) {
+    BatchedTridag<dcomplex> &t = tri[jy - ys];
+    t.setup(nmode, nsolve);
+    t.setPeriodic(mesh->periodicX);
+
+    for(int kz=0;kz<nmode;kz++) {
+      BoutReal kwave = kz*2.0*PI/coord->zlength(); // wave number is 1/[rad]
+      tridagMatrix(avec.begin(), bvec.begin(), cvec.begin(), bk.begin(),
+                   jy, kz, kwave,
+                   global_flags, inner_boundary_flags, outer_boundary_flags,
+                   &one, nullptr, &d);
+      t.setCoefs(kz, avec.begin() + xs, bvec.begin() + xs, cvec.begin() + xs);
+    }
+    t.factor();
+  }
+}
+
+void GyroPade::solveModes(int jy, dcomplex *fk, int xstride, dcomplex *rhs) {
+  const int nmode = maxmode + 1;
+
+  for(int ix=0;ix<nsolve;ix++) {
+    const dcomplex *f = fk + (ix + xs)*xstride;
+    const BoutReal m = mask[ix + xs];
+    for(int kz=0;kz<nmode;kz++)
+      rhs[ix*nmode + kz] = f[kz] * m;
+  }
+
+  tri[jy - ys].solve(rhs, nmode);
+
+  for(int ix=0;ix<nsolve;ix++) {
+    dcomplex *f = fk + (ix + xs)*xstride;
+    for(int kz=0;kz<nmode;kz++)
+      f[kz] = rhs[ix*nmode + kz];
+    for(int kz=nmode;kz<nkz;kz++)
+      f[kz] = 0.0;
+  }
+
+  // Copy boundary regions if periodic
+  const int nx = mesh->LocalNx;
+  for(int ix=0;ix<xs;ix++) {
+    for(int kz=0;kz<nkz;kz++) {
+      fk[ix*xstride + kz] = fk[(nx - 2*xs + ix)*xstride + kz];
+      fk[(nx - xs + ix)*xstride + kz] = fk[(xs + ix)*xstride + kz];
+    }
+  }
+
+  if(global_flags & INVERT_KX_ZERO) {
+    dcomplex offset(0.0);
+    for(int ix=mesh->xstart;ix<=mesh->xend;ix++)
+      offset += fk[ix*xstride];
+    offset /= static_cast<BoutReal>(mesh->xend - mesh->xstart + 1);
+    for(int ix=mesh->xstart;ix<=mesh->xend;ix++)
+      fk[ix*xstride] -= offset;
+  }
+
+  if(global_flags & INVERT_ZERO_DC) {
+    for(int ix=0;ix<nx;ix++)
+      fk[ix*xstride] = 0.0;
+  }
+}
+
+const FieldPerp GyroPade::solve(const FieldPerp &b) {
+  TRACE("GyroPade::solve(FieldPerp)");
+
+  int jy = b.getIndex();
+  if((jy < ys) || (jy > ye))
+    throw BoutException("GyroPade: Y index %d outside solved range %d to %d", jy, ys, ye);
+
+  const int nx = mesh->LocalNx, nz = mesh->LocalNz;
+
+  Array<dcomplex> fk(nx*nkz);
+  rfft(b[0], nz, nx, fk.begin());
+
+  std::vector<dcomplex> rhs(nsolve*(maxmode + 1));
+  solveModes(jy, fk.begin(), nkz, rhs.data());
+
+  FieldPerp x;
+  x.allocate();
+  x.setIndex(jy);
+  irfft(fk.begin(), nz, nx, x[0]);
+  return x;
+}
+
+/// Only the DC mode is non-zero, so no FFTs are needed
+const Field2D GyroPade::solve(const Field2D &b) {
+  TRACE("GyroPade::solve(Field2D)");
+
+  const int nx = mesh->LocalNx;
+
+  Field2D x = b;
+  x.allocate();
+
+  BOUT_OMP(parallel)
+  {
+    std::vector<dcomplex> fk(nx*nkz), rhs(nsolve*(maxmode + 1));
+    BOUT_OMP(for)
+    for(int jy=ys;jy<=ye;jy++) {
+      for(int ix=0;ix<nx;ix++) {
+        fk[ix*nkz] = b(ix,jy);
+        for(int kz=1;kz<nkz;kz++)
+          fk[ix*nkz + kz] = 0.0;
+      }
+      solveModes(jy, fk.data(), nkz, rhs.data());
+      for(int ix=0;ix<nx;ix++)
+        x(ix,jy) = fk[ix*nkz].real();
+    }
+  }
+  return x;
+}
+
+/// Transforms all Z lines of each field at once, then solves the
+/// Y indices in parallel
+std::vector<Field3D> GyroPade::solve(const std::vector<Field3D> &b) {
+  TRACE("GyroPade::solve(vector<Field3D>)");
+
+  Timer timer("invert");
+
+  const int nx = mesh->LocalNx, ny = mesh->LocalNy, nz = mesh->LocalNz;
+
+  Array<dcomplex> fk(nx*ny*nkz);
+
+  std::vector<Field3D> result;
+  for(const auto &f : b) {
+    rfft(f(0,0), nz, nx*ny, fk.begin());
+
+    BOUT_OMP(parallel)
+    {
+      std::vector<dcomplex> rhs(nsolve*(maxmode + 1));
+      BOUT_OMP(for)
+      for(int jy=ys;jy<=ye;jy++)
+        solveModes(jy, fk.begin() + jy*nkz, ny*nkz, rhs.data());
+    }
+
+    // Y indices not solved, including Y guard cells unless
+    // include_yguards is set, are copied from f
+    Field3D x;
+    x.allocate();
+    irfft(fk.begin(), nz, nx*ny, x(0,0));
+    x.setLocation(f.getLocation());
+    result.push_back(x);
+  }
+  return result;
+}
+}
+
+GyroAverage::GyroAverage(const Field2D &rho, int flags) : rho(rho), flags(flags) {
+  halfrhosq = 0.5*rho*rho;
+}
+
+GyroAverage::~GyroAverage() {}
+
+Laplacian *GyroAverage::getInversion(std::unique_ptr<Laplacian> &inv, BoutReal factor) {
+  if(!inv) {
+    Field2D d = -factor*rho*rho;
+    if(mesh->firstX() && mesh->lastX()) {
+      inv.reset(new GyroPade(d, flags));
+    }else {
+      // Parallel in X, so use a general solver. The coefficients
+      // are only set once
+      inv.reset(Laplacian::create());
+      inv->setCoefA(1.0);
+      inv->setCoefC(1.0);
+      inv->setCoefD(d);
+      inv->setFlags(flags);
+    }
+  }
+  return inv.get();
+}
+
+const Field3D GyroAverage::pade0(const Field3D &f) {
+  return pade0(std::vector<Field3D>{f})[0];
+}
+
+std::vector<Field3D> GyroAverage::pade0(const std::vector<Field3D> &f) {
+  return getInversion(inv0, 1.0)->solve(f);
+}
+
+const Field3D GyroAverage::pade1(const Field3D &f) {
+  return pade1(std::vector<Field3D>{f})[0];
+}
+
+const Field2D GyroAverage::pade1(const Field2D &f) {
+  return getInversion(inv1, 0.5)->solve(f);
+}
+
+std::vector<Field3D> GyroAverage::pade1(const std::vector<Field3D> &f) {
+  return getInversion(inv1, 0.5)->solve(f);
+}
+
+const Field3D GyroAverage::pade2(const Field3D &f) {
+  return pade2(std::vector<Field3D>{f})[0];
+}
+
+std::vector<Field3D> GyroAverage::pade2(const std::vector<Field3D> &f) {
+  std::vector<Field3D> result = pade1(pade1(f));
+  FieldGroup group;
+  for(auto &r : result) {
+    group.add(r);
+  }
+  mesh->communicate(group);
+  for(auto &r : result) {
+    r = halfrhosq*Delp2( r );
+    r.applyBoundary("dirichlet");
+  }
+  return result;
+}
+
+const Field3D GyroAverage::besselJ0(const Field3D &f) {
+  TRACE("GyroAverage::besselJ0");
+
+  const int nx = mesh->LocalNx, ny = mesh->LocalNy, nz = mesh->LocalNz;
+  const int nkz = nz/2 + 1;
+
+  if(j0symbol.empty()) {
+    // k_perp^2 = g^zz k_z^2, as the Z second derivative in tridagCoefs
+    Coordinates *coord = mesh->coordinates();
+    j0symbol = Array<BoutReal>(nx*ny*nkz);
+    for(int ix=0;ix<nx;ix++) {
+      for(int jy=0;jy<ny;jy++) {
+        BoutReal gzz = coord->g33(ix,jy);
+        if(mesh->IncIntShear)
+          gzz += coord->g11(ix,jy) * SQ(coord->IntShiftTorsion(ix,jy));
+        BoutReal krho = sqrt(gzz) * rho(ix,jy) * 2.0*PI/coord->zlength();
+        for(int kz=0;kz<nkz;kz++)
+          j0symbol[(ix*ny + jy)*nkz + kz] = j0(kz*krho);
+      }
+    }
+  }
+
+  Array<dcomplex> fk(nx*ny*nkz);
+  rfft(f(0,0), nz, nx*ny, fk.begin());
+
+  const int n = nx*ny*nkz;
+  BOUT_OMP(parallel for)
+  for(int i=0;i<n;i++)
+    fk[i] *= j0symbol[i];
+
+  Field3D result;
+  result.allocate();
+  irfft(fk.begin(), nz, nx*ny, result(0,0));
+  result.setLocation(f.getLocation());
+  return result;
+}
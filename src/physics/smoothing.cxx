@@ -39,28 +39,41 @@
 
 #include <utils.hxx>
 #include <bout/constants.hxx>
+#include <bout/openmpwrap.hxx>
 
 // Smooth using simple 1-2-1 filter
 const Field3D smooth_x(const Field3D &f) {
   TRACE("smooth_x");
+
+  // Guard cells are used, so fill any waiting for communication
+  mesh->communicatePending();
   
   Field3D result;
   result.allocate();
+
+  const int nx = mesh->LocalNx;
+  const int nyz = mesh->LocalNy*mesh->LocalNz;
+  const BoutReal *fd = &f(0,0,0);
+  BoutReal *rd = &result(0,0,0);
   
   // Copy boundary region
-  for(int jy=0;jy<mesh->LocalNy;jy++)
-    for(int jz=0;jz<mesh->LocalNz;jz++) {
-      result(0,jy,jz) = f(0,jy,jz);
-      result(mesh->LocalNx-1,jy,jz) = f(mesh->LocalNx-1,jy,jz);
-    }
+  for(int i=0;i<nyz;i++) {
+    rd[i] = fd[i];
+    rd[(nx-1)*nyz + i] = fd[(nx-1)*nyz + i];
+  }
 
   // Smooth using simple 1-2-1 filter
-
-  for(int jx=1;jx<mesh->LocalNx-1;jx++)
-    for(int jy=0;jy<mesh->LocalNy;jy++)
-      for(int jz=0;jz<mesh->LocalNz;jz++) {
-	result(jx,jy,jz) = 0.5*f(jx,jy,jz) + 0.25*( f(jx-1,jy,jz) + f(jx+1,jy,jz) );
-      }
+  // Each X index is a contiguous block of Y and Z
+  BOUT_OMP(parallel for)
+  for(int jx=1;jx<nx-1;jx++) {
+    const BoutReal *fm = fd + (jx-1)*nyz;
+    const BoutReal *fc = fd + jx*nyz;
+    const BoutReal *fp = fd + (jx+1)*nyz;
+    BoutReal *r = rd + jx*nyz;
+    for(int i=0;i<nyz;i++) {
+      r[i] = 0.5*fc[i] + 0.25*( fm[i] + fp[i] );
+    }
+  }
 
   // Need to communicate boundaries
   mesh->communicate(result);
@@ -71,24 +84,34 @@ const Field3D smooth_x(const Field3D &f) {
 
 const Field3D smooth_y(const Field3D &f) {
   TRACE("smooth_y");
+
+  // Guard cells are used, so fill any waiting for communication
+  mesh->communicatePending();
   
   Field3D result;
   result.allocate();
-  
-  // Copy boundary region
-  for(int jx=0;jx<mesh->LocalNx;jx++)
-    for(int jz=0;jz<mesh->LocalNz;jz++) {
-      result(jx,0,jz) = f(jx,0,jz);
-      result(jx,mesh->LocalNy-1,jz) = f(jx,mesh->LocalNy-1,jz);
-    }
-  
-  // Smooth using simple 1-2-1 filter
 
-  for(int jx=0;jx<mesh->LocalNx;jx++)
-    for(int jy=1;jy<mesh->LocalNy-1;jy++)
-      for(int jz=0;jz<mesh->LocalNz;jz++) {
-	result(jx,jy,jz) = 0.5*f(jx,jy,jz) + 0.25*( f.ydown()(jx,jy-1,jz) + f.yup()(jx,jy+1,jz) );
-      }
+  const int nx = mesh->LocalNx;
+  const int nz = mesh->LocalNz;
+  const int nyz = mesh->LocalNy*nz;
+  const BoutReal *fd = &f(0,0,0);
+  const BoutReal *fdown = &f.ydown()(0,0,0);
+  const BoutReal *fup = &f.yup()(0,0,0);
+  BoutReal *rd = &result(0,0,0);
+  
+  // Smooth using simple 1-2-1 filter, copying the boundary region.
+  // For each X index the interior in Y is a contiguous block
+  BOUT_OMP(parallel for)
+  for(int jx=0;jx<nx;jx++) {
+    const int start = jx*nyz;
+    for(int i=start;i<start+nz;i++) {
+      rd[i] = fd[i];
+      rd[i + nyz - nz] = fd[i + nyz - nz];
+    }
+    for(int i=start+nz;i<start+nyz-nz;i++) {
+      rd[i] = 0.5*fd[i] + 0.25*( fdown[i-nz] + fup[i+nz] );
+    }
+  }
 
   // Need to communicate boundaries
   mesh->communicate(result);
@@ -342,92 +365,116 @@ BoutReal Vol_Integral(const Field2D &var) {
 }
 
 const Field3D smoothXY(const Field3D &f) {
-  Field3D result;
-  result.allocate();
-
-  for(int x=2;x<mesh->LocalNx-2;x++)
-    for(int y=2;y<mesh->LocalNy-2;y++)
-      for(int z=0;z<mesh->LocalNz;z++) {
-        result(x,y,z) = 0.5*f(x,y,z) + 0.125*( 0.5*f(x+1,y,z) + 0.125*(f(x+2,y,z) + f(x,y,z) + f(x+1,y-1,z) + f(x+1,y+1,z)) +
-                                                   0.5*f(x-1,y,z) + 0.125*(f(x,y,z) + f(x-2,y,z) + f(x-1,y-1,z) + f(x-1,y+1,z)) +
-                                                   0.5*f(x,y-1,z) + 0.125*(f(x+1,y-1,z) + f(x-1,y-1,z) + f(x,y-2,z) + f(x,y,z)) +
-                                                   0.5*f(x,y+1,z) + 0.125*(f(x+1,y+1,z) + f(x-1,y+1,z) + f(x,y,z) + f(x,y+2,z)));
+  TRACE("smoothXY");
+
+  // Guard cells are used, so fill any waiting for communication
+  mesh->communicatePending();
+
+  // Two points at each edge in X and Y are not smoothed
+  Field3D result = copy(f);
+
+  const int nx = mesh->LocalNx;
+  const int ny = mesh->LocalNy;
+  const int nz = mesh->LocalNz;
+  const int sx = ny*nz; // Strides in X and Y
+  const int sy = nz;
+  const BoutReal *fd = &f(0,0,0);
+  BoutReal *rd = &result(0,0,0);
+
+  BOUT_OMP(parallel for)
+  for(int x=2;x<nx-2;x++)
+    for(int y=2;y<ny-2;y++) {
+      // Pointers to Z lines, named by their offset in X and Y
+      const BoutReal *c = fd + x*sx + y*sy;
+      const BoutReal *xp = c + sx, *xpp = c + 2*sx, *xm = c - sx, *xmm = c - 2*sx;
+      const BoutReal *yp = c + sy, *ypp = c + 2*sy, *ym = c - sy, *ymm = c - 2*sy;
+      const BoutReal *xpyp = xp + sy, *xpym = xp - sy, *xmyp = xm + sy, *xmym = xm - sy;
+      BoutReal *r = rd + x*sx + y*sy;
+      BOUT_OMP(simd)
+      for(int z=0;z<nz;z++) {
+        r[z] = 0.5*c[z] + 0.125*( 0.5*xp[z] + 0.125*(xpp[z] + c[z] + xpym[z] + xpyp[z]) +
+                                  0.5*xm[z] + 0.125*(c[z] + xmm[z] + xmym[z] + xmyp[z]) +
+                                  0.5*ym[z] + 0.125*(xpym[z] + xmym[z] + ymm[z] + c[z]) +
+                                  0.5*yp[z] + 0.125*(xpyp[z] + xmyp[z] + c[z] + ypp[z]));
       }
+    }
   
   return result;
 }
 
-
-void nl_filter(rvec &f, BoutReal w) {
-  for(size_t i=1; i<f.size()-1; i++) {
-    
-    BoutReal dp = f[i+1] - f[i];
-    BoutReal dm = f[i-1] - f[i];
-    if(dp*dm > 0.) {
-      // Local extrema - adjust
-      BoutReal ep, em, e; // Amount to adjust by
-      if(fabs(dp) > fabs(dm)) {
-	ep = w*0.5*dp;
-	em = w*dm;
-	e = (fabs(ep) < fabs(em)) ? ep : em; // Pick smallest absolute
-	// Adjust
-	f[i+1] -= e;
-	f[i] += e;
-      }else {
-	ep = w*0.5*dm;
-	em = w*dp;
-	e = (fabs(ep) < fabs(em)) ? ep : em; // Pick smallest absolute
-	// Adjust
-	f[i-1] -= e;
-	f[i] += e;
-      }
+namespace {
+/*!
+ * Nonlinear filter of Shyy et al., applied in place to \p nlines lines
+ * of \p n points. Point i of line l is data[i*stride + l*line_stride].
+ *
+ * The filter is sequential along each line, so all lines are filtered
+ * together one point at a time. When line_stride is 1 the inner loop
+ * is over contiguous memory, and vectorises.
+ */
+void nl_filter_lines(BoutReal *data, int n, int stride, int nlines, int line_stride,
+                     BoutReal w) {
+  for(int i=1; i<n-1; i++) {
+    BoutReal *fm = data + (i-1)*stride;
+    BoutReal *fc = data + i*stride;
+    BoutReal *fp = data + (i+1)*stride;
+    BOUT_OMP(simd)
+    for(int l=0; l<nlines; l++) {
+      const int j = l*line_stride;
+      const BoutReal dp = fp[j] - fc[j];
+      const BoutReal dm = fm[j] - fc[j];
+      // Written with selects rather than branches, so that it vectorises
+      const bool plus = fabs(dp) > fabs(dm); // Adjust the larger difference
+      const BoutReal ep = w*0.5*(plus ? dp : dm);
+      const BoutReal em = w*(plus ? dm : dp);
+      BoutReal e = (fabs(ep) < fabs(em)) ? ep : em; // Pick smallest absolute
+      e = (dp*dm > 0.) ? e : 0.0; // Only local extrema are adjusted
+      const BoutReal eplus = plus ? e : 0.0;
+      fc[j] += e;
+      fp[j] -= eplus;
+      fm[j] -= e - eplus;
     }
   }
 }
+}
 
 const Field3D nl_filter_x(const Field3D &f, BoutReal w) {
   TRACE("nl_filter_x( Field3D )");
+
+  // Guard cells are used, so fill any waiting for communication
+  mesh->communicatePending();
   
-  Field3D result;
-  result.allocate();
-  rvec v(mesh->LocalNx);
-  
-  for (int jy=0;jy<mesh->LocalNy;jy++) {
-    for (int jz=0;jz<mesh->LocalNz;jz++) {
-      for (int jx=0;jx<mesh->LocalNx;jx++) {
-        v[jx] = f(jx,jy,jz);
-      }
-      nl_filter(v, w);
-      for (int jx=0;jx<mesh->LocalNx;jx++) {
-         result(jx,jy,jz) = v[jx];
-      }
-    }
+  Field3D result = copy(f);
+
+  const int ny = mesh->LocalNy;
+  const int nz = mesh->LocalNz;
+  BoutReal *data = &result(0,0,0);
+
+  // Lines in X for each Y index. Z is contiguous
+  BOUT_OMP(parallel for)
+  for (int jy=0;jy<ny;jy++) {
+    nl_filter_lines(data + jy*nz, mesh->LocalNx, ny*nz, nz, 1, w);
   }
   
   return result;
 }
 
 const Field3D nl_filter_y(const Field3D &f, BoutReal w) {
-  TRACE("nl_filter_x( Field3D )");
-  
-  Field3D result;
-  result.allocate();
+  TRACE("nl_filter_y( Field3D )");
 
-  rvec v(mesh->LocalNy); // Temporary array
+  // Guard cells are used, so fill any waiting for communication
+  mesh->communicatePending();
   
   // Transform into field-aligned coordinates
-  Field3D fs = mesh->toFieldAligned(f);
+  Field3D result = copy(mesh->toFieldAligned(f));
 
+  const int ny = mesh->LocalNy;
+  const int nz = mesh->LocalNz;
+  BoutReal *data = &result(0,0,0);
+
+  // Lines in Y for each X index. Z is contiguous
+  BOUT_OMP(parallel for)
   for (int jx=0;jx<mesh->LocalNx;jx++) {
-    for (int jz=0;jz<mesh->LocalNz;jz++) {
-      for (int jy=0;jy<mesh->LocalNy;jy++) {
-        v[jy] = fs(jx,jy,jz);
-      }
-      nl_filter(v, w);
-      for (int jy=0;jy<mesh->LocalNy;jy++) {
-        result(jx,jy,jz) = v[jy];
-      }
-    }
+    nl_filter_lines(data + jx*ny*nz, ny, nz, nz, 1, w);
   }
   
   // Tranform the field back from field aligned coordinates
@@ -437,21 +484,16 @@ const Field3D nl_filter_y(const Field3D &f, BoutReal w) {
 const Field3D nl_filter_z(const Field3D &fs, BoutReal w) {
   TRACE("nl_filter_z( Field3D )");
   
-  Field3D result;
-  result.allocate();
-  
-  rvec v(mesh->LocalNz);
-  
+  Field3D result = copy(fs);
+
+  const int ny = mesh->LocalNy;
+  const int nz = mesh->LocalNz;
+  BoutReal *data = &result(0,0,0);
+
+  // Lines in Z for each X index, one for each Y
+  BOUT_OMP(parallel for)
   for (int jx=0;jx<mesh->LocalNx;jx++) {
-    for (int jy=0;jy<mesh->LocalNy;jy++) {
-      for (int jz=0;jz<mesh->LocalNz;jz++) {
-        v[jz] = fs(jx,jy,jz);
-      }
-      nl_filter(v, w);
-      for (int jz=0;jz<mesh->LocalNz;jz++) {
-        result(jx,jy,jz) = v[jz];
-      }
-    }
+    nl_filter_lines(data + jx*ny*nz, nz, 1, ny, nz, w);
   }
   
   return result;
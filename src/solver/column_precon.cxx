@@ -0,0 +1,275 @@
+/**************************************************************************
+ * Block Jacobi preconditioner from a coloured finite difference Jacobian
+ *
+ **************************************************************************
+ * Copyright 2010 B.D.Dudson, S.Farley, M.V.Umansky, X.Q.Xu
+ *
+ * Contact: Ben Dudson, bd512@york.ac.uk
+ *
+ * This file is part of BOUT++.
+ *
+ * BOUT++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BOUT++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with BOUT++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **************************************************************************/
+
+#include <bout/column_precon.hxx>
+#include <bout/openmpwrap.hxx>
+#include <boutexception.hxx>
+#include <msg_stack.hxx>
+
+#include <cstdlib>
+
+namespace {
+  /// Non-negative remainder
+  int posmod(int a, int n) { return ((a % n) + n) % n; }
+}
+
+ColumnPrecon::ColumnPrecon(int nz, int n2d, int n3d, int stencil, int zband,
+                           int xcolours, int ycolours)
+  : nz(nz), n2d(n2d), n3d(n3d), stencil(stencil), zband(zband),
+    xcolours(xcolours), ycolours(ycolours) {
+  if(stencil < 0)
+    throw BoutException("ColumnPrecon: stencil width must not be negative");
+
+  if(this->xcolours <= 0)
+    this->xcolours = stencil + 1;
+  if(this->ycolours <= 0)
+    this->ycolours = stencil + 1;
+  ncolours = this->xcolours * this->ycolours;
+
+  // z points perturbed together must be more than 2*zband apart, so that
+  // each point is coupled to at most one of them. Using a divisor of nz
+  // keeps this true across the periodic boundary
+  nzgroup = nz;
+  if(zband >= 0) {
+    for(int g = 2*zband + 1; g < nz; g++) {
+      if(nz % g == 0) {
+        nzgroup = g;
+        break;
+      }
+    }
+  }
+  if(nzgroup == nz) {
+    // Every z point perturbed separately, so keep all coupling
+    this->zband = -1;
+  }
+  ngroups = n2d + n3d * nzgroup;
+
+  rowptr.push_back(0);
+}
+
+int ColumnPrecon::periodColours(int stencil, int period) {
+  for(int g = stencil + 1; g <= period; g++) {
+    if(period % g == 0)
+      return g;
+  }
+  return 0;
+}
+
+void ColumnPrecon::addColumn(int xglobal, int yglobal,
+                             const std::vector<bool> &evolve2d,
+                             const std::vector<bool> &evolve3d) {
+  if((static_cast<int>(evolve2d.size()) != n2d) || (static_cast<int>(evolve3d.size()) != n3d))
+    throw BoutException("ColumnPrecon: Expected %d 2D and %d 3D variables", n2d, n3d);
+
+  Column col;
+  col.start = size();
+  col.colour = posmod(xglobal, xcolours) + xcolours * posmod(yglobal, ycolours);
+
+  // Elements in state order. z is -1 for 2D variables
+  std::vector<int> zind;
+  for(int v = 0; v < n2d; v++) {
+    if(evolve2d[v]) {
+      zind.push_back(-1);
+      group.push_back(v);
+    }
+  }
+  for(int jz = 0; jz < nz; jz++) {
+    for(int v = 0; v < n3d; v++) {
+      if(evolve3d[v]) {
+        zind.push_back(jz);
+        group.push_back(n2d + v * nzgroup + jz % nzgroup);
+      }
+    }
+  }
+  col.n = static_cast<int>(zind.size());
+
+  // Sparsity pattern. If z coupling is banded, 2D variables are only
+  // coupled to 3D variables through their own RHS, since a 2D RHS
+  // responds to all z points perturbed together
+  for(int i = 0; i < col.n; i++) {
+    for(int j = 0; j < col.n; j++) {
+      bool coupled;
+      if((zind[j] < 0) || (zband < 0)) {
+        coupled = true;
+      }else if(zind[i] < 0) {
+        coupled = false;
+      }else {
+        int dz = std::abs(zind[i] - zind[j]);
+        coupled = (dz <= zband) || (nz - dz <= zband);
+      }
+      if(coupled) {
+        if(j == i)
+          diag.push_back(static_cast<int>(colind.size()));
+        colind.push_back(j);
+      }
+    }
+    rowptr.push_back(static_cast<int>(colind.size()));
+  }
+
+  columns.push_back(col);
+}
+
+void ColumnPrecon::computeJacobian(const BoutReal *u, const BoutReal *f, const BoutReal *inc,
+                                   const RhsFunc &rhs) {
+  TRACE("ColumnPrecon::computeJacobian");
+
+  const int N = size();
+  if(jac.size() != numNonZeros())
+    jac = Array<BoutReal>(numNonZeros());
+
+  Array<BoutReal> work(N), fwork(N);
+  for(int i = 0; i < N; i++)
+    work[i] = u[i];
+
+  // Columns of each colour
+  std::vector<std::vector<int>> colour_columns(ncolours);
+  for(int c = 0; c < static_cast<int>(columns.size()); c++)
+    colour_columns[columns[c].colour].push_back(c);
+
+  // Every processor does the same number of evaluations, even if
+  // it has no columns of some colours
+  for(const auto &cols : colour_columns) {
+    for(int g = 0; g < ngroups; g++) {
+      for(int c : cols) {
+        const Column &col = columns[c];
+        for(int j = col.start; j < col.start + col.n; j++) {
+          if(group[j] == g)
+            work[j] = u[j] + inc[j];
+        }
+      }
+
+      rhs(work.begin(), fwork.begin());
+
+      BOUT_OMP(parallel for)
+      for(std::size_t k = 0; k < cols.size(); k++) {
+        const Column &col = columns[cols[k]];
+        for(int i = col.start; i < col.start + col.n; i++) {
+          const BoutReal df = fwork[i] - f[i];
+          for(int p = rowptr[i]; p < rowptr[i + 1]; p++) {
+            const int j = col.start + colind[p];
+            if(group[j] == g) {
+              // Actual increment, after rounding
+              const BoutReal du = work[j] - u[j];
+              jac[p] = (du != 0.0) ? df / du : 0.0;
+            }
+          }
+        }
+      }
+
+      for(int c : cols) {
+        const Column &col = columns[c];
+        for(int j = col.start; j < col.start + col.n; j++)
+          work[j] = u[j];
+      }
+    }
+  }
+}
+
+void ColumnPrecon::factorise(BoutReal gamma) {
+  TRACE("ColumnPrecon::factorise");
+
+  if(jac.size() != numNonZeros())
+    throw BoutException("ColumnPrecon: factorise called before computeJacobian");
+
+  if(lu.size() != numNonZeros()) {
+    lu = Array<BoutReal>(numNonZeros());
+    invdiag = Array<BoutReal>(size());
+  }
+
+  int maxn = 0;
+  for(const auto &col : columns)
+    maxn = (col.n > maxn) ? col.n : maxn;
+
+  bool zero_pivot = false;
+
+  BOUT_OMP(parallel)
+  {
+    // Location of each column index in the current row, or -1
+    std::vector<int> iw(maxn, -1);
+
+    BOUT_OMP(for reduction(||:zero_pivot))
+    for(std::size_t c = 0; c < columns.size(); c++) {
+      const Column &col = columns[c];
+
+      // I - gamma J
+      for(int p = rowptr[col.start]; p < rowptr[col.start + col.n]; p++)
+        lu[p] = -gamma * jac[p];
+      for(int i = col.start; i < col.start + col.n; i++)
+        lu[diag[i]] += 1.0;
+
+      // ILU(0), row by row
+      for(int i = col.start; i < col.start + col.n; i++) {
+        for(int p = rowptr[i]; p < rowptr[i + 1]; p++)
+          iw[colind[p]] = p;
+
+        for(int p = rowptr[i]; p < diag[i]; p++) {
+          const int k = col.start + colind[p];
+          lu[p] *= invdiag[k];
+          for(int q = diag[k] + 1; q < rowptr[k + 1]; q++) {
+            const int w = iw[colind[q]];
+            if(w >= 0)
+              lu[w] -= lu[p] * lu[q];
+          }
+        }
+
+        if(lu[diag[i]] == 0.0) {
+          zero_pivot = true;
+          invdiag[i] = 0.0;
+        }else {
+          invdiag[i] = 1.0 / lu[diag[i]];
+        }
+
+        for(int p = rowptr[i]; p < rowptr[i + 1]; p++)
+          iw[colind[p]] = -1;
+      }
+    }
+  }
+
+  if(zero_pivot)
+    throw BoutException("ColumnPrecon: Zero pivot");
+}
+
+void ColumnPrecon::solve(const BoutReal *r, BoutReal *z) const {
+  BOUT_OMP(parallel for)
+  for(std::size_t c = 0; c < columns.size(); c++) {
+    const Column &col = columns[c];
+
+    // Forward substitution with unit lower triangle
+    for(int i = col.start; i < col.start + col.n; i++) {
+      BoutReal sum = r[i];
+      for(int p = rowptr[i]; p < diag[i]; p++)
+        sum -= lu[p] * z[col.start + colind[p]];
+      z[i] = sum;
+    }
+
+    // Back substitution
+    for(int i = col.start + col.n - 1; i >= col.start; i--) {
+      BoutReal sum = z[i];
+      for(int p = diag[i] + 1; p < rowptr[i + 1]; p++)
+        sum -= lu[p] * z[col.start + colind[p]];
+      z[i] = sum * invdiag[i];
+    }
+  }
+}
@@ -44,6 +44,8 @@
 
 #include "unused.hxx"
 
+#include "../sundials_nvector.hxx"
+
 #define ZERO        RCONST(0.)
 #define ONE         RCONST(1.0)
 
@@ -114,8 +116,8 @@ int ArkodeSolver::init(int nout, BoutReal tstep) {
 
   // Allocate memory
 
-  {TRACE("Allocating memory with N_VNew_Parallel");
-    if((uvec = N_VNew_Parallel(BoutComm::get(), local_N, neq)) == NULL)
+  {TRACE("Allocating memory with newParallelVector");
+    if((uvec = newParallelVector(BoutComm::get(), local_N, neq)) == NULL)
       throw BoutException("ERROR: SUNDIALS memory allocation failed\n");
   }
 
@@ -154,7 +156,7 @@ int ArkodeSolver::init(int nout, BoutReal tstep) {
     if (use_vector_abstol) {
       Options *abstol_options = Options::getRoot();
       BoutReal tempabstol;
-      if((abstolvec = N_VNew_Parallel(BoutComm::get(), local_N, neq)) == NULL)
+      if((abstolvec = newParallelVector(BoutComm::get(), local_N, neq)) == NULL)
 	throw BoutException("ERROR: SUNDIALS memory allocation (abstol vector) failed\n");
       vector<BoutReal> f2dtols;
       vector<BoutReal> f3dtols;
@@ -32,6 +32,7 @@
 #include <interpolation.hxx> // Cell interpolation
 #include <boutexception.hxx>
 #include <msg_stack.hxx>
+#include <utils.hxx>
 
 #include <cvode/cvode.h>
 #include <cvode/cvode_bbdpre.h>
@@ -43,6 +44,11 @@
 
 #include "unused.hxx"
 
+#include "../sundials_nvector.hxx"
+
+#include <cmath>
+#include <cstdlib>
+
 #define ZERO        RCONST(0.)
 #define ONE         RCONST(1.0)
 
@@ -59,6 +65,10 @@ static int cvode_pre(BoutReal t, N_Vector yy, N_Vector yp,
 		     BoutReal gamma, BoutReal delta, int lr,
 		     void *user_data, N_Vector tmp);
 
+static int cvode_pre_setup(BoutReal t, N_Vector yy, N_Vector yp,
+			   booleantype jok, booleantype *jcurPtr, BoutReal gamma,
+			   void *user_data, N_Vector tmp1, N_Vector tmp2, N_Vector tmp3);
+
 static int cvode_jac(N_Vector v, N_Vector Jv,
 		     realtype t, N_Vector y, N_Vector fy,
 		     void *user_data, N_Vector tmp);
@@ -67,6 +77,7 @@ CvodeSolver::CvodeSolver(Options *opts) : Solver(opts) {
   has_constraints = false; ///< This solver doesn't have constraints
   
   jacfunc = NULL;
+  block_njac = 0;
   
   canReset = true;
 }
@@ -110,8 +121,8 @@ int CvodeSolver::init(int nout, BoutReal tstep) {
                     n3Dvars(), n2Dvars(), neq, local_N);
 
   // Allocate memory
-  {TRACE("Allocating memory with N_VNew_Parallel");
-    if((uvec = N_VNew_Parallel(BoutComm::get(), local_N, neq)) == NULL)
+  {TRACE("Allocating memory with newParallelVector");
+    if((uvec = newParallelVector(BoutComm::get(), local_N, neq)) == NULL)
       throw BoutException("ERROR: SUNDIALS memory allocation failed\n");
   }
 
@@ -150,7 +161,7 @@ int CvodeSolver::init(int nout, BoutReal tstep) {
     if (use_vector_abstol) {
       Options *abstol_options = Options::getRoot();
       BoutReal tempabstol;
-      if((abstolvec = N_VNew_Parallel(BoutComm::get(), local_N, neq)) == NULL)
+      if((abstolvec = newParallelVector(BoutComm::get(), local_N, neq)) == NULL)
 	throw BoutException("ERROR: SUNDIALS memory allocation (abstol vector) failed\n");
       vector<BoutReal> f2dtols;
       vector<BoutReal> f3dtols;
@@ -271,18 +282,40 @@ int CvodeSolver::init(int nout, BoutReal tstep) {
       if ( CVSpgmr(cvode_mem, prectype, maxl) != CVSPILS_SUCCESS )
         throw BoutException("ERROR: CVSpgmr failed\n");
 
-      if (!have_user_precon()) {
+      // Type of preconditioner: "user", "bbd" or "block"
+      string precon_type;
+      options->get("precon_type", precon_type, have_user_precon() ? "user" : "bbd");
+
+      if (precon_type == "block") {
+        int block_stencil, block_zband;
+        OPTION(options, block_stencil, 2); // Stencil width in x and y
+        OPTION(options, block_zband, 2);   // Coupling width in z. < 0 for all z
+
+        setup_block_precon(block_stencil, block_zband);
+
+        output_info.write("\tUsing block Jacobi preconditioner, %d RHS evaluations per Jacobian\n",
+                          block_precon->numEvaluations());
+
+        if( CVSpilsSetPreconditioner(cvode_mem, cvode_pre_setup, cvode_pre) )
+          throw BoutException("ERROR: CVSpilsSetPreconditioner failed\n");
+
+      } else if (precon_type == "bbd") {
         output_info.write("\tUsing BBD preconditioner\n");
 
         if( CVBBDPrecInit(cvode_mem, local_N, mudq, mldq, 
               mukeep, mlkeep, ZERO, cvode_bbd_rhs, NULL) )
           throw BoutException("ERROR: CVBBDPrecInit failed\n");
 
-      } else {
+      } else if (precon_type == "user") {
+        if (!have_user_precon())
+          throw BoutException("ERROR: precon_type = user, but no preconditioner supplied\n");
+
         output_info.write("\tUsing user-supplied preconditioner\n");
 
         if( CVSpilsSetPreconditioner(cvode_mem, NULL, cvode_pre) )
           throw BoutException("ERROR: CVSpilsSetPreconditioner failed\n");
+      } else {
+        throw BoutException("ERROR: Unknown precon_type '%s'\n", precon_type.c_str());
       }
     }else {
       // Not using preconditioning
@@ -378,6 +411,10 @@ int CvodeSolver::run() {
       CVodeGetNumStabLimOrderReds(cvode_mem, &stab_lims);
       
       output.write("    -> Stability limit order reductions: %d\n", stab_lims);
+
+      if (block_precon) {
+        output.write("    -> Block preconditioner Jacobians: %ld\n", block_njac);
+      }
       
     }
 
@@ -471,6 +508,14 @@ void CvodeSolver::pre(BoutReal t, BoutReal gamma, BoutReal delta, BoutReal *udat
   BoutReal tstart = MPI_Wtime();
 
   int N = NV_LOCLENGTH_P(uvec);
+
+  if(block_precon) {
+    block_precon->solve(rvec, zvec);
+
+    pre_Wtime += MPI_Wtime() - tstart;
+    pre_ncalls++;
+    return;
+  }
   
   if(!have_user_precon()) {
     // Identity (but should never happen)
@@ -494,6 +539,176 @@ void CvodeSolver::pre(BoutReal t, BoutReal gamma, BoutReal delta, BoutReal *udat
   pre_ncalls++;
 }
 
+/**************************************************************************
+ * Preconditioner setup function
+ **************************************************************************/
+
+bool CvodeSolver::pre_setup(BoutReal t, N_Vector y, N_Vector fy, bool jok, BoutReal gamma,
+                            N_Vector ewt, N_Vector inc) {
+  TRACE("Running preconditioner setup: CvodeSolver::pre_setup(%e)", t);
+
+  bool jcur = false;
+  if(!jok) {
+    // Recalculate the Jacobian, with increments chosen as in
+    // CVODE's own difference quotient Jacobians
+    CVodeGetErrWeights(cvode_mem, ewt);
+
+    BoutReal h;
+    CVodeGetCurrentStep(cvode_mem, &h);
+
+    BoutReal fnorm = N_VWrmsNorm(fy, ewt);
+    BoutReal minInc = (fnorm != ZERO) ?
+      1000.0 * std::abs(h) * UNIT_ROUNDOFF * NV_GLOBLENGTH_P(y) * fnorm : ONE;
+    BoutReal srur = std::sqrt(UNIT_ROUNDOFF);
+
+    BoutReal *ydata = NV_DATA_P(y);
+    BoutReal *ewtdata = NV_DATA_P(ewt);
+    BoutReal *incdata = NV_DATA_P(inc);
+    for(int i=0;i<NV_LOCLENGTH_P(y);i++)
+      incdata[i] = BOUTMAX(srur * std::abs(ydata[i]), minInc / ewtdata[i]);
+
+    block_precon->computeJacobian(ydata, NV_DATA_P(fy), incdata,
+                                  [this, t](BoutReal *udata, BoutReal *dudata) {
+                                    rhs(t, udata, dudata);
+                                  });
+    block_njac++;
+    jcur = true;
+  }
+
+  // Factorise for the current gamma. A zero pivot is a recoverable
+  // failure, which every processor must report so CVODE stays in step
+  int status = 0;
+  try {
+    block_precon->factorise(gamma);
+  } catch (BoutException &error) {
+    status = 1;
+  }
+  BoutParallelThrowRhsFail(status, "ColumnPrecon: Zero pivot");
+
+  return jcur;
+}
+
+namespace {
+  /// Greatest common divisor. gcd(a, 0) = a
+  int gcd(int a, int b) {
+    while(b != 0) {
+      int t = a % b;
+      a = b;
+      b = t;
+    }
+    return a;
+  }
+
+  /// The greatest common divisor of b - a - 1, over every step in y
+  /// from index a to a non-consecutive index b on any processor. These
+  /// are at periodic boundaries and branch cuts. Zero if there are none
+  int yJumpPeriod() {
+    // Global y index, communicated into the guard cells. Guard cells at
+    // boundaries aren't communicated, so keep the marker
+    const BoutReal none = -1e10;
+    Field2D yglobal = none;
+    for(int jx=0;jx<mesh->LocalNx;jx++)
+      for(int jy=mesh->ystart;jy<=mesh->yend;jy++)
+        yglobal(jx, jy) = mesh->YGLOBAL(jy);
+    mesh->communicate(yglobal);
+
+    int period = 0;
+    for(int jx=0;jx<mesh->LocalNx;jx++) {
+      for(int k=1;k<=mesh->ystart;k++) {
+        BoutReal below = yglobal(jx, mesh->ystart - k);
+        if(below > none)
+          period = gcd(period, std::abs(mesh->YGLOBAL(mesh->ystart) - k - static_cast<int>(below)));
+        BoutReal above = yglobal(jx, mesh->yend + k);
+        if(above > none)
+          period = gcd(period, std::abs(mesh->YGLOBAL(mesh->yend) + k - static_cast<int>(above)));
+      }
+    }
+
+    int nproc;
+    MPI_Comm_size(BoutComm::get(), &nproc);
+    std::vector<int> all(nproc);
+    MPI_Allgather(&period, 1, MPI_INT, all.data(), 1, MPI_INT, BoutComm::get());
+    for(int p : all)
+      period = gcd(period, p);
+    return period;
+  }
+}
+
+/// Create the block preconditioner, with columns in the same
+/// order as Solver::loop_vars
+void CvodeSolver::setup_block_precon(int stencil, int zband) {
+  // Columns coupled across a periodic boundary or branch cut must have
+  // different colours, so the number of colours must divide the jumps
+  int xcolours = 0, ycolours = 0;
+  if(mesh->periodicX) {
+    int period = mesh->GlobalNx - 2*mesh->xstart;
+    xcolours = ColumnPrecon::periodColours(stencil, period);
+    if(xcolours == 0)
+      xcolours = period; // Fewer points than the stencil. Each has its own colour
+  }
+  int yperiod = yJumpPeriod();
+  if(yperiod > 0) {
+    ycolours = ColumnPrecon::periodColours(stencil, yperiod);
+    if(ycolours == 0) {
+      // Every global y index has its own colour
+      ycolours = mesh->GlobalNy;
+      output_warn.write("\tBlock preconditioner: No regular colouring in Y, using %d colours\n",
+                        ycolours);
+    }
+  }
+
+  block_precon = std::unique_ptr<ColumnPrecon>(
+      new ColumnPrecon(mesh->LocalNz, n2Dvars(), n3Dvars(), stencil, zband,
+                       xcolours, ycolours));
+
+  int MYSUB = mesh->yend - mesh->ystart + 1;
+
+  // Inner X boundary
+  if(mesh->firstX() && !mesh->periodicX) {
+    for(int jx=0;jx<mesh->xstart;jx++)
+      for(int jy=0;jy<MYSUB;jy++)
+        add_block_precon_column(jx, jy+mesh->ystart, true);
+  }
+
+  // Lower Y boundary region
+  for(RangeIterator xi = mesh->iterateBndryLowerY(); !xi.isDone(); xi++) {
+    for(int jy=0;jy<mesh->ystart;jy++)
+      add_block_precon_column(*xi, jy, true);
+  }
+
+  // Bulk of points
+  for(int jx=mesh->xstart; jx <= mesh->xend; jx++)
+    for(int jy=mesh->ystart; jy <= mesh->yend; jy++)
+      add_block_precon_column(jx, jy, false);
+
+  // Upper Y boundary condition
+  for(RangeIterator xi = mesh->iterateBndryUpperY(); !xi.isDone(); xi++) {
+    for(int jy=mesh->yend+1;jy<mesh->LocalNy;jy++)
+      add_block_precon_column(*xi, jy, true);
+  }
+
+  // Outer X boundary
+  if(mesh->lastX() && !mesh->periodicX) {
+    for(int jx=mesh->xend+1;jx<mesh->LocalNx;jx++)
+      for(int jy=mesh->ystart;jy<=mesh->yend;jy++)
+        add_block_precon_column(jx, jy, true);
+  }
+
+  if(block_precon->size() != NV_LOCLENGTH_P(uvec))
+    throw BoutException("ERROR: Block preconditioner size %d, expected %d\n",
+                        block_precon->size(), NV_LOCLENGTH_P(uvec));
+}
+
+void CvodeSolver::add_block_precon_column(int jx, int jy, bool bndry) {
+  vector<bool> evolve2d, evolve3d;
+  for(const auto& f : f2d)
+    evolve2d.push_back(!bndry || f.evolve_bndry);
+  for(const auto& f : f3d)
+    evolve3d.push_back(!bndry || f.evolve_bndry);
+
+  block_precon->addColumn(mesh->XGLOBAL(jx), mesh->YGLOBAL(jy), evolve2d, evolve3d);
+}
+
 /**************************************************************************
  * Jacobian-vector multiplication function
  **************************************************************************/
@@ -562,6 +777,25 @@ static int cvode_pre(BoutReal t, N_Vector yy, N_Vector UNUSED(yp), N_Vector rvec
   return 0;
 }
 
+/// Preconditioner setup function, called when the Jacobian
+/// may need recalculating or gamma has changed
+static int cvode_pre_setup(BoutReal t, N_Vector yy, N_Vector yp,
+                           booleantype jok, booleantype *jcurPtr, BoutReal gamma,
+                           void *user_data, N_Vector tmp1, N_Vector tmp2,
+                           N_Vector UNUSED(tmp3)) {
+  CvodeSolver *s = static_cast<CvodeSolver *>(user_data);
+
+  try {
+    *jcurPtr = s->pre_setup(t, yy, yp, jok, gamma, tmp1, tmp2);
+  }
+  catch (BoutRhsFail error) {
+    // Includes a zero pivot in the block factorisation. CVODE
+    // reduces the step and tries again
+    return 1;
+  }
+  return 0;
+}
+
 /// Jacobian-vector multiplication function
 static int cvode_jac(N_Vector v, N_Vector Jv, realtype t, N_Vector y, N_Vector UNUSED(fy),
                      void *user_data, N_Vector UNUSED(tmp)) {
@@ -46,11 +46,13 @@ class CvodeSolver;
 #include "vector3d.hxx"
 
 #include "bout/solver.hxx"
+#include "bout/column_precon.hxx"
 
 #include <cvode/cvode_spgmr.h>
 #include <cvode/cvode_bbdpre.h>
 #include <nvector/nvector_parallel.h>
 
+#include <memory>
 #include <vector>
 using std::vector;
 
@@ -73,6 +75,7 @@ class CvodeSolver : public Solver {
     // These functions used internally (but need to be public)
     void rhs(BoutReal t, BoutReal *udata, BoutReal *dudata);
     void pre(BoutReal t, BoutReal gamma, BoutReal delta, BoutReal *udata, BoutReal *rvec, BoutReal *zvec);
+    bool pre_setup(BoutReal t, N_Vector y, N_Vector fy, bool jok, BoutReal gamma, N_Vector ewt, N_Vector inc);
     void jac(BoutReal t, BoutReal *ydata, BoutReal *vdata, BoutReal *Jvdata);
   private:
     int NOUT; // Number of outputs. Specified in init, needed in run
@@ -87,6 +90,12 @@ class CvodeSolver : public Solver {
 
     BoutReal pre_Wtime; // Time in preconditioner
     BoutReal pre_ncalls; // Number of calls to preconditioner
+
+    std::unique_ptr<ColumnPrecon> block_precon; // Built-in block Jacobi preconditioner
+    long int block_njac; // Number of Jacobians calculated for block_precon
+
+    void setup_block_precon(int stencil, int zband);
+    void add_block_precon_column(int jx, int jy, bool bndry);
     
     void set_abstol_values(BoutReal* abstolvec_data, vector<BoutReal> &f2dtols, vector<BoutReal> &f3dtols);
     void loop_abstol_values_op(int jx, int jy, BoutReal* abstolvec_data, int &p, vector<BoutReal> &f2dtols, vector<BoutReal> &f3dtols, bool bndry);
@@ -48,6 +48,8 @@
 
 #include "unused.hxx"
 
+#include "../sundials_nvector.hxx"
+
 #define ZERO        RCONST(0.)
 #define ONE         RCONST(1.0)
 
@@ -105,11 +107,11 @@ IdaSolver::~IdaSolver() { }
 
   // Allocate memory
   
-  if((uvec = N_VNew_Parallel(BoutComm::get(), local_N, neq)) == NULL)
+  if((uvec = newParallelVector(BoutComm::get(), local_N, neq)) == NULL)
     throw BoutException("ERROR: SUNDIALS memory allocation failed\n");
-  if((duvec = N_VNew_Parallel(BoutComm::get(), local_N, neq)) == NULL)
+  if((duvec = newParallelVector(BoutComm::get(), local_N, neq)) == NULL)
     throw BoutException("ERROR: SUNDIALS memory allocation failed\n");
-  if((id = N_VNew_Parallel(BoutComm::get(), local_N, neq)) == NULL)
+  if((id = newParallelVector(BoutComm::get(), local_N, neq)) == NULL)
     throw BoutException("ERROR: SUNDIALS memory allocation failed\n");
   
   // Put the variables into uvec
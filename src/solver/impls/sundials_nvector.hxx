@@ -0,0 +1,382 @@
+/**************************************************************************
+ * Hybrid MPI + OpenMP vectors for the SUNDIALS solvers
+ *
+ * The NVECTOR_PARALLEL vectors used by CVODE, IDA and ARKODE do their
+ * vector operations (linear sums, norms, dot products) on a single
+ * thread on each processor. In hybrid MPI+OpenMP runs these become a
+ * serial bottleneck next to the threaded RHS function.
+ *
+ * newParallelVector() creates an ordinary parallel N_Vector, so that
+ * NV_DATA_P etc. and the SUNDIALS preconditioners work unchanged, but
+ * replaces its operations with versions threaded using OpenMP. Vectors
+ * cloned from it by the solvers copy these operations.
+ *
+ * With SUNDIALS 4 or later the fused operations (linear combination,
+ * multiple scaled additions and multiple dot products) are also set,
+ * so that e.g. Gram-Schmidt orthogonalisation in GMRES needs only one
+ * pass over memory and one MPI reduction for all the dot products.
+ *
+ **************************************************************************
+ * Copyright 2010 B.D.Dudson, S.Farley, M.V.Umansky, X.Q.Xu
+ *
+ * Contact: Ben Dudson, bd512@york.ac.uk
+ *
+ * This file is part of BOUT++.
+ *
+ * BOUT++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BOUT++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with BOUT++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **************************************************************************/
+
+#ifndef __SUNDIALS_NVECTOR_H__
+#define __SUNDIALS_NVECTOR_H__
+
+// NOTE: MPI must be included before SUNDIALS, otherwise complains
+#include "mpi.h"
+
+#include <bout/openmpwrap.hxx>
+
+#include <nvector/nvector_parallel.h>
+#include <sundials/sundials_types.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace sundials_nvector {
+
+  /// Reduce \p val over all processors in the vector's communicator
+  inline realtype allReduce(realtype val, MPI_Op op, N_Vector x) {
+    realtype result;
+    MPI_Allreduce(&val, &result, 1, PVEC_REAL_MPI_TYPE, op, NV_COMM_P(x));
+    return result;
+  }
+
+  /// z = a*x + b*y
+  inline void linearSum(realtype a, N_Vector x, realtype b, N_Vector y, N_Vector z) {
+    const long int n = NV_LOCLENGTH_P(x);
+    const realtype *xd = NV_DATA_P(x);
+    const realtype *yd = NV_DATA_P(y);
+    realtype *zd = NV_DATA_P(z);
+    BOUT_OMP(parallel for)
+    for(long int i=0;i<n;i++)
+      zd[i] = a*xd[i] + b*yd[i];
+  }
+
+  /// z = c
+  inline void constant(realtype c, N_Vector z) {
+    const long int n = NV_LOCLENGTH_P(z);
+    realtype *zd = NV_DATA_P(z);
+    BOUT_OMP(parallel for)
+    for(long int i=0;i<n;i++)
+      zd[i] = c;
+  }
+
+  /// z = x*y elementwise
+  inline void prod(N_Vector x, N_Vector y, N_Vector z) {
+    const long int n = NV_LOCLENGTH_P(x);
+    const realtype *xd = NV_DATA_P(x);
+    const realtype *yd = NV_DATA_P(y);
+    realtype *zd = NV_DATA_P(z);
+    BOUT_OMP(parallel for)
+    for(long int i=0;i<n;i++)
+      zd[i] = xd[i]*yd[i];
+  }
+
+  /// z = x/y elementwise
+  inline void divide(N_Vector x, N_Vector y, N_Vector z) {
+    const long int n = NV_LOCLENGTH_P(x);
+    const realtype *xd = NV_DATA_P(x);
+    const realtype *yd = NV_DATA_P(y);
+    realtype *zd = NV_DATA_P(z);
+    BOUT_OMP(parallel for)
+    for(long int i=0;i<n;i++)
+      zd[i] = xd[i]/yd[i];
+  }
+
+  /// z = c*x
+  inline void scale(realtype c, N_Vector x, N_Vector z) {
+    const long int n = NV_LOCLENGTH_P(x);
+    const realtype *xd = NV_DATA_P(x);
+    realtype *zd = NV_DATA_P(z);
+    BOUT_OMP(parallel for)
+    for(long int i=0;i<n;i++)
+      zd[i] = c*xd[i];
+  }
+
+  /// z = |x|
+  inline void absolute(N_Vector x, N_Vector z) {
+    const long int n = NV_LOCLENGTH_P(x);
+    const realtype *xd = NV_DATA_P(x);
+    realtype *zd = NV_DATA_P(z);
+    BOUT_OMP(parallel for)
+    for(long int i=0;i<n;i++)
+      zd[i] = std::abs(xd[i]);
+  }
+
+  /// z = 1/x
+  inline void inv(N_Vector x, N_Vector z) {
+    const long int n = NV_LOCLENGTH_P(x);
+    const realtype *xd = NV_DATA_P(x);
+    realtype *zd = NV_DATA_P(z);
+    BOUT_OMP(parallel for)
+    for(long int i=0;i<n;i++)
+      zd[i] = 1.0/xd[i];
+  }
+
+  /// z = x + b
+  inline void addConst(N_Vector x, realtype b, N_Vector z) {
+    const long int n = NV_LOCLENGTH_P(x);
+    const realtype *xd = NV_DATA_P(x);
+    realtype *zd = NV_DATA_P(z);
+    BOUT_OMP(parallel for)
+    for(long int i=0;i<n;i++)
+      zd[i] = xd[i] + b;
+  }
+
+  /// Global dot product x.y
+  inline realtype dotProd(N_Vector x, N_Vector y) {
+    const long int n = NV_LOCLENGTH_P(x);
+    const realtype *xd = NV_DATA_P(x);
+    const realtype *yd = NV_DATA_P(y);
+    realtype sum = 0.0;
+    BOUT_OMP(parallel for reduction(+:sum))
+    for(long int i=0;i<n;i++)
+      sum += xd[i]*yd[i];
+    return allReduce(sum, MPI_SUM, x);
+  }
+
+  /// Global max |x|
+  inline realtype maxNorm(N_Vector x) {
+    const long int n = NV_LOCLENGTH_P(x);
+    const realtype *xd = NV_DATA_P(x);
+    realtype result = 0.0;
+    BOUT_OMP(parallel for reduction(max:result))
+    for(long int i=0;i<n;i++)
+      result = std::max(result, std::abs(xd[i]));
+    return allReduce(result, MPI_MAX, x);
+  }
+
+  /// Weighted root-mean-square norm, sqrt( sum (x*w)^2 / N )
+  inline realtype wrmsNorm(N_Vector x, N_Vector w) {
+    const long int n = NV_LOCLENGTH_P(x);
+    const realtype *xd = NV_DATA_P(x);
+    const realtype *wd = NV_DATA_P(w);
+    realtype sum = 0.0;
+    BOUT_OMP(parallel for reduction(+:sum))
+    for(long int i=0;i<n;i++)
+      sum += (xd[i]*wd[i]) * (xd[i]*wd[i]);
+    return std::sqrt(allReduce(sum, MPI_SUM, x) / NV_GLOBLENGTH_P(x));
+  }
+
+  /// Weighted RMS norm, only including elements where id > 0
+  inline realtype wrmsNormMask(N_Vector x, N_Vector w, N_Vector id) {
+    const long int n = NV_LOCLENGTH_P(x);
+    const realtype *xd = NV_DATA_P(x);
+    const realtype *wd = NV_DATA_P(w);
+    const realtype *idd = NV_DATA_P(id);
+    realtype sum = 0.0;
+    BOUT_OMP(parallel for reduction(+:sum))
+    for(long int i=0;i<n;i++) {
+      if(idd[i] > 0.0)
+        sum += (xd[i]*wd[i]) * (xd[i]*wd[i]);
+    }
+    return std::sqrt(allReduce(sum, MPI_SUM, x) / NV_GLOBLENGTH_P(x));
+  }
+
+  /// Global minimum
+  inline realtype minimum(N_Vector x) {
+    const long int n = NV_LOCLENGTH_P(x);
+    const realtype *xd = NV_DATA_P(x);
+    realtype result = BIG_REAL;
+    BOUT_OMP(parallel for reduction(min:result))
+    for(long int i=0;i<n;i++)
+      result = std::min(result, xd[i]);
+    return allReduce(result, MPI_MIN, x);
+  }
+
+  /// Weighted L2 norm, sqrt( sum (x*w)^2 )
+  inline realtype wl2Norm(N_Vector x, N_Vector w) {
+    const long int n = NV_LOCLENGTH_P(x);
+    const realtype *xd = NV_DATA_P(x);
+    const realtype *wd = NV_DATA_P(w);
+    realtype sum = 0.0;
+    BOUT_OMP(parallel for reduction(+:sum))
+    for(long int i=0;i<n;i++)
+      sum += (xd[i]*wd[i]) * (xd[i]*wd[i]);
+    return std::sqrt(allReduce(sum, MPI_SUM, x));
+  }
+
+  /// L1 norm, sum |x|
+  inline realtype l1Norm(N_Vector x) {
+    const long int n = NV_LOCLENGTH_P(x);
+    const realtype *xd = NV_DATA_P(x);
+    realtype sum = 0.0;
+    BOUT_OMP(parallel for reduction(+:sum))
+    for(long int i=0;i<n;i++)
+      sum += std::abs(xd[i]);
+    return allReduce(sum, MPI_SUM, x);
+  }
+
+  /// z = 1 where |x| >= c, 0 otherwise
+  inline void compare(realtype c, N_Vector x, N_Vector z) {
+    const long int n = NV_LOCLENGTH_P(x);
+    const realtype *xd = NV_DATA_P(x);
+    realtype *zd = NV_DATA_P(z);
+    BOUT_OMP(parallel for)
+    for(long int i=0;i<n;i++)
+      zd[i] = (std::abs(xd[i]) >= c) ? 1.0 : 0.0;
+  }
+
+  /// z = 1/x, returning false if any element of x is zero
+  inline booleantype invTest(N_Vector x, N_Vector z) {
+    const long int n = NV_LOCLENGTH_P(x);
+    const realtype *xd = NV_DATA_P(x);
+    realtype *zd = NV_DATA_P(z);
+    realtype ok = 1.0;
+    BOUT_OMP(parallel for reduction(min:ok))
+    for(long int i=0;i<n;i++) {
+      if(xd[i] == 0.0) {
+        ok = 0.0;
+      }else {
+        zd[i] = 1.0/xd[i];
+      }
+    }
+    return allReduce(ok, MPI_MIN, x) > 0.5;
+  }
+
+  /// Check the constraints c on x: c = 2 (x > 0), 1 (x >= 0),
+  /// -1 (x <= 0), -2 (x < 0). Sets m = 1 where they fail, and
+  /// returns false if any fail
+  inline booleantype constrMask(N_Vector c, N_Vector x, N_Vector m) {
+    const long int n = NV_LOCLENGTH_P(x);
+    const realtype *cd = NV_DATA_P(c);
+    const realtype *xd = NV_DATA_P(x);
+    realtype *md = NV_DATA_P(m);
+    realtype ok = 1.0;
+    BOUT_OMP(parallel for reduction(min:ok))
+    for(long int i=0;i<n;i++) {
+      md[i] = 0.0;
+      const realtype xc = xd[i]*cd[i];
+      const realtype ac = std::abs(cd[i]);
+      if(((ac > 1.5) && (xc <= 0.0)) || ((ac > 0.5) && (xc < 0.0))) {
+        md[i] = 1.0;
+        ok = 0.0;
+      }
+    }
+    return allReduce(ok, MPI_MIN, x) > 0.5;
+  }
+
+  /// Minimum of num/denom over elements where denom is not zero
+  inline realtype minQuotient(N_Vector num, N_Vector denom) {
+    const long int n = NV_LOCLENGTH_P(num);
+    const realtype *nd = NV_DATA_P(num);
+    const realtype *dd = NV_DATA_P(denom);
+    realtype result = BIG_REAL;
+    BOUT_OMP(parallel for reduction(min:result))
+    for(long int i=0;i<n;i++) {
+      if(dd[i] != 0.0)
+        result = std::min(result, nd[i]/dd[i]);
+    }
+    return allReduce(result, MPI_MIN, num);
+  }
+
+#if defined(SUNDIALS_VERSION_MAJOR) && (SUNDIALS_VERSION_MAJOR >= 4)
+  /// z = sum_j c[j]*X[j]. z may be one of the X
+  inline int linearCombination(int nvec, realtype *c, N_Vector *X, N_Vector z) {
+    const long int n = NV_LOCLENGTH_P(z);
+    realtype *zd = NV_DATA_P(z);
+    BOUT_OMP(parallel for)
+    for(long int i=0;i<n;i++) {
+      realtype sum = 0.0;
+      for(int j=0;j<nvec;j++)
+        sum += c[j]*NV_DATA_P(X[j])[i];
+      zd[i] = sum;
+    }
+    return 0;
+  }
+
+  /// Z[j] = a[j]*x + Y[j]
+  inline int scaleAddMulti(int nvec, realtype *a, N_Vector x, N_Vector *Y, N_Vector *Z) {
+    const long int n = NV_LOCLENGTH_P(x);
+    const realtype *xd = NV_DATA_P(x);
+    BOUT_OMP(parallel for)
+    for(long int i=0;i<n;i++) {
+      for(int j=0;j<nvec;j++)
+        NV_DATA_P(Z[j])[i] = a[j]*xd[i] + NV_DATA_P(Y[j])[i];
+    }
+    return 0;
+  }
+
+  /// dotprods[j] = x.Y[j], with a single reduction
+  inline int dotProdMulti(int nvec, N_Vector x, N_Vector *Y, realtype *dotprods) {
+    const long int n = NV_LOCLENGTH_P(x);
+    const realtype *xd = NV_DATA_P(x);
+    for(int j=0;j<nvec;j++)
+      dotprods[j] = 0.0;
+    BOUT_OMP(parallel)
+    {
+      std::vector<realtype> local(nvec, 0.0);
+      BOUT_OMP(for nowait)
+      for(long int i=0;i<n;i++) {
+        for(int j=0;j<nvec;j++)
+          local[j] += xd[i]*NV_DATA_P(Y[j])[i];
+      }
+      BOUT_OMP(critical)
+      for(int j=0;j<nvec;j++)
+        dotprods[j] += local[j];
+    }
+    MPI_Allreduce(MPI_IN_PLACE, dotprods, nvec, PVEC_REAL_MPI_TYPE, MPI_SUM, NV_COMM_P(x));
+    return 0;
+  }
+#endif
+}
+
+/// Create a parallel N_Vector with operations threaded using OpenMP.
+/// Returns NULL if allocation fails, as N_VNew_Parallel
+inline N_Vector newParallelVector(MPI_Comm comm, long int local_length, long int global_length) {
+  N_Vector v = N_VNew_Parallel(comm, local_length, global_length);
+  if(v == NULL)
+    return NULL;
+
+  using namespace sundials_nvector;
+  N_Vector_Ops ops = v->ops;
+  ops->nvlinearsum    = linearSum;
+  ops->nvconst        = constant;
+  ops->nvprod         = prod;
+  ops->nvdiv          = divide;
+  ops->nvscale        = scale;
+  ops->nvabs          = absolute;
+  ops->nvinv          = inv;
+  ops->nvaddconst     = addConst;
+  ops->nvdotprod      = dotProd;
+  ops->nvmaxnorm      = maxNorm;
+  ops->nvwrmsnorm     = wrmsNorm;
+  ops->nvwrmsnormmask = wrmsNormMask;
+  ops->nvmin          = minimum;
+  ops->nvwl2norm      = wl2Norm;
+  ops->nvl1norm       = l1Norm;
+  ops->nvcompare      = compare;
+  ops->nvinvtest      = invTest;
+  ops->nvconstrmask   = constrMask;
+  ops->nvminquotient  = minQuotient;
+#if defined(SUNDIALS_VERSION_MAJOR) && (SUNDIALS_VERSION_MAJOR >= 4)
+  ops->nvlinearcombination = linearCombination;
+  ops->nvscaleaddmulti     = scaleAddMulti;
+  ops->nvdotprodmulti      = dotProdMulti;
+#endif
+
+  return v;
+}
+
+#endif // __SUNDIALS_NVECTOR_H__
@@ -34,11 +34,13 @@
 #include "solverfactory.hxx"
 
 #include <bout/sys/timer.hxx>
+#include <bout/openmpwrap.hxx>
 #include <msg_stack.hxx>
 #include <output.hxx>
 #include <bout/assert.hxx>
 
 #include <bout/array.hxx>
+#include <bout/reduced_output.hxx>
 
 // Static member variables
 
@@ -77,6 +79,9 @@ Solver::Solver(Options *opts) : options(opts), model(0), prefunc(0) {
   // Method of Manufactured Solutions (MMS)
   options->get("mms", mms, false);
   options->get("mms_initialise", mms_initialise, mms);
+
+  // Run the user's RHS functions in one OpenMP parallel region
+  options->get("openmp_team", openmp_team, false);
 }
 
 /**************************************************************************
@@ -489,6 +494,9 @@ int Solver::solve(int NOUT, BoutReal TIMESTEP) {
     options->get("output_step", TIMESTEP, TIMESTEP);
   }
 
+  if(!initCalled)
+    addReducedOutputs();
+
   /// syncronize timestep with those set to the monitors
   if (timestep > 0){
     if (!isMultiple(timestep,TIMESTEP)){
@@ -674,6 +682,37 @@ void Solver::removeMonitor(Monitor * f) {
   monitors.remove(f);
 }
 
+void Solver::addReducedOutputs() {
+  std::string reduced;
+  Options::getRoot()->getSection("output")->get("reduced", reduced, "");
+  
+  for(const auto &s : strsplit(reduced, ',')) {
+    std::string name = trim(s);
+    if(name.empty())
+      continue;
+    
+    ReducedOutput *out = new ReducedOutput(Options::getRoot()->getSection(name), name);
+    reduced_outputs.emplace_back(out);
+    
+    // Find the fields to output in the evolving variables
+    for(const auto &fname : out->fieldNames()) {
+      bool found = false;
+      for(const auto &f : f3d) {
+        if(f.name == fname) {
+          out->add(*(f.var), fname);
+          found = true;
+          break;
+        }
+      }
+      if(!found)
+        throw BoutException("Reduced output '%s': '%s' is not an evolving 3D variable",
+                            name.c_str(), fname.c_str());
+    }
+    
+    addMonitor(out);
+  }
+}
+
 extern bool user_requested_exit;
 int Solver::call_monitors(BoutReal simtime, int iter, int NOUT) {
   bool abort;
@@ -1232,6 +1271,23 @@ void Solver::setSplitOperator(rhsfunc fC, rhsfunc fD) {
   phys_diff = fD;
 }
 
+template<typename F>
+int Solver::runInTeam(F func) {
+  if(!openmp_team || ompTeam())
+    return func();
+
+  // Every thread runs the function. Field operations share the work
+  // between threads (see bout/openmpwrap.hxx)
+  int status = 0;
+  ompRunTeam([&]() {
+    int thread_status = func();
+    BOUT_OMP(master)
+    status = thread_status;
+  });
+
+  return status;
+}
+
 int Solver::run_rhs(BoutReal t) {
   int status;
   
@@ -1248,18 +1304,18 @@ int Solver::run_rhs(BoutReal t) {
     save_vars(tmp.begin()); // Copy variables into tmp
     pre_rhs(t);
     if(model) {
-      status = model->runConvective(t);
+      status = runInTeam([&]() { return model->runConvective(t); });
     }else 
-      status = (*phys_conv)(t);
+      status = runInTeam([&]() { return (*phys_conv)(t); });
     post_rhs(t); // Check variables, apply boundary conditions
     
     load_vars(tmp.begin()); // Reset variables
     save_derivs(tmp.begin()); // Save time derivatives
     pre_rhs(t);
     if(model) {
-      status = model->runDiffusive(t, false);
+      status = runInTeam([&]() { return model->runDiffusive(t, false); });
     }else
-      status = (*phys_diff)(t);
+      status = runInTeam([&]() { return (*phys_diff)(t); });
     post_rhs(t);
     save_derivs(tmp2.begin()); // Save time derivatives
     for(BoutReal *t = tmp.begin(), *t2 = tmp2.begin(); t != tmp.end(); ++t, ++t2)
@@ -1268,9 +1324,9 @@ int Solver::run_rhs(BoutReal t) {
   }else {
     pre_rhs(t);
     if(model) {
-      status = model->runRHS(t);
+      status = runInTeam([&]() { return model->runRHS(t); });
     }else
-      status = (*phys_run)(t);
+      status = runInTeam([&]() { return (*phys_run)(t); });
     post_rhs(t);
   }
 
@@ -1291,9 +1347,9 @@ int Solver::run_convective(BoutReal t) {
   pre_rhs(t);
   if(split_operator) {
     if(model) {
-      status = model->runConvective(t);
+      status = runInTeam([&]() { return model->runConvective(t); });
     }else
-      status = (*phys_conv)(t);
+      status = runInTeam([&]() { return (*phys_conv)(t); });
   }else {
     // Zero if not split
     for(const auto& f : f3d)
@@ -1320,16 +1376,16 @@ int Solver::run_diffusive(BoutReal t, bool linear) {
   if(split_operator) {
 
     if(model) {
-      status = model->runDiffusive(t, linear);
+      status = runInTeam([&]() { return model->runDiffusive(t, linear); });
     }else 
-      status = (*phys_diff)(t);
+      status = runInTeam([&]() { return (*phys_diff)(t); });
     post_rhs(t);
   }else {
     // Return total
     if(model) {
-      status = model->runRHS(t);
+      status = runInTeam([&]() { return model->runRHS(t); });
     }else
-      status = (*phys_run)(t);
+      status = runInTeam([&]() { return (*phys_run)(t); });
   }
   rhs_ncalls_i++;
   return status;
@@ -1337,6 +1393,9 @@ int Solver::run_diffusive(BoutReal t, bool linear) {
 
 void Solver::pre_rhs(BoutReal t) {
 
+  // Cached interpolations may refer to the previous state
+  interp_clear_cache();
+
   // Apply boundary conditions to the values
   for(const auto& f : f2d) {
     if(!f.constraint) // If it's not a constraint
@@ -1351,6 +1410,13 @@ void Solver::pre_rhs(BoutReal t) {
 }
 
 void Solver::post_rhs(BoutReal UNUSED(t)) {
+  // Complete any communications deferred by the RHS function
+  mesh->communicatePending();
+
+  // Release cached interpolations, so that the evolving variables
+  // don't share data with the cache between RHS calls
+  interp_clear_cache();
+
 #if CHECK > 0
   for(const auto& f : f3d) {
     if(!f.F_var->isAllocated())
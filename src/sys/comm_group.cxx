@@ -31,6 +31,7 @@
 #include <output.hxx>
 #include <options.hxx>
 #include <msg_stack.hxx>
+#include <boutexception.hxx>
 
 namespace comm_group {
 
@@ -38,6 +39,7 @@ namespace comm_group {
   
   static bool initialised = false;
   static bool nonblock;
+  static bool native; ///< Use MPI-3 nonblocking collectives?
   
   void Comm_initialise()
   {
@@ -48,83 +50,195 @@ namespace comm_group {
     Options *options = Options::getRoot();
     options = options->getSection("comms");
     options->get("group_nonblock", nonblock, true);
+    options->get("group_native", native, true);
+
+#if MPI_VERSION < 3
+    native = false; // Not available
+#endif
 
     initialised = true;
   }
 
-  bool Comm_gather_start(void *local, int nlocal, MPI_Datatype type,
-			 void *data, 
-			 int root, MPI_Comm comm,
-			 Comm_handle_t *handle)
+  /// Store the operation in the handle, freeing any previous persistent requests
+  static void Comm_setup(Comm_handle_t *handle, bool gather,
+			 void *sendbuf, int count, MPI_Datatype type,
+			 void *recvbuf, int root, MPI_Comm comm)
   {
-    TRACE("Comm_gather_start(%d -> %d)", nlocal, root);
-   
-    Comm_initialise();
- 
-    // Put communication info into handle
+    if(handle->persistent)
+      Comm_handle_free(handle);
+
     MPI_Comm_size(comm, &handle->nprocs);
     MPI_Comm_rank(comm, &handle->myrank);
     handle->root = root;
 
-    if(!nonblock) {
-      // Blocking comms using the MPI call
-      // May be faster for different architectures, and useful
-      // for debugging
-      
-      MPI_Gather(local, nlocal, type,
-		 data, nlocal, type,
-		 root, comm);
-      
-      handle->current = true;
-      
-      return (root == handle->myrank);
+    handle->gather = gather;
+    handle->sendbuf = sendbuf;
+    handle->recvbuf = recvbuf;
+    handle->count = count;
+    handle->type = type;
+    handle->comm = comm;
+    handle->nreq = 0;
+  }
+
+  /// Get space for \p n requests, reusing the handle's array if large enough
+  static MPI_Request* Comm_requests(Comm_handle_t *handle, int n)
+  {
+    if(handle->nalloc < n) {
+      free(handle->request);
+      handle->request = (MPI_Request*) malloc(sizeof(MPI_Request)*n);
+      handle->nalloc = n;
     }
-    
+    handle->nreq = n;
+    return handle->request;
+  }
+
+  /// Blocking version of the operation, using the MPI call.
+  /// May be faster for different architectures, and useful for debugging
+  static void Comm_blocking(Comm_handle_t *handle)
+  {
+    if(handle->gather) {
+      MPI_Gather(handle->sendbuf, handle->count, handle->type,
+		 handle->recvbuf, handle->count, handle->type,
+		 handle->root, handle->comm);
+    }else {
+      MPI_Scatter(handle->sendbuf, handle->count, handle->type,
+		  handle->recvbuf, handle->count, handle->type,
+		  handle->root, handle->comm);
+    }
+  }
+
+  /// Post one send or receive for each processor. If \p persistent
+  /// the requests are created but not started
+  static void Comm_post(Comm_handle_t *handle, bool persistent)
+  {
     int type_size; // Get size of the datatype
-    MPI_Type_size(type, &type_size);
+    MPI_Type_size(handle->type, &type_size);
     
-    if(root == handle->myrank) {
-      // All arriving on this processor. Post receives
-
-      handle->request = (MPI_Request *)malloc(sizeof(MPI_Request) * (handle->nprocs - 1));
-      handle->nreq = handle->nprocs-1;
+    int count = handle->count;
+    MPI_Datatype type = handle->type;
+    MPI_Comm comm = handle->comm;
+    
+    if(handle->root == handle->myrank) {
+      // Gather: all arriving on this processor
+      // Scatter: sending from this processor
+      char *buf = (char*) (handle->gather ? handle->recvbuf : handle->sendbuf);
       
-      MPI_Request *r = handle->request;
+      MPI_Request *r = Comm_requests(handle, handle->nprocs-1);
       for(int p=0;p<handle->nprocs; p++) {
-	if(p != root) {
-	  MPI_Irecv((void*) ( ((char*) data) + p*nlocal*type_size),
-		    nlocal,
-		    type,
-		    p,
-		    COMM_GROUP_TAG,
-		    comm,
-		    r);
-	  r++; // Next request
+	if(p == handle->root)
+	  continue;
+	
+	void *pbuf = (void*) (buf + p*count*type_size);
+	if(handle->gather) {
+	  if(persistent) {
+	    MPI_Recv_init(pbuf, count, type, p, COMM_GROUP_TAG, comm, r);
+	  }else
+	    MPI_Irecv(pbuf, count, type, p, COMM_GROUP_TAG, comm, r);
+	}else {
+	  if(persistent) {
+	    MPI_Send_init(pbuf, count, type, p, COMM_GROUP_TAG, comm, r);
+	  }else
+	    MPI_Isend(pbuf, count, type, p, COMM_GROUP_TAG, comm, r);
 	}
+	r++; // Next request
       }
-      
-      // Copy local data into output
-      memcpy((void*) (((char*) data) + handle->myrank*nlocal*type_size),
-	     local, 
-	     nlocal*type_size);
     }else {
-      // Sending to root processor
-
-      handle->request = (MPI_Request *)malloc(sizeof(MPI_Request));
-      handle->nreq = 1;
-
-      MPI_Isend(local,
-		nlocal,
-		type,
-		root,
-		COMM_GROUP_TAG,
-		comm,
-		handle->request);
+      // One message to or from root
+      MPI_Request *r = Comm_requests(handle, 1);
+      if(handle->gather) {
+	if(persistent) {
+	  MPI_Send_init(handle->sendbuf, count, type, handle->root, COMM_GROUP_TAG, comm, r);
+	}else
+	  MPI_Isend(handle->sendbuf, count, type, handle->root, COMM_GROUP_TAG, comm, r);
+      }else {
+	if(persistent) {
+	  MPI_Recv_init(handle->recvbuf, count, type, handle->root, COMM_GROUP_TAG, comm, r);
+	}else
+	  MPI_Irecv(handle->recvbuf, count, type, handle->root, COMM_GROUP_TAG, comm, r);
+      }
+    }
+  }
+
+  /// Copy the root processor's own data
+  static void Comm_copy_local(Comm_handle_t *handle)
+  {
+    if(handle->root != handle->myrank)
+      return;
+    
+    int type_size;
+    MPI_Type_size(handle->type, &type_size);
+    int nbytes = handle->count*type_size;
+    
+    if(handle->gather) {
+      memcpy((void*) (((char*) handle->recvbuf) + handle->root*nbytes),
+	     handle->sendbuf,
+	     nbytes);
+    }else {
+      memcpy(handle->recvbuf,
+	     (void*) (((char*) handle->sendbuf) + handle->root*nbytes),
+	     nbytes);
+    }
+  }
+
+  /// Start a gather or scatter, once stored in the handle
+  static bool Comm_begin(Comm_handle_t *handle)
+  {
+    if(!nonblock) {
+      Comm_blocking(handle);
+      handle->current = true;
+      return (handle->root == handle->myrank);
+    }
+
+#if MPI_VERSION >= 3
+    if(native) {
+      // Let the MPI library choose the algorithm, which can use
+      // a tree rather than every message going to or from root
+      MPI_Request *r = Comm_requests(handle, 1);
+      if(handle->gather) {
+	MPI_Igather(handle->sendbuf, handle->count, handle->type,
+		    handle->recvbuf, handle->count, handle->type,
+		    handle->root, handle->comm, r);
+      }else {
+	MPI_Iscatter(handle->sendbuf, handle->count, handle->type,
+		     handle->recvbuf, handle->count, handle->type,
+		     handle->root, handle->comm, r);
+      }
+      handle->current = true;
+      return (handle->root == handle->myrank);
     }
+#endif
+
+    Comm_post(handle, false);
+    Comm_copy_local(handle);
     
     handle->current = true; // Mark as in progress
     
-    return (root == handle->myrank);
+    return (handle->root == handle->myrank);
+  }
+
+  /// start a gather operation
+  /*!
+   * @param[in]  local     Data to be sent from this process
+   * @param[in]  nlocal    Number of elements sent from each process
+   * @param[in]  type      Data type
+   * @param[out] data      Where to store the data (only used on root process)
+   * @param[in]  root      Process rank where data is gathered
+   * @param[in]  comm      Communicator
+   * @param[out] handle    Used for completion later
+   */ 
+  bool Comm_gather_start(void *local, int nlocal, MPI_Datatype type,
+			 void *data, 
+			 int root, MPI_Comm comm,
+			 Comm_handle_t *handle)
+  {
+    TRACE("Comm_gather_start(%d -> %d)", nlocal, root);
+   
+    Comm_initialise();
+ 
+    // Put communication info into handle
+    Comm_setup(handle, true, local, nlocal, type, data, root, comm);
+
+    return Comm_begin(handle);
   }
   
   /// start a scatter operation
@@ -146,87 +260,81 @@ namespace comm_group {
 
     Comm_initialise();
 
-    MPI_Comm_size(comm, &handle->nprocs);
-    MPI_Comm_rank(comm, &handle->myrank);
-    handle->root = root;
-    
+    Comm_setup(handle, false, sendbuf, sendcnt, type, recvbuf, root, comm);
+
+    return Comm_begin(handle);
+  }
+
+  /// Persistent requests are point-to-point, since persistent
+  /// collectives are not available before MPI-4
+  bool Comm_gather_init(void *local, int nlocal, MPI_Datatype type,
+			void *data, 
+			int root, MPI_Comm comm,
+			Comm_handle_t *handle)
+  {
+    TRACE("Comm_gather_init(%d -> %d)", nlocal, root);
+
+    Comm_initialise();
+
+    Comm_setup(handle, true, local, nlocal, type, data, root, comm);
+    if(nonblock)
+      Comm_post(handle, true);
+    handle->persistent = true;
+
+    return (root == handle->myrank);
+  }
+
+  bool Comm_scatter_init( void *sendbuf, int sendcnt, MPI_Datatype type, 
+			  void *recvbuf, 
+			  int root, MPI_Comm comm,
+			  Comm_handle_t *handle)
+  {
+    TRACE("Comm_scatter_init(%d -> %d)", root, sendcnt);
+
+    Comm_initialise();
+
+    Comm_setup(handle, false, sendbuf, sendcnt, type, recvbuf, root, comm);
+    if(nonblock)
+      Comm_post(handle, true);
+    handle->persistent = true;
+
+    return (root == handle->myrank);
+  }
+
+  bool Comm_start(Comm_handle_t *handle)
+  {
+    TRACE("Comm_start");
+
+    if(!handle->persistent)
+      throw BoutException("Comm_start: handle not set up by Comm_gather_init or Comm_scatter_init");
+    if(handle->current)
+      throw BoutException("Comm_start: operation already in progress");
+
     if(!nonblock) {
-      MPI_Scatter ( sendbuf, sendcnt, type, recvbuf, sendcnt, type, root, comm );
-      handle->current = true;
-      
-      return (root == handle->myrank);
-    }
-    
-    int type_size; // Get size of the datatype
-    MPI_Type_size(type, &type_size);
-    
-    if(root == handle->myrank) {
-      // Sending from this processor
-      
-      handle->request = (MPI_Request*) malloc(sizeof(MPI_Request)*(handle->nprocs-1));
-      handle->nreq = handle->nprocs-1;
-      
-      MPI_Request *r = handle->request;
-      for(int p=0;p<handle->nprocs; p++) {
-	if(p != root) {
-	  
-	  MPI_Isend((void*) ( ((char*) sendbuf) + p*sendcnt*type_size),
-		    sendcnt,
-		    type,
-		    p,
-		    COMM_GROUP_TAG,
-		    comm,
-		    r);
-	  r++; // Next request
-	}
-      }
-      
-      // Copy local data
-      memcpy(recvbuf,
-	     (void*) (((char*) sendbuf) + root*sendcnt*type_size),
-	     sendcnt*type_size);
+      Comm_blocking(handle);
     }else {
-      // Receiving one message from root
-      
-      handle->request = (MPI_Request*) malloc(sizeof(MPI_Request));
-      handle->nreq = 1;
-
-      MPI_Irecv(recvbuf,
-		sendcnt,
-		type,
-		root,
-		COMM_GROUP_TAG,
-		comm,
-		handle->request);
+      MPI_Startall(handle->nreq, handle->request);
+      Comm_copy_local(handle);
     }
-
     handle->current = true;
-    
-    return (root == handle->myrank);
+
+    return (handle->root == handle->myrank);
   }
   
-  
   bool Comm_wait(Comm_handle_t *handle)
   {
-    TRACE("Comm_gather_wait(%d)", handle->root);
-
     if(handle == NULL)
       return false;
+
+    TRACE("Comm_wait(%d)", handle->root);
+
     if(!handle->current)
       return false;
 
-    if(!nonblock) { // Already done communication
-      handle->current = false;
-      return (handle->root == handle->myrank);
-    }
-
-    MPI_Status *s = (MPI_Status*) malloc(sizeof(MPI_Status)*(handle->nreq));
-    MPI_Waitall(handle->nreq, 
-		handle->request,
-		s);
+    // No requests if already done communication
+    if(handle->nreq > 0)
+      MPI_Waitall(handle->nreq, handle->request, MPI_STATUSES_IGNORE);
 
-    free(s); 
-    free(handle->request);
     handle->current = false;
     
     return (handle->root == handle->myrank);
@@ -241,4 +349,23 @@ namespace comm_group {
     }
     return newdata;
   }
+
+  void Comm_handle_free(Comm_handle_t *handle)
+  {
+    if(handle == NULL)
+      return;
+
+    Comm_wait(handle);
+
+    if(handle->persistent) {
+      for(int i=0;i<handle->nreq;i++)
+	MPI_Request_free(handle->request + i);
+      handle->persistent = false;
+    }
+
+    free(handle->request);
+    handle->request = nullptr;
+    handle->nalloc = 0;
+    handle->nreq = 0;
+  }
 }
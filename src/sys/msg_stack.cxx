@@ -26,6 +26,7 @@
 
 #include <msg_stack.hxx>
 #include <output.hxx>
+#include <bout/openmpwrap.hxx>
 #include <string.h>
 #include <string>
 #include <stdarg.h>
@@ -47,6 +48,11 @@ int MsgStack::push(const char *s, ...)
   va_list ap;  // List of arguments
   msg_item_t *m;
 
+  // Only one thread records messages, so the stack is not modified
+  // by several threads at once
+  if(!ompMasterThread())
+    return 0;
+
   if(size > nmsg) {
     m = &msg[nmsg];
   }else {
@@ -82,13 +88,16 @@ int MsgStack::setPoint() {
 }
 
 void MsgStack::pop() {
-  if(nmsg <= 0)
+  if((nmsg <= 0) || !ompMasterThread())
     return;
 
   nmsg--;
 }
 
 void MsgStack::pop(int id) {
+  if(!ompMasterThread())
+    return;
+
   if(id < 0)
     id = 0;
 
@@ -0,0 +1,308 @@
+/**************************************************************************
+ * Placement of field data on nodes with non-uniform memory access
+ *
+ **************************************************************************
+ * Copyright 2010 B.D.Dudson, S.Farley, M.V.Umansky, X.Q.Xu
+ *
+ * Contact: Ben Dudson, bd512@york.ac.uk
+ *
+ * This file is part of BOUT++.
+ *
+ * BOUT++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BOUT++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with BOUT++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **************************************************************************/
+
+#include <bout/sys/numa.hxx>
+#include <bout/array.hxx>
+#include <bout/dataiterator.hxx>
+#include <bout/openmpwrap.hxx>
+#include <boutcomm.hxx>
+#include <msg_stack.hxx>
+#include <options.hxx>
+#include <output.hxx>
+
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+  /// NUMA domain of each CPU, read from sysfs. Empty if not available
+  std::vector<int> readCpuDomains() {
+    std::vector<int> domains;
+#ifdef __linux__
+    for(int node = 0; ; node++) {
+      std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+      if(!file)
+        break;
+
+      // Comma separated ranges of CPUs, e.g. "0-7,16-23"
+      std::string list, range;
+      std::getline(file, list);
+      std::stringstream ranges(list);
+      while(std::getline(ranges, range, ',')) {
+        if(range.empty())
+          continue;
+        std::size_t dash = range.find('-');
+        int first = std::stoi(range.substr(0, dash));
+        int last = (dash == std::string::npos) ? first : std::stoi(range.substr(dash + 1));
+        if(last >= static_cast<int>(domains.size()))
+          domains.resize(last + 1, 0);
+        for(int cpu = first; cpu <= last; cpu++)
+          domains[cpu] = node;
+      }
+    }
+#endif
+    return domains;
+  }
+
+  const std::vector<int> &cpuDomains() {
+    static const std::vector<int> domains = readCpuDomains();
+    return domains;
+  }
+
+  /// Are threads bound to CPUs by the OpenMP runtime?
+  bool ompBound() {
+#if defined(_OPENMP) && (_OPENMP >= 201307)
+    return omp_get_proc_bind() != omp_proc_bind_false;
+#else
+    return false;
+#endif
+  }
+
+  /// Pin each OpenMP thread of this process to one CPU, in order
+  /// (as OMP_PROC_BIND=close). If all processes on this node may use
+  /// the same CPUs, these are divided between them. Collective, so
+  /// must be called on every process; threads are only pinned if
+  /// \p apply is true. Returns true if all threads were pinned
+  bool pinThreads(bool apply) {
+#if defined(__linux__) && defined(_OPENMP)
+    cpu_set_t mask;
+    std::vector<int> cpus;
+    if(sched_getaffinity(0, sizeof(mask), &mask) == 0) {
+      for(int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+        if(CPU_ISSET(cpu, &mask))
+          cpus.push_back(cpu);
+    }
+
+    // Processes on this node with the same CPUs as this one
+    MPI_Comm node;
+    MPI_Comm_split_type(BoutComm::get(), MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &node);
+    int noderank, nodesize;
+    MPI_Comm_rank(node, &noderank);
+    MPI_Comm_size(node, &nodesize);
+
+    int mine[2] = {cpus.empty() ? -1 : cpus.front(), static_cast<int>(cpus.size())};
+    std::vector<int> all(2 * nodesize);
+    MPI_Allgather(mine, 2, MPI_INT, all.data(), 2, MPI_INT, node);
+    MPI_Comm_free(&node);
+
+    if(!apply)
+      return false;
+
+    bool same = true;
+    for(int r = 0; r < nodesize; r++)
+      same = same && (all[2*r] == mine[0]) && (all[2*r + 1] == mine[1]);
+
+    int first = 0, count = static_cast<int>(cpus.size());
+    if(same) {
+      first = DI_spread_work(count, noderank, nodesize);
+      count = DI_spread_work(count, noderank + 1, nodesize) - first;
+    }
+    if(count < 1)
+      return false;
+
+    int failed = 0;
+    BOUT_OMP(parallel reduction(+:failed))
+    {
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      CPU_SET(cpus[first + omp_get_thread_num() % count], &set);
+      if(sched_setaffinity(0, sizeof(set), &set) != 0)
+        failed++;
+    }
+    return failed == 0;
+#else
+    return false;
+#endif
+  }
+
+  /// Fraction of the pages of \p data which are not in the domain of
+  /// the thread using them, dividing data between threads as
+  /// DataIterator. Negative if this can't be found
+  BoutReal remoteFraction(const BoutReal *data, int len) {
+#if defined(__linux__) && defined(SYS_move_pages)
+    const std::uintptr_t pagesize = sysconf(_SC_PAGESIZE);
+    long remote = 0, total = 0;
+    bool ok = true;
+    BOUT_OMP(parallel reduction(+:remote, total) reduction(&&:ok))
+    {
+      int np = 1, cp = 0;
+#ifdef _OPENMP
+      np = omp_get_num_threads();
+      cp = omp_get_thread_num();
+#endif
+      auto start = reinterpret_cast<std::uintptr_t>(data + DI_spread_work(len, cp, np));
+      auto end = reinterpret_cast<std::uintptr_t>(data + DI_spread_work(len, cp + 1, np));
+
+      std::vector<void*> pages;
+      for(std::uintptr_t page = start & ~(pagesize - 1); page < end; page += pagesize)
+        pages.push_back(reinterpret_cast<void*>(page));
+
+      // With no target nodes, move_pages only finds the node of each page
+      std::vector<int> status(pages.size());
+      if(!pages.empty() &&
+         (syscall(SYS_move_pages, 0, pages.size(), pages.data(), nullptr, status.data(), 0) != 0)) {
+        ok = false;
+      }else {
+        int here = numaDomain();
+        for(int node : status) {
+          if(node >= 0) {
+            total++;
+            if(node != here)
+              remote++;
+          }
+        }
+      }
+    }
+    if(ok && (total > 0))
+      return static_cast<BoutReal>(remote) / total;
+#endif
+    return -1.0;
+  }
+
+  /// Memory bandwidth in GB/s of a = b + s*c, with each thread using
+  /// the part of the arrays which DataIterator gives to the thread
+  /// \p shift after it
+  BoutReal triadBandwidth(BoutReal *a, const BoutReal *b, const BoutReal *c, int len,
+                          int shift) {
+    const int reps = 10;
+    const BoutReal s = 3.0;
+    BoutReal start = 0.0, end = 0.0;
+    BOUT_OMP(parallel)
+    {
+      int np = 1, cp = 0;
+#ifdef _OPENMP
+      np = omp_get_num_threads();
+      cp = omp_get_thread_num();
+#endif
+      int t = (cp + shift) % np;
+      int first = DI_spread_work(len, t, np), last = DI_spread_work(len, t + 1, np);
+
+      BOUT_OMP(barrier)
+      BOUT_OMP(master)
+      start = MPI_Wtime();
+
+      for(int r = 0; r < reps; r++)
+        for(int i = first; i < last; i++)
+          a[i] = b[i] + s * c[i];
+
+      BOUT_OMP(barrier)
+      BOUT_OMP(master)
+      end = MPI_Wtime();
+    }
+    return 3.0 * sizeof(BoutReal) * len * reps / (end - start) / 1e9;
+  }
+
+  /// Measure and print the placement of Array data, and the bandwidth
+  void printDiagnostic() {
+    // Larger than the caches
+    const int len = 1 << 21;
+    Array<BoutReal> a(len), b(len), c(len);
+
+    // On one thread, as fields are usually initialised. With first
+    // touch the pages have already been placed
+    for(int i = 0; i < len; i++) {
+      a[i] = 0.0;
+      b[i] = 1.0;
+      c[i] = 2.0;
+    }
+
+    BoutReal remote = remoteFraction(a.begin(), len);
+    if(remote < 0.0) {
+      output_info.write("\tNUMA: Page locations not available\n");
+    }else {
+      output_info.write("\tNUMA: %.1f%% of pages are remote from the threads using them\n",
+                        100. * remote);
+    }
+
+    int nthreads = 1;
+#ifdef _OPENMP
+    nthreads = omp_get_max_threads();
+#endif
+    BoutReal own = triadBandwidth(a.begin(), b.begin(), c.begin(), len, 0);
+    if(nthreads > 1) {
+      // Half-way round, which is on another socket for close binding
+      BoutReal other = triadBandwidth(a.begin(), b.begin(), c.begin(), len, nthreads / 2);
+      output_info.write("\tNUMA: Bandwidth %.1f GB/s, %.1f GB/s using other threads' data\n",
+                        own, other);
+    }else {
+      output_info.write("\tNUMA: Bandwidth %.1f GB/s\n", own);
+    }
+  }
+}
+
+int numaDomain() {
+#ifdef __linux__
+  int cpu = sched_getcpu();
+  const std::vector<int> &domains = cpuDomains();
+  if((cpu >= 0) && (cpu < static_cast<int>(domains.size())))
+    return domains[cpu];
+#endif
+  return 0;
+}
+
+int numaNumDomains() {
+  int n = 0;
+  for(int d : cpuDomains())
+    n = (d + 1 > n) ? d + 1 : n;
+  return (n > 0) ? n : 1;
+}
+
+void numaInitialise(Options *options) {
+  TRACE("numaInitialise");
+
+  bool first_touch, pin_threads, diagnose;
+  OPTION(options, first_touch, false);
+  OPTION(options, pin_threads, false);
+  OPTION(options, diagnose, false);
+
+  // Whether the OpenMP runtime binds threads can differ between
+  // processes, so all join pinThreads but only unbound ones pin
+  bool pinned = ompBound();
+  if(pin_threads) {
+    bool result = pinThreads(!pinned);
+    pinned = pinned || result;
+  }
+
+  numaFirstTouch() = first_touch;
+
+  if(!(first_touch || pin_threads || diagnose))
+    return;
+
+  output_info.write("\tNUMA: %d domains, first touch %s, threads %s\n", numaNumDomains(),
+                    first_touch ? "on" : "off", pinned ? "bound" : "not bound");
+  if(first_touch && !pinned)
+    output_warn.write("\tNUMA: Threads may move between domains. Set OMP_PROC_BIND or numa:pin_threads\n");
+
+  if(diagnose)
+    printDiagnostic();
+}
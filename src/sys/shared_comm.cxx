@@ -0,0 +1,125 @@
+/**************************************************************************
+ * Exchange of data through MPI-3 shared memory windows
+ *
+ **************************************************************************
+ * Copyright 2010 B.D.Dudson, S.Farley, M.V.Umansky, X.Q.Xu
+ *
+ * Contact: Ben Dudson, bd512@york.ac.uk
+ *
+ * This file is part of BOUT++.
+ *
+ * BOUT++ is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BOUT++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with BOUT++.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **************************************************************************/
+
+#include <bout/sys/shared_comm.hxx>
+#include <boutexception.hxx>
+
+SharedComm::SharedComm(MPI_Comm comm, int nslots, int slotsize) : nslots(nslots) {
+  if (MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &comm_node) !=
+      MPI_SUCCESS)
+    throw BoutException("SharedComm: Could not create node communicator");
+
+  // All buffers the same size, so that slots can be found in other processes
+  MPI_Allreduce(&slotsize, &this->slotsize, 1, MPI_INT, MPI_MAX, comm_node);
+
+  // Separate communicator for releases, so they can't match other messages
+  MPI_Comm_dup(comm, &comm_ack);
+
+  // Each process' buffers in its own pages, near the process which writes them
+  MPI_Info info;
+  MPI_Info_create(&info);
+  MPI_Info_set(info, const_cast<char *>("alloc_shared_noncontig"), const_cast<char *>("true"));
+
+  MPI_Aint size = static_cast<MPI_Aint>(nslots) * this->slotsize * sizeof(BoutReal);
+  if (MPI_Win_allocate_shared(size, sizeof(BoutReal), info, comm_node, &base, &win) !=
+      MPI_SUCCESS)
+    throw BoutException("SharedComm: Could not allocate shared memory window");
+  MPI_Info_free(&info);
+
+  // Passive target epoch for the lifetime of the window. Synchronisation is
+  // by MPI_Win_sync and messages
+  MPI_Win_lock_all(MPI_MODE_NOCHECK, win);
+
+  // Map ranks in comm to ranks on this node
+  int nprocs;
+  MPI_Comm_size(comm, &nprocs);
+  std::vector<int> ranks(nprocs);
+  for (int i = 0; i < nprocs; i++)
+    ranks[i] = i;
+  node_rank.resize(nprocs);
+
+  MPI_Group group, group_node;
+  MPI_Comm_group(comm, &group);
+  MPI_Comm_group(comm_node, &group_node);
+  MPI_Group_translate_ranks(group, nprocs, ranks.data(), group_node, node_rank.data());
+  MPI_Group_free(&group);
+  MPI_Group_free(&group_node);
+
+  // Buffers of the other processes on this node
+  int nnode;
+  MPI_Comm_size(comm_node, &nnode);
+  remote.resize(nnode);
+  for (int i = 0; i < nnode; i++) {
+    MPI_Aint remote_size;
+    int disp_unit;
+    MPI_Win_shared_query(win, i, &remote_size, &disp_unit, &remote[i]);
+  }
+
+  acks.resize(nslots, MPI_REQUEST_NULL);
+}
+
+SharedComm::~SharedComm() {
+  // Receivers release every slot they are told about
+  MPI_Waitall(nslots, acks.data(), MPI_STATUSES_IGNORE);
+
+  MPI_Win_unlock_all(win);
+  MPI_Win_free(&win);
+  MPI_Comm_free(&comm_ack);
+  MPI_Comm_free(&comm_node);
+}
+
+BoutReal *SharedComm::sendBuffer(int slot, int rank, int len) {
+  if (!isLocal(rank) || (len <= 0) || (len > slotsize))
+    return nullptr;
+
+  if (acks[slot] != MPI_REQUEST_NULL) {
+    // Check if the last receiver has finished with this slot
+    int done;
+    MPI_Test(&acks[slot], &done, MPI_STATUS_IGNORE);
+    if (!done)
+      return nullptr;
+  }
+  return base + static_cast<std::size_t>(slot) * slotsize;
+}
+
+void SharedComm::ready(int slot, int rank) {
+  // Make the data written visible to other processes
+  MPI_Win_sync(win);
+
+  MPI_Irecv(nullptr, 0, MPI_BYTE, rank, slot, comm_ack, &acks[slot]);
+}
+
+BoutReal *SharedComm::recvBuffer(int rank, int slot) {
+  // See data written by the sender before it sent its message
+  MPI_Win_sync(win);
+
+  return remote[node_rank[rank]] + static_cast<std::size_t>(slot) * slotsize;
+}
+
+void SharedComm::release(int rank, int slot) {
+  MPI_Request request;
+  MPI_Isend(nullptr, 0, MPI_BYTE, rank, slot, comm_ack, &request);
+  MPI_Request_free(&request);
+}
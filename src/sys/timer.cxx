@@ -2,34 +2,51 @@
 
 #include <mpi.h>
 #include <bout/sys/timer.hxx>
+#include <bout/openmpwrap.hxx>
 
 using namespace std;
 
 Timer::Timer() {
+  // Only one thread records time, so that threads in a team
+  // don't modify the same timer
+  if(!ompMasterThread()) {
+    timing = nullptr;
+    return;
+  }
   timing = getInfo("");
   timing->started = MPI_Wtime();
   timing->running = true;
 }
 
 Timer::Timer(const string &label) {
+  if(!ompMasterThread()) {
+    timing = nullptr;
+    return;
+  }
   timing = getInfo(label);
   timing->started = MPI_Wtime();
   timing->running = true;
 }
 
 Timer::~Timer() {
+  if(!timing)
+    return;
   double finished = MPI_Wtime();
   timing->running = false;
   timing->time += finished - timing->started;
 }
 
 double Timer::getTime() {
+  if(!timing)
+    return 0.0;
   if(timing->running)
     return timing->time + (MPI_Wtime() - timing->started);
   return timing->time;
 }
 
 double Timer::resetTime() {
+  if(!timing)
+    return 0.0;
   double val = timing->time;
   timing->time = 0.0;
   if(timing->running) {
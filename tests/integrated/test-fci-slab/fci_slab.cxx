@@ -1,6 +1,13 @@
 #include <bout/physicsmodel.hxx>
 #include <utils.hxx>
 #include <bout/mesh.hxx>
+#include <field_factory.hxx>
+
+#include <chrono>
+
+typedef std::chrono::time_point<std::chrono::steady_clock> SteadyClock;
+typedef std::chrono::duration<double> Duration;
+using namespace std::chrono;
 
 class FCISlab : public PhysicsModel {
 public:
@@ -24,9 +31,31 @@ public:
     f.applyBoundary("dirichlet");
     g.applyBoundary("dirichlet");
 
+    // Optionally time the parallel interpolation
+    int iterations;
+    Options::getRoot()->getSection("benchmark")->get("iterations", iterations, 0);
+    if(iterations > 0)
+      benchmark(iterations);
+
     return 0;
   }
 
+  /// Time the communication of a field, which includes
+  /// the calculation of yup and ydown fields by interpolation
+  void benchmark(int iterations) {
+    Field3D a = FieldFactory::get()->create3D("cos(y-z)", Options::getRoot(), mesh);
+    mesh->communicate(a);
+
+    SteadyClock start = steady_clock::now();
+    for(int i=0;i<iterations;i++) {
+      mesh->communicate(a);
+    }
+    Duration elapsed = steady_clock::now() - start;
+
+    output << "TIMING\n======\n";
+    output << "communicate: " << elapsed.count() / iterations << endl;
+  }
+
   int rhs(BoutReal time);
 
 private:
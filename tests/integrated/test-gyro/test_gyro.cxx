@@ -21,6 +21,19 @@ int main(int argc, char **argv) {
   Field3D pade1 = gyroPade1(input3d, 0.5);
   Field3D pade2 = gyroPade2(input3d, 0.5);
   SAVE_ONCE2(pade1, pade2);
+
+  // Several fields at once, inverted together
+  std::vector<Field3D> multi1 = gyroPade1({2.0*input3d, input3d}, 0.5);
+  std::vector<Field3D> multi2 = gyroPade2({2.0*input3d, input3d}, 0.5);
+  Field3D pade1_multi = multi1[1];
+  Field3D pade2_multi = multi2[1];
+  SAVE_ONCE2(pade1_multi, pade2_multi);
+
+  // Operator object, with matrices set up once
+  GyroAverage gyro(0.5);
+  Field3D pade1_op = gyro.pade1(input3d);
+  Field3D pade2_op = gyro.pade2(input3d);
+  SAVE_ONCE2(pade1_op, pade2_op);
   
   // Write data
   dump.write();
@@ -0,0 +1,36 @@
+#!/usr/bin/env python
+
+#
+# Compare the time to write a record with one NetCDF-4 file
+# per processor, and with one shared file written by PnetCDF.
+# Needs BOUT++ configured with PnetCDF
+#
+# Usage: ./benchmark.py [nproc ...]
+#
+
+from __future__ import print_function
+
+from boututils.run_wrapper import shell, launch, getmpirun
+from sys import argv, exit
+import re
+
+MPIRUN=getmpirun()
+
+nprocs = [int(n) for n in argv[1:]] or [4]
+
+print("Making I/O test")
+shell("make > make.log")
+
+def time_per_write(nproc, options):
+  shell("rm -f benchmark/BOUT.dmp.*")
+  s, out = launch("./test_io -d benchmark "+options, runcmd=MPIRUN, nproc=nproc, pipe=True)
+  if s != 0:
+    print(out)
+    exit(1)
+  return float(re.search(r"Time per write: (\S+) s", out).group(1))
+
+print("nproc  file per process [s]  PnetCDF [s]")
+for nproc in nprocs:
+  t_nc4 = time_per_write(nproc, "dump_format=nc output:parallel=false")
+  t_pnc = time_per_write(nproc, "output:parallel=true")
+  print("%5d  %20e  %11e" % (nproc, t_nc4, t_pnc))
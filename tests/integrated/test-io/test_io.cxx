@@ -46,7 +46,14 @@ int main(int argc, char **argv) {
   int MYPE;
   MPI_Comm_rank(BoutComm::get(), &MYPE);
 
-  for(int i=0;i<3;i++) {
+  // Number of records to write. Increased by the benchmark
+  int nwrite;
+  Options::getRoot()->getSection("test_io")->get("nwrite", nwrite, 3);
+
+  MPI_Barrier(BoutComm::get());
+  BoutReal start = MPI_Wtime();
+
+  for(int i=0;i<nwrite;i++) {
     ivar_evol = ivar + i;
     rvar_evol = rvar + 0.5 * i;
     v2d.x = v2d.y = v2d.z = f2d;
@@ -55,6 +62,9 @@ int main(int argc, char **argv) {
     dump.write();
   }
 
+  MPI_Barrier(BoutComm::get());
+  output.write("Time per write: %e s\n", (MPI_Wtime() - start) / nwrite);
+
   dump.close(); // Ensure data is written
 
   // Need to wait for all processes to finish writing
@@ -782,3 +782,21 @@ TEST_F(Field2DTest, Max) {
 
   EXPECT_TRUE(IsField2DEqualBoutReal(max(field, false), max_value));
 }
+
+TEST_F(Field2DTest, ReuseTemporaries) {
+  Field2D a = 1.0;
+  Field2D b = 2.0;
+  Field2D c = 3.0;
+
+  // Only the first operation needs a new array
+  Array<BoutReal>::allocations() = 0;
+  Field2D result = sqrt(2.0 * (a * b + c) - 1.0) / 4.0;
+  EXPECT_EQ(Array<BoutReal>::allocations(), 1);
+  EXPECT_TRUE(IsField2DEqualBoutReal(result, 0.75));
+
+  // Temporary on the right
+  Array<BoutReal>::allocations() = 0;
+  result = c - (a * b);
+  EXPECT_EQ(Array<BoutReal>::allocations(), 1);
+  EXPECT_TRUE(IsField2DEqualBoutReal(result, 1.0));
+}
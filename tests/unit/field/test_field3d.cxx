@@ -2,6 +2,7 @@
 
 #include "bout/constants.hxx"
 #include "bout/mesh.hxx"
+#include "bout/openmpwrap.hxx"
 #include "boutexception.hxx"
 #include "field3d.hxx"
 #include "test_extras.hxx"
@@ -997,3 +998,120 @@ TEST_F(Field3DTest, DC) {
 
   EXPECT_TRUE(IsField2DEqualBoutReal(DC(field), 3.0));
 }
+
+TEST_F(Field3DTest, OpenMPTeam) {
+  Field3D a = 1.0;
+  Field3D b = 2.0;
+  Field3D result, zero;
+
+  // Every thread evaluates the same expressions, sharing the work
+  BOUT_OMP(parallel)
+  {
+    OmpTeam team;
+    Field3D tmp = a * b + 3.0; // Thread-private, but shares data
+    result = tmp - 1.0;        // Shared between threads
+    zero = 0.0;
+    zero += sqrt(result) - 2.0;
+  }
+
+  EXPECT_TRUE(IsField3DEqualBoutReal(result, 4.0));
+  EXPECT_TRUE(IsField3DEqualBoutReal(zero, 0.0));
+}
+
+TEST_F(Field3DTest, TeamMasterThrows) {
+  int caught = 0, nthreads = 1;
+
+  // Every thread gets the exception, rather than waiting at the barrier
+  BOUT_OMP(parallel reduction(+:caught))
+  {
+    OmpTeam team;
+    BOUT_OMP(master)
+    nthreads = ompTeamSize();
+    try {
+      ompMaster([]() { throw BoutException("Test"); });
+    } catch (BoutException &) {
+      caught++;
+    }
+  }
+
+  EXPECT_EQ(caught, nthreads);
+}
+
+TEST_F(Field3DTest, TeamThreadThrows) {
+  Field3D a = 1.0;
+  Field3D result;
+
+  // One thread fails before the others reach the barriers in the
+  // field operations. They leave the team rather than wait for it
+  auto rhs = [&]() {
+    int thread = 0;
+#ifdef _OPENMP
+    thread = omp_get_thread_num();
+#endif
+    if (thread == ompTeamSize() - 1)
+      throw BoutException("Test");
+    result = a * 2.0 + 1.0;
+    result = sqrt(result);
+  };
+  EXPECT_THROW(ompRunTeam(rhs), BoutException);
+
+  // The next team is not affected
+  ompRunTeam([&]() { result = a + 1.0; });
+  EXPECT_TRUE(IsField3DEqualBoutReal(result, 2.0));
+}
+
+TEST_F(Field3DTest, TeamMasterResult) {
+  int wrong = 0;
+
+  // Calculated once, and shared by every thread
+  BOUT_OMP(parallel reduction(+:wrong))
+  {
+    OmpTeam team;
+    Field3D a = ompMasterResult([]() { return Field3D(2.0); });
+    Field3D b = ompMasterResult([&]() { return a + 1.0; });
+    if ((a(1, 1, 1) != 2.0) || (b(1, 1, 1) != 3.0))
+      wrong++;
+  }
+
+  EXPECT_EQ(wrong, 0);
+}
+
+TEST_F(Field3DTest, ReuseTemporaries) {
+  Field3D a = 1.0;
+  Field3D b = 2.0;
+  Field3D c = 3.0;
+  Field2D d = 4.0;
+
+  // Only the first operation needs a new array
+  Array<BoutReal>::allocations() = 0;
+  Field3D result = sqrt(2.0 * (a * b + c) - 1.0) / d;
+  EXPECT_EQ(Array<BoutReal>::allocations(), 1);
+  EXPECT_TRUE(IsField3DEqualBoutReal(result, 0.75));
+
+  // Temporary on the right
+  Array<BoutReal>::allocations() = 0;
+  result = d - c * (a * b);
+  EXPECT_EQ(Array<BoutReal>::allocations(), 1);
+  EXPECT_TRUE(IsField3DEqualBoutReal(result, -2.0));
+
+  Array<BoutReal>::allocations() = 0;
+  result = -(a * b) + (c * b);
+  EXPECT_EQ(Array<BoutReal>::allocations(), 2);
+  EXPECT_TRUE(IsField3DEqualBoutReal(result, 4.0));
+}
+
+TEST_F(Field3DTest, NoReuseSharedTemporaries) {
+  Field3D a = 1.0;
+  Field3D b = 2.0;
+
+  Field3D tmp = a + b;
+  Field3D shared = tmp;
+
+  // tmp shares data with another field, so a new array is needed
+  Array<BoutReal>::allocations() = 0;
+  Field3D result = std::move(tmp) * b;
+  EXPECT_EQ(Array<BoutReal>::allocations(), 1);
+
+  EXPECT_TRUE(IsField3DEqualBoutReal(result, 6.0));
+  EXPECT_TRUE(IsField3DEqualBoutReal(shared, 3.0));
+}
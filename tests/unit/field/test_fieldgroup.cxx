@@ -3,6 +3,8 @@
 
 #include "bout/fieldgroup.hxx"
 #include "bout/mesh.hxx"
+#include "bout/openmpwrap.hxx"
+#include "bout/paralleltransform.hxx"
 #include "field2d.hxx"
 #include "field3d.hxx"
 #include "unused.hxx"
@@ -37,6 +39,23 @@ const int FieldGroupTest::nx = 3;
 const int FieldGroupTest::ny = 5;
 const int FieldGroupTest::nz = 7;
 
+/// A FakeMesh which counts its communications
+class CountingMesh : public FakeMesh {
+public:
+  CountingMesh(int nx, int ny, int nz) : FakeMesh(nx, ny, nz) {
+    setParallelTransform(PTptr(new ParallelTransformIdentity()));
+  }
+
+  comm_handle send(FieldGroup &g) override {
+    sends++;
+    sent = g.size();
+    return nullptr;
+  }
+
+  int sends = 0; ///< Number of calls to send
+  int sent = 0;  ///< Number of fields in the last send
+};
+
 TEST_F(FieldGroupTest, CreateWithField2D) {
   Field2D a;
   FieldGroup group(a);
@@ -173,3 +192,122 @@ TEST_F(FieldGroupTest, MakeUnique) {
   EXPECT_EQ(group.size_field3d(), 1);
 }
 
+
+TEST_F(FieldGroupTest, Merge) {
+  Field2D a;
+  Field3D b, c;
+  FieldGroup group(b, a);
+  FieldGroup other(a, c, b);
+
+  group.merge(other);
+
+  EXPECT_EQ(group.size(), 3);
+  EXPECT_EQ(group.size_field3d(), 2);
+
+  // Order in which fields were first added is kept
+  EXPECT_EQ(group.get()[0], &b);
+  EXPECT_EQ(group.get()[1], &a);
+  EXPECT_EQ(group.get()[2], &c);
+}
+
+TEST_F(FieldGroupTest, CommunicateLater) {
+  CountingMesh localmesh(nx, ny, nz);
+  Field2D a = 1.0;
+  Field3D b = 2.0, c = 3.0;
+
+  localmesh.communicateLater(a, b);
+  localmesh.communicateLater(c, a);
+  EXPECT_EQ(localmesh.sends, 0);
+
+  // All fields in one exchange, each once
+  localmesh.communicatePending();
+  EXPECT_EQ(localmesh.sends, 1);
+  EXPECT_EQ(localmesh.sent, 3);
+
+  // Nothing left to send
+  localmesh.communicatePending();
+  EXPECT_EQ(localmesh.sends, 1);
+}
+
+TEST_F(FieldGroupTest, CommunicateIncludesPending) {
+  CountingMesh localmesh(nx, ny, nz);
+  Field3D a = 1.0, b = 2.0;
+
+  localmesh.communicateLater(a);
+  localmesh.communicate(b);
+  EXPECT_EQ(localmesh.sends, 1);
+  EXPECT_EQ(localmesh.sent, 2);
+
+  localmesh.communicatePending();
+  EXPECT_EQ(localmesh.sends, 1);
+}
+
+TEST_F(FieldGroupTest, CommunicatePendingInTeam) {
+  CountingMesh localmesh(nx, ny, nz);
+  Field3D a = 1.0;
+
+  // Every thread flushes twice. The second finds the queue empty,
+  // but must still wait with the others
+  BOUT_OMP(parallel)
+  {
+    OmpTeam team;
+    localmesh.communicateLater(a);
+    localmesh.communicatePending();
+    localmesh.communicatePending();
+  }
+
+  EXPECT_EQ(localmesh.sends, 1);
+  EXPECT_EQ(localmesh.sent, 1);
+}
+
+TEST_F(FieldGroupTest, CommunicatePrivateInTeam) {
+  CountingMesh localmesh(nx, ny, nz);
+  Field3D shared = 1.0;
+  int nthreads = 1;
+
+  BOUT_OMP(parallel)
+  {
+    OmpTeam team;
+    BOUT_OMP(master)
+    nthreads = ompTeamSize();
+
+    // The same data on every thread, so communicated once
+    localmesh.communicate(shared);
+
+    // A copy on each thread, as made by functions which aren't
+    // team-aware. Every copy needs its guard cells
+    Field3D mine;
+    mine.allocate();
+    localmesh.communicate(mine);
+  }
+
+  EXPECT_EQ(localmesh.sends, 1 + nthreads);
+}
+
+TEST_F(FieldGroupTest, CommunicateXZIncludesPending) {
+  CountingMesh localmesh(nx, ny, nz);
+  Field3D a = 1.0, b = 2.0;
+
+  localmesh.communicateLater(a);
+  localmesh.communicateXZ(b);
+  EXPECT_EQ(localmesh.sends, 1);
+  EXPECT_EQ(localmesh.sent, 2);
+
+  localmesh.communicatePending();
+  EXPECT_EQ(localmesh.sends, 1);
+}
+
+TEST_F(FieldGroupTest, NothingPendingInTeam) {
+  CountingMesh localmesh(nx, ny, nz);
+
+  // With nothing waiting there is no barrier, so one thread alone
+  // can check the queue without waiting for the others
+  BOUT_OMP(parallel)
+  {
+    OmpTeam team;
+    BOUT_OMP(master)
+    localmesh.communicatePending();
+  }
+
+  EXPECT_EQ(localmesh.sends, 0);
+}
@@ -0,0 +1,112 @@
+#include "gtest/gtest.h"
+#include "bout/compression.hxx"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace {
+/// Values spanning many orders of magnitude, of both signs
+std::vector<BoutReal> testData() {
+  std::vector<BoutReal> data;
+  for (int i = 0; i < 1000; i++) {
+    data.push_back(std::sin(0.37 * i) * std::pow(10.0, (i % 13) - 6));
+  }
+  return data;
+}
+
+/// Number of trailing zero bits in the mantissa
+int zeroBits(BoutReal x) {
+  uint64_t bits;
+  std::memcpy(&bits, &x, sizeof(bits));
+  int n = 0;
+  while ((n < 52) && !(bits & (uint64_t(1) << n))) {
+    n++;
+  }
+  return n;
+}
+} // namespace
+
+TEST(CompressionTest, QuantiseBits) {
+  EXPECT_EQ(quantiseBits(0.0), 52);
+  EXPECT_EQ(quantiseBits(0.5), 0);
+  EXPECT_EQ(quantiseBits(2.0), 0);
+  EXPECT_EQ(quantiseBits(std::pow(2.0, -10)), 9);
+  EXPECT_EQ(quantiseBits(1e-3), 9);
+  EXPECT_EQ(quantiseBits(1e-30), 52);
+}
+
+TEST(CompressionTest, NoTolerance) {
+  std::vector<BoutReal> data = testData();
+  std::vector<BoutReal> orig = data;
+
+  quantise(data.data(), data.size(), 0.0, 0.0);
+
+  EXPECT_EQ(data, orig);
+}
+
+TEST(CompressionTest, Relative) {
+  std::vector<BoutReal> data = testData();
+  std::vector<BoutReal> orig = data;
+  const BoutReal reltol = 1e-4;
+
+  quantise(data.data(), data.size(), 0.0, reltol);
+
+  for (unsigned int i = 0; i < data.size(); i++) {
+    EXPECT_LE(std::abs(data[i] - orig[i]), reltol * std::abs(orig[i]));
+    EXPECT_GE(zeroBits(data[i]), 52 - quantiseBits(reltol));
+  }
+}
+
+TEST(CompressionTest, Absolute) {
+  std::vector<BoutReal> data = testData();
+  std::vector<BoutReal> orig = data;
+  const BoutReal abstol = 1e-3;
+
+  quantise(data.data(), data.size(), abstol, 0.0);
+
+  int zeros = 0;
+  for (unsigned int i = 0; i < data.size(); i++) {
+    EXPECT_LE(std::abs(data[i] - orig[i]), abstol);
+    if (data[i] == 0.0) {
+      zeros++;
+    }
+  }
+  // Small values are set to zero
+  EXPECT_GT(zeros, 0);
+}
+
+TEST(CompressionTest, Combined) {
+  std::vector<BoutReal> data = testData();
+  std::vector<BoutReal> orig = data;
+  const BoutReal abstol = 1e-3, reltol = 1e-6;
+
+  quantise(data.data(), data.size(), abstol, reltol);
+
+  for (unsigned int i = 0; i < data.size(); i++) {
+    EXPECT_LE(std::abs(data[i] - orig[i]), std::max(abstol, reltol * std::abs(orig[i])));
+  }
+}
+
+TEST(CompressionTest, SpecialValues) {
+  std::vector<BoutReal> data = {std::numeric_limits<BoutReal>::infinity(),
+                                -std::numeric_limits<BoutReal>::infinity(),
+                                std::numeric_limits<BoutReal>::max(),
+                                std::numeric_limits<BoutReal>::denorm_min(),
+                                0.0, -1.0};
+
+  quantise(data.data(), data.size(), 0.0, 0.1);
+
+  EXPECT_EQ(data[0], std::numeric_limits<BoutReal>::infinity());
+  EXPECT_EQ(data[1], -std::numeric_limits<BoutReal>::infinity());
+  EXPECT_EQ(data[2], std::numeric_limits<BoutReal>::max());
+  EXPECT_EQ(data[3], std::numeric_limits<BoutReal>::denorm_min());
+  EXPECT_EQ(data[4], 0.0);
+  EXPECT_EQ(data[5], -1.0);
+
+  std::vector<BoutReal> nan = {std::nan("")};
+  quantise(nan.data(), nan.size(), 1.0, 0.1);
+  EXPECT_TRUE(std::isnan(nan[0]));
+}
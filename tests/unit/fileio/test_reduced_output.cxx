@@ -0,0 +1,155 @@
+#include "gtest/gtest.h"
+
+#include "bout/mesh.hxx"
+#include "bout/reduced_output.hxx"
+#include "boutexception.hxx"
+#include "fft.hxx"
+#include "field2d.hxx"
+#include "field3d.hxx"
+#include "options.hxx"
+#include "test_extras.hxx"
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+/// Global mesh
+extern Mesh *mesh;
+
+/// A FakeMesh whose Y communicator is this process only, so that
+/// averages in Y can be taken
+class SerialYMesh : public FakeMesh {
+public:
+  SerialYMesh(int nx, int ny, int nz) : FakeMesh(nx, ny, nz) {}
+  MPI_Comm getYcomm(int UNUSED(jx)) const override { return MPI_COMM_SELF; }
+};
+
+/// Test fixture to make sure the global mesh is our fake one
+class ReducedOutputTest : public ::testing::Test {
+protected:
+  static void SetUpTestCase() {
+    // Averages in Y use MPI, even on a single process
+    int initialised;
+    MPI_Initialized(&initialised);
+    if (!initialised) {
+      MPI_Init(nullptr, nullptr);
+      std::atexit([]() { MPI_Finalize(); });
+    }
+
+    // Delete any existing mesh
+    if (mesh != nullptr) {
+      delete mesh;
+      mesh = nullptr;
+    }
+    mesh = new SerialYMesh(nx, ny, nz);
+  }
+
+  static void TearDownTestCase() {
+    delete mesh;
+    mesh = nullptr;
+  }
+
+  void SetUp() {
+    f.allocate();
+    for (int x = 0; x < nx; x++)
+      for (int y = 0; y < ny; y++)
+        for (int z = 0; z < nz; z++)
+          f(x, y, z) = x + 0.5 * y * y + std::sin(2.0 * z + x) + 0.1 * z;
+  }
+
+  /// Options section \p name, with the given type and no file output
+  static Options *section(const std::string &name, const std::string &type) {
+    Options *opt = Options::getRoot()->getSection(name);
+    opt->set("type", type, "test");
+    opt->set("enabled", false, "test");
+    return opt;
+  }
+
+  Field3D f;
+
+public:
+  static const int nx;
+  static const int ny;
+  static const int nz;
+};
+
+const int ReducedOutputTest::nx = 3;
+const int ReducedOutputTest::ny = 5;
+const int ReducedOutputTest::nz = 8;
+
+TEST_F(ReducedOutputTest, AverageZ) {
+  ReducedOutput out(section("reduced_avz", "average_z"), "reduced_avz");
+  out.add(f, "f");
+  out.call(nullptr, 1.0, 0, 1);
+
+  ASSERT_EQ(out.outputs(0).size(), 1u);
+  const Field2D &result = *(out.outputs(0)[0]);
+  for (int x = 0; x < nx; x++)
+    for (int y = 0; y < ny; y++) {
+      BoutReal sum = 0.0;
+      for (int z = 0; z < nz; z++)
+        sum += f(x, y, z);
+      EXPECT_NEAR(result(x, y), sum / nz, 1e-12);
+    }
+}
+
+TEST_F(ReducedOutputTest, AverageYZ) {
+  ReducedOutput out(section("reduced_avyz", "average_yz"), "reduced_avyz");
+  out.add(f, "f");
+  out.call(nullptr, 1.0, 0, 1);
+
+  ASSERT_EQ(out.outputs(0).size(), 1u);
+  const Field2D &result = *(out.outputs(0)[0]);
+  for (int x = 0; x < nx; x++) {
+    // Average over Z, and over Y without the guard cells
+    BoutReal sum = 0.0;
+    for (int y = mesh->ystart; y <= mesh->yend; y++)
+      for (int z = 0; z < nz; z++)
+        sum += f(x, y, z);
+    BoutReal expected = sum / (nz * (mesh->yend - mesh->ystart + 1));
+    for (int y = 0; y < ny; y++)
+      EXPECT_NEAR(result(x, y), expected, 1e-12);
+  }
+}
+
+TEST_F(ReducedOutputTest, SliceZ) {
+  Options *opt = section("reduced_slice", "slice_z");
+  opt->set("zstart", 1, "test");
+  opt->set("zstride", 3, "test");
+  ReducedOutput out(opt, "reduced_slice");
+  out.add(f, "f");
+  out.call(nullptr, 1.0, 0, 1);
+
+  // Planes 1, 4 and 7
+  ASSERT_EQ(out.outputs(0).size(), 3u);
+  for (int i = 0; i < 3; i++) {
+    const Field2D &result = *(out.outputs(0)[i]);
+    for (int x = 0; x < nx; x++)
+      for (int y = 0; y < ny; y++)
+        EXPECT_DOUBLE_EQ(result(x, y), f(x, y, 1 + 3 * i));
+  }
+}
+
+TEST_F(ReducedOutputTest, Fourier) {
+  Options *opt = section("reduced_fourier", "fourier");
+  opt->set("nmodes", 3, "test");
+  ReducedOutput out(opt, "reduced_fourier");
+  out.add(f, "f");
+  out.call(nullptr, 1.0, 0, 1);
+
+  ASSERT_EQ(out.outputs(0).size(), 6u);
+  std::vector<dcomplex> fk(nz / 2 + 1);
+  for (int x = 0; x < nx; x++)
+    for (int y = 0; y < ny; y++) {
+      rfft(&f(x, y, 0), nz, fk.data());
+      for (int k = 0; k < 3; k++) {
+        EXPECT_DOUBLE_EQ((*(out.outputs(0)[2 * k]))(x, y), fk[k].real());
+        EXPECT_DOUBLE_EQ((*(out.outputs(0)[2 * k + 1]))(x, y), fk[k].imag());
+      }
+    }
+}
+
+TEST_F(ReducedOutputTest, UnknownType) {
+  EXPECT_THROW(ReducedOutput(section("reduced_unknown", "average_x"), "reduced_unknown"),
+               BoutException);
+}
@@ -0,0 +1,206 @@
+#include "gtest/gtest.h"
+#include "batched_tridag.hxx"
+#include "utils.hxx"
+
+#include <cmath>
+
+namespace {
+const int nsys = 7;
+const int n = 12;
+
+/// Diagonally dominant coefficients, different for each system
+template <class T>
+void fillCoefs(T **a, T **b, T **c, T **rhs) {
+  for (int s = 0; s < nsys; s++) {
+    for (int i = 0; i < n; i++) {
+      a[s][i] = 1.0 + 0.1 * s + 0.01 * i;
+      c[s][i] = 0.5 - 0.05 * i + 0.02 * s;
+      b[s][i] = -4.0 - 0.3 * std::sin(1.0 * i + s);
+      rhs[s][i] = std::cos(0.7 * i) + 0.2 * s;
+    }
+  }
+}
+
+template <>
+void fillCoefs(dcomplex **a, dcomplex **b, dcomplex **c, dcomplex **rhs) {
+  for (int s = 0; s < nsys; s++) {
+    for (int i = 0; i < n; i++) {
+      a[s][i] = dcomplex(1.0 + 0.1 * s, 0.01 * i);
+      c[s][i] = dcomplex(0.5 - 0.05 * i, 0.02 * s);
+      b[s][i] = dcomplex(-4.0 - 0.3 * std::sin(1.0 * i + s), 0.5);
+      rhs[s][i] = dcomplex(std::cos(0.7 * i), 0.2 * s);
+    }
+  }
+}
+
+/// Largest |A x - rhs| over all systems
+template <class T>
+BoutReal residual(T **a, T **b, T **c, T **rhs, T **x, bool periodic) {
+  BoutReal maxerr = 0.0;
+  for (int s = 0; s < nsys; s++) {
+    for (int i = 0; i < n; i++) {
+      T ax = b[s][i] * x[s][i];
+      if (i > 0) {
+        ax += a[s][i] * x[s][i - 1];
+      } else if (periodic) {
+        ax += a[s][i] * x[s][n - 1];
+      }
+      if (i < n - 1) {
+        ax += c[s][i] * x[s][i + 1];
+      } else if (periodic) {
+        ax += c[s][i] * x[s][0];
+      }
+      maxerr = BOUTMAX(maxerr, std::abs(ax - rhs[s][i]));
+    }
+  }
+  return maxerr;
+}
+
+template <class T>
+void checkSolve(bool periodic) {
+  T **a = matrix<T>(nsys, n);
+  T **b = matrix<T>(nsys, n);
+  T **c = matrix<T>(nsys, n);
+  T **rhs = matrix<T>(nsys, n);
+  T **x = matrix<T>(nsys, n);
+
+  fillCoefs(a, b, c, rhs);
+
+  BatchedTridag<T> tri(nsys, n);
+  tri.setPeriodic(periodic);
+  tri.setCoefs(nsys, a, b, c);
+  tri.solve(nsys, rhs, x);
+
+  EXPECT_LT(residual(a, b, c, rhs, x, periodic), 1e-12);
+
+  // Solve again with a different RHS, reusing the factorisation
+  for (int s = 0; s < nsys; s++) {
+    for (int i = 0; i < n; i++) {
+      rhs[s][i] *= -2.0;
+      rhs[s][i] += 0.1 * i;
+    }
+  }
+  tri.solve(nsys, rhs, x);
+
+  EXPECT_LT(residual(a, b, c, rhs, x, periodic), 1e-12);
+
+  free_matrix(a);
+  free_matrix(b);
+  free_matrix(c);
+  free_matrix(rhs);
+  free_matrix(x);
+}
+} // namespace
+
+TEST(BatchedTridagTest, SolveReal) { checkSolve<BoutReal>(false); }
+
+TEST(BatchedTridagTest, SolvePeriodicReal) { checkSolve<BoutReal>(true); }
+
+TEST(BatchedTridagTest, SolveComplex) { checkSolve<dcomplex>(false); }
+
+TEST(BatchedTridagTest, SolvePeriodicComplex) { checkSolve<dcomplex>(true); }
+
+TEST(BatchedTridagTest, SolveInterleaved) {
+  BoutReal **a = matrix<BoutReal>(nsys, n);
+  BoutReal **b = matrix<BoutReal>(nsys, n);
+  BoutReal **c = matrix<BoutReal>(nsys, n);
+  BoutReal **rhs = matrix<BoutReal>(nsys, n);
+  BoutReal **x = matrix<BoutReal>(nsys, n);
+
+  fillCoefs(a, b, c, rhs);
+
+  BatchedTridag<BoutReal> tri(nsys, n);
+  tri.setCoefs(nsys, a, b, c);
+  tri.solve(nsys, rhs, x);
+
+  // Interleaved, with padding after each row
+  const int ld = nsys + 3;
+  Array<BoutReal> data(n * ld);
+  for (int i = 0; i < n; i++) {
+    for (int s = 0; s < nsys; s++) {
+      data[i * ld + s] = rhs[s][i];
+    }
+  }
+  tri.solve(data.begin(), ld);
+
+  for (int s = 0; s < nsys; s++) {
+    for (int i = 0; i < n; i++) {
+      EXPECT_DOUBLE_EQ(data[i * ld + s], x[s][i]);
+    }
+  }
+
+  free_matrix(a);
+  free_matrix(b);
+  free_matrix(c);
+  free_matrix(rhs);
+  free_matrix(x);
+}
+
+TEST(BatchedTridagTest, ZeroPivot) {
+  BatchedTridag<BoutReal> tri(1, 3);
+  BoutReal a[] = {0.0, 1.0, 1.0}, b[] = {0.0, 1.0, 1.0}, c[] = {1.0, 1.0, 0.0};
+  tri.setCoefs(0, a, b, c);
+
+  EXPECT_THROW(tri.factor(), BoutException);
+}
+
+TEST(BatchedTridagTest, WrongNumberOfSystems) {
+  BatchedTridag<BoutReal> tri(2, 3);
+  BoutReal **rhs = matrix<BoutReal>(3, 3);
+
+  EXPECT_THROW(tri.solve(3, rhs, rhs), BoutException);
+
+  free_matrix(rhs);
+}
+
+TEST(BatchedTridagTest, DiagonallyDominant) {
+  BoutReal a[] = {5.0, 1.0, 1.0}, b[] = {-2.0, -2.0, -2.0}, c[] = {1.0, 1.0, 5.0};
+  // Corners only count if periodic
+  EXPECT_TRUE(BatchedTridag<BoutReal>::diagonallyDominant(3, a, b, c, false));
+  EXPECT_FALSE(BatchedTridag<BoutReal>::diagonallyDominant(3, a, b, c, true));
+
+  b[1] = -1.5;
+  EXPECT_FALSE(BatchedTridag<BoutReal>::diagonallyDominant(3, a, b, c, false));
+
+  dcomplex ac[] = {0.0, dcomplex(0.6, 0.8), 1.0};
+  dcomplex bc[] = {1.0, dcomplex(0.0, 2.0), 1.0};
+  dcomplex cc[] = {0.0, 1.0, 0.0};
+  EXPECT_TRUE(BatchedTridag<dcomplex>::diagonallyDominant(3, ac, bc, cc, false));
+  bc[1] = dcomplex(0.0, 1.9);
+  EXPECT_FALSE(BatchedTridag<dcomplex>::diagonallyDominant(3, ac, bc, cc, false));
+}
+
+TEST(BatchedTridagTest, Identity) {
+  for (bool periodic : {false, true}) {
+    BoutReal **a = matrix<BoutReal>(nsys, n);
+    BoutReal **b = matrix<BoutReal>(nsys, n);
+    BoutReal **c = matrix<BoutReal>(nsys, n);
+    BoutReal **rhs = matrix<BoutReal>(nsys, n);
+    BoutReal **x = matrix<BoutReal>(nsys, n);
+
+    fillCoefs(a, b, c, rhs);
+
+    BatchedTridag<BoutReal> tri(nsys, n);
+    tri.setPeriodic(periodic);
+    tri.setCoefs(nsys, a, b, c);
+    tri.setIdentity(2);
+    tri.solve(nsys, rhs, x);
+
+    for (int i = 0; i < n; i++) {
+      EXPECT_NEAR(x[2][i], rhs[2][i], 1e-12);
+    }
+
+    // The other systems are still solved
+    for (int i = 0; i < n; i++) {
+      a[2][i] = c[2][i] = 0.0;
+      b[2][i] = 1.0;
+    }
+    EXPECT_LT(residual(a, b, c, rhs, x, periodic), 1e-10);
+
+    free_matrix(a);
+    free_matrix(b);
+    free_matrix(c);
+    free_matrix(rhs);
+    free_matrix(x);
+  }
+}
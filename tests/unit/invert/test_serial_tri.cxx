@@ -0,0 +1,117 @@
+#include "gtest/gtest.h"
+
+#include "bout/coordinates.hxx"
+#include "bout/mesh.hxx"
+#include "field2d.hxx"
+#include "fieldperp.hxx"
+#include "invert_laplace.hxx"
+#include "options.hxx"
+#include "test_extras.hxx"
+
+#include <cmath>
+#include <memory>
+
+/// Global mesh
+extern Mesh *mesh;
+
+/// Test fixture to make sure the global mesh is our fake one
+class SerialTriTest : public ::testing::Test {
+protected:
+  static void SetUpTestCase() {
+    // Delete any existing mesh
+    if (mesh != nullptr) {
+      delete mesh;
+      mesh = nullptr;
+    }
+    mesh = new CoordinatesMesh(nx, ny, nz);
+  }
+
+  static void TearDownTestCase() {
+    delete mesh;
+    mesh = nullptr;
+  }
+
+  void SetUp() override {
+    Coordinates *coords = mesh->coordinates();
+    coords->g11 = 1.0;
+    coords->g33 = 1.0;
+    coords->invalidateCoefs();
+
+    Options *opt = Options::getRoot()->getSection("serial_tri_test");
+    opt->set("type", "tri", "test");
+    lap.reset(Laplacian::create(opt));
+
+    b.allocate();
+    b.setIndex(jy);
+    for (int x = 0; x < nx; x++)
+      for (int z = 0; z < nz; z++)
+        b(x, z) = std::sin(0.7 * x + 2.0 * z) + 0.3 * x * x - 0.5;
+  }
+
+  /// Largest difference between Delp2(x) + A x and b, away from the
+  /// two boundary points at each end in X
+  BoutReal residual(const FieldPerp &x, BoutReal a) {
+    FieldPerp lhs = mesh->coordinates()->Delp2(x);
+    BoutReal maxerr = 0.0;
+    for (int ix = 2; ix < nx - 2; ix++)
+      for (int z = 0; z < nz; z++)
+        maxerr = std::max(maxerr, std::abs(lhs(ix, z) + a * x(ix, z) - b(ix, z)));
+    return maxerr;
+  }
+
+  std::unique_ptr<Laplacian> lap;
+  FieldPerp b;
+
+public:
+  static const int nx;
+  static const int ny;
+  static const int nz;
+  static const int jy;
+};
+
+const int SerialTriTest::nx = 9;
+const int SerialTriTest::ny = 3;
+const int SerialTriTest::nz = 8;
+const int SerialTriTest::jy = 1;
+
+TEST_F(SerialTriTest, Solve) {
+  FieldPerp x = lap->solve(b);
+  EXPECT_LT(residual(x, 0.0), 1e-10);
+
+  // Again, with the factorised matrices
+  x = lap->solve(b);
+  EXPECT_LT(residual(x, 0.0), 1e-10);
+}
+
+TEST_F(SerialTriTest, CoefficientChanged) {
+  lap->setCoefA(0.0);
+  FieldPerp x = lap->solve(b);
+  EXPECT_LT(residual(x, 0.0), 1e-10);
+
+  lap->setCoefA(-0.5);
+  x = lap->solve(b);
+  EXPECT_LT(residual(x, -0.5), 1e-10);
+}
+
+TEST_F(SerialTriTest, MetricChanged) {
+  FieldPerp x = lap->solve(b);
+  EXPECT_LT(residual(x, 0.0), 1e-10);
+
+  Coordinates *coords = mesh->coordinates();
+  coords->g11 = 2.0;
+  coords->g33 = 0.5;
+  coords->invalidateCoefs();
+
+  x = lap->solve(b);
+  EXPECT_LT(residual(x, 0.0), 1e-10);
+}
+
+TEST_F(SerialTriTest, NotDiagonallyDominant) {
+  // The kz = 0 matrix has diagonal -1 and off-diagonals 1, so needs
+  // pivoting, and the other modes don't
+  lap->setCoefA(1.0);
+  for (int i = 0; i < 2; i++) {
+    FieldPerp x = lap->solve(b);
+    EXPECT_LT(residual(x, 1.0), 1e-10);
+  }
+}
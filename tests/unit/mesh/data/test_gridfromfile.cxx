@@ -0,0 +1,183 @@
+#include "gtest/gtest.h"
+#include "test_extras.hxx"
+
+#include "bout/griddata.hxx"
+#include "dataformat.hxx"
+#include "field2d.hxx"
+#include "options.hxx"
+#include "unused.hxx"
+
+#include <memory>
+
+namespace {
+const int nx = 5, ny = 6, nz = 2;
+
+/// A DataFormat holding one 2D variable "f", which counts reads
+class FakeDataFormat : public DataFormat {
+public:
+  bool openr(const char *UNUSED(name)) override { return true; }
+  bool openw(const char *UNUSED(name), bool UNUSED(append)) override { return false; }
+  bool is_valid() override { return true; }
+  void close() override {}
+  void flush() override {}
+  const vector<int> getSize(const char *var) override { return getSize(string(var)); }
+  const vector<int> getSize(const string &var) override {
+    if (var == "f")
+      return {nx, ny};
+    return {};
+  }
+  bool setGlobalOrigin(int x, int y, int UNUSED(z)) override {
+    x0 = x;
+    y0 = y;
+    return true;
+  }
+  bool setRecord(int UNUSED(t)) override { return true; }
+
+  bool read(int *UNUSED(var), const char *UNUSED(name), int UNUSED(lx), int UNUSED(ly),
+            int UNUSED(lz)) override {
+    return false;
+  }
+  bool read(int *UNUSED(var), const string &UNUSED(name), int UNUSED(lx), int UNUSED(ly),
+            int UNUSED(lz)) override {
+    return false;
+  }
+  bool read(BoutReal *var, const char *name, int lx, int ly, int lz) override {
+    return read(var, string(name), lx, ly, lz);
+  }
+  bool read(BoutReal *var, const string &name, int lx, int ly, int UNUSED(lz)) override {
+    if (name != "f")
+      return false;
+    reads++;
+    for (int x = 0; x < lx; x++)
+      for (int y = 0; y < ly; y++)
+        var[x * ly + y] = value(x0 + x, y0 + y);
+    return true;
+  }
+
+  bool write(int *UNUSED(var), const char *UNUSED(name), int UNUSED(lx), int UNUSED(ly),
+             int UNUSED(lz)) override {
+    return false;
+  }
+  bool write(int *UNUSED(var), const string &UNUSED(name), int UNUSED(lx), int UNUSED(ly),
+             int UNUSED(lz)) override {
+    return false;
+  }
+  bool write(BoutReal *UNUSED(var), const char *UNUSED(name), int UNUSED(lx),
+             int UNUSED(ly), int UNUSED(lz)) override {
+    return false;
+  }
+  bool write(BoutReal *UNUSED(var), const string &UNUSED(name), int UNUSED(lx),
+             int UNUSED(ly), int UNUSED(lz)) override {
+    return false;
+  }
+  bool read_rec(int *UNUSED(var), const char *UNUSED(name), int UNUSED(lx), int UNUSED(ly),
+                int UNUSED(lz)) override {
+    return false;
+  }
+  bool read_rec(int *UNUSED(var), const string &UNUSED(name), int UNUSED(lx),
+                int UNUSED(ly), int UNUSED(lz)) override {
+    return false;
+  }
+  bool read_rec(BoutReal *UNUSED(var), const char *UNUSED(name), int UNUSED(lx),
+                int UNUSED(ly), int UNUSED(lz)) override {
+    return false;
+  }
+  bool read_rec(BoutReal *UNUSED(var), const string &UNUSED(name), int UNUSED(lx),
+                int UNUSED(ly), int UNUSED(lz)) override {
+    return false;
+  }
+  bool write_rec(int *UNUSED(var), const char *UNUSED(name), int UNUSED(lx),
+                 int UNUSED(ly), int UNUSED(lz)) override {
+    return false;
+  }
+  bool write_rec(int *UNUSED(var), const string &UNUSED(name), int UNUSED(lx),
+                 int UNUSED(ly), int UNUSED(lz)) override {
+    return false;
+  }
+  bool write_rec(BoutReal *UNUSED(var), const char *UNUSED(name), int UNUSED(lx),
+                 int UNUSED(ly), int UNUSED(lz)) override {
+    return false;
+  }
+  bool write_rec(BoutReal *UNUSED(var), const string &UNUSED(name), int UNUSED(lx),
+                 int UNUSED(ly), int UNUSED(lz)) override {
+    return false;
+  }
+
+  static BoutReal value(int x, int y) { return 10. * x + y; }
+
+  int reads = 0; ///< Number of reads of "f"
+
+private:
+  int x0 = 0, y0 = 0;
+};
+
+/// A FakeMesh covering the whole grid file, including guard cells
+FakeMesh *gridMesh() {
+  FakeMesh *m = new FakeMesh(nx, ny, nz);
+  m->GlobalNx = nx;
+  m->GlobalNy = ny;
+  m->OffsetX = 0;
+  m->OffsetY = 0;
+  return m;
+}
+} // namespace
+
+class GridFromFileTest : public ::testing::Test {
+public:
+  ~GridFromFileTest() {
+    Options::getRoot()->getSection("mesh")->set("cache_grid", false, "test");
+    GridFile::clearCache();
+  }
+
+  /// Create a GridFile reading from a new FakeDataFormat. The
+  /// cache_grid option is read here
+  std::unique_ptr<GridFile> makeGrid() {
+    format = new FakeDataFormat;
+    return std::unique_ptr<GridFile>(
+        new GridFile(std::unique_ptr<DataFormat>(format), "grid.nc"));
+  }
+
+  FakeDataFormat *format = nullptr; ///< Owned by the GridFile
+};
+
+TEST_F(GridFromFileTest, NotCachedByDefault) {
+  auto grid = makeGrid();
+  std::unique_ptr<FakeMesh> m(gridMesh());
+  Field2D a, b;
+
+  EXPECT_TRUE(grid->get(m.get(), a, "f"));
+  EXPECT_TRUE(grid->get(m.get(), b, "f"));
+  EXPECT_EQ(format->reads, 2);
+  EXPECT_EQ(a.getMesh(), m.get());
+  EXPECT_DOUBLE_EQ(a(2, 3), FakeDataFormat::value(2, 3));
+}
+
+TEST_F(GridFromFileTest, CacheKeepsMesh) {
+  Options::getRoot()->getSection("mesh")->set("cache_grid", true, "test");
+  auto grid = makeGrid();
+
+  std::unique_ptr<FakeMesh> first(gridMesh()), second(gridMesh());
+  Field2D a, b, c;
+
+  EXPECT_TRUE(grid->get(first.get(), a, "f"));
+  EXPECT_TRUE(grid->get(first.get(), b, "f"));
+  EXPECT_EQ(format->reads, 1);
+  EXPECT_EQ(b.getMesh(), first.get());
+  EXPECT_DOUBLE_EQ(b(2, 3), FakeDataFormat::value(2, 3));
+
+  // Modifying the result doesn't change the cache
+  b(2, 3) = -1.0;
+  EXPECT_TRUE(grid->get(first.get(), b, "f"));
+  EXPECT_DOUBLE_EQ(b(2, 3), FakeDataFormat::value(2, 3));
+
+  // Another mesh reads the file again, and the field is on that mesh
+  EXPECT_TRUE(grid->get(second.get(), c, "f"));
+  EXPECT_EQ(format->reads, 2);
+  EXPECT_EQ(c.getMesh(), second.get());
+
+  // Clearing one mesh's fields leaves the other's
+  GridFile::clearCache(first.get());
+  EXPECT_TRUE(grid->get(first.get(), a, "f"));
+  EXPECT_TRUE(grid->get(second.get(), c, "f"));
+  EXPECT_EQ(format->reads, 3);
+}
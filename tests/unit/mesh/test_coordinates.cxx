@@ -0,0 +1,153 @@
+#include "gtest/gtest.h"
+
+#include "bout/constants.hxx"
+#include "bout/coordinates.hxx"
+#include "bout/mesh.hxx"
+#include "fft.hxx"
+#include "field2d.hxx"
+#include "field3d.hxx"
+#include "fieldperp.hxx"
+#include "invert_laplace.hxx"
+#include "test_extras.hxx"
+
+#include <cmath>
+#include <vector>
+
+/// Global mesh
+extern Mesh *mesh;
+
+/// Test fixture to make sure the global mesh is our fake one, with
+/// a metric which varies in X and Y
+class Delp2Test : public ::testing::Test {
+protected:
+  static void SetUpTestCase() {
+    // Delete any existing mesh
+    if (mesh != nullptr) {
+      delete mesh;
+      mesh = nullptr;
+    }
+    mesh = new CoordinatesMesh(nx, ny, nz);
+  }
+
+  static void TearDownTestCase() {
+    delete mesh;
+    mesh = nullptr;
+  }
+
+  void SetUp() {
+    Coordinates *coords = mesh->coordinates();
+    coords->g11.allocate();
+    coords->g33.allocate();
+    coords->g13.allocate();
+    coords->G1.allocate();
+    coords->G3.allocate();
+    for (int x = 0; x < nx; x++)
+      for (int y = 0; y < ny; y++) {
+        coords->g11(x, y) = 1.0 + 0.1 * x + 0.05 * y;
+        coords->g33(x, y) = 2.0 - 0.2 * x + 0.1 * y;
+        coords->g13(x, y) = 0.3 + 0.02 * x * y;
+        coords->G1(x, y) = 0.4 - 0.1 * y;
+        coords->G3(x, y) = 0.1 * x;
+      }
+    coords->invalidateCoefs();
+
+    f.allocate();
+    for (int x = 0; x < nx; x++)
+      for (int y = 0; y < ny; y++)
+        for (int z = 0; z < nz; z++) {
+          BoutReal zpos = TWOPI * z / nz;
+          f(x, y, z) = x * x + y + std::sin(zpos + 0.1 * x) +
+                       0.5 * x * std::cos(3.0 * zpos) + (((x + z) % 3) == 0);
+        }
+  }
+
+  /// Delp2 of \p f at (\p jx, \p jy), taking each Fourier mode with the
+  /// coefficients of the default Laplacian, as done before these were
+  /// cached by Coordinates
+  static std::vector<BoutReal> delp2Reference(const Field3D &f, int jx, int jy) {
+    int nmodes = nz / 2 + 1;
+    std::vector<dcomplex> fm(nmodes), f0(nmodes), fp(nmodes), delft(nmodes);
+    rfft(&f(jx - 1, jy, 0), nz, fm.data());
+    rfft(&f(jx, jy, 0), nz, f0.data());
+    rfft(&f(jx + 1, jy, 0), nz, fp.data());
+
+    for (int jz = 0; jz < nmodes; jz++) {
+      dcomplex a, b, c;
+      laplace_tridag_coefs(jx, jy, jz, a, b, c);
+      delft[jz] = a * fm[jz] + b * f0[jz] + c * fp[jz];
+    }
+
+    std::vector<BoutReal> result(nz);
+    irfft(delft.data(), nz, result.data());
+    return result;
+  }
+
+  Field3D f;
+
+public:
+  static const int nx;
+  static const int ny;
+  static const int nz;
+};
+
+const int Delp2Test::nx = 6;
+const int Delp2Test::ny = 3;
+const int Delp2Test::nz = 8;
+
+TEST_F(Delp2Test, Field3DMatchesModes) {
+  Field3D result = mesh->coordinates()->Delp2(f);
+
+  for (int x = 0; x < nx; x++)
+    for (int y = 0; y < ny; y++) {
+      if ((x < mesh->xstart) || (x > mesh->xend)) {
+        for (int z = 0; z < nz; z++)
+          EXPECT_DOUBLE_EQ(result(x, y, z), 0.0);
+        continue;
+      }
+      std::vector<BoutReal> expected = delp2Reference(f, x, y);
+      for (int z = 0; z < nz; z++)
+        EXPECT_NEAR(result(x, y, z), expected[z], 1e-10);
+    }
+}
+
+TEST_F(Delp2Test, FieldPerpMatchesModes) {
+  const int y = 1;
+  FieldPerp fp = sliceXZ(f, y);
+  FieldPerp result = mesh->coordinates()->Delp2(fp);
+
+  EXPECT_EQ(result.getIndex(), y);
+
+  // All points except the X edges, including x = 1 and x = nx - 2
+  for (int x = 1; x < nx - 1; x++) {
+    std::vector<BoutReal> expected = delp2Reference(f, x, y);
+    for (int z = 0; z < nz; z++)
+      EXPECT_NEAR(result(x, z), expected[z], 1e-10);
+  }
+  for (int z = 0; z < nz; z++) {
+    EXPECT_DOUBLE_EQ(result(0, z), 0.0);
+    EXPECT_DOUBLE_EQ(result(nx - 1, z), 0.0);
+  }
+}
+
+TEST_F(Delp2Test, FollowsMetricChange) {
+  Coordinates *coords = mesh->coordinates();
+  Field3D before = coords->Delp2(f);
+
+  // Change the metric without calling geometry()
+  coords->g33 *= 2.0;
+  coords->g13 = 0.0;
+  coords->invalidateCoefs();
+
+  Field3D after = coords->Delp2(f);
+
+  bool changed = false;
+  for (int x = mesh->xstart; x <= mesh->xend; x++)
+    for (int y = 0; y < ny; y++) {
+      std::vector<BoutReal> expected = delp2Reference(f, x, y);
+      for (int z = 0; z < nz; z++) {
+        EXPECT_NEAR(after(x, y, z), expected[z], 1e-10);
+        changed |= std::abs(after(x, y, z) - before(x, y, z)) > 1e-6;
+      }
+    }
+  EXPECT_TRUE(changed);
+}
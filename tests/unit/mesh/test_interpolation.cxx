@@ -0,0 +1,236 @@
+#include "gtest/gtest.h"
+
+#include "bout/constants.hxx"
+#include "bout/mesh.hxx"
+#include "field3d.hxx"
+#include "interpolation.hxx"
+#include "options.hxx"
+#include "test_extras.hxx"
+
+#include <cmath>
+#include <vector>
+
+/// Global mesh
+extern Mesh *mesh;
+
+namespace {
+/// A FakeMesh which can take index derivatives, with the default methods
+class DerivativeMesh : public FakeMesh {
+public:
+  DerivativeMesh(int nx, int ny, int nz) : FakeMesh(nx, ny, nz) {
+    derivs_init(Options::getRoot()->getSection("mesh"));
+  }
+};
+} // namespace
+
+/// Test fixture to make sure the global mesh is our fake one
+class HermiteSplineTest : public ::testing::Test {
+protected:
+  static void SetUpTestCase() {
+    // Delete any existing mesh
+    if (mesh != nullptr) {
+      delete mesh;
+      mesh = nullptr;
+    }
+    mesh = new DerivativeMesh(nx, ny, nz);
+  }
+
+  static void TearDownTestCase() {
+    delete mesh;
+    mesh = nullptr;
+  }
+
+  void TearDown() override {
+    Options::getRoot()->getSection("interpolation")->set("combine_weights", false, "test");
+  }
+
+  /// Interpolate \p f with combine_weights set to \p combine
+  Field3D interpolate(bool combine, const Field3D &f, const Field3D &delta_x,
+                      const Field3D &delta_z, bool &used_combined) {
+    Options::getRoot()->getSection("interpolation")->set("combine_weights", combine, "test");
+    HermiteSpline interp;
+    Field3D result = interp.interpolate(f, delta_x, delta_z);
+    used_combined = interp.usesCombined();
+    return result;
+  }
+
+  /// A smooth field, set everywhere including guard cells
+  Field3D testField() {
+    Field3D f;
+    f.allocate();
+    for (int x = 0; x < nx; x++)
+      for (int y = 0; y < ny; y++)
+        for (int z = 0; z < nz; z++)
+          f(x, y, z) = std::sin(0.7 * x + 0.3 * y) * std::cos(2.0 * M_PI * z / nz) + 0.1 * x * x;
+    return f;
+  }
+
+  /// Displacements in X starting at \p xmin, and in Z which wrap around
+  void testDelta(BoutReal xmin, Field3D &delta_x, Field3D &delta_z) {
+    delta_x.allocate();
+    delta_z.allocate();
+    for (int x = 0; x < nx; x++)
+      for (int y = 0; y < ny; y++)
+        for (int z = 0; z < nz; z++) {
+          delta_x(x, y, z) = xmin + std::fmod(0.37 * (x + 2 * y + 3 * z), nx - 3.0 - xmin);
+          delta_z(x, y, z) = z + 0.61 * (x - y) + 0.2 * z;
+        }
+  }
+
+public:
+  static const int nx;
+  static const int ny;
+  static const int nz;
+};
+
+const int HermiteSplineTest::nx = 9;
+const int HermiteSplineTest::ny = 4;
+const int HermiteSplineTest::nz = 8;
+
+TEST_F(HermiteSplineTest, NotCombinedByDefault) {
+  Field3D delta_x, delta_z;
+  testDelta(1.0, delta_x, delta_z);
+
+  HermiteSpline interp;
+  interp.calcWeights(delta_x, delta_z);
+  EXPECT_FALSE(interp.usesCombined());
+}
+
+TEST_F(HermiteSplineTest, CombinedMatchesSeparate) {
+  Field3D f = testField();
+  Field3D delta_x, delta_z;
+  testDelta(1.0, delta_x, delta_z);
+
+  bool used_combined;
+  Field3D separate = interpolate(false, f, delta_x, delta_z, used_combined);
+  EXPECT_FALSE(used_combined);
+  Field3D combined = interpolate(true, f, delta_x, delta_z, used_combined);
+  EXPECT_TRUE(used_combined);
+
+  for (int x = mesh->xstart; x <= mesh->xend; x++)
+    for (int y = mesh->ystart; y <= mesh->yend; y++)
+      for (int z = 0; z < nz; z++)
+        EXPECT_NEAR(combined(x, y, z), separate(x, y, z), 1e-12);
+}
+
+TEST_F(HermiteSplineTest, NotCombinedNearXEdge) {
+  Field3D f = testField();
+  Field3D delta_x, delta_z;
+  // Some points in the first cell, where the X derivative isn't central
+  testDelta(0.5, delta_x, delta_z);
+
+  bool used_combined;
+  Field3D separate = interpolate(false, f, delta_x, delta_z, used_combined);
+  Field3D combined = interpolate(true, f, delta_x, delta_z, used_combined);
+  EXPECT_FALSE(used_combined);
+
+  // The X derivative in the guard cell isn't set, so only compare
+  // points interpolated from further in
+  for (int x = mesh->xstart; x <= mesh->xend; x++)
+    for (int y = mesh->ystart; y <= mesh->yend; y++)
+      for (int z = 0; z < nz; z++)
+        if (delta_x(x, y, z) >= 1.0)
+          EXPECT_DOUBLE_EQ(combined(x, y, z), separate(x, y, z));
+}
+
+/// Test fixture for interp_to, with staggered grids and the cache enabled
+class InterpCacheTest : public ::testing::Test {
+protected:
+  static void SetUpTestCase() {
+    // Delete any existing mesh
+    if (mesh != nullptr) {
+      delete mesh;
+      mesh = nullptr;
+    }
+    mesh = new FakeMesh(nx, ny, nz);
+    mesh->StaggerGrids = true;
+    Options::getRoot()->getSection("mesh")->set("interp_cache", true, "test");
+  }
+
+  static void TearDownTestCase() {
+    interp_clear_cache();
+    delete mesh;
+    mesh = nullptr;
+  }
+
+  void SetUp() override {
+    interp_clear_cache();
+    f.allocate();
+    for (int x = 0; x < nx; x++)
+      for (int y = 0; y < ny; y++)
+        for (int z = 0; z < nz; z++)
+          f(x, y, z) = std::sin(x + 0.3 * y + 2.0 * TWOPI * z / nz);
+  }
+
+  /// The value of \p var interpolated from cell centre to CELL_ZLOW
+  static BoutReal toZlow(const Field3D &var, int x, int y, int z) {
+    auto v = [&](int k) { return var(x, y, (z + k + nz) % nz); };
+    return (9. * (v(-1) + v(0)) - v(-2) - v(1)) / 16.;
+  }
+
+  Field3D f;
+
+public:
+  static const int nx;
+  static const int ny;
+  static const int nz;
+};
+
+const int InterpCacheTest::nx = 3;
+const int InterpCacheTest::ny = 5;
+const int InterpCacheTest::nz = 8;
+
+TEST_F(InterpCacheTest, RepeatedInterpolation) {
+  Field3D first = interp_to(f, CELL_ZLOW);
+  Field3D second = interp_to(f, CELL_ZLOW);
+
+  EXPECT_EQ(second.getLocation(), CELL_ZLOW);
+  for (int x = 0; x < nx; x++)
+    for (int y = mesh->ystart; y <= mesh->yend; y++)
+      for (int z = 0; z < nz; z++) {
+        EXPECT_DOUBLE_EQ(first(x, y, z), toZlow(f, x, y, z));
+        EXPECT_DOUBLE_EQ(second(x, y, z), first(x, y, z));
+      }
+}
+
+TEST_F(InterpCacheTest, InputChangedInPlace) {
+  Field3D first = interp_to(f, CELL_ZLOW);
+
+  // Same data block, different values
+  f(1, 2, 3) = 10.0;
+  Field3D second = interp_to(f, CELL_ZLOW);
+
+  EXPECT_NE(second(1, 2, 3), first(1, 2, 3));
+  for (int x = 0; x < nx; x++)
+    for (int y = mesh->ystart; y <= mesh->yend; y++)
+      for (int z = 0; z < nz; z++)
+        EXPECT_DOUBLE_EQ(second(x, y, z), toZlow(f, x, y, z));
+}
+
+TEST_F(InterpCacheTest, ResultChangedInPlace) {
+  Field3D first = interp_to(f, CELL_ZLOW);
+  BoutReal expected = first(1, 2, 3);
+
+  first(1, 2, 3) = 10.0;
+  Field3D second = interp_to(f, CELL_ZLOW);
+
+  EXPECT_DOUBLE_EQ(second(1, 2, 3), expected);
+}
+
+TEST_F(InterpCacheTest, ManyFields) {
+  // More fields than the default number of entries
+  const int nfields = 20;
+  std::vector<Field3D> fields(nfields);
+  for (int i = 0; i < nfields; i++) {
+    fields[i] = f * (i + 1.0);
+    interp_to(fields[i], CELL_ZLOW);
+  }
+
+  for (int i = 0; i < nfields; i++) {
+    Field3D result = interp_to(fields[i], CELL_ZLOW);
+    for (int x = 0; x < nx; x++)
+      for (int y = mesh->ystart; y <= mesh->yend; y++)
+        for (int z = 0; z < nz; z++)
+          EXPECT_DOUBLE_EQ(result(x, y, z), toZlow(fields[i], x, y, z));
+  }
+}
@@ -0,0 +1,93 @@
+#include "gtest/gtest.h"
+
+#include "bout/constants.hxx"
+#include "bout/mesh.hxx"
+#include "boutexception.hxx"
+#include "field3d.hxx"
+#include "gyro_average.hxx"
+#include "options.hxx"
+#include "test_extras.hxx"
+
+#include <cmath>
+
+/// Global mesh
+extern Mesh *mesh;
+
+/// Test fixture to make sure the global mesh is our fake one
+class GyroAverageTest : public ::testing::Test {
+protected:
+  static void SetUpTestCase() {
+    // Delete any existing mesh
+    if (mesh != nullptr) {
+      delete mesh;
+      mesh = nullptr;
+    }
+    mesh = new CoordinatesMesh(nx, ny, nz);
+  }
+
+  static void TearDownTestCase() {
+    delete mesh;
+    mesh = nullptr;
+  }
+
+public:
+  static const int nx;
+  static const int ny;
+  static const int nz;
+};
+
+const int GyroAverageTest::nx = 3;
+const int GyroAverageTest::ny = 4;
+const int GyroAverageTest::nz = 16;
+
+TEST_F(GyroAverageTest, BesselJ0ZeroRadius) {
+  Field3D f;
+  f.allocate();
+  for (int x = 0; x < nx; x++)
+    for (int y = 0; y < ny; y++)
+      for (int z = 0; z < nz; z++)
+        f(x, y, z) = x + 2.0 * y + std::sin(3.0 * TWOPI * z / nz) + ((z % 3) == 0);
+
+  GyroAverage gyro(0.0);
+  Field3D result = gyro.besselJ0(f);
+
+  for (int x = 0; x < nx; x++)
+    for (int y = 0; y < ny; y++)
+      for (int z = 0; z < nz; z++)
+        EXPECT_NEAR(result(x, y, z), f(x, y, z), 1e-12);
+}
+
+TEST_F(GyroAverageTest, BesselJ0SingleModes) {
+  // With unit metric and a Z domain of length 2pi, mode n has
+  // k_perp = n, so is multiplied by J0(n rho)
+  const BoutReal rho = 0.3;
+  Field3D f;
+  f.allocate();
+  for (int x = 0; x < nx; x++)
+    for (int y = 0; y < ny; y++)
+      for (int z = 0; z < nz; z++) {
+        BoutReal zpos = TWOPI * z / nz;
+        f(x, y, z) = 1.5 + std::cos(zpos) + (x + 1) * std::sin(4.0 * zpos);
+      }
+
+  GyroAverage gyro(rho);
+  Field3D result = gyro.besselJ0(f);
+
+  for (int x = 0; x < nx; x++)
+    for (int y = 0; y < ny; y++)
+      for (int z = 0; z < nz; z++) {
+        BoutReal zpos = TWOPI * z / nz;
+        BoutReal expected = 1.5 + j0(rho) * std::cos(zpos)
+                            + j0(4.0 * rho) * (x + 1) * std::sin(4.0 * zpos);
+        EXPECT_NEAR(result(x, y, z), expected, 1e-12);
+      }
+}
+
+TEST_F(GyroAverageTest, PadeBoundaryValuesNotSupported) {
+  Field3D f = 1.0;
+
+  // Old-style flags: one boundary cell, and set the inner boundary
+  const int flags = 64 + 4096;
+  GyroAverage gyro(0.3, flags);
+  EXPECT_THROW(gyro.pade1(f), BoutException);
+}
@@ -0,0 +1,214 @@
+#include "gtest/gtest.h"
+
+#include "bout/mesh.hxx"
+#include "bout/paralleltransform.hxx"
+#include "field3d.hxx"
+#include "smoothing.hxx"
+#include "test_extras.hxx"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+/// Global mesh
+extern Mesh *mesh;
+
+namespace {
+// Versions of the smoothing functions before they were changed to work
+// on whole fields, which the new versions should match exactly
+
+void old_nl_filter(std::vector<BoutReal> &f, BoutReal w) {
+  for (size_t i = 1; i < f.size() - 1; i++) {
+    BoutReal dp = f[i + 1] - f[i];
+    BoutReal dm = f[i - 1] - f[i];
+    if (dp * dm > 0.) {
+      // Local extrema - adjust
+      BoutReal ep, em, e; // Amount to adjust by
+      if (fabs(dp) > fabs(dm)) {
+        ep = w * 0.5 * dp;
+        em = w * dm;
+        e = (fabs(ep) < fabs(em)) ? ep : em; // Pick smallest absolute
+        // Adjust
+        f[i + 1] -= e;
+        f[i] += e;
+      } else {
+        ep = w * 0.5 * dm;
+        em = w * dp;
+        e = (fabs(ep) < fabs(em)) ? ep : em; // Pick smallest absolute
+        // Adjust
+        f[i - 1] -= e;
+        f[i] += e;
+      }
+    }
+  }
+}
+
+/// Old nl_filter along direction \p dir (0 = X, 1 = Y, 2 = Z)
+Field3D old_nl_filter_dir(const Field3D &f, BoutReal w, int dir) {
+  Field3D result;
+  result.allocate();
+
+  int n[3] = {mesh->LocalNx, mesh->LocalNy, mesh->LocalNz};
+  // The two indices other than dir
+  int d1 = (dir + 1) % 3, d2 = (dir + 2) % 3;
+  std::vector<BoutReal> v(n[dir]);
+  int ind[3];
+  for (ind[d1] = 0; ind[d1] < n[d1]; ind[d1]++)
+    for (ind[d2] = 0; ind[d2] < n[d2]; ind[d2]++) {
+      for (ind[dir] = 0; ind[dir] < n[dir]; ind[dir]++)
+        v[ind[dir]] = f(ind[0], ind[1], ind[2]);
+      old_nl_filter(v, w);
+      for (ind[dir] = 0; ind[dir] < n[dir]; ind[dir]++)
+        result(ind[0], ind[1], ind[2]) = v[ind[dir]];
+    }
+  return result;
+}
+
+Field3D old_smooth_x(const Field3D &f) {
+  Field3D result;
+  result.allocate();
+  for (int jy = 0; jy < mesh->LocalNy; jy++)
+    for (int jz = 0; jz < mesh->LocalNz; jz++) {
+      result(0, jy, jz) = f(0, jy, jz);
+      result(mesh->LocalNx - 1, jy, jz) = f(mesh->LocalNx - 1, jy, jz);
+    }
+  for (int jx = 1; jx < mesh->LocalNx - 1; jx++)
+    for (int jy = 0; jy < mesh->LocalNy; jy++)
+      for (int jz = 0; jz < mesh->LocalNz; jz++)
+        result(jx, jy, jz) = 0.5 * f(jx, jy, jz) + 0.25 * (f(jx - 1, jy, jz) + f(jx + 1, jy, jz));
+  return result;
+}
+
+Field3D old_smooth_y(const Field3D &f) {
+  Field3D result;
+  result.allocate();
+  for (int jx = 0; jx < mesh->LocalNx; jx++)
+    for (int jz = 0; jz < mesh->LocalNz; jz++) {
+      result(jx, 0, jz) = f(jx, 0, jz);
+      result(jx, mesh->LocalNy - 1, jz) = f(jx, mesh->LocalNy - 1, jz);
+    }
+  for (int jx = 0; jx < mesh->LocalNx; jx++)
+    for (int jy = 1; jy < mesh->LocalNy - 1; jy++)
+      for (int jz = 0; jz < mesh->LocalNz; jz++)
+        result(jx, jy, jz) = 0.5 * f(jx, jy, jz) +
+                             0.25 * (f.ydown()(jx, jy - 1, jz) + f.yup()(jx, jy + 1, jz));
+  return result;
+}
+
+/// Old smoothXY, at one interior point
+BoutReal old_smoothXY(const Field3D &f, int x, int y, int z) {
+  return 0.5 * f(x, y, z) +
+         0.125 * (0.5 * f(x + 1, y, z) +
+                  0.125 * (f(x + 2, y, z) + f(x, y, z) + f(x + 1, y - 1, z) + f(x + 1, y + 1, z)) +
+                  0.5 * f(x - 1, y, z) +
+                  0.125 * (f(x, y, z) + f(x - 2, y, z) + f(x - 1, y - 1, z) + f(x - 1, y + 1, z)) +
+                  0.5 * f(x, y - 1, z) +
+                  0.125 * (f(x + 1, y - 1, z) + f(x - 1, y - 1, z) + f(x, y - 2, z) + f(x, y, z)) +
+                  0.5 * f(x, y + 1, z) +
+                  0.125 * (f(x + 1, y + 1, z) + f(x - 1, y + 1, z) + f(x, y, z) + f(x, y + 2, z)));
+}
+} // namespace
+
+/// Test fixture to make sure the global mesh is our fake one
+class SmoothingTest : public ::testing::Test {
+protected:
+  static void SetUpTestCase() {
+    // Delete any existing mesh
+    if (mesh != nullptr) {
+      delete mesh;
+      mesh = nullptr;
+    }
+    mesh = new FakeMesh(nx, ny, nz);
+    // Used by communicate and nl_filter_y. FakeMesh has no options to set it from
+    mesh->setParallelTransform(
+        std::unique_ptr<ParallelTransform>(new ParallelTransformIdentity()));
+  }
+
+  static void TearDownTestCase() {
+    delete mesh;
+    mesh = nullptr;
+  }
+
+  void SetUp() {
+    // Rough data, with many local extrema in every direction
+    f.allocate();
+    for (int x = 0; x < nx; x++)
+      for (int y = 0; y < ny; y++)
+        for (int z = 0; z < nz; z++)
+          f(x, y, z) = std::sin(1.7 * x * x + 2.3 * y + 3.1 * z * z) + 0.1 * x - 0.05 * z;
+  }
+
+  Field3D f;
+
+public:
+  static const int nx;
+  static const int ny;
+  static const int nz;
+};
+
+const int SmoothingTest::nx = 7;
+const int SmoothingTest::ny = 8;
+const int SmoothingTest::nz = 6;
+
+/// Is \p field equal to \p expected at every point?
+static void expectFieldsEqual(const Field3D &field, const Field3D &expected) {
+  for (int x = 0; x < mesh->LocalNx; x++)
+    for (int y = 0; y < mesh->LocalNy; y++)
+      for (int z = 0; z < mesh->LocalNz; z++)
+        EXPECT_DOUBLE_EQ(field(x, y, z), expected(x, y, z))
+            << "at (" << x << ", " << y << ", " << z << ")";
+}
+
+TEST_F(SmoothingTest, SmoothXMatchesPrevious) {
+  expectFieldsEqual(smooth_x(f), old_smooth_x(f));
+}
+
+TEST_F(SmoothingTest, SmoothYMatchesPrevious) {
+  // Sets yup and ydown
+  mesh->communicate(f);
+  expectFieldsEqual(smooth_y(f), old_smooth_y(f));
+}
+
+TEST_F(SmoothingTest, SmoothXYMatchesPrevious) {
+  Field3D result = smoothXY(f);
+
+  for (int x = 0; x < nx; x++)
+    for (int y = 0; y < ny; y++)
+      for (int z = 0; z < nz; z++) {
+        if ((x < 2) || (x >= nx - 2) || (y < 2) || (y >= ny - 2)) {
+          // Not smoothed. Previously uninitialised, now a copy of the input
+          EXPECT_DOUBLE_EQ(result(x, y, z), f(x, y, z));
+        } else {
+          EXPECT_DOUBLE_EQ(result(x, y, z), old_smoothXY(f, x, y, z));
+        }
+      }
+}
+
+TEST_F(SmoothingTest, NLFilterXMatchesPrevious) {
+  for (BoutReal w : {1.0, 0.3}) {
+    expectFieldsEqual(nl_filter_x(f, w), old_nl_filter_dir(f, w, 0));
+  }
+}
+
+TEST_F(SmoothingTest, NLFilterYMatchesPrevious) {
+  for (BoutReal w : {1.0, 0.3}) {
+    expectFieldsEqual(nl_filter_y(f, w), old_nl_filter_dir(f, w, 1));
+  }
+}
+
+TEST_F(SmoothingTest, NLFilterZMatchesPrevious) {
+  for (BoutReal w : {1.0, 0.3}) {
+    expectFieldsEqual(nl_filter_z(f, w), old_nl_filter_dir(f, w, 2));
+  }
+}
+
+TEST_F(SmoothingTest, NLFilterChangesExtrema) {
+  // Check the comparisons above are not trivial
+  Field3D result = nl_filter_x(f, 1.0);
+  BoutReal maxdiff = 0.0;
+  for (int x = 0; x < nx; x++)
+    for (int y = 0; y < ny; y++)
+      for (int z = 0; z < nz; z++)
+        maxdiff = std::max(maxdiff, std::abs(result(x, y, z) - f(x, y, z)));
+  EXPECT_GT(maxdiff, 1e-3);
+}
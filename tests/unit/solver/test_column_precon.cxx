@@ -0,0 +1,159 @@
+#include "gtest/gtest.h"
+#include "bout/column_precon.hxx"
+#include "boutexception.hxx"
+
+#include <cmath>
+#include <vector>
+
+namespace {
+const int nx = 4, ny = 3, nz = 8;
+const int n2d = 1, n3d = 2;
+const int ncol = n2d + nz * n3d;
+const BoutReal gam = 0.5;
+
+/// z index of element e in a column, -1 for 2D
+int zindex(int e) { return (e < n2d) ? -1 : (e - n2d) / n3d; }
+
+/// Coupling between elements e and e2 in the same column
+BoutReal localCoef(int e, int e2, bool banded) {
+  if(e == e2)
+    return -2.0;
+  if(banded) {
+    // 2D rows only depend on 2D variables, and z coupling is to
+    // nearest neighbours, not periodic
+    if(zindex(e) < 0)
+      return (zindex(e2) < 0) ? 0.1 : 0.0;
+    if((zindex(e2) >= 0) && (std::abs(zindex(e) - zindex(e2)) > 1))
+      return 0.0;
+  }
+  return 0.1 * std::cos(e + 2.0 * e2);
+}
+
+/// Linear RHS, coupling each column to its neighbours in x and y.
+/// If \p periodic then y = ny - 1 and y = 0 are neighbours
+void rhs(const BoutReal *u, BoutReal *f, bool banded, bool periodic) {
+  for(int x = 0; x < nx; x++) {
+    for(int y = 0; y < ny; y++) {
+      const int c = (x * ny + y) * ncol;
+      for(int e = 0; e < ncol; e++) {
+        BoutReal val = 0.0;
+        for(int e2 = 0; e2 < ncol; e2++)
+          val += localCoef(e, e2, banded) * u[c + e2];
+        if(x > 0)
+          val += 0.3 * u[c - ny * ncol + e];
+        if(x < nx - 1)
+          val += 0.3 * u[c + ny * ncol + e];
+        if(y > 0)
+          val += 0.2 * u[c - ncol + e];
+        else if(periodic)
+          val += 0.2 * u[c + (ny - 1) * ncol + e];
+        if(y < ny - 1)
+          val += 0.2 * u[c + ncol + e];
+        else if(periodic)
+          val += 0.2 * u[c - (ny - 1) * ncol + e];
+        f[c + e] = val;
+      }
+    }
+  }
+}
+
+/// Largest |(I - gam J_local) z - r|
+BoutReal residual(const std::vector<BoutReal> &r, const std::vector<BoutReal> &z, bool banded) {
+  BoutReal maxerr = 0.0;
+  for(int c = 0; c < nx * ny; c++) {
+    for(int e = 0; e < ncol; e++) {
+      BoutReal val = z[c * ncol + e];
+      for(int e2 = 0; e2 < ncol; e2++)
+        val -= gam * localCoef(e, e2, banded) * z[c * ncol + e2];
+      maxerr = std::max(maxerr, std::abs(val - r[c * ncol + e]));
+    }
+  }
+  return maxerr;
+}
+
+void checkSolve(int zband, bool banded, bool periodic = false) {
+  // With the default two colours, y = 0 and y = ny - 1 would be
+  // perturbed together, so a periodic y needs one colour per point
+  ColumnPrecon precon(nz, n2d, n3d, 1, zband, 0,
+                      periodic ? ColumnPrecon::periodColours(1, ny) : 0);
+  std::vector<bool> evolve2d(n2d, true), evolve3d(n3d, true);
+  for(int x = 0; x < nx; x++)
+    for(int y = 0; y < ny; y++)
+      precon.addColumn(x, y, evolve2d, evolve3d);
+
+  const int N = nx * ny * ncol;
+  ASSERT_EQ(precon.size(), N);
+
+  std::vector<BoutReal> u(N), f(N), inc(N, 1e-6);
+  for(int i = 0; i < N; i++)
+    u[i] = std::sin(0.3 * i);
+  rhs(u.data(), f.data(), banded, periodic);
+
+  int nevals = 0;
+  precon.computeJacobian(u.data(), f.data(), inc.data(), [&](BoutReal *uin, BoutReal *fout) {
+    nevals++;
+    rhs(uin, fout, banded, periodic);
+  });
+  EXPECT_EQ(nevals, precon.numEvaluations());
+
+  precon.factorise(gam);
+
+  std::vector<BoutReal> r(N), z(N);
+  for(int i = 0; i < N; i++)
+    r[i] = std::cos(0.7 * i) + 0.1 * i;
+  precon.solve(r.data(), z.data());
+
+  EXPECT_LT(residual(r, z, banded), 1e-6);
+
+  // Solve in place
+  precon.solve(r.data(), r.data());
+  for(int i = 0; i < N; i++)
+    EXPECT_DOUBLE_EQ(r[i], z[i]);
+}
+} // namespace
+
+TEST(ColumnPreconTest, DenseColumns) { checkSolve(-1, false); }
+
+TEST(ColumnPreconTest, BandedColumns) { checkSolve(1, true); }
+
+TEST(ColumnPreconTest, PeriodicY) { checkSolve(-1, false, true); }
+
+TEST(ColumnPreconTest, PeriodColours) {
+  EXPECT_EQ(ColumnPrecon::periodColours(1, 3), 3);
+  EXPECT_EQ(ColumnPrecon::periodColours(1, 16), 2);
+  EXPECT_EQ(ColumnPrecon::periodColours(2, 12), 3);
+  EXPECT_EQ(ColumnPrecon::periodColours(3, 5), 5);
+  // Fewer points than colours needed
+  EXPECT_EQ(ColumnPrecon::periodColours(3, 2), 0);
+}
+
+TEST(ColumnPreconTest, NumEvaluations) {
+  // Four colours. With zband = 1, z points 4 apart are perturbed together
+  ColumnPrecon banded(nz, n2d, n3d, 1, 1);
+  EXPECT_EQ(banded.numEvaluations(), 4 * (n2d + 4 * n3d));
+
+  // Band covering all z points is the same as dense
+  ColumnPrecon wide(nz, n2d, n3d, 1, 3);
+  ColumnPrecon dense(nz, n2d, n3d, 1, -1);
+  EXPECT_EQ(wide.numEvaluations(), dense.numEvaluations());
+  EXPECT_EQ(dense.numEvaluations(), 4 * ncol);
+}
+
+TEST(ColumnPreconTest, BoundaryColumn) {
+  ColumnPrecon precon(nz, n2d, n3d, 2, -1);
+  precon.addColumn(0, 0, {true}, {true, true});
+  precon.addColumn(0, 1, {false}, {true, false});
+  EXPECT_EQ(precon.size(), ncol + nz);
+  EXPECT_EQ(precon.numNonZeros(), ncol * ncol + nz * nz);
+}
+
+TEST(ColumnPreconTest, WrongNumberOfVariables) {
+  ColumnPrecon precon(nz, n2d, n3d, 2, 2);
+  EXPECT_THROW(precon.addColumn(0, 0, {true, true}, {true, true}), BoutException);
+}
+
+TEST(ColumnPreconTest, FactoriseBeforeJacobian) {
+  ColumnPrecon precon(nz, n2d, n3d, 2, 2);
+  precon.addColumn(0, 0, {true}, {true, true});
+  EXPECT_THROW(precon.factorise(1.0), BoutException);
+}
@@ -1,6 +1,7 @@
 #include "gtest/gtest.h"
 
 #include "bout/array.hxx"
+#include "bout/sys/numa.hxx"
 
 #include <iostream>
 
@@ -127,3 +128,96 @@ TEST_F(ArrayTest, Assignment) {
   EXPECT_FALSE(a.unique());
   EXPECT_FALSE(b.unique());
 }
+
+TEST_F(ArrayTest, FirstTouch) {
+  numaFirstTouch() = true;
+
+  Array<double> a(1000);
+  EXPECT_EQ(a.size(), 1000);
+  EXPECT_TRUE(a.unique());
+
+  for (int i = 0; i < 1000; ++i) {
+    a[i] = i;
+  }
+  double *data = a.begin();
+
+  // Released data is reused for the same size
+  a.clear();
+  Array<double> b(1000);
+  EXPECT_EQ(b.begin(), data);
+  EXPECT_EQ(b[999], 999);
+
+  numaFirstTouch() = false;
+}
+
+#ifdef _OPENMP
+TEST_F(ArrayTest, FirstTouchThreadPrivate) {
+  numaFirstTouch() = true;
+  const int len = 2345;
+
+  // Requested by one thread of a parallel region, so private to it
+  double *data = nullptr;
+  int domain = -1;
+  bool parallel = false;
+  BOUT_OMP(parallel num_threads(2))
+  {
+    BOUT_OMP(master)
+    {
+      parallel = omp_in_parallel();
+      domain = numaDomain();
+      Array<double> a(len);
+      data = a.begin();
+    }
+  }
+
+  // Data spread over domains doesn't come from a thread's store
+  Array<double> b(len);
+  if (parallel) {
+    EXPECT_NE(b.begin(), data);
+  }
+
+  // Nor does data shared by a team
+  double *team = nullptr;
+  ompRunTeam([&]() {
+    BOUT_OMP(master)
+    {
+      Array<double> c(len);
+      team = c.begin();
+    }
+  });
+  if (parallel) {
+    EXPECT_NE(team, data);
+  }
+
+  // Another private array on the same domain reuses the data
+  double *again = nullptr;
+  int again_domain = -1;
+  BOUT_OMP(parallel num_threads(2))
+  {
+    BOUT_OMP(master)
+    {
+      again_domain = numaDomain();
+      Array<double> d(len);
+      again = d.begin();
+    }
+  }
+  if (parallel && (again_domain == domain)) {
+    EXPECT_EQ(again, data);
+  }
+
+  numaFirstTouch() = false;
+}
+#endif
+
+TEST(NumaTest, Domain) {
+  EXPECT_GE(numaDomain(), 0);
+  EXPECT_LT(numaDomain(), numaNumDomains());
+}
+
+TEST(NumaTest, SpreadWork) {
+  // All work divided between threads, in order
+  EXPECT_EQ(DI_spread_work(10, 0, 3), 0);
+  EXPECT_EQ(DI_spread_work(10, 1, 3), 4);
+  EXPECT_EQ(DI_spread_work(10, 2, 3), 7);
+  EXPECT_EQ(DI_spread_work(10, 3, 3), 10);
+}
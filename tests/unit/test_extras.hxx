@@ -5,6 +5,7 @@
 
 #include <mpi.h>
 
+#include "bout/griddata.hxx"
 #include "bout/mesh.hxx"
 #include "field3d.hxx"
 #include "unused.hxx"
@@ -149,4 +150,47 @@ public:
   const Field2D lowPass_poloidal(const Field2D &, int) { return Field2D(0.0); }
 };
 
+/// Grid source which has no variables. As GridFile, fields are set to
+/// the default value. The coordinates are then Cartesian, with unit
+/// spacing in X and Y and a Z domain of length 2pi
+class DefaultGridSource : public GridDataSource {
+public:
+  bool hasVar(const string &UNUSED(name)) override { return false; }
+  bool get(Mesh *UNUSED(m), int &ival, const string &UNUSED(name)) override {
+    ival = 0;
+    return false;
+  }
+  bool get(Mesh *UNUSED(m), BoutReal &rval, const string &UNUSED(name)) override {
+    rval = 0.0;
+    return false;
+  }
+  bool get(Mesh *UNUSED(m), Field2D &var, const string &UNUSED(name),
+           BoutReal def) override {
+    var = def;
+    return false;
+  }
+  bool get(Mesh *UNUSED(m), Field3D &var, const string &UNUSED(name),
+           BoutReal def) override {
+    var = def;
+    return false;
+  }
+  bool get(Mesh *UNUSED(m), vector<int> &UNUSED(var), const string &UNUSED(name),
+           int UNUSED(len), int UNUSED(offset), Direction UNUSED(dir)) override {
+    return false;
+  }
+  bool get(Mesh *UNUSED(m), vector<BoutReal> &UNUSED(var), const string &UNUSED(name),
+           int UNUSED(len), int UNUSED(offset), Direction UNUSED(dir)) override {
+    return false;
+  }
+};
+
+/// A FakeMesh which can create its coordinates, from a DefaultGridSource
+class CoordinatesMesh : public FakeMesh {
+public:
+  CoordinatesMesh(int nx, int ny, int nz) : FakeMesh(nx, ny, nz) {
+    source = new DefaultGridSource;
+    derivs_init(Options::getRoot()->getSection("mesh"));
+  }
+};
+
 #endif //  TEST_EXTRAS_H__